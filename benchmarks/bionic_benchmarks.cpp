@@ -526,6 +526,14 @@ std::map<std::string, args_vector_t> GetShorthand() {
 
     {"MATH_COMMON", args_vector_t{ {0}, {1}, {2}, {3} }},
     {"MATH_SINCOS_COMMON", args_vector_t{ {0}, {1}, {2}, {3}, {4}, {5}, {6}, {7} }},
+    {"MATH_INVERSE_TRIG_COMMON", args_vector_t{ {0}, {1}, {2} }},
+    {"MATH_ACCURACY_DOMAINS", args_vector_t{ {0}, {1}, {2}, {3} }},
+
+    // Chunk sizes in KiB for the incremental heap walk benchmarks.
+    {"MALLOC_ITERATE_CHUNK_KIB", args_vector_t{ {64}, {1024}, {16384} }},
+
+    // Numbers of exit-time handlers for the exit latency benchmarks.
+    {"EXIT_HANDLERS", args_vector_t{ {16}, {1024} }},
   };
 
   args_vector_t args_onebuf;
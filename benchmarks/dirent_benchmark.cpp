@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fts.h>
+#include <ftw.h>
+#include <math.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include <android-base/file.h>
+#include <android-base/stringprintf.h>
+#include <benchmark/benchmark.h>
+#include "util.h"
+
+#if defined(__BIONIC__)
+#include "platform/bionic/dirent_batch.h"
+#endif
+
+// A tree of roughly sqrt(n) directories of sqrt(n) empty files each, built
+// once and shared by every benchmark that asks for the same size. Building a
+// million files takes a while, so it's kept until the next size is asked for.
+class SyntheticTree {
+ public:
+  static SyntheticTree* Get(benchmark::State& state) {
+    static std::unique_ptr<SyntheticTree> tree;
+    size_t entries = state.range(0);
+    if (tree == nullptr || tree->entries_ != entries) {
+      tree.reset();
+      tree.reset(new SyntheticTree(entries));
+    }
+    if (!tree->error_.empty()) {
+      state.SkipWithError(tree->error_.c_str());
+      return nullptr;
+    }
+    return tree.get();
+  }
+
+  ~SyntheticTree() {
+    nftw(root_.path, [](const char* path, const struct stat*, int type, FTW*) {
+      return (type == FTW_DP) ? rmdir(path) : unlink(path);
+    }, 16, FTW_DEPTH | FTW_PHYS);
+  }
+
+  const char* path() const { return root_.path; }
+  size_t dirs() const { return dirs_; }
+
+ private:
+  explicit SyntheticTree(size_t entries) : entries_(entries) {
+    dirs_ = static_cast<size_t>(sqrt(entries));
+    if (dirs_ == 0) dirs_ = 1;
+    size_t files_per_dir = entries / dirs_;
+    for (size_t d = 0; d < dirs_ && error_.empty(); ++d) {
+      std::string dir = android::base::StringPrintf("%s/d%zu", root_.path, d);
+      if (mkdir(dir.c_str(), 0700) == -1) {
+        error_ = "mkdir " + dir + " failed: " + strerror(errno);
+        break;
+      }
+      for (size_t f = 0; f < files_per_dir; ++f) {
+        std::string file = android::base::StringPrintf("%s/file-%zu", dir.c_str(), f);
+        int fd = open(file.c_str(), O_CREAT | O_WRONLY | O_CLOEXEC, 0600);
+        if (fd == -1) {
+          error_ = "creating " + file + " failed: " + strerror(errno);
+          break;
+        }
+        close(fd);
+      }
+    }
+  }
+
+  TemporaryDir root_;
+  size_t entries_;
+  size_t dirs_;
+  std::string error_;
+};
+
+// Just reading the directories, as the floor for the walks below.
+static void BM_dirent_readdir_tree(benchmark::State& state) {
+  SyntheticTree* tree = SyntheticTree::Get(state);
+  if (tree == nullptr) return;
+
+  for (auto _ : state) {
+    for (size_t d = 0; d < tree->dirs(); ++d) {
+      std::string dir = android::base::StringPrintf("%s/d%zu", tree->path(), d);
+      DIR* dirp = opendir(dir.c_str());
+      while (readdir(dirp) != nullptr) {
+      }
+      closedir(dirp);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_dirent_readdir_tree, "1000000");
+
+#if defined(__BIONIC__)
+static void BM_dirent_readdir_batch_tree(benchmark::State& state) {
+  SyntheticTree* tree = SyntheticTree::Get(state);
+  if (tree == nullptr) return;
+
+  for (auto _ : state) {
+    for (size_t d = 0; d < tree->dirs(); ++d) {
+      std::string dir = android::base::StringPrintf("%s/d%zu", tree->path(), d);
+      DIR* dirp = opendir(dir.c_str());
+      dirent* entries;
+      while (android_readdir_batch(dirp, &entries) > 0) {
+        benchmark::DoNotOptimize(entries);
+      }
+      closedir(dirp);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_dirent_readdir_batch_tree, "1000000");
+#endif
+
+// Scans every directory, including freeing the results, since that's where the
+// single allocation of android_scandirat saves the most.
+static void ScandirTree(benchmark::State& state,
+                        int (*scan)(const char*, dirent***,
+                                    int (*)(const dirent**, const dirent**)),
+                        int (*comparator)(const dirent**, const dirent**)) {
+  SyntheticTree* tree = SyntheticTree::Get(state);
+  if (tree == nullptr) return;
+
+  for (auto _ : state) {
+    for (size_t d = 0; d < tree->dirs(); ++d) {
+      std::string dir = android::base::StringPrintf("%s/d%zu", tree->path(), d);
+      dirent** names;
+      benchmark::DoNotOptimize(scan(dir.c_str(), &names, comparator));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static int Scandir(const char* dir, dirent*** names,
+                   int (*comparator)(const dirent**, const dirent**)) {
+  int count = scandir(dir, names, nullptr, comparator);
+  // On failure, *names is left untouched.
+  if (count >= 0) {
+    for (int i = 0; i < count; ++i) free((*names)[i]);
+    free(*names);
+  }
+  return count;
+}
+
+static void BM_dirent_scandir_tree(benchmark::State& state) {
+  ScandirTree(state, Scandir, alphasort);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_dirent_scandir_tree, "1000000");
+
+#if defined(__BIONIC__)
+static int AndroidScandirat(const char* dir, dirent*** names,
+                            int (*comparator)(const dirent**, const dirent**)) {
+  int count = android_scandirat(AT_FDCWD, dir, names, nullptr, comparator);
+  if (count >= 0) free(*names);
+  return count;
+}
+
+static void BM_dirent_android_scandirat_tree(benchmark::State& state) {
+  ScandirTree(state, AndroidScandirat, alphasort);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_dirent_android_scandirat_tree, "1000000");
+
+static void BM_dirent_android_scandirat_unsorted_tree(benchmark::State& state) {
+  ScandirTree(state, AndroidScandirat, nullptr);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_dirent_android_scandirat_unsorted_tree, "1000000");
+#endif
+
+static void FtsWalk(benchmark::State& state, int options) {
+  SyntheticTree* tree = SyntheticTree::Get(state);
+  if (tree == nullptr) return;
+
+  char* paths[] = {const_cast<char*>(tree->path()), nullptr};
+  for (auto _ : state) {
+    FTS* fts = fts_open(paths, options, nullptr);
+    FTSENT* e;
+    while ((e = fts_read(fts)) != nullptr) {
+      benchmark::DoNotOptimize(e->fts_info);
+    }
+    fts_close(fts);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// What `find` or a backup agent that only wants names does: d_type says which
+// entries are directories, so only they get stat'ed.
+static void BM_dirent_fts_nostat_physical(benchmark::State& state) {
+  FtsWalk(state, FTS_PHYSICAL | FTS_NOSTAT | FTS_NOCHDIR);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_dirent_fts_nostat_physical, "1000000");
+
+static void BM_dirent_fts_nostat_logical(benchmark::State& state) {
+  FtsWalk(state, FTS_LOGICAL | FTS_NOSTAT | FTS_NOCHDIR);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_dirent_fts_nostat_logical, "1000000");
+
+static void BM_dirent_fts_stat(benchmark::State& state) {
+  FtsWalk(state, FTS_PHYSICAL | FTS_NOCHDIR);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_dirent_fts_stat, "1000000");
+
+static void BM_dirent_nftw(benchmark::State& state) {
+  SyntheticTree* tree = SyntheticTree::Get(state);
+  if (tree == nullptr) return;
+
+  for (auto _ : state) {
+    nftw(tree->path(), [](const char*, const struct stat* sb, int, FTW*) {
+      benchmark::DoNotOptimize(sb->st_mode);
+      return 0;
+    }, 16, FTW_PHYS);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_dirent_nftw, "1000000");
@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dns_server.h"
+
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+
+static constexpr int kPollTimeoutMs = 100;
+static constexpr size_t kHeaderSize = 12;
+static constexpr uint16_t kTypeA = 1;
+static constexpr uint16_t kTypeAAAA = 28;
+static constexpr uint16_t kClassIN = 1;
+
+static uint64_t NowNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint16_t Get16(const uint8_t* p) {
+  return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+static uint8_t* Put16(uint8_t* p, uint16_t v) {
+  p[0] = v >> 8;
+  p[1] = v & 0xff;
+  return p + 2;
+}
+
+static uint8_t* Put32(uint8_t* p, uint32_t v) {
+  return Put16(Put16(p, v >> 16), v & 0xffff);
+}
+
+static bool ReadFully(int fd, void* buf, size_t len) {
+  uint8_t* p = static_cast<uint8_t*>(buf);
+  while (len > 0) {
+    ssize_t n = TEMP_FAILURE_RETRY(read(fd, p, len));
+    if (n <= 0) return false;
+    p += n;
+    len -= n;
+  }
+  return true;
+}
+
+static bool WriteFully(int fd, const void* buf, size_t len) {
+  const uint8_t* p = static_cast<const uint8_t*>(buf);
+  while (len > 0) {
+    ssize_t n = TEMP_FAILURE_RETRY(write(fd, p, len));
+    if (n <= 0) return false;
+    p += n;
+    len -= n;
+  }
+  return true;
+}
+
+FakeDnsServer::FakeDnsServer(const Options& options) : options_(options) {}
+
+FakeDnsServer::~FakeDnsServer() {
+  stop_ = true;
+  cv_.notify_all();
+  if (udp_receiver_.joinable()) udp_receiver_.join();
+  if (udp_sender_.joinable()) udp_sender_.join();
+  if (tcp_acceptor_.joinable()) tcp_acceptor_.join();
+  for (auto& t : connection_threads_) t.join();
+  if (udp_fd_ != -1) close(udp_fd_);
+  if (tcp_fd_ != -1) close(tcp_fd_);
+}
+
+bool FakeDnsServer::Start() {
+  addr_.sin_family = AF_INET;
+  addr_.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr_.sin_port = htons(options_.port);
+
+  // Bind TCP first so that an ephemeral port can then be claimed for UDP too.
+  tcp_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (tcp_fd_ == -1) return false;
+  int on = 1;
+  setsockopt(tcp_fd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  if (bind(tcp_fd_, reinterpret_cast<sockaddr*>(&addr_), sizeof(addr_)) == -1) return false;
+  socklen_t addr_len = sizeof(addr_);
+  if (getsockname(tcp_fd_, reinterpret_cast<sockaddr*>(&addr_), &addr_len) == -1) return false;
+  if (listen(tcp_fd_, SOMAXCONN) == -1) return false;
+
+  udp_fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (udp_fd_ == -1) return false;
+  if (bind(udp_fd_, reinterpret_cast<sockaddr*>(&addr_), sizeof(addr_)) == -1) return false;
+
+  udp_receiver_ = std::thread(&FakeDnsServer::UdpReceiveLoop, this);
+  udp_sender_ = std::thread(&FakeDnsServer::UdpSendLoop, this);
+  tcp_acceptor_ = std::thread(&FakeDnsServer::TcpAcceptLoop, this);
+  return true;
+}
+
+bool FakeDnsServer::ShouldDrop() {
+  if (options_.loss <= 0.0) return false;
+  // xorshift64: deterministic, so runs with the same loss rate are comparable.
+  std::lock_guard<std::mutex> guard(lock_);
+  rng_state_ ^= rng_state_ << 13;
+  rng_state_ ^= rng_state_ >> 7;
+  rng_state_ ^= rng_state_ << 17;
+  return static_cast<double>(rng_state_ >> 11) / static_cast<double>(1ULL << 53) < options_.loss;
+}
+
+size_t FakeDnsServer::BuildReply(const uint8_t* query, size_t query_len, bool udp, uint8_t* reply,
+                                 size_t reply_size) {
+  if (query_len < kHeaderSize || Get16(query + 4) != 1) return 0;
+
+  // Walk the (uncompressed) question name, remembering it for the NXDOMAIN check.
+  std::string name;
+  size_t pos = kHeaderSize;
+  while (pos < query_len && query[pos] != 0) {
+    size_t label_len = query[pos];
+    if ((label_len & 0xc0) != 0 || pos + 1 + label_len >= query_len) return 0;
+    if (!name.empty()) name += '.';
+    for (size_t i = 0; i < label_len; ++i) name += tolower(query[pos + 1 + i]);
+    pos += 1 + label_len;
+  }
+  if (pos + 5 > query_len) return 0;
+  size_t question_end = pos + 5;
+  uint16_t qtype = Get16(query + pos + 1);
+  uint16_t qclass = Get16(query + pos + 3);
+  if (qtype == kTypeAAAA && options_.ignore_aaaa) return 0;
+
+  static constexpr char kInvalid[] = ".invalid";
+  bool nxdomain = name.size() >= strlen(kInvalid) &&
+                  name.compare(name.size() - strlen(kInvalid), std::string::npos, kInvalid) == 0;
+  bool truncated = udp && options_.truncate;
+  bool has_answer = !nxdomain && !truncated && qclass == kClassIN &&
+                    (qtype == kTypeA || qtype == kTypeAAAA);
+  size_t rdata_len = (qtype == kTypeA) ? 4 : 16;
+  size_t reply_len = question_end + (has_answer ? 12 + rdata_len : 0);
+  if (reply_len > reply_size) return 0;
+
+  uint16_t flags = 0x8000 | (Get16(query + 2) & 0x7900) | 0x0400 | 0x0080;  // QR|opcode|RD, AA, RA.
+  if (truncated) flags |= 0x0200;
+  if (nxdomain) flags |= 3;
+
+  memcpy(reply, query, question_end);
+  uint8_t* p = Put16(reply + 2, flags);
+  p = Put16(p, 1);
+  p = Put16(p, has_answer ? 1 : 0);
+  p = Put16(p, 0);
+  Put16(p, 0);
+
+  if (has_answer) {
+    p = reply + question_end;
+    p = Put16(p, 0xc000 | kHeaderSize);  // Pointer to the question name.
+    p = Put16(p, qtype);
+    p = Put16(p, kClassIN);
+    p = Put32(p, options_.ttl);
+    p = Put16(p, rdata_len);
+    if (qtype == kTypeA) {
+      inet_pton(AF_INET, "192.0.2.1", p);
+    } else {
+      inet_pton(AF_INET6, "2001:db8::1", p);
+    }
+  }
+  return reply_len;
+}
+
+void FakeDnsServer::UdpReceiveLoop() {
+  uint8_t query[512];
+  uint8_t reply[512];
+  while (!stop_) {
+    pollfd pfd = {.fd = udp_fd_, .events = POLLIN, .revents = 0};
+    if (poll(&pfd, 1, kPollTimeoutMs) <= 0) continue;
+
+    sockaddr_in peer;
+    socklen_t peer_len = sizeof(peer);
+    ssize_t n = recvfrom(udp_fd_, query, sizeof(query), 0, reinterpret_cast<sockaddr*>(&peer),
+                         &peer_len);
+    if (n <= 0) continue;
+    ++udp_queries_;
+    if (ShouldDrop()) continue;
+
+    size_t reply_len = BuildReply(query, n, true, reply, sizeof(reply));
+    if (reply_len == 0) continue;
+    if (options_.latency_us == 0) {
+      sendto(udp_fd_, reply, reply_len, 0, reinterpret_cast<sockaddr*>(&peer), peer_len);
+      continue;
+    }
+
+    // Replies are queued rather than slept on, so that latency doesn't serialize clients.
+    std::lock_guard<std::mutex> guard(lock_);
+    pending_.push({NowNs() + options_.latency_us * 1000ULL, peer,
+                   std::vector<uint8_t>(reply, reply + reply_len)});
+    cv_.notify_one();
+  }
+}
+
+void FakeDnsServer::UdpSendLoop() {
+  std::unique_lock<std::mutex> lock(lock_);
+  while (!stop_) {
+    if (pending_.empty()) {
+      cv_.wait_for(lock, std::chrono::milliseconds(kPollTimeoutMs));
+      continue;
+    }
+    uint64_t now = NowNs();
+    const PendingReply& next = pending_.top();
+    if (next.due_ns > now) {
+      cv_.wait_for(lock, std::chrono::nanoseconds(next.due_ns - now));
+      continue;
+    }
+    sendto(udp_fd_, next.reply.data(), next.reply.size(), 0,
+           reinterpret_cast<const sockaddr*>(&next.peer), sizeof(next.peer));
+    pending_.pop();
+  }
+}
+
+void FakeDnsServer::TcpAcceptLoop() {
+  while (!stop_) {
+    pollfd pfd = {.fd = tcp_fd_, .events = POLLIN, .revents = 0};
+    if (poll(&pfd, 1, kPollTimeoutMs) <= 0) continue;
+    int fd = accept4(tcp_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd == -1) continue;
+    std::lock_guard<std::mutex> guard(lock_);
+    connection_threads_.emplace_back(&FakeDnsServer::ServeTcpConnection, this, fd);
+  }
+}
+
+void FakeDnsServer::ServeTcpConnection(int fd) {
+  uint8_t query[1024];
+  uint8_t reply[1024 + 2];
+  while (!stop_) {
+    pollfd pfd = {.fd = fd, .events = POLLIN, .revents = 0};
+    int rc = poll(&pfd, 1, kPollTimeoutMs);
+    if (rc == 0) continue;
+    if (rc == -1) break;
+
+    uint8_t len_buf[2];
+    if (!ReadFully(fd, len_buf, sizeof(len_buf))) break;
+    size_t query_len = Get16(len_buf);
+    if (query_len > sizeof(query) || !ReadFully(fd, query, query_len)) break;
+    ++tcp_queries_;
+
+    size_t reply_len = BuildReply(query, query_len, false, reply + 2, sizeof(reply) - 2);
+    if (reply_len == 0) break;
+    if (options_.latency_us != 0) usleep(options_.latency_us);
+    Put16(reply, reply_len);
+    if (!WriteFully(fd, reply, reply_len + 2)) break;
+  }
+  close(fd);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <netinet/in.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// A stub DNS server on the loopback interface, for testing and benchmarking the
+// resolver without a network. It listens on UDP and TCP on the same port and
+// answers every A query with 192.0.2.1 and every AAAA query with 2001:db8::1
+// (both documentation addresses). Names under ".invalid" get NXDOMAIN, and any
+// other query type gets an empty NOERROR answer.
+class FakeDnsServer {
+ public:
+  struct Options {
+    // Port to listen on; 0 picks an ephemeral port.
+    uint16_t port = 0;
+    // Delay before each reply is sent.
+    uint32_t latency_us = 0;
+    // Fraction of UDP queries, in [0, 1], that are silently dropped.
+    double loss = 0.0;
+    // Answer UDP queries with an empty truncated (TC) reply, forcing TCP.
+    bool truncate = false;
+    // Never answer AAAA queries, like a broken IPv4-only network.
+    bool ignore_aaaa = false;
+    // TTL of every answer record.
+    uint32_t ttl = 300;
+  };
+
+  explicit FakeDnsServer(const Options& options);
+  ~FakeDnsServer();
+
+  // Binds the sockets and starts serving. Returns false (with errno set) on failure.
+  bool Start();
+
+  const sockaddr_in& addr() const { return addr_; }
+  uint16_t port() const { return ntohs(addr_.sin_port); }
+
+  // The number of queries received over UDP and TCP, including dropped ones.
+  size_t udp_queries() const { return udp_queries_; }
+  size_t tcp_queries() const { return tcp_queries_; }
+
+ private:
+  struct PendingReply {
+    uint64_t due_ns;
+    sockaddr_in peer;
+    std::vector<uint8_t> reply;
+    bool operator<(const PendingReply& rhs) const { return due_ns > rhs.due_ns; }
+  };
+
+  void UdpReceiveLoop();
+  void UdpSendLoop();
+  void TcpAcceptLoop();
+  void ServeTcpConnection(int fd);
+  bool ShouldDrop();
+  size_t BuildReply(const uint8_t* query, size_t query_len, bool udp, uint8_t* reply,
+                    size_t reply_size);
+
+  Options options_;
+  sockaddr_in addr_ = {};
+  int udp_fd_ = -1;
+  int tcp_fd_ = -1;
+  std::atomic<bool> stop_ = false;
+  std::atomic<size_t> udp_queries_ = 0;
+  std::atomic<size_t> tcp_queries_ = 0;
+
+  std::mutex lock_;
+  std::condition_variable cv_;
+  std::priority_queue<PendingReply> pending_;
+  uint64_t rng_state_ = 0x9e3779b97f4a7c15ULL;
+  std::vector<std::thread> connection_threads_;
+
+  std::thread udp_receiver_;
+  std::thread udp_sender_;
+  std::thread tcp_acceptor_;
+};
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <grp.h>
+#include <pwd.h>
+
+#include <benchmark/benchmark.h>
+#include "util.h"
+
+// On bionic, root is in android_ids, while an app id misses there and in every
+// passwd/group file before being synthesized, so it's the slowest case.
+static constexpr uid_t kAppId = 10123;
+
+static void BM_grp_pwd_getpwuid_root(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(getpwuid(0));
+  }
+}
+BIONIC_BENCHMARK(BM_grp_pwd_getpwuid_root);
+
+static void BM_grp_pwd_getpwuid_app(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(getpwuid(kAppId));
+  }
+}
+BIONIC_BENCHMARK(BM_grp_pwd_getpwuid_app);
+
+static void BM_grp_pwd_getpwnam_root(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(getpwnam("root"));
+  }
+}
+BIONIC_BENCHMARK(BM_grp_pwd_getpwnam_root);
+
+static void BM_grp_pwd_getgrgid_app(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(getgrgid(kAppId));
+  }
+}
+BIONIC_BENCHMARK(BM_grp_pwd_getgrgid_app);
+
+static void BM_grp_pwd_getgrnam_root(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(getgrnam("root"));
+  }
+}
+BIONIC_BENCHMARK(BM_grp_pwd_getgrnam_root);
+
+static void BM_grp_pwd_getgrnam_app(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(getgrnam("u0_a123"));
+  }
+}
+BIONIC_BENCHMARK(BM_grp_pwd_getgrnam_app);
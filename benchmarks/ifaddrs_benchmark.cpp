@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <ifaddrs.h>
+#include <string.h>
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+#include "util.h"
+
+#if defined(__BIONIC__)
+#include "platform/bionic/getifaddrs_cache.h"
+#endif
+
+static void GetIfaddrs(benchmark::State& state) {
+  for (auto _ : state) {
+    ifaddrs* addrs;
+    if (getifaddrs(&addrs) == -1) {
+      state.SkipWithError((std::string("getifaddrs failed: ") + strerror(errno)).c_str());
+      break;
+    }
+    freeifaddrs(addrs);
+  }
+}
+
+// A netlink dump of every link and address, plus an ioctl per link for its flags.
+static void BM_ifaddrs_getifaddrs(benchmark::State& state) {
+  GetIfaddrs(state);
+}
+BIONIC_BENCHMARK(BM_ifaddrs_getifaddrs);
+
+// With nothing changing, just a check for notifications and a copy of the snapshot.
+static void BM_ifaddrs_getifaddrs_cached(benchmark::State& state) {
+#if defined(__BIONIC__)
+  if (!android_set_getifaddrs_cache_enabled(true)) {
+    state.SkipWithError((std::string("couldn't enable the cache: ") + strerror(errno)).c_str());
+    return;
+  }
+  GetIfaddrs(state);
+  android_set_getifaddrs_cache_enabled(false);
+#else
+  state.SkipWithError("the getifaddrs cache is bionic-only");
+#endif
+}
+BIONIC_BENCHMARK(BM_ifaddrs_getifaddrs_cached);
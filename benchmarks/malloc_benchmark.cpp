@@ -27,15 +27,70 @@
  */
 
 #include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <vector>
 
 #include <benchmark/benchmark.h>
 #include "util.h"
 
+// The fixed cost of a call into the allocator. Nothing is written to the
+// memory, and the allocator's thread cache always has a block of the right
+// size, so what's measured is mostly the path from the libc entry points to
+// the native allocator.
+static void BM_malloc_free_call(benchmark::State& state) {
+  for (auto _ : state) {
+    void* ptr = malloc(16);
+    benchmark::DoNotOptimize(ptr);
+    free(ptr);
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+BIONIC_BENCHMARK(BM_malloc_free_call);
+
+// As above, but with a batch of live allocations, so that free() doesn't
+// always get the block malloc() just returned.
+static void BM_malloc_free_call_batch(benchmark::State& state) {
+  constexpr size_t kBatch = 64;
+  void* ptrs[kBatch];
+  for (auto _ : state) {
+    for (size_t i = 0; i < kBatch; ++i) {
+      ptrs[i] = malloc(16 + 16 * (i % 4));
+      benchmark::DoNotOptimize(ptrs[i]);
+    }
+    for (size_t i = 0; i < kBatch; ++i) free(ptrs[i]);
+  }
+  state.SetItemsProcessed(state.iterations() * kBatch * 2);
+}
+BIONIC_BENCHMARK(BM_malloc_free_call_batch);
+
+static void BM_malloc_calloc_free_call(benchmark::State& state) {
+  for (auto _ : state) {
+    void* ptr = calloc(1, 16);
+    benchmark::DoNotOptimize(ptr);
+    free(ptr);
+  }
+  state.SetItemsProcessed(state.iterations() * 2);
+}
+BIONIC_BENCHMARK(BM_malloc_calloc_free_call);
+
 #if defined(__BIONIC__)
 
+#include <procinfo/process_map.h>
+
+extern "C" void malloc_disable();
+extern "C" void malloc_enable();
+extern "C" int malloc_iterate(uintptr_t base, size_t size,
+                              void (*callback)(uintptr_t base, size_t size, void* arg), void* arg);
+extern "C" ssize_t android_malloc_iterate_incremental(
+    uintptr_t base, size_t size, size_t chunk_size,
+    void (*callback)(uintptr_t base, size_t size, void* arg), void* arg, bool verify);
+
 static void BM_mallopt_purge(benchmark::State& state) {
   static size_t sizes[] = {8, 16, 32, 64, 128, 1024, 4096, 16384, 65536, 131072, 1048576};
   static int pagesize = getpagesize();
@@ -69,4 +124,98 @@ static void BM_mallopt_purge(benchmark::State& state) {
 }
 BIONIC_BENCHMARK(BM_mallopt_purge);
 
+static void CountAllocation(uintptr_t, size_t size, void* arg) {
+  *reinterpret_cast<size_t*>(arg) += size;
+}
+
+// Walks a heap of about 64MiB in small allocations while another thread
+// allocates and frees in a loop, and reports the longest any of those calls
+// took as max_pause_us. That's the stall a leak checker or heap dump inflicts
+// on the rest of the process. chunk_kib is 0 for one malloc_iterate() walk
+// of everything, with malloc disabled throughout, as libmemunreachable does.
+static void HeapWalkPause(benchmark::State& state, size_t chunk_kib) {
+  std::vector<void*> ptrs(256 * 1024);
+  for (size_t i = 0; i < ptrs.size(); ++i) ptrs[i] = malloc(16 + (i * 37) % 496);
+
+  std::vector<std::pair<uintptr_t, size_t>> maps;
+  std::vector<char> buffer(256 * 1024);
+  bool scudo = false;
+  bool parsed = android::procinfo::ReadMapFileAsyncSafe(
+      "/proc/self/maps", buffer.data(), buffer.size(),
+      [&](uint64_t start, uint64_t end, uint16_t, uint64_t, ino_t, const char* name, bool) {
+        if (strncmp(name, "[anon:scudo:", 12) == 0) {
+          maps.emplace_back(start, end - start);
+          scudo = true;
+        } else if (strcmp(name, "[anon:libc_malloc]") == 0) {
+          maps.emplace_back(start, end - start);
+        }
+      });
+  if (!parsed) {
+    state.SkipWithError("Failed to parse /proc/self/maps");
+    for (void* ptr : ptrs) free(ptr);
+    return;
+  }
+
+  std::atomic<bool> done(false);
+  std::atomic<uint64_t> max_pause_ns(0);
+  std::thread allocator([&]() {
+    while (!done.load(std::memory_order_relaxed)) {
+      auto start = std::chrono::steady_clock::now();
+      void* ptr = malloc(32);
+      benchmark::DoNotOptimize(ptr);
+      free(ptr);
+      uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start).count();
+      if (ns > max_pause_ns.load(std::memory_order_relaxed)) {
+        max_pause_ns.store(ns, std::memory_order_relaxed);
+      }
+    }
+  });
+
+  size_t bytes = 0;
+  size_t heap_bytes = 0;
+  size_t chunks = 0;
+  for (const auto& [base, size] : maps) {
+    heap_bytes += size;
+    // Scudo can't walk part of its heap, so it walks each range in one go.
+    chunks += (chunk_kib == 0 || scudo) ? 1 : (size + chunk_kib * 1024 - 1) / (chunk_kib * 1024);
+  }
+  uint64_t walk_ns = 0;
+  for (auto _ : state) {
+    auto start = std::chrono::steady_clock::now();
+    if (chunk_kib == 0) {
+      malloc_disable();
+      for (const auto& [base, size] : maps) malloc_iterate(base, size, CountAllocation, &bytes);
+      malloc_enable();
+    } else {
+      for (const auto& [base, size] : maps) {
+        android_malloc_iterate_incremental(base, size, chunk_kib * 1024, CountAllocation, &bytes,
+                                           false);
+      }
+    }
+    walk_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now() - start).count();
+  }
+  benchmark::DoNotOptimize(bytes);
+
+  done = true;
+  allocator.join();
+  state.counters["max_pause_us"] = max_pause_ns / 1000.0;
+  state.counters["chunks"] = chunks;
+  state.counters["heap_mib"] = heap_bytes / (1024.0 * 1024.0);
+  state.counters["walk_ms"] = walk_ns / 1e6 / state.iterations();
+  state.SetLabel(scudo ? "scudo" : "jemalloc");
+  for (void* ptr : ptrs) free(ptr);
+}
+
+static void BM_malloc_iterate_pause_full(benchmark::State& state) {
+  HeapWalkPause(state, 0);
+}
+BIONIC_BENCHMARK(BM_malloc_iterate_pause_full);
+
+static void BM_malloc_iterate_pause_incremental(benchmark::State& state) {
+  HeapWalkPause(state, state.range(0));
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_malloc_iterate_pause_incremental, "MALLOC_ITERATE_CHUNK_KIB");
+
 #endif
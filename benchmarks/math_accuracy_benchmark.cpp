@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <float.h>
+#include <math.h>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include "util.h"
+
+// Speed and accuracy together, for trying out a new libm implementation: for
+// each function and each of four input domains, BM_math_accuracy_<fn> is the
+// throughput-bound loop and BM_math_accuracy_<fn>_latency the latency-bound
+// one (each call depends on the previous result), and both report the max and
+// mean error in ULP over the same inputs as counters. The reference is the
+// long double version of the function, so there's no dependency on MPFR; where
+// long double is no wider than double, only the float functions report errors.
+//
+//   benchmarks/run-on-host.sh 64 --benchmark_filter=BM_math_accuracy
+
+static constexpr size_t kInputCount = 4096;
+
+struct InputRange {
+  enum Kind { kLinear, kLog, kLogBothSigns };
+  double lo;
+  double hi;
+  Kind kind;
+};
+
+struct Domain {
+  const char* label;
+  InputRange x;
+  InputRange y;  // Only used by functions of two arguments.
+};
+
+template <typename T>
+struct MathFunction {
+  T (*fn1)(T);
+  long double (*ref1)(long double);
+  T (*fn2)(T, T);
+  long double (*ref2)(long double, long double);
+  Domain domains[4];
+};
+
+static std::vector<double> MakeInputs(const InputRange& range, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<double> result(kInputCount);
+  for (double& x : result) {
+    double u = static_cast<double>(rng() >> 11) * 0x1p-53;
+    if (range.kind == InputRange::kLinear) {
+      x = range.lo + u * (range.hi - range.lo);
+    } else {
+      x = exp(log(range.lo) + u * (log(range.hi) - log(range.lo)));
+      if (range.kind == InputRange::kLogBothSigns && (rng() & 1)) x = -x;
+    }
+  }
+  return result;
+}
+
+// The error of `actual` in units of the last place of `expected` rounded to T.
+template <typename T>
+static double UlpError(T actual, long double expected) {
+  T rounded = static_cast<T>(expected);
+  if (isnan(actual) || isnan(rounded)) return (isnan(actual) && isnan(rounded)) ? 0.0 : INFINITY;
+  if (isinf(actual) || isinf(rounded)) return (actual == rounded) ? 0.0 : INFINITY;
+  int exponent;
+  frexpl(expected, &exponent);
+  exponent = std::max(exponent, std::numeric_limits<T>::min_exponent);
+  long double ulp = ldexpl(1.0L, exponent - std::numeric_limits<T>::digits);
+  return static_cast<double>(fabsl(static_cast<long double>(actual) - expected) / ulp);
+}
+
+template <typename T>
+static void MeasureAccuracy(benchmark::State& state, const MathFunction<T>& f,
+                            const std::vector<T>& xs, const std::vector<T>& ys) {
+  if (std::numeric_limits<T>::digits >= LDBL_MANT_DIG) return;
+
+  double max_error = 0.0;
+  double total_error = 0.0;
+  double worst_input = 0.0;
+  for (size_t i = 0; i < kInputCount; ++i) {
+    double error = f.fn1 ? UlpError(f.fn1(xs[i]), f.ref1(xs[i]))
+                         : UlpError(f.fn2(xs[i], ys[i]), f.ref2(xs[i], ys[i]));
+    if (error > max_error) {
+      max_error = error;
+      worst_input = xs[i];
+    }
+    total_error += error;
+  }
+  state.counters["max_ulp"] = max_error;
+  state.counters["mean_ulp"] = total_error / kInputCount;
+  state.counters["worst_x"] = worst_input;
+}
+
+template <typename T>
+static void MathAccuracy(benchmark::State& state, const MathFunction<T>& f, bool latency) {
+  const Domain& domain = f.domains[state.range(0)];
+  std::vector<double> x_inputs = MakeInputs(domain.x, 1);
+  std::vector<double> y_inputs = MakeInputs(domain.y, 2);
+  std::vector<T> xs(x_inputs.begin(), x_inputs.end());
+  std::vector<T> ys(y_inputs.begin(), y_inputs.end());
+
+  // Adding the previous result times zero keeps the dependency without
+  // changing the input. (The domains are chosen so that all the results are
+  // finite.)
+  volatile T zero = 0;
+  T z = zero;
+  T result = 0;
+  size_t i = 0;
+  for (auto _ : state) {
+    T x = latency ? xs[i] + result * z : xs[i];
+    result = f.fn1 ? f.fn1(x) : f.fn2(x, ys[i]);
+    benchmark::DoNotOptimize(result);
+    i = (i + 1) % kInputCount;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetLabel(domain.label);
+
+  MeasureAccuracy(state, f, xs, ys);
+}
+
+static long double log2_reference(long double x) { return logl(x) / logl(2.0L); }
+static long double log10_reference(long double x) { return logl(x) / logl(10.0L); }
+
+static constexpr InputRange kNone = {0.0, 0.0, InputRange::kLinear};
+
+static constexpr Domain kSinCosDomains[4] = {
+  {"|x| < pi/4", {-0.785, 0.785, InputRange::kLinear}, kNone},
+  {"|x| < 10", {-10.0, 10.0, InputRange::kLinear}, kNone},
+  {"|x| < 1e6", {-1e6, 1e6, InputRange::kLinear}, kNone},
+  {"1e6 <= |x| < 1e300", {1e6, 1e300, InputRange::kLogBothSigns}, kNone},
+};
+
+static constexpr Domain kSinCosfDomains[4] = {
+  {"|x| < pi/4", {-0.785, 0.785, InputRange::kLinear}, kNone},
+  {"|x| < 10", {-10.0, 10.0, InputRange::kLinear}, kNone},
+  {"|x| < 1e6", {-1e6, 1e6, InputRange::kLinear}, kNone},
+  {"1e6 <= |x| < 1e38", {1e6, 1e38, InputRange::kLogBothSigns}, kNone},
+};
+
+static constexpr Domain kAsinDomains[4] = {
+  {"|x| < 0.5", {-0.5, 0.5, InputRange::kLinear}, kNone},
+  {"|x| < 1", {-1.0, 1.0, InputRange::kLinear}, kNone},
+  {"0.9 <= x < 1", {0.9, 1.0, InputRange::kLinear}, kNone},
+  {"1e-10 <= |x| < 1e-3", {1e-10, 1e-3, InputRange::kLogBothSigns}, kNone},
+};
+
+static constexpr Domain kAtanDomains[4] = {
+  {"|x| < 1", {-1.0, 1.0, InputRange::kLinear}, kNone},
+  {"|x| < 10", {-10.0, 10.0, InputRange::kLinear}, kNone},
+  {"1 <= |x| < 1e10", {1.0, 1e10, InputRange::kLogBothSigns}, kNone},
+  {"1e-10 <= |x| < 1e-3", {1e-10, 1e-3, InputRange::kLogBothSigns}, kNone},
+};
+
+static constexpr Domain kAtan2Domains[4] = {
+  {"|y|, |x| < 1", {-1.0, 1.0, InputRange::kLinear}, {-1.0, 1.0, InputRange::kLinear}},
+  {"|y|, |x| < 1e3", {-1e3, 1e3, InputRange::kLinear}, {-1e3, 1e3, InputRange::kLinear}},
+  {"y tiny, x ~ 1", {1e-10, 1e-3, InputRange::kLogBothSigns}, {0.5, 2.0, InputRange::kLinear}},
+  {"y ~ 1, x tiny", {0.5, 2.0, InputRange::kLinear}, {1e-10, 1e-3, InputRange::kLogBothSigns}},
+};
+
+static constexpr Domain kExpDomains[4] = {
+  {"|x| < 1", {-1.0, 1.0, InputRange::kLinear}, kNone},
+  {"|x| < 700", {-700.0, 700.0, InputRange::kLinear}, kNone},
+  {"-745 <= x < -708 (subnormal)", {-745.0, -708.0, InputRange::kLinear}, kNone},
+  {"1e-10 <= |x| < 1e-3", {1e-10, 1e-3, InputRange::kLogBothSigns}, kNone},
+};
+
+static constexpr Domain kExpfDomains[4] = {
+  {"|x| < 1", {-1.0, 1.0, InputRange::kLinear}, kNone},
+  {"|x| < 88", {-88.0, 88.0, InputRange::kLinear}, kNone},
+  {"-103 <= x < -88 (subnormal)", {-103.0, -88.0, InputRange::kLinear}, kNone},
+  {"1e-10 <= |x| < 1e-3", {1e-10, 1e-3, InputRange::kLogBothSigns}, kNone},
+};
+
+static constexpr Domain kExp2Domains[4] = {
+  {"|x| < 1", {-1.0, 1.0, InputRange::kLinear}, kNone},
+  {"|x| < 1000", {-1000.0, 1000.0, InputRange::kLinear}, kNone},
+  {"-1074 <= x < -1022 (subnormal)", {-1074.0, -1022.0, InputRange::kLinear}, kNone},
+  {"1e-10 <= |x| < 1e-3", {1e-10, 1e-3, InputRange::kLogBothSigns}, kNone},
+};
+
+static constexpr Domain kExp2fDomains[4] = {
+  {"|x| < 1", {-1.0, 1.0, InputRange::kLinear}, kNone},
+  {"|x| < 126", {-126.0, 126.0, InputRange::kLinear}, kNone},
+  {"-149 <= x < -126 (subnormal)", {-149.0, -126.0, InputRange::kLinear}, kNone},
+  {"1e-10 <= |x| < 1e-3", {1e-10, 1e-3, InputRange::kLogBothSigns}, kNone},
+};
+
+static constexpr Domain kLogDomains[4] = {
+  {"0.5 <= x < 2", {0.5, 2.0, InputRange::kLinear}, kNone},
+  {"0.99 <= x < 1.01", {0.99, 1.01, InputRange::kLinear}, kNone},
+  {"1e-300 <= x < 1e300", {1e-300, 1e300, InputRange::kLog}, kNone},
+  {"subnormal x", {1e-320, 2e-308, InputRange::kLog}, kNone},
+};
+
+static constexpr Domain kLogfDomains[4] = {
+  {"0.5 <= x < 2", {0.5, 2.0, InputRange::kLinear}, kNone},
+  {"0.99 <= x < 1.01", {0.99, 1.01, InputRange::kLinear}, kNone},
+  {"1e-37 <= x < 1e38", {1e-37, 1e38, InputRange::kLog}, kNone},
+  {"subnormal x", {1e-44, 1e-38, InputRange::kLog}, kNone},
+};
+
+static constexpr Domain kPowDomains[4] = {
+  {"0.5 <= x < 2, |y| < 10", {0.5, 2.0, InputRange::kLinear}, {-10.0, 10.0, InputRange::kLinear}},
+  {"x ~ 1, |y| < 1e3", {0.99, 1.01, InputRange::kLinear}, {-1e3, 1e3, InputRange::kLinear}},
+  {"1e-10 <= x < 1e10, |y| < 10",
+   {1e-10, 1e10, InputRange::kLog}, {-10.0, 10.0, InputRange::kLinear}},
+  {"1e-3 <= x < 1e3, |y| < 1", {1e-3, 1e3, InputRange::kLog}, {-1.0, 1.0, InputRange::kLinear}},
+};
+
+static constexpr Domain kPowfDomains[4] = {
+  {"0.5 <= x < 2, |y| < 10", {0.5, 2.0, InputRange::kLinear}, {-10.0, 10.0, InputRange::kLinear}},
+  {"x ~ 1, |y| < 1e3", {0.99, 1.01, InputRange::kLinear}, {-1e3, 1e3, InputRange::kLinear}},
+  {"1e-3 <= x < 1e3, |y| < 5", {1e-3, 1e3, InputRange::kLog}, {-5.0, 5.0, InputRange::kLinear}},
+  {"1e-3 <= x < 1e3, |y| < 1", {1e-3, 1e3, InputRange::kLog}, {-1.0, 1.0, InputRange::kLinear}},
+};
+
+#define MATH_ACCURACY_BENCHMARK(name, T, function)                                    \
+  static void BM_math_accuracy_##name(benchmark::State& state) {                      \
+    MathAccuracy<T>(state, function, false);                                          \
+  }                                                                                   \
+  BIONIC_BENCHMARK_WITH_ARG(BM_math_accuracy_##name, "MATH_ACCURACY_DOMAINS");        \
+  static void BM_math_accuracy_##name##_latency(benchmark::State& state) {            \
+    MathAccuracy<T>(state, function, true);                                           \
+  }                                                                                   \
+  BIONIC_BENCHMARK_WITH_ARG(BM_math_accuracy_##name##_latency, "MATH_ACCURACY_DOMAINS")
+
+template <typename T>
+static MathFunction<T> Unary(T (*fn)(T), long double (*ref)(long double), const Domain (&d)[4]) {
+  return {fn, ref, nullptr, nullptr, {d[0], d[1], d[2], d[3]}};
+}
+
+template <typename T>
+static MathFunction<T> Binary(T (*fn)(T, T), long double (*ref)(long double, long double),
+                              const Domain (&d)[4]) {
+  return {nullptr, nullptr, fn, ref, {d[0], d[1], d[2], d[3]}};
+}
+
+MATH_ACCURACY_BENCHMARK(sin, double, Unary<double>(sin, sinl, kSinCosDomains));
+MATH_ACCURACY_BENCHMARK(cos, double, Unary<double>(cos, cosl, kSinCosDomains));
+MATH_ACCURACY_BENCHMARK(tan, double, Unary<double>(tan, tanl, kSinCosDomains));
+MATH_ACCURACY_BENCHMARK(asin, double, Unary<double>(asin, asinl, kAsinDomains));
+MATH_ACCURACY_BENCHMARK(acos, double, Unary<double>(acos, acosl, kAsinDomains));
+MATH_ACCURACY_BENCHMARK(atan, double, Unary<double>(atan, atanl, kAtanDomains));
+MATH_ACCURACY_BENCHMARK(atan2, double, Binary<double>(atan2, atan2l, kAtan2Domains));
+MATH_ACCURACY_BENCHMARK(exp, double, Unary<double>(exp, expl, kExpDomains));
+MATH_ACCURACY_BENCHMARK(exp2, double, Unary<double>(exp2, exp2l, kExp2Domains));
+MATH_ACCURACY_BENCHMARK(log, double, Unary<double>(log, logl, kLogDomains));
+MATH_ACCURACY_BENCHMARK(log2, double, Unary<double>(log2, log2_reference, kLogDomains));
+MATH_ACCURACY_BENCHMARK(log10, double, Unary<double>(log10, log10_reference, kLogDomains));
+MATH_ACCURACY_BENCHMARK(pow, double, Binary<double>(pow, powl, kPowDomains));
+
+MATH_ACCURACY_BENCHMARK(sinf, float, Unary<float>(sinf, sinl, kSinCosfDomains));
+MATH_ACCURACY_BENCHMARK(cosf, float, Unary<float>(cosf, cosl, kSinCosfDomains));
+MATH_ACCURACY_BENCHMARK(tanf, float, Unary<float>(tanf, tanl, kSinCosfDomains));
+MATH_ACCURACY_BENCHMARK(asinf, float, Unary<float>(asinf, asinl, kAsinDomains));
+MATH_ACCURACY_BENCHMARK(acosf, float, Unary<float>(acosf, acosl, kAsinDomains));
+MATH_ACCURACY_BENCHMARK(atanf, float, Unary<float>(atanf, atanl, kAtanDomains));
+MATH_ACCURACY_BENCHMARK(atan2f, float, Binary<float>(atan2f, atan2l, kAtan2Domains));
+MATH_ACCURACY_BENCHMARK(expf, float, Unary<float>(expf, expl, kExpfDomains));
+MATH_ACCURACY_BENCHMARK(exp2f, float, Unary<float>(exp2f, exp2l, kExp2fDomains));
+MATH_ACCURACY_BENCHMARK(logf, float, Unary<float>(logf, logl, kLogfDomains));
+MATH_ACCURACY_BENCHMARK(log2f, float, Unary<float>(log2f, log2_reference, kLogfDomains));
+MATH_ACCURACY_BENCHMARK(log10f, float, Unary<float>(log10f, log10_reference, kLogfDomains));
+MATH_ACCURACY_BENCHMARK(powf, float, Binary<float>(powf, powl, kPowfDomains));
@@ -16,10 +16,17 @@
 
 #include <fenv.h>
 #include <math.h>
+#include <string.h>
+
+#include <vector>
 
 #include <benchmark/benchmark.h>
 #include "util.h"
 
+#if defined(__BIONIC__)
+#include <android/math_array.h>
+#endif
+
 static const double values[] = { 1234.0, nan(""), HUGE_VAL, 0.0 };
 static const char* names[] = { "1234.0", "nan", "HUGE_VAL", "0.0" };
 
@@ -564,3 +571,502 @@ static void BM_math_sincosf_latency(benchmark::State& state) {
   state.SetLabel(range.label);
 }
 BIONIC_BENCHMARK_WITH_ARG(BM_math_sincosf_latency, "MATH_SINCOS_COMMON");
+
+// Double versions of the sincosf_input sets.
+struct sincos_range {
+  const char* label;
+  std::vector<double> values;
+};
+
+static std::vector<sincos_range> MakeSincosInput() {
+  std::vector<sincos_range> result;
+  for (const auto& range : sincosf_input) {
+    result.push_back({range.label, std::vector<double>(range.values.begin(), range.values.end())});
+  }
+  return result;
+}
+
+static const std::vector<sincos_range> sincos_input = MakeSincosInput();
+
+static void MathRange(benchmark::State& state, double (*fn)(double),
+                      const std::vector<double>& values, const char* label) {
+  auto cin = values.cbegin();
+  d = 0.0;
+  for (auto _ : state) {
+    d = fn(*cin);
+    if (++cin == values.cend())
+      cin = values.cbegin();
+  }
+  state.SetLabel(label);
+}
+
+static void MathRangeLatency(benchmark::State& state, double (*fn)(double),
+                             const std::vector<double>& values, const char* label) {
+  auto cin = values.cbegin();
+  d = 0.0;
+  for (auto _ : state) {
+    d = fn(d * zerod + *cin);
+    if (++cin == values.cend())
+      cin = values.cbegin();
+  }
+  state.SetLabel(label);
+}
+
+static void BM_math_sin(benchmark::State& state) {
+  const sincos_range& range = sincos_input[state.range(0)];
+  MathRange(state, sin, range.values, range.label);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_math_sin, "MATH_SINCOS_COMMON");
+
+static void BM_math_sin_latency(benchmark::State& state) {
+  const sincos_range& range = sincos_input[state.range(0)];
+  MathRangeLatency(state, sin, range.values, range.label);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_math_sin_latency, "MATH_SINCOS_COMMON");
+
+static void BM_math_cos(benchmark::State& state) {
+  const sincos_range& range = sincos_input[state.range(0)];
+  MathRange(state, cos, range.values, range.label);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_math_cos, "MATH_SINCOS_COMMON");
+
+static void BM_math_cos_latency(benchmark::State& state) {
+  const sincos_range& range = sincos_input[state.range(0)];
+  MathRangeLatency(state, cos, range.values, range.label);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_math_cos_latency, "MATH_SINCOS_COMMON");
+
+static void BM_math_tan(benchmark::State& state) {
+  const sincos_range& range = sincos_input[state.range(0)];
+  MathRange(state, tan, range.values, range.label);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_math_tan, "MATH_SINCOS_COMMON");
+
+static void BM_math_tan_latency(benchmark::State& state) {
+  const sincos_range& range = sincos_input[state.range(0)];
+  MathRangeLatency(state, tan, range.values, range.label);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_math_tan_latency, "MATH_SINCOS_COMMON");
+
+static void BM_math_sincos_range(benchmark::State& state) {
+  const sincos_range& range = sincos_input[state.range(0)];
+  auto cin = range.values.cbegin();
+  d = 0.0;
+  for (auto _ : state) {
+    double s, c;
+    sincos(*cin, &s, &c);
+    d += s;
+    if (++cin == range.values.cend())
+      cin = range.values.cbegin();
+  }
+  state.SetLabel(range.label);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_math_sincos_range, "MATH_SINCOS_COMMON");
+
+// Inputs for atan and atan2, and for asin and acos.
+static std::vector<double> InverseTrigInput(double lo, double hi) {
+  // A stride that's coprime with the size, so consecutive inputs aren't
+  // consecutive values (which would make any branches predictable).
+  std::vector<double> result(1024);
+  for (size_t i = 0; i < result.size(); ++i) {
+    result[i] = lo + (hi - lo) * static_cast<double>((i * 389) % result.size()) / result.size();
+  }
+  return result;
+}
+
+static const std::vector<sincos_range> atan_input = {
+  {"-1 <= x < 1", InverseTrigInput(-1.0, 1.0)},
+  {"1 <= x < 16", InverseTrigInput(1.0, 16.0)},
+  {"-1e6 <= x < 1e6", InverseTrigInput(-1e6, 1e6)},
+};
+
+static const std::vector<sincos_range> asin_input = {
+  {"-0.5 <= x < 0.5", InverseTrigInput(-0.5, 0.5)},
+  {"-1 <= x < 1", InverseTrigInput(-1.0, 1.0)},
+  {"0.99 <= x < 1", InverseTrigInput(0.99, 1.0)},
+};
+
+static void BM_math_atan(benchmark::State& state) {
+  const sincos_range& range = atan_input[state.range(0)];
+  MathRange(state, atan, range.values, range.label);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_math_atan, "MATH_INVERSE_TRIG_COMMON");
+
+static void BM_math_atan_latency(benchmark::State& state) {
+  const sincos_range& range = atan_input[state.range(0)];
+  MathRangeLatency(state, atan, range.values, range.label);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_math_atan_latency, "MATH_INVERSE_TRIG_COMMON");
+
+// y from the atan inputs, and x from the same inputs in a different order.
+static void BM_math_atan2(benchmark::State& state) {
+  const sincos_range& range = atan_input[state.range(0)];
+  auto yin = range.values.cbegin();
+  auto xin = range.values.crbegin();
+  d = 0.0;
+  for (auto _ : state) {
+    d = atan2(*yin, *xin);
+    if (++yin == range.values.cend()) {
+      yin = range.values.cbegin();
+      xin = range.values.crbegin();
+    } else {
+      ++xin;
+    }
+  }
+  state.SetLabel(range.label);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_math_atan2, "MATH_INVERSE_TRIG_COMMON");
+
+static void BM_math_asin(benchmark::State& state) {
+  const sincos_range& range = asin_input[state.range(0)];
+  MathRange(state, asin, range.values, range.label);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_math_asin, "MATH_INVERSE_TRIG_COMMON");
+
+static void BM_math_asin_latency(benchmark::State& state) {
+  const sincos_range& range = asin_input[state.range(0)];
+  MathRangeLatency(state, asin, range.values, range.label);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_math_asin_latency, "MATH_INVERSE_TRIG_COMMON");
+
+static void BM_math_acos(benchmark::State& state) {
+  const sincos_range& range = asin_input[state.range(0)];
+  MathRange(state, acos, range.values, range.label);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_math_acos, "MATH_INVERSE_TRIG_COMMON");
+
+static void BM_math_acos_latency(benchmark::State& state) {
+  const sincos_range& range = asin_input[state.range(0)];
+  MathRangeLatency(state, acos, range.values, range.label);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_math_acos_latency, "MATH_INVERSE_TRIG_COMMON");
+
+// Array throughput: a loop over 1024 inputs calling the scalar function, the
+// same loop calling libm's vector function ABI entry points directly, as a
+// vectorizing compiler would (with `-fopenmp-simd`, say), and one call to
+// libm's array function for the whole lot.
+static constexpr size_t kArraySize = 1024;
+
+template <typename T>
+static std::vector<T> ArrayInput(T lo, T hi) {
+  std::vector<T> result(kArraySize);
+  for (size_t i = 0; i < kArraySize; ++i) {
+    // A stride that's coprime with the size, so neighbouring lanes aren't neighbouring values.
+    result[i] = lo + (hi - lo) * static_cast<T>((i * 389) % kArraySize) / kArraySize;
+  }
+  return result;
+}
+
+template <typename T>
+static void MathArray(benchmark::State& state, T (*fn)(T), T lo, T hi) {
+  std::vector<T> in = ArrayInput(lo, hi);
+  std::vector<T> out(kArraySize);
+  for (auto _ : state) {
+    for (size_t i = 0; i < kArraySize; ++i) out[i] = fn(in[i]);
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kArraySize);
+}
+
+template <typename T>
+static void MathArray2(benchmark::State& state, T (*fn)(T, T), T lo, T hi, T lo2, T hi2) {
+  std::vector<T> in = ArrayInput(lo, hi);
+  std::vector<T> in2 = ArrayInput(lo2, hi2);
+  std::vector<T> out(kArraySize);
+  for (auto _ : state) {
+    for (size_t i = 0; i < kArraySize; ++i) out[i] = fn(in[i], in2[i]);
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kArraySize);
+}
+
+#if defined(__BIONIC__) && (defined(__aarch64__) || defined(__x86_64__))
+#define HAVE_VECTOR_MATH
+typedef double vdouble __attribute__((__vector_size__(16)));
+typedef float vfloat __attribute__((__vector_size__(16)));
+
+#if defined(__aarch64__)
+#define VECTOR_FN(name, args) _ZGVnN##args##_##name
+#define VECTOR_PCS __attribute__((__aarch64_vector_pcs__))
+#else
+#define VECTOR_FN(name, args) _ZGVbN##args##_##name
+#define VECTOR_PCS
+#endif
+
+extern "C" {
+VECTOR_PCS vdouble VECTOR_FN(cos, 2v)(vdouble);
+VECTOR_PCS vdouble VECTOR_FN(exp, 2v)(vdouble);
+VECTOR_PCS vdouble VECTOR_FN(log, 2v)(vdouble);
+VECTOR_PCS vdouble VECTOR_FN(pow, 2vv)(vdouble, vdouble);
+VECTOR_PCS vdouble VECTOR_FN(sin, 2v)(vdouble);
+VECTOR_PCS vfloat VECTOR_FN(cosf, 4v)(vfloat);
+VECTOR_PCS vfloat VECTOR_FN(expf, 4v)(vfloat);
+VECTOR_PCS vfloat VECTOR_FN(logf, 4v)(vfloat);
+VECTOR_PCS vfloat VECTOR_FN(powf, 4vv)(vfloat, vfloat);
+VECTOR_PCS vfloat VECTOR_FN(sinf, 4v)(vfloat);
+}
+
+template <typename T, typename V, typename F>
+static void MathArrayVector(benchmark::State& state, F fn, T lo, T hi) {
+  std::vector<T> in = ArrayInput(lo, hi);
+  std::vector<T> out(kArraySize);
+  for (auto _ : state) {
+    for (size_t i = 0; i < kArraySize; i += sizeof(V) / sizeof(T)) {
+      V x;
+      memcpy(&x, &in[i], sizeof(x));
+      V y = fn(x);
+      memcpy(&out[i], &y, sizeof(y));
+    }
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kArraySize);
+}
+
+template <typename T, typename V, typename F>
+static void MathArrayVector2(benchmark::State& state, F fn, T lo, T hi, T lo2, T hi2) {
+  std::vector<T> in = ArrayInput(lo, hi);
+  std::vector<T> in2 = ArrayInput(lo2, hi2);
+  std::vector<T> out(kArraySize);
+  for (auto _ : state) {
+    for (size_t i = 0; i < kArraySize; i += sizeof(V) / sizeof(T)) {
+      V x, x2;
+      memcpy(&x, &in[i], sizeof(x));
+      memcpy(&x2, &in2[i], sizeof(x2));
+      V y = fn(x, x2);
+      memcpy(&out[i], &y, sizeof(y));
+    }
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kArraySize);
+}
+#endif
+
+#if defined(HAVE_VECTOR_MATH)
+template <typename T>
+static void MathArrayBatch(benchmark::State& state, void (*fn)(const T*, T*, size_t), T lo, T hi) {
+  std::vector<T> in = ArrayInput(lo, hi);
+  std::vector<T> out(kArraySize);
+  for (auto _ : state) {
+    fn(in.data(), out.data(), kArraySize);
+    benchmark::DoNotOptimize(out.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kArraySize);
+}
+
+template <typename T>
+static void MathArraySincosBatch(benchmark::State& state, void (*fn)(const T*, T*, T*, size_t),
+                                 T lo, T hi) {
+  std::vector<T> in = ArrayInput(lo, hi);
+  std::vector<T> s(kArraySize);
+  std::vector<T> c(kArraySize);
+  for (auto _ : state) {
+    fn(in.data(), s.data(), c.data(), kArraySize);
+    benchmark::DoNotOptimize(s.data());
+    benchmark::DoNotOptimize(c.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kArraySize);
+}
+#endif
+
+template <typename T>
+static void MathArraySincos(benchmark::State& state, void (*fn)(T, T*, T*), T lo, T hi) {
+  std::vector<T> in = ArrayInput(lo, hi);
+  std::vector<T> s(kArraySize);
+  std::vector<T> c(kArraySize);
+  for (auto _ : state) {
+    for (size_t i = 0; i < kArraySize; ++i) fn(in[i], &s[i], &c[i]);
+    benchmark::DoNotOptimize(s.data());
+    benchmark::DoNotOptimize(c.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kArraySize);
+}
+
+// What code that doesn't know about sincos() does.
+template <typename T>
+static void MathArraySinAndCos(benchmark::State& state, T (*sin_fn)(T), T (*cos_fn)(T), T lo,
+                               T hi) {
+  std::vector<T> in = ArrayInput(lo, hi);
+  std::vector<T> s(kArraySize);
+  std::vector<T> c(kArraySize);
+  for (auto _ : state) {
+    for (size_t i = 0; i < kArraySize; ++i) {
+      s[i] = sin_fn(in[i]);
+      c[i] = cos_fn(in[i]);
+    }
+    benchmark::DoNotOptimize(s.data());
+    benchmark::DoNotOptimize(c.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * kArraySize);
+}
+
+#if defined(HAVE_VECTOR_MATH)
+#define VECTOR_ARRAY(T, V, name, args, ...) \
+  MathArrayVector<T, V>(state, [](V x) { return VECTOR_FN(name, args)(x); }, __VA_ARGS__)
+#define VECTOR_ARRAY2(T, V, name, args, ...) \
+  MathArrayVector2<T, V>(state, [](V x, V y) { return VECTOR_FN(name, args)(x, y); }, __VA_ARGS__)
+#define BATCH_ARRAY(T, name, ...) MathArrayBatch<T>(state, android_##name##_array, __VA_ARGS__)
+#define BATCH_ARRAY_SINCOS(T, name, ...) MathArraySincosBatch<T>(state, android_##name##_array, __VA_ARGS__)
+#else
+#define VECTOR_ARRAY(...) state.SkipWithError("no vector math on this platform")
+#define VECTOR_ARRAY2(...) state.SkipWithError("no vector math on this platform")
+#define BATCH_ARRAY(...) state.SkipWithError("no array math on this platform")
+#define BATCH_ARRAY_SINCOS(...) state.SkipWithError("no array math on this platform")
+#endif
+
+static void BM_math_sin_array(benchmark::State& state) {
+  MathArray<double>(state, sin, -10.0, 10.0);
+}
+BIONIC_BENCHMARK(BM_math_sin_array);
+
+static void BM_math_sin_array_vector(benchmark::State& state) {
+  VECTOR_ARRAY(double, vdouble, sin, 2v, -10.0, 10.0);
+}
+BIONIC_BENCHMARK(BM_math_sin_array_vector);
+
+static void BM_math_cos_array(benchmark::State& state) {
+  MathArray<double>(state, cos, -10.0, 10.0);
+}
+BIONIC_BENCHMARK(BM_math_cos_array);
+
+static void BM_math_cos_array_vector(benchmark::State& state) {
+  VECTOR_ARRAY(double, vdouble, cos, 2v, -10.0, 10.0);
+}
+BIONIC_BENCHMARK(BM_math_cos_array_vector);
+
+static void BM_math_sincos_array(benchmark::State& state) {
+  MathArraySincos<double>(state, sincos, -10.0, 10.0);
+}
+BIONIC_BENCHMARK(BM_math_sincos_array);
+
+static void BM_math_sincos_array_sin_and_cos(benchmark::State& state) {
+  MathArraySinAndCos<double>(state, sin, cos, -10.0, 10.0);
+}
+BIONIC_BENCHMARK(BM_math_sincos_array_sin_and_cos);
+
+static void BM_math_sincos_array_batch(benchmark::State& state) {
+  BATCH_ARRAY_SINCOS(double, sincos, -10.0, 10.0);
+}
+BIONIC_BENCHMARK(BM_math_sincos_array_batch);
+
+static void BM_math_exp_array(benchmark::State& state) {
+  MathArray<double>(state, exp, -20.0, 20.0);
+}
+BIONIC_BENCHMARK(BM_math_exp_array);
+
+static void BM_math_exp_array_vector(benchmark::State& state) {
+  VECTOR_ARRAY(double, vdouble, exp, 2v, -20.0, 20.0);
+}
+BIONIC_BENCHMARK(BM_math_exp_array_vector);
+
+static void BM_math_exp_array_batch(benchmark::State& state) {
+  BATCH_ARRAY(double, exp, -20.0, 20.0);
+}
+BIONIC_BENCHMARK(BM_math_exp_array_batch);
+
+static void BM_math_log_array(benchmark::State& state) {
+  MathArray<double>(state, log, 0.01, 100.0);
+}
+BIONIC_BENCHMARK(BM_math_log_array);
+
+static void BM_math_log_array_vector(benchmark::State& state) {
+  VECTOR_ARRAY(double, vdouble, log, 2v, 0.01, 100.0);
+}
+BIONIC_BENCHMARK(BM_math_log_array_vector);
+
+static void BM_math_log_array_batch(benchmark::State& state) {
+  BATCH_ARRAY(double, log, 0.01, 100.0);
+}
+BIONIC_BENCHMARK(BM_math_log_array_batch);
+
+static void BM_math_pow_array(benchmark::State& state) {
+  MathArray2<double>(state, pow, 0.01, 100.0, -4.0, 4.0);
+}
+BIONIC_BENCHMARK(BM_math_pow_array);
+
+static void BM_math_pow_array_vector(benchmark::State& state) {
+  VECTOR_ARRAY2(double, vdouble, pow, 2vv, 0.01, 100.0, -4.0, 4.0);
+}
+BIONIC_BENCHMARK(BM_math_pow_array_vector);
+
+static void BM_math_sinf_array(benchmark::State& state) {
+  MathArray<float>(state, sinf, -10.0f, 10.0f);
+}
+BIONIC_BENCHMARK(BM_math_sinf_array);
+
+static void BM_math_sinf_array_vector(benchmark::State& state) {
+  VECTOR_ARRAY(float, vfloat, sinf, 4v, -10.0f, 10.0f);
+}
+BIONIC_BENCHMARK(BM_math_sinf_array_vector);
+
+static void BM_math_cosf_array(benchmark::State& state) {
+  MathArray<float>(state, cosf, -10.0f, 10.0f);
+}
+BIONIC_BENCHMARK(BM_math_cosf_array);
+
+static void BM_math_cosf_array_vector(benchmark::State& state) {
+  VECTOR_ARRAY(float, vfloat, cosf, 4v, -10.0f, 10.0f);
+}
+BIONIC_BENCHMARK(BM_math_cosf_array_vector);
+
+static void BM_math_sincosf_array(benchmark::State& state) {
+  MathArraySincos<float>(state, sincosf, -10.0f, 10.0f);
+}
+BIONIC_BENCHMARK(BM_math_sincosf_array);
+
+static void BM_math_sincosf_array_sin_and_cos(benchmark::State& state) {
+  MathArraySinAndCos<float>(state, sinf, cosf, -10.0f, 10.0f);
+}
+BIONIC_BENCHMARK(BM_math_sincosf_array_sin_and_cos);
+
+static void BM_math_sincosf_array_batch(benchmark::State& state) {
+  BATCH_ARRAY_SINCOS(float, sincosf, -10.0f, 10.0f);
+}
+BIONIC_BENCHMARK(BM_math_sincosf_array_batch);
+
+static void BM_math_expf_array(benchmark::State& state) {
+  MathArray<float>(state, expf, -20.0f, 20.0f);
+}
+BIONIC_BENCHMARK(BM_math_expf_array);
+
+static void BM_math_expf_array_vector(benchmark::State& state) {
+  VECTOR_ARRAY(float, vfloat, expf, 4v, -20.0f, 20.0f);
+}
+BIONIC_BENCHMARK(BM_math_expf_array_vector);
+
+static void BM_math_expf_array_batch(benchmark::State& state) {
+  BATCH_ARRAY(float, expf, -20.0f, 20.0f);
+}
+BIONIC_BENCHMARK(BM_math_expf_array_batch);
+
+static void BM_math_logf_array(benchmark::State& state) {
+  MathArray<float>(state, logf, 0.01f, 100.0f);
+}
+BIONIC_BENCHMARK(BM_math_logf_array);
+
+static void BM_math_logf_array_vector(benchmark::State& state) {
+  VECTOR_ARRAY(float, vfloat, logf, 4v, 0.01f, 100.0f);
+}
+BIONIC_BENCHMARK(BM_math_logf_array_vector);
+
+static void BM_math_logf_array_batch(benchmark::State& state) {
+  BATCH_ARRAY(float, logf, 0.01f, 100.0f);
+}
+BIONIC_BENCHMARK(BM_math_logf_array_batch);
+
+static void BM_math_powf_array(benchmark::State& state) {
+  MathArray2<float>(state, powf, 0.01f, 100.0f, -4.0f, 4.0f);
+}
+BIONIC_BENCHMARK(BM_math_powf_array);
+
+static void BM_math_powf_array_vector(benchmark::State& state) {
+  VECTOR_ARRAY2(float, vfloat, powf, 4vv, 0.01f, 100.0f, -4.0f, 4.0f);
+}
+BIONIC_BENCHMARK(BM_math_powf_array_vector);
@@ -0,0 +1,361 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <android-base/stringprintf.h>
+#include <benchmark/benchmark.h>
+#include "dns_server.h"
+#include "util.h"
+
+#if defined(__BIONIC__)
+#include "dns/include/resolv_netid.h"
+#else
+#include <resolv.h>
+#endif
+
+// All of these benchmarks talk to a FakeDnsServer on the loopback interface,
+// so they measure the resolver itself rather than the network.
+//
+// On bionic, the resolver only talks to port 53 of the servers configured for
+// a netid, so the server has to be able to bind 127.0.0.1:53 (run as root), and
+// ANDROID_DNS_MODE=local keeps getaddrinfo from going to netd. On glibc, each
+// thread's _res is pointed at the server's ephemeral port; glibc has no
+// resolver cache, so the cached benchmarks are skipped there.
+
+#if defined(__BIONIC__)
+static constexpr unsigned kBenchNetId = 4242;
+#endif
+
+static std::atomic<unsigned> g_name_counter;
+
+static std::string UniqueName() {
+  return android::base::StringPrintf("host-%u.bench", g_name_counter++);
+}
+
+static uint64_t NowNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+class ResolverFixture {
+ public:
+  explicit ResolverFixture(FakeDnsServer::Options options) : server_(PrepareOptions(options)) {
+    if (!server_.Start()) {
+      error_ = android::base::StringPrintf("couldn't start fake DNS server on port %u: %s",
+                                           server_.port(), strerror(errno));
+#if defined(__BIONIC__)
+      if (errno == EACCES || errno == EADDRINUSE) {
+        error_ += " (the resolver only queries port 53; run as root with nothing else on it)";
+      }
+#endif
+      return;
+    }
+#if defined(__BIONIC__)
+    // Only for the lifetime of the fixture; the destructor puts it back.
+    const char* old_mode = getenv("ANDROID_DNS_MODE");
+    if (old_mode != nullptr) old_dns_mode_ = old_mode;
+    had_dns_mode_ = (old_mode != nullptr);
+    setenv("ANDROID_DNS_MODE", "local", 1);
+    configured_ = true;
+    const char* servers[] = {"127.0.0.1"};
+    __res_params params = {};
+    params.sample_validity = 1800;
+    params.base_timeout_msec = 100;
+    if (_resolv_set_nameservers_for_net(kBenchNetId, servers, 1, "", &params) != 0) {
+      error_ = "_resolv_set_nameservers_for_net failed";
+    }
+#endif
+    generation_ = ++g_generation;
+  }
+
+  ~ResolverFixture() {
+#if defined(__BIONIC__)
+    if (!configured_) return;
+    _resolv_delete_cache_for_net(kBenchNetId);
+    if (had_dns_mode_) {
+      setenv("ANDROID_DNS_MODE", old_dns_mode_.c_str(), 1);
+    } else {
+      unsetenv("ANDROID_DNS_MODE");
+    }
+#endif
+  }
+
+  const std::string& error() const { return error_; }
+
+  // Returns the getaddrinfo error code for an A lookup of |name|.
+  int Resolve(const char* name) {
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* res = nullptr;
+#if defined(__BIONIC__)
+    int rc = android_getaddrinfofornet(name, nullptr, &hints, kBenchNetId, 0, &res);
+#else
+    ConfigureThread();
+    int rc = getaddrinfo(name, nullptr, &hints, &res);
+#endif
+    if (rc == 0) freeaddrinfo(res);
+    return rc;
+  }
+
+ private:
+  static FakeDnsServer::Options PrepareOptions(FakeDnsServer::Options options) {
+#if defined(__BIONIC__)
+    options.port = 53;
+#endif
+    return options;
+  }
+
+#if !defined(__BIONIC__)
+  // _res is per-thread, so every thread that resolves has to be redirected.
+  void ConfigureThread() {
+    static thread_local unsigned configured_generation = 0;
+    if (configured_generation == generation_) return;
+    res_init();
+    _res.nsaddr_list[0] = server_.addr();
+    _res.nscount = 1;
+    _res.retrans = 1;
+    _res.retry = 2;
+    configured_generation = generation_;
+  }
+#endif
+
+  static inline std::atomic<unsigned> g_generation = 0;
+
+  FakeDnsServer server_;
+  std::string error_;
+  unsigned generation_ = 0;
+#if defined(__BIONIC__)
+  bool configured_ = false;
+  bool had_dns_mode_ = false;
+  std::string old_dns_mode_;
+#endif
+};
+
+static bool CheckResolve(benchmark::State& state, ResolverFixture& fixture, const char* name) {
+  int rc = fixture.Resolve(name);
+  if (rc != 0) {
+    state.SkipWithError(android::base::StringPrintf("resolving %s failed: %s", name,
+                                                    gai_strerror(rc)).c_str());
+    return false;
+  }
+  return true;
+}
+
+static void BM_resolv_getaddrinfo_cached(benchmark::State& state) {
+#if defined(__BIONIC__)
+  ResolverFixture fixture({});
+  if (!fixture.error().empty()) {
+    state.SkipWithError(fixture.error().c_str());
+    return;
+  }
+  if (!CheckResolve(state, fixture, "cached.bench")) return;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fixture.Resolve("cached.bench"));
+  }
+#else
+  state.SkipWithError("glibc has no resolver cache");
+#endif
+}
+BIONIC_BENCHMARK(BM_resolv_getaddrinfo_cached);
+
+static void BM_resolv_getaddrinfo_uncached(benchmark::State& state) {
+  ResolverFixture fixture({});
+  if (!fixture.error().empty()) {
+    state.SkipWithError(fixture.error().c_str());
+    return;
+  }
+  for (auto _ : state) {
+    if (!CheckResolve(state, fixture, UniqueName().c_str())) break;
+  }
+}
+BIONIC_BENCHMARK(BM_resolv_getaddrinfo_uncached);
+
+// Every UDP reply is truncated, so each lookup is retried over TCP.
+static void BM_resolv_getaddrinfo_tcp_fallback(benchmark::State& state) {
+  FakeDnsServer::Options options;
+  options.truncate = true;
+  ResolverFixture fixture(options);
+  if (!fixture.error().empty()) {
+    state.SkipWithError(fixture.error().c_str());
+    return;
+  }
+  for (auto _ : state) {
+    if (!CheckResolve(state, fixture, UniqueName().c_str())) break;
+  }
+}
+BIONIC_BENCHMARK(BM_resolv_getaddrinfo_tcp_fallback);
+
+// Uncached lookups against a server with 1ms of latency that drops the given
+// percentage of queries, reporting the median and tail latency.
+static void BM_resolv_getaddrinfo_loss(benchmark::State& state) {
+  FakeDnsServer::Options options;
+  options.latency_us = 1000;
+  options.loss = state.range(0) / 100.0;
+  ResolverFixture fixture(options);
+  if (!fixture.error().empty()) {
+    state.SkipWithError(fixture.error().c_str());
+    return;
+  }
+
+  std::vector<uint64_t> latencies;
+  for (auto _ : state) {
+    std::string name = UniqueName();
+    uint64_t start = NowNs();
+    // A lookup can fail outright if every retry is dropped; that's still a sample.
+    benchmark::DoNotOptimize(fixture.Resolve(name.c_str()));
+    latencies.push_back(NowNs() - start);
+  }
+  if (latencies.empty()) return;
+
+  std::sort(latencies.begin(), latencies.end());
+  auto percentile = [&](double p) {
+    return static_cast<double>(latencies[static_cast<size_t>(p * (latencies.size() - 1))]) / 1e3;
+  };
+  state.counters["p50_us"] = percentile(0.50);
+  state.counters["p99_us"] = percentile(0.99);
+  state.counters["max_us"] = percentile(1.00);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_resolv_getaddrinfo_loss, "1");
+
+// Uncached lookups on the benchmark thread while the given number of other
+// threads do the same, to measure contention in the resolver (cache lock,
+// per-thread state, socket setup).
+static void BM_resolv_getaddrinfo_contended(benchmark::State& state) {
+  ResolverFixture fixture({});
+  if (!fixture.error().empty()) {
+    state.SkipWithError(fixture.error().c_str());
+    return;
+  }
+
+  std::atomic<bool> stop = false;
+  std::vector<std::thread> threads;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    threads.emplace_back([&]() {
+      while (!stop) fixture.Resolve(UniqueName().c_str());
+    });
+  }
+  for (auto _ : state) {
+    if (!CheckResolve(state, fixture, UniqueName().c_str())) break;
+  }
+  stop = true;
+  for (auto& t : threads) t.join();
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_resolv_getaddrinfo_contended, "4");
+
+// Cache hits from several threads at once, which all serialize on the cache lock.
+static void BM_resolv_getaddrinfo_cached_contended(benchmark::State& state) {
+#if defined(__BIONIC__)
+  ResolverFixture fixture({});
+  if (!fixture.error().empty()) {
+    state.SkipWithError(fixture.error().c_str());
+    return;
+  }
+  if (!CheckResolve(state, fixture, "cached.bench")) return;
+
+  std::atomic<bool> stop = false;
+  std::vector<std::thread> threads;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    threads.emplace_back([&]() {
+      while (!stop) fixture.Resolve("cached.bench");
+    });
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fixture.Resolve("cached.bench"));
+  }
+  stop = true;
+  for (auto& t : threads) t.join();
+#else
+  state.SkipWithError("glibc has no resolver cache");
+#endif
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_resolv_getaddrinfo_cached_contended, "4");
+
+// Resolving the given number of uncached names against a server with 1ms of
+// latency, one after another...
+static void BM_resolv_getaddrinfo_serial(benchmark::State& state) {
+  FakeDnsServer::Options options;
+  options.latency_us = 1000;
+  ResolverFixture fixture(options);
+  if (!fixture.error().empty()) {
+    state.SkipWithError(fixture.error().c_str());
+    return;
+  }
+  for (auto _ : state) {
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      if (!CheckResolve(state, fixture, UniqueName().c_str())) return;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_resolv_getaddrinfo_serial, "64");
+
+// ...and all at once with android_getaddrinfo_batchfornet.
+static void BM_resolv_getaddrinfo_batch(benchmark::State& state) {
+#if defined(__BIONIC__)
+  FakeDnsServer::Options options;
+  options.latency_us = 1000;
+  ResolverFixture fixture(options);
+  if (!fixture.error().empty()) {
+    state.SkipWithError(fixture.error().c_str());
+    return;
+  }
+
+  addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  std::vector<std::string> names(state.range(0));
+  std::vector<android_getaddrinfo_request> reqs(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (size_t i = 0; i < reqs.size(); ++i) {
+      names[i] = UniqueName();
+      reqs[i] = {.hostname = names[i].c_str(), .servname = nullptr, .hints = &hints,
+                 .res = nullptr, .error = 0};
+    }
+    state.ResumeTiming();
+
+    int resolved = android_getaddrinfo_batchfornet(reqs.data(), reqs.size(), kBenchNetId, 0, 5000);
+    for (auto& req : reqs) {
+      if (req.res != nullptr) freeaddrinfo(req.res);
+    }
+    if (resolved != static_cast<int>(reqs.size())) {
+      state.SkipWithError(android::base::StringPrintf("only %d of %zu names resolved", resolved,
+                                                      reqs.size()).c_str());
+      return;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+#else
+  state.SkipWithError("android_getaddrinfo_batchfornet is bionic-only");
+#endif
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_resolv_getaddrinfo_batch, "64");
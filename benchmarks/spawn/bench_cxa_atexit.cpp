@@ -40,14 +40,27 @@ static void dtor_func(void*) {}
 // Prevent the compiler from optimizing out the __cxa_atexit call.
 void (*volatile g_pdtor_func)(void*) = dtor_func;
 
+// With a third argument of "ctor", the handlers are registered from a constructor, as a library's
+// static destructors would be, rather than from main. bionic and glibc both pass argc and argv to
+// constructors.
+__attribute__((constructor)) static void register_from_constructor(int argc, char* argv[]) {
+  if (argc != 4 || std::string(argv[3]) != "ctor") return;
+
+  int count = atoi(argv[1]);
+  for (int i = 0; i < count; ++i) {
+    __cxa_atexit(g_pdtor_func, nullptr, &__dso_handle);
+  }
+}
+
 int main(int argc, char* argv[]) {
   auto usage = [&argv]() {
-    fprintf(stderr, "usage: %s COUNT MODE\n", argv[0]);
+    fprintf(stderr, "usage: %s COUNT MODE [WHEN]\n", argv[0]);
     fprintf(stderr, "MODE is one of '_Exit' or 'exit'.\n");
+    fprintf(stderr, "WHEN is one of 'main' (the default) or 'ctor'.\n");
     exit(1);
   };
 
-  if (argc != 3) usage();
+  if (argc != 3 && argc != 4) usage();
 
   int count = atoi(argv[1]);
 
@@ -55,8 +68,13 @@ int main(int argc, char* argv[]) {
   std::string mode = argv[2];
   if (mode != "_Exit" && mode != "exit") usage();
 
-  for (int i = 0; i < count; ++i) {
-    __cxa_atexit(g_pdtor_func, nullptr, &__dso_handle);
+  std::string when = (argc == 4) ? argv[3] : "main";
+  if (when != "main" && when != "ctor") usage();
+
+  if (when == "main") {
+    for (int i = 0; i < count; ++i) {
+      __cxa_atexit(g_pdtor_func, nullptr, &__dso_handle);
+    }
   }
 
   if (mode == "_Exit") {
@@ -31,8 +31,14 @@
 #include <android-base/file.h>
 #include <benchmark/benchmark.h>
 
+#include <string>
+
 void BM_spawn_test(benchmark::State& state, const char* const* argv);
 
+// Spawns `program` with a dup2 file action from a parent holding state.range(0) MiB of dirty
+// memory, to show that spawning doesn't get slower as the parent grows.
+void BM_spawn_rss_test(benchmark::State& state, const std::string& program);
+
 static inline std::string test_program(const char* name) {
 #if defined(__LP64__)
   return android::base::GetExecutableDirectory() + "/" + name + "64";
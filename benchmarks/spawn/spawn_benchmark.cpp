@@ -31,34 +31,72 @@
 #include <errno.h>
 #include <spawn.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <unistd.h>
 
 #include <android-base/stringprintf.h>
 
 extern char** environ;
 
+static bool SpawnAndWait(benchmark::State& state, const char* const* argv,
+                         const posix_spawn_file_actions_t* actions) {
+  pid_t child = 0;
+  if (int spawn_err = posix_spawn(&child, argv[0], actions, nullptr, const_cast<char**>(argv),
+                                  environ)) {
+    state.SkipWithError(android::base::StringPrintf(
+        "posix_spawn of %s failed: %s", argv[0], strerror(spawn_err)).c_str());
+    return false;
+  }
+
+  int wstatus = 0;
+  const pid_t wait_result = TEMP_FAILURE_RETRY(waitpid(child, &wstatus, 0));
+  if (wait_result != child) {
+    state.SkipWithError(android::base::StringPrintf(
+        "waitpid on pid %d for %s failed: %s",
+        static_cast<int>(child), argv[0], strerror(errno)).c_str());
+    return false;
+  }
+  if (WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 127) {
+    state.SkipWithError(android::base::StringPrintf("could not exec %s", argv[0]).c_str());
+    return false;
+  }
+  return true;
+}
+
 void BM_spawn_test(benchmark::State& state, const char* const* argv) {
   for (auto _ : state) {
-    pid_t child = 0;
-    if (int spawn_err = posix_spawn(&child, argv[0], nullptr, nullptr, const_cast<char**>(argv),
-                                    environ)) {
-      state.SkipWithError(android::base::StringPrintf(
-          "posix_spawn of %s failed: %s", argv[0], strerror(spawn_err)).c_str());
-      break;
-    }
+    if (!SpawnAndWait(state, argv, nullptr)) break;
+  }
+}
 
-    int wstatus = 0;
-    const pid_t wait_result = TEMP_FAILURE_RETRY(waitpid(child, &wstatus, 0));
-    if (wait_result != child) {
+void BM_spawn_rss_test(benchmark::State& state, const std::string& program) {
+  // Give the parent the given number of MiB of dirty anonymous memory. A fork-based spawn has to
+  // copy the page tables for all of it; a CLONE_VM one shouldn't care.
+  size_t ballast_size = static_cast<size_t>(state.range(0)) * 1024 * 1024;
+  void* ballast = nullptr;
+  if (ballast_size != 0) {
+    ballast = mmap(nullptr, ballast_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                   -1, 0);
+    if (ballast == MAP_FAILED) {
       state.SkipWithError(android::base::StringPrintf(
-          "waitpid on pid %d for %s failed: %s",
-          static_cast<int>(child), argv[0], strerror(errno)).c_str());
-      break;
-    }
-    if (WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 127) {
-      state.SkipWithError(android::base::StringPrintf("could not exec %s", argv[0]).c_str());
-      break;
+          "couldn't map %zu bytes: %s", ballast_size, strerror(errno)).c_str());
+      return;
     }
+    memset(ballast, 1, ballast_size);
+  }
+
+  // A file action, which is what used to force posix_spawn to fork.
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, STDERR_FILENO, STDOUT_FILENO);
+
+  const char* argv[] = {program.c_str(), nullptr};
+  for (auto _ : state) {
+    if (!SpawnAndWait(state, argv, &actions)) break;
   }
+
+  posix_spawn_file_actions_destroy(&actions);
+  if (ballast != nullptr) munmap(ballast, ballast_size);
 }
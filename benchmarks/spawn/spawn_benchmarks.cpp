@@ -33,6 +33,15 @@ SPAWN_BENCHMARK(noop_nostl, test_program("bench_noop_nostl").c_str());
 SPAWN_BENCHMARK(noop_static, test_program("bench_noop_static").c_str());
 SPAWN_BENCHMARK(bench_cxa_atexit, test_program("bench_cxa_atexit").c_str(), "100000", "_Exit");
 SPAWN_BENCHMARK(bench_cxa_atexit_full, test_program("bench_cxa_atexit").c_str(), "100000", "exit");
+SPAWN_BENCHMARK(bench_cxa_atexit_ctor, test_program("bench_cxa_atexit").c_str(), "100000", "_Exit",
+                "ctor");
+
+BENCHMARK_CAPTURE(BM_spawn_rss_test, noop_dup2, test_program("bench_noop"))
+    ->Arg(0)
+    ->Arg(256)
+    ->Arg(1024)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
 
 // Android has a /bin -> /system/bin symlink, but use /system/bin explicitly so we can more easily
 // compare Bionic-vs-glibc on a Linux desktop machine.
@@ -14,16 +14,33 @@
  * limitations under the License.
  */
 
+#include <dirent.h>
+#include <dlfcn.h>
 #include <err.h>
+#include <errno.h>
 #include <langinfo.h>
 #include <locale.h>
 #include <malloc.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <android-base/file.h>
 #include <benchmark/benchmark.h>
 #include "util.h"
 
+#if defined(__BIONIC__)
+#include "platform/bionic/exit.h"
+#endif
+
+extern "C" int __cxa_atexit(void (*fn)(void*), void* arg, void* dso_handle);
+
 static void MallocFree(benchmark::State& state) {
   const size_t nbytes = state.range(0);
   int pagesize = getpagesize();
@@ -227,3 +244,178 @@ BIONIC_TRIVIAL_BENCHMARK(BM_stdlib_strtol, strtol(" -123", nullptr, 0));
 BIONIC_TRIVIAL_BENCHMARK(BM_stdlib_strtoll, strtoll(" -123", nullptr, 0));
 BIONIC_TRIVIAL_BENCHMARK(BM_stdlib_strtoul, strtoul(" -123", nullptr, 0));
 BIONIC_TRIVIAL_BENCHMARK(BM_stdlib_strtoull, strtoull(" -123", nullptr, 0));
+
+// glibc only gained arc4random in 2.36, which is newer than the host glibc.
+static void BM_stdlib_arc4random(benchmark::State& state) {
+#if defined(__BIONIC__)
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(arc4random());
+  }
+#else
+  state.SkipWithError("arc4random is bionic-only");
+#endif
+}
+BIONIC_BENCHMARK(BM_stdlib_arc4random);
+
+static void BM_stdlib_arc4random_buf(benchmark::State& state) {
+#if defined(__BIONIC__)
+  std::vector<char> buf(state.range(0));
+  for (auto _ : state) {
+    arc4random_buf(buf.data(), buf.size());
+    benchmark::DoNotOptimize(buf.data());
+  }
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(buf.size()));
+#else
+  state.SkipWithError("arc4random_buf is bionic-only");
+#endif
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_stdlib_arc4random_buf, "AT_COMMON_SIZES");
+
+// arc4random on the benchmark thread while the given number of other threads
+// do the same, to measure contention on the generator's state.
+static void BM_stdlib_arc4random_contended(benchmark::State& state) {
+#if defined(__BIONIC__)
+  std::atomic<bool> stop = false;
+  std::vector<std::thread> threads;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    threads.emplace_back([&]() {
+      while (!stop) benchmark::DoNotOptimize(arc4random());
+    });
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(arc4random());
+  }
+  stop = true;
+  for (auto& t : threads) t.join();
+#else
+  state.SkipWithError("arc4random is bionic-only");
+#endif
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_stdlib_arc4random_contended, "4");
+
+// Stands in for one library's destructors: frees the heap that library built
+// up, touching each block on the way.
+static constexpr size_t kExitBlocksPerHandler = 8;
+static constexpr size_t kExitBlockSize = 4096;
+
+static void FreeExitBlocks(void* arg) {
+  void** blocks = static_cast<void**>(arg);
+  for (size_t i = 0; i < kExitBlocksPerHandler; ++i) free(blocks[i]);
+  free(blocks);
+}
+
+// The libraries built for linker-reloc-bench mimic the dependencies of
+// libandroid_servers.so, so loading them all gives exit() a realistic set of
+// libraries to finalize. They're only there once linker-reloc-bench has been
+// installed, next to this benchmark's own directory:
+//    /data/benchmarktest[64]/bionic-benchmarks    [exe dir]
+//    /data/nativetest[64]/linker-reloc-bench      [dir with test libs]
+static std::string LinkerRelocBenchLibDir() {
+#if defined(__LP64__)
+  static constexpr const char* kNativeTestDir = "nativetest64";
+#else
+  static constexpr const char* kNativeTestDir = "nativetest";
+#endif
+  return android::base::Dirname(android::base::Dirname(android::base::GetExecutableDirectory())) +
+         "/" + kNativeTestDir + "/linker-reloc-bench";
+}
+
+using update_LD_LIBRARY_PATH_t = void (*)(const char*);
+
+static update_LD_LIBRARY_PATH_t GetUpdateLdLibraryPath() {
+  return reinterpret_cast<update_LD_LIBRARY_PATH_t>(
+      dlsym(RTLD_DEFAULT, "android_update_LD_LIBRARY_PATH"));
+}
+
+static void LoadLinkerRelocBenchLibs(const std::string& lib_dir) {
+  // The libraries find each other through LD_LIBRARY_PATH, so they can be
+  // opened in any order.
+  GetUpdateLdLibraryPath()(lib_dir.c_str());
+  DIR* dir = opendir(lib_dir.c_str());
+  if (dir == nullptr) errx(1, "ERROR: opendir %s failed: %s", lib_dir.c_str(), strerror(errno));
+  while (dirent* entry = readdir(dir)) {
+    std::string name(entry->d_name);
+    if (name.size() < 3 || name.compare(name.size() - 3, 3, ".so") != 0) continue;
+    if (dlopen(name.c_str(), RTLD_NOW) == nullptr) errx(1, "ERROR: dlopen failed: %s", dlerror());
+  }
+  closedir(dir);
+}
+
+// Time from a child's call to exit() until the parent reaps it, with the
+// given number of destructor-registering "libraries" in the child, and the
+// linker-reloc-bench libraries loaded too if |lib_dir| isn't null.
+static void ExitLatency(benchmark::State& state, bool fast, int64_t handlers,
+                        const std::string* lib_dir) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    int fds[2];
+    if (pipe(fds) == -1) errx(1, "ERROR: pipe failed: %s", strerror(errno));
+    pid_t pid = fork();
+    if (pid == -1) errx(1, "ERROR: fork failed: %s", strerror(errno));
+    if (pid == 0) {
+      close(fds[0]);
+      if (lib_dir != nullptr) LoadLinkerRelocBenchLibs(*lib_dir);
+      for (int64_t i = 0; i < handlers; ++i) {
+        void** blocks = static_cast<void**>(malloc(kExitBlocksPerHandler * sizeof(void*)));
+        for (size_t j = 0; j < kExitBlocksPerHandler; ++j) {
+          blocks[j] = malloc(kExitBlockSize);
+          memset(blocks[j], 1, kExitBlockSize);
+        }
+        __cxa_atexit(FreeExitBlocks, blocks, nullptr);
+      }
+#if defined(__BIONIC__)
+      if (fast) android_set_fast_exit(true);
+#else
+      (void)fast;
+#endif
+      char c = 0;
+      write(fds[1], &c, 1);
+      exit(0);
+    }
+    close(fds[1]);
+    char c;
+    read(fds[0], &c, 1);
+    close(fds[0]);
+    state.ResumeTiming();
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) errx(1, "ERROR: child failed");
+  }
+}
+
+static void BM_stdlib_exit(benchmark::State& state) {
+  ExitLatency(state, false, state.range(0), nullptr);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_stdlib_exit, "EXIT_HANDLERS");
+
+#if defined(__BIONIC__)
+static void BM_stdlib_fast_exit(benchmark::State& state) {
+  ExitLatency(state, true, state.range(0), nullptr);
+}
+BIONIC_BENCHMARK_WITH_ARG(BM_stdlib_fast_exit, "EXIT_HANDLERS");
+#endif
+
+static void ExitLatencyWithLibs(benchmark::State& state, bool fast) {
+  std::string lib_dir = LinkerRelocBenchLibDir();
+  if (GetUpdateLdLibraryPath() == nullptr) {
+    state.SkipWithError("android_update_LD_LIBRARY_PATH isn't available");
+    return;
+  }
+  if (access(lib_dir.c_str(), F_OK) == -1) {
+    state.SkipWithError(("the linker-reloc-bench libraries aren't installed in " + lib_dir).c_str());
+    return;
+  }
+  ExitLatency(state, fast, 0, &lib_dir);
+}
+
+static void BM_stdlib_exit_dlopen(benchmark::State& state) {
+  ExitLatencyWithLibs(state, false);
+}
+BIONIC_BENCHMARK(BM_stdlib_exit_dlopen);
+
+#if defined(__BIONIC__)
+static void BM_stdlib_fast_exit_dlopen(benchmark::State& state) {
+  ExitLatencyWithLibs(state, true);
+}
+BIONIC_BENCHMARK(BM_stdlib_fast_exit_dlopen);
+#endif
@@ -45,6 +45,7 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <android/fdsan.h>
 #include <android/set_abort_message.h>
 #include <async_safe/log.h>
 
@@ -68,6 +69,26 @@ static int __socket(int domain, int type, int protocol) {
 #endif
 }
 
+static ssize_t __sendmsg(int fd, const msghdr* msg, int flags) {
+#if defined(__i386__)
+  unsigned long args[3] = {static_cast<unsigned long>(fd), reinterpret_cast<unsigned long>(msg),
+                           static_cast<unsigned long>(flags)};
+  return syscall(__NR_socketcall, SYS_SENDMSG, &args);
+#else
+  return syscall(__NR_sendmsg, fd, msg, flags);
+#endif
+}
+
+static int __sendmmsg(int fd, mmsghdr* msgs, unsigned int count, int flags) {
+#if defined(__i386__)
+  unsigned long args[4] = {static_cast<unsigned long>(fd), reinterpret_cast<unsigned long>(msgs),
+                           count, static_cast<unsigned long>(flags)};
+  return syscall(__NR_socketcall, SYS_SENDMMSG, &args);
+#else
+  return syscall(__NR_sendmmsg, fd, msgs, count, flags);
+#endif
+}
+
 // Must be kept in sync with frameworks/base/core/java/android/util/EventLog.java.
 enum AndroidEventLogType {
   EVENT_TYPE_INT = 0,
@@ -510,42 +531,258 @@ static int open_log_socket() {
   return log_fd;
 }
 
+// In libc's copy of this library, the socket to logd is opened on first use and then kept for
+// the life of the process, so that a message costs one system call rather than four. Opening it
+// is lock-free (threads racing to open it keep whichever socket was published first), so it's
+// still async signal safe. The socket is close-on-exec, and libc closes it in forked children, so
+// that a zygote's children don't inherit an fd they don't know about.
+//
+// The socket is owned with fdsan, so that code closing an fd it doesn't own is caught rather than
+// going on to have our log messages sent to whatever reuses the fd.
+//
+// Every other copy (the linker's, and those linked into other libraries) opens a socket for each
+// message and closes it again, as nothing would close a socket kept by any of them.
+static bool g_keep_log_socket = false;
+static int g_log_fd = -1;
+
+static uint64_t log_socket_tag() {
+  if (android_fdsan_create_owner_tag == nullptr) return 0;
+  return android_fdsan_create_owner_tag(ANDROID_FDSAN_OWNER_TYPE_GENERIC_00,
+                                        reinterpret_cast<uintptr_t>(&g_log_fd));
+}
+
+static void close_log_socket(int fd, uint64_t tag) {
+  if (tag != 0) android_fdsan_exchange_owner_tag(fd, tag, 0);
+  __close(fd);
+}
+
+// Returns a socket to logd, and sets `temporary` if it's the caller's to close with
+// release_log_socket rather than the one kept for the process.
+static int acquire_log_socket(bool* temporary) {
+  *temporary = !__atomic_load_n(&g_keep_log_socket, __ATOMIC_ACQUIRE);
+  if (*temporary) return open_log_socket();
+
+  uint64_t tag = log_socket_tag();
+  int fd = __atomic_load_n(&g_log_fd, __ATOMIC_ACQUIRE);
+  if (fd != -1) {
+    if (tag == 0 || android_fdsan_get_owner_tag(fd) == tag) return fd;
+    // Someone else closed our socket and the fd has been reused since. It's not ours to close.
+    __atomic_compare_exchange_n(&g_log_fd, &fd, -1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+  }
+
+  fd = open_log_socket();
+  if (fd == -1) return -1;
+  if (tag != 0) android_fdsan_exchange_owner_tag(fd, 0, tag);
+
+  int expected = -1;
+  if (!__atomic_compare_exchange_n(&g_log_fd, &expected, fd, false, __ATOMIC_ACQ_REL,
+                                   __ATOMIC_ACQUIRE)) {
+    close_log_socket(fd, tag);
+    return expected;
+  }
+  return fd;
+}
+
+static void release_log_socket(int fd, bool temporary) {
+  if (fd != -1 && temporary) __close(fd);
+}
+
+// Called when sending on the kept socket `fd` failed, to decide whether the message should be
+// retried with a new socket: either logd has restarted and our connection is dead, or the fd isn't
+// ours any more.
+static bool reset_log_socket(int fd) {
+  int expected = fd;
+  switch (errno) {
+    case ECONNREFUSED:
+    case ENOTCONN:
+      if (__atomic_compare_exchange_n(&g_log_fd, &expected, -1, false, __ATOMIC_ACQ_REL,
+                                      __ATOMIC_ACQUIRE)) {
+        close_log_socket(fd, log_socket_tag());
+      }
+      return true;
+    case EBADF:
+    case ENOTSOCK:
+      __atomic_compare_exchange_n(&g_log_fd, &expected, -1, false, __ATOMIC_ACQ_REL,
+                                  __ATOMIC_ACQUIRE);
+      return true;
+    default:
+      return false;
+  }
+}
+
+void async_safe_log_keep_socket(bool keep) {
+  __atomic_store_n(&g_keep_log_socket, keep, __ATOMIC_RELEASE);
+  if (!keep) async_safe_log_close();
+}
+
+void async_safe_log_close() {
+  int fd = __atomic_exchange_n(&g_log_fd, -1, __ATOMIC_ACQ_REL);
+  if (fd == -1) return;
+  uint64_t tag = log_socket_tag();
+  // If someone else has already closed our socket, the fd isn't ours to close.
+  if (tag != 0 && android_fdsan_get_owner_tag(fd) != tag) return;
+  close_log_socket(fd, tag);
+}
+
 struct log_time {  // Wire format
   uint32_t tv_sec;
   uint32_t tv_nsec;
 };
 
+// The header logd expects before the tag and message of each entry.
+struct LogHeader {
+  char log_id;
+  uint16_t tid;
+  log_time realtime;
+  char priority;
+
+  void Fill(iovec* vec) {
+    vec[0] = {&log_id, sizeof(log_id)};
+    vec[1] = {&tid, sizeof(tid)};
+    vec[2] = {&realtime, sizeof(realtime)};
+    vec[3] = {&priority, sizeof(priority)};
+  }
+};
+
+static log_time log_time_now() {
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return log_time{static_cast<uint32_t>(ts.tv_sec), static_cast<uint32_t>(ts.tv_nsec)};
+}
+
+static LogHeader make_log_header(int priority, log_time realtime) {
+  char log_id = (priority == ANDROID_LOG_FATAL) ? LOG_ID_CRASH : LOG_ID_MAIN;
+  return LogHeader{log_id, static_cast<uint16_t>(gettid()), realtime, static_cast<char>(priority)};
+}
+
 int async_safe_write_log(int priority, const char* tag, const char* msg) {
-  int main_log_fd = open_log_socket();
-  if (main_log_fd == -1) {
+  bool temporary;
+  int log_fd = acquire_log_socket(&temporary);
+  if (log_fd == -1) {
     // Try stderr instead.
     return write_stderr(tag, msg);
   }
 
+  LogHeader header = make_log_header(priority, log_time_now());
   iovec vec[6];
-  char log_id = (priority == ANDROID_LOG_FATAL) ? LOG_ID_CRASH : LOG_ID_MAIN;
-  vec[0].iov_base = &log_id;
-  vec[0].iov_len = sizeof(log_id);
-  uint16_t tid = gettid();
-  vec[1].iov_base = &tid;
-  vec[1].iov_len = sizeof(tid);
-  timespec ts;
-  clock_gettime(CLOCK_REALTIME, &ts);
-  log_time realtime_ts;
-  realtime_ts.tv_sec = ts.tv_sec;
-  realtime_ts.tv_nsec = ts.tv_nsec;
-  vec[2].iov_base = &realtime_ts;
-  vec[2].iov_len = sizeof(realtime_ts);
-
-  vec[3].iov_base = &priority;
-  vec[3].iov_len = 1;
+  header.Fill(vec);
   vec[4].iov_base = const_cast<char*>(tag);
   vec[4].iov_len = strlen(tag) + 1;
   vec[5].iov_base = const_cast<char*>(msg);
   vec[5].iov_len = strlen(msg) + 1;
 
-  int result = TEMP_FAILURE_RETRY(writev(main_log_fd, vec, sizeof(vec) / sizeof(vec[0])));
-  __close(main_log_fd);
+  msghdr mh = {};
+  mh.msg_iov = vec;
+  mh.msg_iovlen = sizeof(vec) / sizeof(vec[0]);
+  int result = TEMP_FAILURE_RETRY(__sendmsg(log_fd, &mh, MSG_NOSIGNAL));
+  if (result == -1 && !temporary && reset_log_socket(log_fd)) {
+    log_fd = acquire_log_socket(&temporary);
+    if (log_fd != -1) result = TEMP_FAILURE_RETRY(__sendmsg(log_fd, &mh, MSG_NOSIGNAL));
+  }
+  release_log_socket(log_fd, temporary);
+  return result;
+}
+
+void async_safe_log_batch_init(async_safe_log_batch* batch, int priority, const char* tag) {
+  batch->priority = priority;
+  batch->tag = tag;
+  batch->count = 0;
+  batch->used = 0;
+}
+
+// Makes the message already copied to the end of the batch's buffer an entry.
+static void batch_append(async_safe_log_batch* batch, size_t length) {
+  log_time now = log_time_now();
+  async_safe_log_batch_entry& entry = batch->entries[batch->count++];
+  entry.tv_sec = now.tv_sec;
+  entry.tv_nsec = now.tv_nsec;
+  entry.offset = batch->used;
+  entry.length = length;
+  batch->used += length + 1;
+}
+
+static bool batch_has_room(async_safe_log_batch* batch, size_t length) {
+  return batch->count < ASYNC_SAFE_LOG_BATCH_ENTRIES &&
+         length < sizeof(batch->buffer) - batch->used;
+}
+
+int async_safe_log_batch_format(async_safe_log_batch* batch, const char* format, ...) {
+  ErrnoRestorer errno_restorer;
+  va_list args;
+  va_start(args, format);
+  va_list retry_args;
+  va_copy(retry_args, args);
+
+  // Format straight into the batch, flushing and trying again if the message didn't fit.
+  // Messages longer than the whole buffer are truncated.
+  int length = 0;
+  if (batch->count < ASYNC_SAFE_LOG_BATCH_ENTRIES) {
+    length = async_safe_format_buffer_va_list(batch->buffer + batch->used,
+                                              sizeof(batch->buffer) - batch->used, format, args);
+  }
+  if (!batch_has_room(batch, length)) {
+    async_safe_log_batch_flush(batch);
+    length = async_safe_format_buffer_va_list(batch->buffer, sizeof(batch->buffer), format,
+                                              retry_args);
+    if (static_cast<size_t>(length) >= sizeof(batch->buffer)) length = sizeof(batch->buffer) - 1;
+  }
+  batch_append(batch, length);
+
+  va_end(retry_args);
+  va_end(args);
+  return length;
+}
+
+int async_safe_log_batch_write(async_safe_log_batch* batch, const char* msg) {
+  size_t length = strlen(msg);
+  if (!batch_has_room(batch, length)) {
+    async_safe_log_batch_flush(batch);
+    if (length >= sizeof(batch->buffer)) {
+      return async_safe_write_log(batch->priority, batch->tag, msg);
+    }
+  }
+  memcpy(batch->buffer + batch->used, msg, length + 1);
+  batch_append(batch, length);
+  return length;
+}
+
+int async_safe_log_batch_flush(async_safe_log_batch* batch) {
+  size_t count = batch->count;
+  batch->count = 0;
+  batch->used = 0;
+  if (count == 0) return 0;
+
+  bool temporary;
+  int log_fd = acquire_log_socket(&temporary);
+  if (log_fd == -1) {
+    for (size_t i = 0; i < count; ++i) {
+      write_stderr(batch->tag, batch->buffer + batch->entries[i].offset);
+    }
+    return count;
+  }
+
+  LogHeader headers[ASYNC_SAFE_LOG_BATCH_ENTRIES];
+  iovec vecs[ASYNC_SAFE_LOG_BATCH_ENTRIES][6];
+  mmsghdr msgs[ASYNC_SAFE_LOG_BATCH_ENTRIES] = {};
+  size_t tag_length = strlen(batch->tag) + 1;
+  for (size_t i = 0; i < count; ++i) {
+    const async_safe_log_batch_entry& entry = batch->entries[i];
+    headers[i] = make_log_header(batch->priority, log_time{entry.tv_sec, entry.tv_nsec});
+    headers[i].Fill(vecs[i]);
+    vecs[i][4] = {const_cast<char*>(batch->tag), tag_length};
+    vecs[i][5] = {batch->buffer + entry.offset, static_cast<size_t>(entry.length) + 1};
+    msgs[i].msg_hdr.msg_iov = vecs[i];
+    msgs[i].msg_hdr.msg_iovlen = 6;
+  }
+
+  // If logd can't keep up, sendmmsg stops early and the rest of the batch is dropped, just as
+  // individual messages would have been.
+  int result = TEMP_FAILURE_RETRY(__sendmmsg(log_fd, msgs, count, MSG_NOSIGNAL));
+  if (result == -1 && !temporary && reset_log_socket(log_fd)) {
+    log_fd = acquire_log_socket(&temporary);
+    if (log_fd != -1) result = TEMP_FAILURE_RETRY(__sendmmsg(log_fd, msgs, count, MSG_NOSIGNAL));
+  }
+  release_log_socket(log_fd, temporary);
   return result;
 }
 
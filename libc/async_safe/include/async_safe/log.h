@@ -30,6 +30,7 @@
 
 #include <sys/cdefs.h>
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -73,4 +74,47 @@ int async_safe_format_log(int priority, const char* tag, const char* fmt, ...) _
 int async_safe_format_log_va_list(int priority, const char* tag, const char* fmt, va_list ap);
 int async_safe_write_log(int priority, const char* tag, const char* msg);
 
+// By default the functions above open a socket to logd for each message. libc's copy of this
+// library keeps the socket open once it's used it instead (libc calls this at startup, and closes
+// the socket in forked children); other copies shouldn't, since nothing would close their socket.
+// Passing false closes the socket.
+void async_safe_log_keep_socket(bool keep);
+
+// Closes the socket kept by async_safe_log_keep_socket, for code about to close every fd it
+// doesn't know about (a daemon, say), which would otherwise trip fdsan; call it alongside liblog's
+// __android_log_close(). The next message opens a new socket. Async signal safe.
+void async_safe_log_close(void);
+
+//
+// Batched logging, for dumps that emit many lines in a row (leak reports, backtraces).
+// Each message is still a separate log entry with its own timestamp, but up to
+// ASYNC_SAFE_LOG_BATCH_ENTRIES of them are sent to the log with a single system call.
+// Messages are only guaranteed to have been sent after async_safe_log_batch_flush.
+// A batch is meant to live on the stack of the one thread using it.
+//
+
+#define ASYNC_SAFE_LOG_BATCH_ENTRIES 32
+#define ASYNC_SAFE_LOG_BATCH_BUFFER_SIZE 4096
+
+struct async_safe_log_batch_entry {
+  uint32_t tv_sec;
+  uint32_t tv_nsec;
+  uint16_t offset;
+  uint16_t length;
+};
+
+struct async_safe_log_batch {
+  int priority;
+  const char* tag;
+  size_t count;
+  size_t used;
+  struct async_safe_log_batch_entry entries[ASYNC_SAFE_LOG_BATCH_ENTRIES];
+  char buffer[ASYNC_SAFE_LOG_BATCH_BUFFER_SIZE];
+};
+
+void async_safe_log_batch_init(struct async_safe_log_batch* batch, int priority, const char* tag);
+int async_safe_log_batch_format(struct async_safe_log_batch* batch, const char* fmt, ...) __printflike(2, 3);
+int async_safe_log_batch_write(struct async_safe_log_batch* batch, const char* msg);
+int async_safe_log_batch_flush(struct async_safe_log_batch* batch);
+
 __END_DECLS
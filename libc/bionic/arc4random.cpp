@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
+#include <unistd.h>
+
+#include <async_safe/log.h>
+
+#include "private/bionic_arc4random.h"
+#include "pthread_internal.h"
+
+// arc4random(3) is the ChaCha20 keystream, keyed from getentropy(3), with the
+// same design as OpenBSD's implementation: the keystream is generated a buffer
+// at a time, the start of each buffer immediately becomes the next key (so a
+// later compromise of the state can't reveal earlier output), output is wiped
+// from the buffer as it's handed out, and fresh entropy is mixed in every
+// kReseedBytes. The difference is that each thread has its own state, in its
+// bionic_tls, so that there's no process-wide lock for threads to contend on.
+//
+// A fork child discards the forking thread's state (it's the only thread the
+// child has) from an atfork handler, so that it doesn't repeat the parent's
+// output. The children of clone() don't run the atfork handlers, so as a
+// fallback the state also records the pid it was seeded in, and is discarded
+// when getpid() no longer matches. That's a load of the cached pid rather
+// than a system call, and libc's clone() leaves its child without a cached
+// pid, so the child's getpid() asks the kernel and gets the mismatch. (A child
+// of the raw clone system call keeps its parent's cached pid, and so its
+// parent's getpid() too, which bionic has never supported.)
+
+static constexpr size_t kKeySize = 32;
+static constexpr size_t kNonceSize = 8;
+static constexpr size_t kBlockSize = 64;
+static constexpr size_t kReseedBytes = 1600000;
+
+static_assert(sizeof(arc4random_state_t::buf) % (4 * kBlockSize) == 0,
+              "keystream is generated four blocks at a time");
+
+// Four 32-bit lanes: the keystream is generated four blocks at a time, one
+// block per lane, which the compiler turns into NEON or SSE.
+typedef uint32_t u32x4 __attribute__((vector_size(16)));
+
+static inline u32x4 Rotl(u32x4 v, int n) {
+  return (v << n) | (v >> (32 - n));
+}
+
+static inline void QuarterRound(u32x4& a, u32x4& b, u32x4& c, u32x4& d) {
+  a += b; d = Rotl(d ^ a, 16);
+  c += d; b = Rotl(b ^ c, 12);
+  a += b; d = Rotl(d ^ a, 8);
+  c += d; b = Rotl(b ^ c, 7);
+}
+
+// Writes the next four blocks of keystream to `out`, and advances the
+// 64-bit block counter in words 12 and 13 past them.
+static void ChaCha20x4(uint32_t input[16], uint8_t* out) {
+  u32x4 x[16];
+  u32x4 orig[16];
+  for (size_t i = 0; i < 16; ++i) {
+    x[i] = u32x4{input[i], input[i], input[i], input[i]};
+  }
+  uint64_t counter = input[12] | (static_cast<uint64_t>(input[13]) << 32);
+  for (size_t lane = 0; lane < 4; ++lane) {
+    x[12][lane] = static_cast<uint32_t>(counter + lane);
+    x[13][lane] = static_cast<uint32_t>((counter + lane) >> 32);
+  }
+  memcpy(orig, x, sizeof(x));
+
+  for (size_t i = 0; i < 10; ++i) {
+    QuarterRound(x[0], x[4], x[8], x[12]);
+    QuarterRound(x[1], x[5], x[9], x[13]);
+    QuarterRound(x[2], x[6], x[10], x[14]);
+    QuarterRound(x[3], x[7], x[11], x[15]);
+    QuarterRound(x[0], x[5], x[10], x[15]);
+    QuarterRound(x[1], x[6], x[11], x[12]);
+    QuarterRound(x[2], x[7], x[8], x[13]);
+    QuarterRound(x[3], x[4], x[9], x[14]);
+  }
+
+  // All of bionic's architectures are little-endian, which is the byte order
+  // ChaCha20 specifies.
+  for (size_t i = 0; i < 16; ++i) {
+    x[i] += orig[i];
+    for (size_t lane = 0; lane < 4; ++lane) {
+      uint32_t word = x[i][lane];
+      memcpy(out + lane * kBlockSize + i * sizeof(word), &word, sizeof(word));
+    }
+  }
+
+  counter += 4;
+  input[12] = static_cast<uint32_t>(counter);
+  input[13] = static_cast<uint32_t>(counter >> 32);
+}
+
+static void KeySetup(arc4random_state_t* st, const uint8_t* seed) {
+  // "expand 32-byte k"
+  st->input[0] = 0x61707865;
+  st->input[1] = 0x3320646e;
+  st->input[2] = 0x79622d32;
+  st->input[3] = 0x6b206574;
+  memcpy(&st->input[4], seed, kKeySize);
+  st->input[12] = 0;
+  st->input[13] = 0;
+  memcpy(&st->input[14], seed + kKeySize, kNonceSize);
+}
+
+// Refills the keystream buffer and immediately rekeys from its start, mixing
+// in `extra` (if any) first.
+static void Rekey(arc4random_state_t* st, const uint8_t* extra, size_t extra_len) {
+  for (size_t i = 0; i < sizeof(st->buf); i += 4 * kBlockSize) {
+    ChaCha20x4(st->input, st->buf + i);
+  }
+  for (size_t i = 0; i < extra_len && i < kKeySize + kNonceSize; ++i) {
+    st->buf[i] ^= extra[i];
+  }
+  KeySetup(st, st->buf);
+  memset(st->buf, 0, kKeySize + kNonceSize);
+  st->have = sizeof(st->buf) - kKeySize - kNonceSize;
+}
+
+static void Stir(arc4random_state_t* st) {
+  uint8_t rnd[kKeySize + kNonceSize];
+  if (getentropy(rnd, sizeof(rnd)) == -1) {
+    async_safe_fatal("getentropy failed: %s", strerror(errno));
+  }
+
+  if (st->pid == 0) {
+    KeySetup(st, rnd);
+    st->pid = getpid();
+  } else {
+    Rekey(st, rnd, sizeof(rnd));
+  }
+  explicit_bzero(rnd, sizeof(rnd));
+
+  // Discard any keystream generated from the old key.
+  st->have = 0;
+  memset(st->buf, 0, sizeof(st->buf));
+  st->count = kReseedBytes;
+}
+
+static arc4random_state_t* GetState(size_t len) {
+  arc4random_state_t* st = &__get_bionic_tls().arc4random_state;
+  if (__predict_false(st->pid != 0 && st->pid != getpid())) {
+    // A clone() child that didn't run the atfork handler.
+    explicit_bzero(st, sizeof(*st));
+  }
+  if (st->pid == 0 || st->count <= len) Stir(st);
+  st->count = (st->count <= len) ? 0 : st->count - len;
+  return st;
+}
+
+uint32_t arc4random() {
+  arc4random_state_t* st = GetState(sizeof(uint32_t));
+  if (st->have < sizeof(uint32_t)) Rekey(st, nullptr, 0);
+
+  // Claim the bytes before copying them out, so that even a signal handler
+  // that interrupts us here can't be handed the same ones.
+  st->have -= sizeof(uint32_t);
+  uint8_t* keystream = st->buf + sizeof(st->buf) - st->have - sizeof(uint32_t);
+  uint32_t result;
+  memcpy(&result, keystream, sizeof(result));
+  memset(keystream, 0, sizeof(result));
+  return result;
+}
+
+void arc4random_buf(void* buf, size_t n) {
+  arc4random_state_t* st = GetState(n);
+  uint8_t* out = static_cast<uint8_t*>(buf);
+  while (n > 0) {
+    if (st->have == 0) Rekey(st, nullptr, 0);
+    size_t m = (n < st->have) ? n : st->have;
+    st->have -= m;
+    uint8_t* keystream = st->buf + sizeof(st->buf) - st->have - m;
+    memcpy(out, keystream, m);
+    memset(keystream, 0, m);
+    out += m;
+    n -= m;
+  }
+}
+
+void __libc_arc4random_fork_child() {
+  arc4random_state_t* st = &__get_bionic_tls().arc4random_state;
+  explicit_bzero(st, sizeof(*st));
+}
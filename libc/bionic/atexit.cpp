@@ -36,6 +36,7 @@
 #include <sys/mman.h>
 #include <sys/param.h>
 #include <sys/prctl.h>
+#include <unistd.h>
 
 #include <async_safe/CHECK.h>
 #include <async_safe/log.h>
@@ -63,6 +64,9 @@ class AtexitArray {
   AtexitEntry extract_entry(size_t idx);
   void recompact();
 
+  void begin_batch();
+  void end_batch();
+
  private:
   AtexitEntry* array_;
   size_t size_;
@@ -73,6 +77,15 @@ class AtexitArray {
   // restart concurrent __cxa_finalize passes.
   uint64_t total_appends_;
 
+  // While a batch is open, appends by the thread that opened it (the one running constructors)
+  // leave the pages they write to writable, rather than write-protecting them again after every
+  // entry. Those pages, [writable_start_, writable_end_), are write-protected when the batch
+  // ends, or before anything else modifies the array, including an append by any other thread.
+  size_t batch_depth_;
+  pid_t batch_tid_;
+  size_t writable_start_;
+  size_t writable_end_;
+
   static size_t page_start_of_index(size_t idx) { return PAGE_START(idx * sizeof(AtexitEntry)); }
   static size_t page_end_of_index(size_t idx) { return PAGE_END(idx * sizeof(AtexitEntry)); }
 
@@ -82,6 +95,9 @@ class AtexitArray {
   }
 
   void set_writable(bool writable, size_t start_idx, size_t num_entries);
+  void set_writable_bytes(bool writable, size_t start_byte, size_t stop_byte);
+  void extend_writable_window(size_t idx);
+  void close_writable_window();
   static bool next_capacity(size_t capacity, size_t* result);
   bool expand_capacity();
 };
@@ -93,6 +109,14 @@ bool AtexitArray::append_entry(const AtexitEntry& entry) {
 
   size_t idx = size_++;
 
+  if (batch_depth_ > 0 && batch_tid_ == gettid()) {
+    extend_writable_window(idx);
+    array_[idx] = entry;
+    ++total_appends_;
+    return true;
+  }
+
+  close_writable_window();
   set_writable(true, idx, 1);
   array_[idx] = entry;
   ++total_appends_;
@@ -101,8 +125,42 @@ bool AtexitArray::append_entry(const AtexitEntry& entry) {
   return true;
 }
 
+void AtexitArray::begin_batch() {
+  // The loader runs constructors with its lock held, so batches on different threads don't
+  // overlap; if one did, only the first thread's appends would be batched.
+  if (batch_depth_++ == 0) batch_tid_ = gettid();
+}
+
+void AtexitArray::end_batch() {
+  if (batch_depth_ == 0) return;
+  if (--batch_depth_ == 0) close_writable_window();
+}
+
+// Appends are sequential, so the window only ever grows at the end: it covers just the pages
+// appended to since the batch began.
+void AtexitArray::extend_writable_window(size_t idx) {
+  const size_t start_byte = page_start_of_index(idx);
+  const size_t stop_byte = page_end_of_index(idx + 1);
+  if (writable_start_ == writable_end_) {
+    set_writable_bytes(true, start_byte, stop_byte);
+    writable_start_ = start_byte;
+    writable_end_ = stop_byte;
+  } else if (stop_byte > writable_end_) {
+    set_writable_bytes(true, writable_end_, stop_byte);
+    writable_end_ = stop_byte;
+  }
+}
+
+void AtexitArray::close_writable_window() {
+  if (writable_start_ == writable_end_) return;
+  set_writable_bytes(false, writable_start_, writable_end_);
+  writable_start_ = writable_end_ = 0;
+}
+
 // Extract an entry and return it.
 AtexitEntry AtexitArray::extract_entry(size_t idx) {
+  close_writable_window();
+
   AtexitEntry result = array_[idx];
 
   set_writable(true, idx, 1);
@@ -116,6 +174,7 @@ AtexitEntry AtexitArray::extract_entry(size_t idx) {
 void AtexitArray::recompact() {
   if (!needs_recompaction()) return;
 
+  close_writable_window();
   set_writable(true, 0, size_);
 
   // Optimization: quickly skip over the initial non-null entries.
@@ -150,10 +209,13 @@ void AtexitArray::recompact() {
 // Use mprotect to make the array writable or read-only. Returns true on success. Making the array
 // read-only could protect against either unintentional or malicious corruption of the array.
 void AtexitArray::set_writable(bool writable, size_t start_idx, size_t num_entries) {
+  set_writable_bytes(writable, page_start_of_index(start_idx),
+                     page_end_of_index(start_idx + num_entries));
+}
+
+void AtexitArray::set_writable_bytes(bool writable, size_t start_byte, size_t stop_byte) {
   if (array_ == nullptr) return;
 
-  const size_t start_byte = page_start_of_index(start_idx);
-  const size_t stop_byte = page_end_of_index(start_idx + num_entries);
   const size_t byte_len = stop_byte - start_byte;
 
   const int prot = PROT_READ | (writable ? PROT_WRITE : 0);
@@ -184,6 +246,7 @@ bool AtexitArray::expand_capacity() {
   if (!next_capacity(capacity_, &new_capacity)) return false;
   const size_t new_capacity_bytes = page_end_of_index(new_capacity);
 
+  close_writable_window();
   set_writable(true, 0, capacity_);
 
   bool result = false;
@@ -241,6 +304,18 @@ int __cxa_atexit(void (*func)(void*), void* arg, void* dso) {
   return result;
 }
 
+void __libc_atexit_batch_begin() {
+  atexit_lock();
+  g_array.begin_batch();
+  atexit_unlock();
+}
+
+void __libc_atexit_batch_end() {
+  atexit_lock();
+  g_array.end_batch();
+  atexit_unlock();
+}
+
 void __cxa_finalize(void* dso) {
   atexit_lock();
 
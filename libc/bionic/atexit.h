@@ -39,4 +39,11 @@ __BEGIN_DECLS
 int __cxa_atexit(void (*)(void*), void*, void*);
 void __cxa_finalize(void*);
 
+// Between these calls, __cxa_atexit calls on the same thread leave the pages of the handler array
+// that they write to writable, and write-protect them all at the end, rather than making two
+// mprotect calls per handler. Other threads' calls write-protect the array as usual. The loader
+// brackets each library's constructors with them. Calls can nest.
+__LIBC_HIDDEN__ void __libc_atexit_batch_begin();
+__LIBC_HIDDEN__ void __libc_atexit_batch_end();
+
 __END_DECLS
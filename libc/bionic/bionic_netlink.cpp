@@ -92,3 +92,45 @@ bool NetlinkConnection::ReadResponses(void callback(void*, nlmsghdr*), void* con
   // We only get here if recv fails before we see a NLMSG_DONE.
   return false;
 }
+
+bool NetlinkMonitor::Open(uint32_t groups) {
+  Close();
+  fd_ = socket(PF_NETLINK, SOCK_RAW | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_ROUTE);
+  if (fd_ == -1) return false;
+
+  sockaddr_nl addr = {};
+  addr.nl_family = AF_NETLINK;
+  addr.nl_groups = groups;
+  if (bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void NetlinkMonitor::Close() {
+  if (fd_ != -1) {
+    ErrnoRestorer errno_restorer;
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+bool NetlinkMonitor::Drain() {
+  ErrnoRestorer errno_restorer;
+
+  // We only care whether anything happened, so truncate each message to its header.
+  bool changed = false;
+  char buf[sizeof(nlmsghdr)];
+  while (true) {
+    ssize_t bytes_read = TEMP_FAILURE_RETRY(recv(fd_, buf, sizeof(buf), MSG_TRUNC));
+    if (bytes_read >= 0) {
+      changed = true;
+    } else if (errno == ENOBUFS) {
+      // Notifications were dropped, so we can't know what changed.
+      changed = true;
+    } else {
+      return changed;
+    }
+  }
+}
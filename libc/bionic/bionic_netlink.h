@@ -50,3 +50,21 @@ class NetlinkConnection {
   char* data_;
   size_t size_;
 };
+
+// A netlink socket subscribed to multicast groups, for finding out that something has changed
+// without asking for a dump. This is meant to be a global, so it has no destructor: call Close.
+class NetlinkMonitor {
+ public:
+  constexpr NetlinkMonitor() {}
+
+  // `groups` is a mask of RTMGRP_* values.
+  bool Open(uint32_t groups);
+  void Close();
+
+  // Reads and discards any pending notifications. Returns true if there were any, or if some
+  // were lost because the socket's buffer overflowed.
+  bool Drain();
+
+ private:
+  int fd_ = -1;
+};
@@ -16,9 +16,15 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/uio.h>
+#include <time.h>
 
 #include "bionic/pthread_internal.h"
 #include "private/bionic_lock.h"
@@ -32,17 +38,217 @@
 #define WRITE_OFFSET   32
 
 static Lock g_lock;
-static CachedProperty g_debug_atrace_tags_enableflags("debug.atrace.tags.enableflags");
-static uint64_t g_tags;
 static int g_trace_marker_fd = -1;
 
+// debug.atrace.tags.enableflags is checked before every event, from every thread, so it's done
+// without g_lock. The property is re-read only when its serial changes, and what we need from
+// it is kept in one word, so that threads racing to update it can't pair a stale value with a
+// newer serial: the property serial shifted left by one, with the bionic tag in the low bit.
+static constexpr const char* kTagsProperty = "debug.atrace.tags.enableflags";
+static _Atomic(const prop_info*) g_tags_prop_info;
+static _Atomic(uint32_t) g_tags_area_serial;
+static _Atomic(uint64_t) g_tags_state;
+
+static void read_tags_callback(void*, const char*, const char* value, uint32_t serial) {
+  bool enabled = (strtoull(value, nullptr, 0) & ATRACE_TAG_BIONIC) != 0;
+  atomic_store_explicit(&g_tags_state, (static_cast<uint64_t>(serial) << 1) | enabled,
+                        memory_order_relaxed);
+}
+
 static bool should_trace() {
+  const prop_info* pi = atomic_load_explicit(&g_tags_prop_info, memory_order_acquire);
+  if (__predict_false(pi == nullptr)) {
+    // `__system_property_find` is expensive, so only retry if a property
+    // has been created since last time we checked.
+    uint32_t area_serial = __system_property_area_serial();
+    if (atomic_exchange_explicit(&g_tags_area_serial, area_serial, memory_order_relaxed) ==
+        area_serial) {
+      return false;
+    }
+    pi = __system_property_find(kTagsProperty);
+    if (pi == nullptr) {
+      return false;
+    }
+    atomic_store_explicit(&g_tags_prop_info, pi, memory_order_release);
+  }
+
+  uint64_t state = atomic_load_explicit(&g_tags_state, memory_order_relaxed);
+  if (__predict_false(__system_property_serial(pi) != (state >> 1))) {
+    __system_property_read_callback(pi, read_tags_callback, nullptr);
+    state = atomic_load_explicit(&g_tags_state, memory_order_relaxed);
+  }
+  return (state & 1) != 0;
+}
+
+// Buffered tracing.
+//
+// Writing each event to trace_marker costs a system call, which is enough to distort measurements
+// of what's being traced (process startup and dlopen in particular). If the
+// libc.debug.systrace.dir property names a directory when a process first traces an event, that
+// process instead records its events in a per-thread buffer, without system calls or locks, and
+// appends each buffer to <dir>/bionic_trace.<pid> when it fills up, when the thread exits, and
+// when the process calls exit. Events still buffered by other threads when the process exits
+// are lost. ftrace timestamps events when they're written, so these can't go to trace_marker in
+// batches; libc/tools/bionic_trace_to_json.py converts the files to JSON for Perfetto's UI instead.
+// Either way, events are only recorded while the bionic atrace tag is enabled.
+//
+// The file is a sequence of blocks in native byte order, each starting with a four byte magic:
+//   "BTRH" u32 version, u32 pid, u32 clock id
+//     A header, written each time the file is opened (by the linker and libc separately).
+//   "BTRC" u32 tid, u32 size, then `size` bytes of events
+//     A thread's buffer.
+// Each event is a u64 timestamp in nanoseconds, a u8 type ('B' or 'E'), a u8 length, and
+// `length` bytes of message without a terminator ('E' events have no message).
+
+enum TraceMode {
+  kTraceModeUnknown,
+  kTraceModeMarker,
+  kTraceModeBuffered,
+};
+
+static constexpr uint32_t kTraceFileVersion = 1;
+static constexpr size_t kTraceEventHeaderSize = sizeof(uint64_t) + 2;
+static constexpr size_t kTraceMaxMessageLength = 255;
+static constexpr size_t kTraceBufferSize = 16 * 1024;
+
+struct bionic_trace_buffer {
+  pid_t tid;
+  uint32_t used;
+  char data[kTraceBufferSize - sizeof(pid_t) - sizeof(uint32_t)];
+};
+static_assert(sizeof(bionic_trace_buffer) == kTraceBufferSize);
+
+static atomic_int g_trace_mode = kTraceModeUnknown;
+static CachedProperty g_libc_debug_systrace_dir("libc.debug.systrace.dir");
+static char g_trace_dir[PROP_VALUE_MAX];
+// Set under g_lock, but read without it by threads flushing their buffers.
+static _Atomic(int) g_trace_file_fd = -1;
+static _Atomic(pid_t) g_trace_file_pid;
+
+static TraceMode get_trace_mode() {
+  int mode = atomic_load_explicit(&g_trace_mode, memory_order_acquire);
+  if (__predict_true(mode != kTraceModeUnknown)) {
+    return static_cast<TraceMode>(mode);
+  }
+
+  // The mode is chosen once, so that a process doesn't switch halfway through a trace.
   g_lock.lock();
-  if (g_debug_atrace_tags_enableflags.DidChange()) {
-    g_tags = strtoull(g_debug_atrace_tags_enableflags.Get(), nullptr, 0);
+  mode = atomic_load_explicit(&g_trace_mode, memory_order_relaxed);
+  if (mode == kTraceModeUnknown) {
+    strlcpy(g_trace_dir, g_libc_debug_systrace_dir.Get(), sizeof(g_trace_dir));
+    mode = (g_trace_dir[0] != '\0') ? kTraceModeBuffered : kTraceModeMarker;
+    atomic_store_explicit(&g_trace_mode, mode, memory_order_release);
   }
   g_lock.unlock();
-  return ((g_tags & ATRACE_TAG_BIONIC) != 0);
+  return static_cast<TraceMode>(mode);
+}
+
+static int get_trace_file_fd() {
+  int fd = atomic_load_explicit(&g_trace_file_fd, memory_order_acquire);
+  if (__predict_true(fd != -1 &&
+                     atomic_load_explicit(&g_trace_file_pid, memory_order_relaxed) == getpid())) {
+    return fd;
+  }
+
+  g_lock.lock();
+  fd = atomic_load_explicit(&g_trace_file_fd, memory_order_relaxed);
+  // A forked child gets a file of its own.
+  if (fd != -1 && atomic_load_explicit(&g_trace_file_pid, memory_order_relaxed) != getpid()) {
+    close(fd);
+    fd = -1;
+  }
+  if (fd == -1) {
+    char path[PATH_MAX];
+    async_safe_format_buffer(path, sizeof(path), "%s/bionic_trace.%d", g_trace_dir, getpid());
+    fd = open(path, O_CLOEXEC | O_WRONLY | O_CREAT | O_APPEND, 0600);
+    if (fd != -1) {
+      struct {
+        char magic[4];
+        uint32_t version;
+        uint32_t pid;
+        uint32_t clock_id;
+      } header = {{'B', 'T', 'R', 'H'}, kTraceFileVersion, static_cast<uint32_t>(getpid()),
+                  CLOCK_MONOTONIC};
+      TEMP_FAILURE_RETRY(write(fd, &header, sizeof(header)));
+      atomic_store_explicit(&g_trace_file_pid, getpid(), memory_order_relaxed);
+    }
+    atomic_store_explicit(&g_trace_file_fd, fd, memory_order_release);
+  }
+  g_lock.unlock();
+  return fd;
+}
+
+static void flush_trace_buffer(bionic_trace_buffer* buffer) {
+  if (buffer->used == 0) {
+    return;
+  }
+
+  int fd = get_trace_file_fd();
+  if (fd != -1) {
+    struct {
+      char magic[4];
+      uint32_t tid;
+      uint32_t size;
+    } chunk = {{'B', 'T', 'R', 'C'}, static_cast<uint32_t>(buffer->tid),
+               buffer->used};
+    iovec vec[2] = {{&chunk, sizeof(chunk)}, {buffer->data, buffer->used}};
+    // With O_APPEND, each thread's chunk lands in the file in one piece.
+    TEMP_FAILURE_RETRY(writev(fd, vec, 2));
+  }
+  buffer->used = 0;
+}
+
+static bionic_trace_buffer* get_trace_buffer(bionic_tls& tls) {
+  pthread_internal_t* thread = __get_thread();
+  // A vforked child shares its parent's memory, including the parent thread's buffer.
+  if (thread->is_vforked()) {
+    return nullptr;
+  }
+
+  bionic_trace_buffer* buffer = tls.trace_buffer;
+  if (buffer == nullptr) {
+    void* map = mmap(nullptr, sizeof(bionic_trace_buffer), PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+      return nullptr;
+    }
+    prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, map, sizeof(bionic_trace_buffer),
+          "bionic trace buffer");
+    buffer = static_cast<bionic_trace_buffer*>(map);
+    buffer->tid = thread->tid;
+    tls.trace_buffer = buffer;
+  } else if (buffer->tid != thread->tid) {
+    // This is a forked child, and anything in the buffer is the parent's to write out.
+    buffer->tid = thread->tid;
+    buffer->used = 0;
+  }
+  return buffer;
+}
+
+static void trace_record(bionic_tls& tls, char type, const char* message) {
+  bionic_trace_buffer* buffer = get_trace_buffer(tls);
+  if (buffer == nullptr) {
+    return;
+  }
+
+  size_t length = (message != nullptr) ? strnlen(message, kTraceMaxMessageLength) : 0;
+  size_t size = kTraceEventHeaderSize + length;
+  if (buffer->used + size > sizeof(buffer->data)) {
+    flush_trace_buffer(buffer);
+  }
+
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  uint64_t timestamp_ns = static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+
+  char* p = buffer->data + buffer->used;
+  memcpy(p, &timestamp_ns, sizeof(timestamp_ns));
+  p[sizeof(timestamp_ns)] = type;
+  p[sizeof(timestamp_ns) + 1] = static_cast<char>(length);
+  if (length != 0) {
+    memcpy(p + kTraceEventHeaderSize, message, length);
+  }
+  buffer->used += size;
 }
 
 static int get_trace_marker_fd() {
@@ -57,11 +263,16 @@ static int get_trace_marker_fd() {
   return g_trace_marker_fd;
 }
 
-static void trace_begin_internal(const char* message) {
+static void trace_begin_internal(bionic_tls& tls, const char* message) {
   if (!should_trace()) {
     return;
   }
 
+  if (get_trace_mode() == kTraceModeBuffered) {
+    trace_record(tls, 'B', message);
+    return;
+  }
+
   int trace_marker_fd = get_trace_marker_fd();
   if (trace_marker_fd == -1) {
     return;
@@ -88,16 +299,21 @@ void bionic_trace_begin(const char* message) {
   }
   tls.bionic_systrace_disabled = true;
 
-  trace_begin_internal(message);
+  trace_begin_internal(tls, message);
 
   tls.bionic_systrace_disabled = false;
 }
 
-static void trace_end_internal() {
+static void trace_end_internal(bionic_tls& tls) {
   if (!should_trace()) {
     return;
   }
 
+  if (get_trace_mode() == kTraceModeBuffered) {
+    trace_record(tls, 'E', nullptr);
+    return;
+  }
+
   int trace_marker_fd = get_trace_marker_fd();
   if (trace_marker_fd == -1) {
     return;
@@ -130,11 +346,35 @@ void bionic_trace_end() {
   }
   tls.bionic_systrace_disabled = true;
 
-  trace_end_internal();
+  trace_end_internal(tls);
 
   tls.bionic_systrace_disabled = false;
 }
 
+void bionic_trace_flush() {
+  bionic_tls& tls = __get_bionic_tls();
+  if (tls.trace_buffer == nullptr || tls.bionic_systrace_disabled) {
+    return;
+  }
+  tls.bionic_systrace_disabled = true;
+
+  if (!__get_thread()->is_vforked()) {
+    flush_trace_buffer(tls.trace_buffer);
+  }
+
+  tls.bionic_systrace_disabled = false;
+}
+
+void bionic_trace_thread_exit() {
+  bionic_trace_flush();
+
+  bionic_tls& tls = __get_bionic_tls();
+  if (tls.trace_buffer != nullptr) {
+    munmap(tls.trace_buffer, sizeof(bionic_trace_buffer));
+    tls.trace_buffer = nullptr;
+  }
+}
+
 ScopedTrace::ScopedTrace(const char* message) : called_end_(false) {
   bionic_trace_begin(message);
 }
@@ -0,0 +1,307 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "platform/bionic/cpu_topology.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sysinfo.h>
+#include <unistd.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+#include "private/ErrnoRestorer.h"
+#include "private/bionic_cpu_topology.h"
+#include "private/bionic_lock.h"
+
+// Reads a small sysfs file into `buf`, NUL-terminated.
+static bool ReadSysfs(const char* path, char* buf, size_t size) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) return false;
+  ssize_t n = TEMP_FAILURE_RETRY(read(fd, buf, size - 1));
+  close(fd);
+  if (n <= 0) return false;
+  buf[n] = '\0';
+  return true;
+}
+
+// Reads the number at the start of a sysfs file, allowing the K and M suffixes that cache sizes
+// use. Lists like "0 1 2 3" give their first number.
+static bool ReadSysfsLong(const char* path, long* result) {
+  char buf[32];
+  if (!ReadSysfs(path, buf, sizeof(buf))) return false;
+  char* end;
+  long value = strtol(buf, &end, 10);
+  if (end == buf) return false;
+  if (*end == 'K') {
+    value *= 1024;
+  } else if (*end == 'M') {
+    value *= 1024 * 1024;
+  }
+  *result = value;
+  return true;
+}
+
+//
+// Cache geometry, for sysconf.
+//
+
+struct CacheGeometry {
+  long size;
+  long assoc;
+  long line_size;
+};
+
+// L1I, L1D, L2, L3, and L4, in the order of the _SC_LEVEL*_CACHE_* constants.
+static CacheGeometry g_caches[5];
+static pthread_once_t g_caches_once = PTHREAD_ONCE_INIT;
+
+static void SetCache(long level, char type, long size, long assoc, long line_size) {
+  if (level < 1 || level > 4) return;
+  CacheGeometry geometry = {size, assoc, line_size};
+  if (level > 1) {
+    g_caches[level] = geometry;
+    return;
+  }
+  // A unified L1 is reported as both the instruction and the data cache.
+  if (type != 'D') g_caches[0] = geometry;
+  if (type != 'I') g_caches[1] = geometry;
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+// Intel's "deterministic cache parameters" leaf, which AMD also has (as an extended leaf) on CPUs
+// with TOPOEXT.
+static bool ReadCachesFromCpuid() {
+  unsigned eax, ebx, ecx, edx;
+  unsigned vendor;
+  unsigned max_leaf = __get_cpuid_max(0, &vendor);
+  unsigned leaf = 0;
+  if (vendor == signature_INTEL_ebx && max_leaf >= 4) {
+    leaf = 4;
+  } else if (vendor == signature_AMD_ebx && __get_cpuid_max(0x80000000, nullptr) >= 0x8000001d) {
+    __cpuid(0x80000001, eax, ebx, ecx, edx);
+    if ((ecx & (1 << 22)) != 0) leaf = 0x8000001d;
+  }
+  if (leaf == 0) return false;
+
+  bool found = false;
+  for (unsigned i = 0; i < 16; ++i) {
+    __cpuid_count(leaf, i, eax, ebx, ecx, edx);
+    unsigned type = eax & 0x1f;
+    if (type == 0) break;
+    long level = (eax >> 5) & 0x7;
+    long line_size = (ebx & 0xfff) + 1;
+    long partitions = ((ebx >> 12) & 0x3ff) + 1;
+    long ways = ((ebx >> 22) & 0x3ff) + 1;
+    long sets = static_cast<long>(ecx) + 1;
+    SetCache(level, (type == 1) ? 'D' : (type == 2) ? 'I' : 'U', ways * partitions * line_size * sets,
+             ways, line_size);
+    found = true;
+  }
+  return found;
+}
+#endif
+
+// The kernel's cacheinfo, from the device tree or ACPI PPTT. This describes CPU 0, which on a
+// big.LITTLE system is one of the little cores.
+static void ReadCachesFromSysfs() {
+  for (int i = 0; i < 16; ++i) {
+    char path[80];
+    long level;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", i);
+    if (!ReadSysfsLong(path, &level)) break;
+
+    char type[16] = "Unified";
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", i);
+    ReadSysfs(path, type, sizeof(type));
+
+    long size = 0;
+    long assoc = 0;
+    long line_size = 0;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", i);
+    ReadSysfsLong(path, &size);
+    snprintf(path, sizeof(path),
+             "/sys/devices/system/cpu/cpu0/cache/index%d/ways_of_associativity", i);
+    ReadSysfsLong(path, &assoc);
+    snprintf(path, sizeof(path),
+             "/sys/devices/system/cpu/cpu0/cache/index%d/coherency_line_size", i);
+    ReadSysfsLong(path, &line_size);
+
+    SetCache(level, type[0], size, assoc, line_size);
+  }
+}
+
+static void InitCaches() {
+  ErrnoRestorer errno_restorer;
+#if defined(__i386__) || defined(__x86_64__)
+  if (ReadCachesFromCpuid()) return;
+#endif
+  ReadCachesFromSysfs();
+#if defined(__aarch64__)
+  // Plenty of devices don't describe their caches to the kernel, but the L1 line sizes are always
+  // available from CTR_EL0 (which the kernel lets us read, or emulates).
+  uint64_t ctr;
+  __asm__ __volatile__("mrs %0, ctr_el0" : "=r"(ctr));
+  if (g_caches[0].line_size == 0) g_caches[0].line_size = 4 << (ctr & 0xf);
+  if (g_caches[1].line_size == 0) g_caches[1].line_size = 4 << ((ctr >> 16) & 0xf);
+#endif
+}
+
+long __sysconf_cache(int name) {
+  pthread_once(&g_caches_once, InitCaches);
+  int i = name - _SC_LEVEL1_ICACHE_SIZE;
+  const CacheGeometry& cache = g_caches[i / 3];
+  switch (i % 3) {
+    case 0: return cache.size;
+    case 1: return cache.assoc;
+    default: return cache.line_size;
+  }
+}
+
+//
+// CPU clusters.
+//
+
+static constexpr size_t kMaxClusters = 16;
+
+static Lock g_clusters_lock;
+static bool g_clusters_valid;
+static size_t g_cluster_count;
+static android_cpu_cluster g_clusters[kMaxClusters];
+
+// The highest CPU number in the kernel's `possible` mask, a list like "0-3,6-7". CPU numbers
+// needn't be contiguous, so counting the cpuN directories isn't enough.
+static int LastPossibleCpu() {
+  char buf[256];
+  if (!ReadSysfs("/sys/devices/system/cpu/possible", buf, sizeof(buf))) {
+    return get_nprocs_conf() - 1;
+  }
+  int last_cpu = -1;
+  for (char* p = buf; *p != '\0';) {
+    if (*p >= '0' && *p <= '9') {
+      long cpu = strtol(p, &p, 10);
+      if (cpu > last_cpu) last_cpu = static_cast<int>(cpu);
+    } else {
+      ++p;
+    }
+  }
+  return last_cpu;
+}
+
+static void ReadClusters() {
+  // The first CPU of each cluster, and of its frequency domain (or -1 if unknown).
+  int first_cpu[kMaxClusters];
+  long domain[kMaxClusters];
+
+  // Not CPU_SETSIZE, which is only 32 on LP32: CPUs past the end of `cpus` still count.
+  int last_cpu = LastPossibleCpu();
+  g_cluster_count = 0;
+  for (int cpu = 0; cpu <= last_cpu; ++cpu) {
+    char path[80];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    // Gaps in the numbering are skipped, not taken as the end.
+    if (access(path, F_OK) == -1) continue;
+
+    long capacity = 0;
+    long max_freq_khz = 0;
+    long cpu_domain = -1;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpu_capacity", cpu);
+    ReadSysfsLong(path, &capacity);
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", cpu);
+    ReadSysfsLong(path, &max_freq_khz);
+    // Older kernels remove an offline CPU's cpufreq directory, so an unknown frequency domain
+    // matches any cluster with the same capacity.
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/related_cpus", cpu);
+    ReadSysfsLong(path, &cpu_domain);
+
+    size_t i = 0;
+    while (i < g_cluster_count &&
+           (g_clusters[i].capacity != static_cast<uint32_t>(capacity) ||
+            (cpu_domain != -1 && domain[i] != -1 && domain[i] != cpu_domain))) {
+      ++i;
+    }
+    if (i == g_cluster_count) {
+      if (g_cluster_count == kMaxClusters) continue;
+      ++g_cluster_count;
+      memset(&g_clusters[i], 0, sizeof(g_clusters[i]));
+      g_clusters[i].capacity = capacity;
+      first_cpu[i] = cpu;
+      domain[i] = cpu_domain;
+    }
+    android_cpu_cluster& cluster = g_clusters[i];
+    CPU_SET(cpu, &cluster.cpus);
+    ++cluster.cpu_count;
+    if (static_cast<uint32_t>(max_freq_khz) > cluster.max_freq_khz) {
+      cluster.max_freq_khz = max_freq_khz;
+    }
+    if (domain[i] == -1) domain[i] = cpu_domain;
+  }
+
+  // Order by capacity, then by CPU number. There are only a handful, so insertion sort is fine.
+  for (size_t i = 1; i < g_cluster_count; ++i) {
+    for (size_t j = i; j > 0; --j) {
+      android_cpu_cluster& a = g_clusters[j - 1];
+      android_cpu_cluster& b = g_clusters[j];
+      if (a.capacity < b.capacity ||
+          (a.capacity == b.capacity && first_cpu[j - 1] < first_cpu[j])) {
+        break;
+      }
+      android_cpu_cluster tmp = a;
+      a = b;
+      b = tmp;
+      int tmp_cpu = first_cpu[j - 1];
+      first_cpu[j - 1] = first_cpu[j];
+      first_cpu[j] = tmp_cpu;
+    }
+  }
+}
+
+size_t android_get_cpu_clusters(android_cpu_cluster* clusters, size_t count) {
+  ErrnoRestorer errno_restorer;
+  LockGuard guard(g_clusters_lock);
+  if (!g_clusters_valid) {
+    ReadClusters();
+    g_clusters_valid = true;
+  }
+  if (count > g_cluster_count) count = g_cluster_count;
+  if (count > 0) memcpy(clusters, g_clusters, count * sizeof(android_cpu_cluster));
+  return g_cluster_count;
+}
+
+void android_cpu_topology_changed() {
+  {
+    LockGuard guard(g_clusters_lock);
+    g_clusters_valid = false;
+  }
+  __invalidate_nprocs();
+}
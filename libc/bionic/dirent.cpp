@@ -38,6 +38,7 @@
 
 #include <android/fdsan.h>
 
+#include "platform/bionic/dirent_batch.h"
 #include "private/bionic_fortify.h"
 #include "private/ErrnoRestorer.h"
 #include "private/ScopedPthreadMutexLocker.h"
@@ -57,8 +58,17 @@ struct DIR {
   pthread_mutex_t mutex_;
   dirent buff_[15];
   long current_pos_;
+  // The buffer getdents64 fills: buff_ to start with, then a larger heap allocation once a
+  // single read doesn't get the whole directory.
+  dirent* buffer_;
+  size_t buffer_size_;
+  bool buffer_was_full_;
 };
 
+// Most directories fit in buff_ (about 4KiB). For big ones, each getdents64 is a trip through
+// the file system's directory iteration, so read them in larger chunks.
+static constexpr size_t kMaxDirBufferSize = 32 * 1024;
+
 #define CHECK_DIR(d) if (d == nullptr) __fortify_fatal("%s: null DIR*", __FUNCTION__)
 
 static uint64_t __get_dir_tag(DIR* dir) {
@@ -76,6 +86,9 @@ static DIR* __allocate_DIR(int fd) {
   d->available_bytes_ = 0;
   d->next_ = nullptr;
   d->current_pos_ = 0L;
+  d->buffer_ = d->buff_;
+  d->buffer_size_ = sizeof(d->buff_);
+  d->buffer_was_full_ = false;
   pthread_mutex_init(&d->mutex_, nullptr);
   return d;
 }
@@ -104,14 +117,33 @@ DIR* opendir(const char* path) {
   return (fd != -1) ? __allocate_DIR(fd) : nullptr;
 }
 
+// Doubles the buffer, up to kMaxDirBufferSize. On allocation failure, the old buffer is kept.
+static void __grow_DIR_buffer(DIR* d) {
+  if (d->buffer_size_ >= kMaxDirBufferSize) return;
+
+  size_t new_size = (d->buffer_ == d->buff_) ? 8 * 1024 : d->buffer_size_ * 2;
+  dirent* new_buffer = reinterpret_cast<dirent*>(malloc(new_size));
+  if (new_buffer == nullptr) return;
+  if (d->buffer_ != d->buff_) free(d->buffer_);
+  d->buffer_ = new_buffer;
+  d->buffer_size_ = new_size;
+}
+
 static bool __fill_DIR(DIR* d) {
   CHECK_DIR(d);
-  int rc = TEMP_FAILURE_RETRY(__getdents64(d->fd_, d->buff_, sizeof(d->buff_)));
+  // If the last read filled the buffer, there's probably more where that came from. The caller is
+  // done with the entries in it (readdir's result is only valid until the next call), so grow it.
+  if (d->buffer_was_full_) {
+    ErrnoRestorer errno_restorer;
+    __grow_DIR_buffer(d);
+  }
+  int rc = TEMP_FAILURE_RETRY(__getdents64(d->fd_, d->buffer_, d->buffer_size_));
   if (rc <= 0) {
     return false;
   }
   d->available_bytes_ = rc;
-  d->next_ = d->buff_;
+  d->buffer_was_full_ = (static_cast<size_t>(rc) + sizeof(dirent) > d->buffer_size_);
+  d->next_ = d->buffer_;
   return true;
 }
 
@@ -136,6 +168,35 @@ dirent* readdir(DIR* d) {
 }
 __strong_alias(readdir64, readdir);
 
+ssize_t android_readdir_batch(DIR* d, dirent** entries) {
+  CHECK_DIR(d);
+  ScopedPthreadMutexLocker locker(&d->mutex_);
+
+  if (d->available_bytes_ == 0) {
+    ErrnoRestorer errno_restorer;
+    errno = 0;
+    if (!__fill_DIR(d)) {
+      if (errno == 0) return 0;
+      errno_restorer.override(errno);
+      return -1;
+    }
+  }
+
+  // Hand over the rest of the buffer: all of it, unless readdir() has already taken some.
+  dirent* first = d->next_;
+  size_t size = d->available_bytes_;
+  char* end = reinterpret_cast<char*>(first) + size;
+  dirent* last = first;
+  for (char* p = reinterpret_cast<char*>(first); p < end; p += last->d_reclen) {
+    last = reinterpret_cast<dirent*>(p);
+  }
+  d->next_ = reinterpret_cast<dirent*>(end);
+  d->available_bytes_ = 0;
+  d->current_pos_ = static_cast<long>(last->d_off);
+  *entries = first;
+  return size;
+}
+
 int readdir_r(DIR* d, dirent* entry, dirent** result) {
   CHECK_DIR(d);
 
@@ -166,6 +227,7 @@ int closedir(DIR* d) {
   }
 
   int fd = d->fd_;
+  if (d->buffer_ != d->buff_) free(d->buffer_);
   pthread_mutex_destroy(&d->mutex_);
   int rc = android_fdsan_close_with_tag(fd, __get_dir_tag(d));
   free(d);
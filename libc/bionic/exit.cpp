@@ -27,16 +27,48 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
+#include "platform/bionic/exit.h"
 #include "private/bionic_defs.h"
+#include "private/bionic_globals.h"
+#include "private/bionic_systrace.h"
 
 extern "C" void __cxa_finalize(void* dso_handle);
 extern "C" void __cxa_thread_finalize();
+extern "C" void __libc_run_quick_exit_handlers();
+extern "C" void __libc_stdio_cleanup();
+
+static bool g_fast_exit = false;
+
+void android_set_fast_exit(bool enabled) {
+  g_fast_exit = enabled;
+}
+
+// LIBC_FAST_EXIT is read once at startup and then removed from the
+// environment, so it only applies to the process it was set for: a program
+// that runs others doesn't quietly pass fast exit on to all of them.
+void __libc_init_fast_exit() {
+  const char* value = getenv("LIBC_FAST_EXIT");
+  if (value == nullptr) return;
+  g_fast_exit = (strcmp(value, "1") == 0);
+  unsetenv("LIBC_FAST_EXIT");
+}
 
 __BIONIC_WEAK_FOR_NATIVE_BRIDGE
 void exit(int status) {
+  if (g_fast_exit) {
+    // Everything __cxa_finalize would do beyond this is tearing down state
+    // that the kernel is about to throw away with the address space anyway.
+    __libc_run_quick_exit_handlers();
+    __libc_stdio_cleanup();
+    bionic_trace_flush();
+    _exit(status);
+  }
+
   __cxa_thread_finalize();
   __cxa_finalize(nullptr);
+  bionic_trace_flush();
   _exit(status);
 }
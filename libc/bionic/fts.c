@@ -31,6 +31,7 @@
 
 #include <sys/param.h>	/* ALIGN */
 #include <sys/stat.h>
+#include <sys/sysmacros.h>
 
 #include <dirent.h>
 #include <errno.h>
@@ -52,6 +53,8 @@ static void	 fts_padjust(FTS *, FTSENT *);
 static int	 fts_palloc(FTS *, size_t);
 static FTSENT	*fts_sort(FTS *, FTSENT *, int);
 static u_short	 fts_stat(FTS *, FTSENT *, int, int);
+static int	 fts_fstatat(int, const char *, struct stat *, int, int);
+static int	 fts_skipstat(FTS *, const struct dirent *);
 static int	 fts_safe_changedir(FTS *, FTSENT *, int, const char *);
 
 #define	ISDOT(a)	(a[0] == '.' && (!a[1] || (a[1] == '.' && !a[2])))
@@ -580,6 +583,12 @@ fts_build(FTS *sp, int type)
 	else if (ISSET(FTS_NOSTAT) && ISSET(FTS_PHYSICAL)) {
 		nlinks = cur->fts_nlink - (ISSET(FTS_SEEDOT) ? 0 : 2);
 		nostat = 1;
+	} else if (ISSET(FTS_NOSTAT)) {
+		// Android: symbolic links can be directories in a logical walk, so
+		// the link count doesn't help, but d_type still rules out
+		// everything that's neither a directory nor a symbolic link.
+		nlinks = -1;
+		nostat = 1;
 	} else {
 		nlinks = -1;
 		nostat = 0;
@@ -705,12 +714,7 @@ mem1:				saved_errno = errno;
 			} else
 				p->fts_info = FTS_NSOK;
 			p->fts_accpath = cur->fts_accpath;
-		} else if (nlinks == 0
-#ifdef DT_DIR
-		    || (nostat &&
-		    dp->d_type != DT_DIR && dp->d_type != DT_UNKNOWN)
-#endif
-		    ) {
+		} else if (nlinks == 0 || (nostat && fts_skipstat(sp, dp))) {
 			p->fts_accpath =
 			    ISSET(FTS_NOCHDIR) ? p->fts_path : p->fts_name;
 			p->fts_info = FTS_NSOK;
@@ -796,7 +800,7 @@ fts_stat(FTS *sp, FTSENT *p, int follow, int dfd)
 	dev_t dev;
 	ino_t ino;
 	struct stat *sbp, sb;
-	int saved_errno;
+	int minimal, saved_errno;
 	const char *path;
 
 	if (dfd == -1) {
@@ -806,7 +810,9 @@ fts_stat(FTS *sp, FTSENT *p, int follow, int dfd)
 		path = p->fts_name;
 
 	/* If user needs stat info, stat buffer already allocated. */
-	sbp = ISSET(FTS_NOSTAT) ? &sb : p->fts_statp;
+	sbp = p->fts_statp != NULL ? p->fts_statp : &sb;
+	/* Android: only a buffer the caller never sees can be left partly filled. */
+	minimal = (sbp == &sb);
 
 	/*
 	 * If doing a logical walk, or application requested FTS_FOLLOW, do
@@ -814,16 +820,16 @@ fts_stat(FTS *sp, FTSENT *p, int follow, int dfd)
 	 * fail, set the errno from the stat call.
 	 */
 	if (ISSET(FTS_LOGICAL) || follow) {
-		if (fstatat(dfd, path, sbp, 0)) {
+		if (fts_fstatat(dfd, path, sbp, 0, minimal)) {
 			saved_errno = errno;
-			if (!fstatat(dfd, path, sbp, AT_SYMLINK_NOFOLLOW)) {
+			if (!fts_fstatat(dfd, path, sbp, AT_SYMLINK_NOFOLLOW, minimal)) {
 				errno = 0;
 				return (FTS_SLNONE);
 			}
 			p->fts_errno = saved_errno;
 			goto err;
 		}
-	} else if (fstatat(dfd, path, sbp, AT_SYMLINK_NOFOLLOW)) {
+	} else if (fts_fstatat(dfd, path, sbp, AT_SYMLINK_NOFOLLOW, minimal)) {
 		p->fts_errno = errno;
 err:		memset(sbp, 0, sizeof(struct stat));
 		return (FTS_NS);
@@ -865,6 +871,57 @@ err:		memset(sbp, 0, sizeof(struct stat));
 	return (FTS_DEFAULT);
 }
 
+/*
+ * Android: when the stat buffer is fts's own (`minimal`), the caller never
+ * sees it, and fts itself only needs the type, device, inode, and link count.
+ * Asking statx for no more than that lets file systems that have to fetch
+ * attributes (FUSE, for example) answer from their cache.  A buffer that's
+ * returned in fts_statp always gets a full fstatat.  Kernels before 4.11 don't
+ * have statx, so fall back to fstatat there.
+ */
+static int
+fts_fstatat(int dfd, const char *path, struct stat *sbp, int flags, int minimal)
+{
+	static int no_statx;
+	struct statx stx;
+
+	if (!minimal || no_statx)
+		return (fstatat(dfd, path, sbp, flags));
+
+	if (statx(dfd, path, flags, STATX_TYPE | STATX_INO | STATX_NLINK,
+	    &stx) == -1) {
+		if (errno != ENOSYS)
+			return (-1);
+		no_statx = 1;
+		return (fstatat(dfd, path, sbp, flags));
+	}
+	memset(sbp, 0, sizeof(struct stat));
+	sbp->st_mode = stx.stx_mode;
+	sbp->st_ino = stx.stx_ino;
+	sbp->st_nlink = stx.stx_nlink;
+	sbp->st_dev = makedev(stx.stx_dev_major, stx.stx_dev_minor);
+	return (0);
+}
+
+/*
+ * Android: returns true if an entry's d_type shows that it can't be a
+ * directory to descend into, so that with FTS_NOSTAT it needn't be stat'ed.
+ * Linux file systems all fill in d_type (or say DT_UNKNOWN).
+ */
+static int
+fts_skipstat(FTS *sp, const struct dirent *dp)
+{
+	switch (dp->d_type) {
+	case DT_DIR:
+	case DT_UNKNOWN:
+		return (0);
+	case DT_LNK:
+		return (ISSET(FTS_PHYSICAL) != 0);
+	default:
+		return (1);
+	}
+}
+
 static FTSENT *
 fts_sort(FTS *sp, FTSENT *head, int nitems)
 {
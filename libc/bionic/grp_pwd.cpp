@@ -127,22 +127,76 @@ static group* android_iinfo_to_group(group_state_t* state,
   return gr;
 }
 
-static const android_id_info* find_android_id_info(unsigned id) {
-  for (size_t n = 0; n < android_id_count; ++n) {
-    if (android_ids[n].aid == id) {
-      return &android_ids[n];
+// android_ids is generated outside bionic, and isn't usable in constant expressions, so it can't
+// be sorted at compile time. Instead, these indexes into it are sorted on first use. Both sorts
+// are stable, so a lookup finds the same entry that a linear search of android_ids would.
+struct AndroidIdIndex {
+  // The +1 avoids zero-length arrays on the host, where android_ids is empty.
+  uint16_t by_aid[android_id_count + 1];
+  uint16_t by_name[android_id_count + 1];
+};
+
+static_assert(android_id_count <= UINT16_MAX, "android_ids is too large for AndroidIdIndex");
+
+template <typename Less>
+static void insertion_sort(uint16_t* indexes, size_t count, Less less) {
+  for (size_t i = 1; i < count; ++i) {
+    uint16_t index = indexes[i];
+    size_t j = i;
+    for (; j > 0 && less(index, indexes[j - 1]); --j) {
+      indexes[j] = indexes[j - 1];
     }
+    indexes[j] = index;
   }
-  return nullptr;
 }
 
-static const android_id_info* find_android_id_info(const char* name) {
-  for (size_t n = 0; n < android_id_count; ++n) {
-    if (!strcmp(android_ids[n].name, name)) {
-      return &android_ids[n];
+static const AndroidIdIndex& get_android_id_index() {
+  static const AndroidIdIndex index = [] {
+    AndroidIdIndex result = {};
+    for (size_t n = 0; n < android_id_count; ++n) {
+      result.by_aid[n] = result.by_name[n] = n;
+    }
+    insertion_sort(result.by_aid, android_id_count, [](uint16_t a, uint16_t b) {
+      return android_ids[a].aid < android_ids[b].aid;
+    });
+    insertion_sort(result.by_name, android_id_count, [](uint16_t a, uint16_t b) {
+      return strcmp(android_ids[a].name, android_ids[b].name) < 0;
+    });
+    return result;
+  }();
+  return index;
+}
+
+// Binary searches `indexes`, which is sorted consistently with `compare` (which returns <0, 0 or
+// >0, like strcmp), for the first matching entry.
+template <typename Compare>
+static const android_id_info* find_android_id_info(const uint16_t* indexes, Compare compare) {
+  size_t low = 0;
+  size_t high = android_id_count;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (compare(android_ids[indexes[mid]]) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
     }
   }
-  return nullptr;
+  if (low == android_id_count || compare(android_ids[indexes[low]]) != 0) {
+    return nullptr;
+  }
+  return &android_ids[indexes[low]];
+}
+
+static const android_id_info* find_android_id_info(unsigned id) {
+  return find_android_id_info(get_android_id_index().by_aid, [id](const android_id_info& info) {
+    return (info.aid < id) ? -1 : (info.aid > id);
+  });
+}
+
+static const android_id_info* find_android_id_info(const char* name) {
+  return find_android_id_info(get_android_id_index().by_name, [name](const android_id_info& info) {
+    return strcmp(info.name, name);
+  });
 }
 
 // These are a list of the reserved app ranges, and should never contain anything below
@@ -32,7 +32,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <sys/prctl.h>
 #include <sys/stat.h>
+#include <time.h>
 
 #include <async_safe/log.h>
 
@@ -44,9 +46,15 @@
 // null-terminated.  ':'s are used to deliminate fields and '\n's are used to deliminate lines.
 // There is a check that the file ends with '\n', such that terminating loops at '\n' ensures that
 // memory will be not read beyond the mmap region.
+//
+// Lookups go through a hash index of line offsets by name and by id, which is built when the file
+// is mapped. The file is stat'ed again at most once every kRecheckIntervalSeconds, and the mapping
+// and index are rebuilt if it has changed (or appeared or disappeared) since.
 
 namespace {
 
+constexpr time_t kRecheckIntervalSeconds = 1;
+
 void CopyFieldToString(char* dest, const char* source, size_t max) {
   while (*source != ':' && *source != '\n' && max > 1) {
     *dest++ = *source++;
@@ -93,6 +101,26 @@ const char* ParseLine(const char* begin, const char* end, const char** fields, s
   return position + 1;
 }
 
+// Hashes a name up to its terminating '\0' (for a name being looked up) or ':' or '\n' (for a name
+// in the file), with FNV-1a.
+uint32_t HashName(const char* name) {
+  uint32_t hash = 2166136261u;
+  while (*name != '\0' && *name != ':' && *name != '\n') {
+    hash = (hash ^ static_cast<uint8_t>(*name++)) * 16777619u;
+  }
+  return hash;
+}
+
+uint32_t HashId(uid_t id) {
+  uint32_t hash = id * 0x9e3779b1u;
+  return hash ^ (hash >> 16);
+}
+
+bool SameFile(const struct stat& a, const struct stat& b) {
+  return a.st_dev == b.st_dev && a.st_ino == b.st_ino && a.st_size == b.st_size &&
+         a.st_mtim.tv_sec == b.st_mtim.tv_sec && a.st_mtim.tv_nsec == b.st_mtim.tv_nsec;
+}
+
 struct PasswdLine {
   const char* name() const {
     return fields[0];
@@ -112,7 +140,7 @@ struct PasswdLine {
     return fields[6];
   }
 
-  bool ToPasswdState(passwd_state_t* passwd_state) {
+  bool ToState(passwd_state_t* passwd_state) {
     if (name() == nullptr || dir() == nullptr || shell() == nullptr) {
       return false;
     }
@@ -162,7 +190,7 @@ struct GroupLine {
   }
   // User list is not supported (returns simply name)
 
-  bool ToGroupState(group_state_t* group_state) {
+  bool ToState(group_state_t* group_state) {
     if (name() == nullptr || gid() == nullptr) {
       return false;
     }
@@ -199,34 +227,61 @@ MmapFile::MmapFile(const char* filename, const char* required_prefix)
 }
 
 void MmapFile::Unmap() {
+  LockGuard guard(lock_);
+  UnmapLocked();
+  status_ = FileStatus::Uninitialized;
+}
+
+void MmapFile::UnmapLocked() {
   if (status_ == FileStatus::Initialized) {
     size_t size = end_ - start_ + 1;
     munmap(const_cast<char*>(start_), size);
-    status_ = FileStatus::Uninitialized;
+    munmap(index_, 2 * index_capacity_ * sizeof(*index_));
     start_ = nullptr;
     end_ = nullptr;
+    index_ = nullptr;
+    index_capacity_ = 0;
   }
 }
 
-bool MmapFile::GetFile(const char** start, const char** end) {
-  LockGuard guard(lock_);
-  if (status_ == FileStatus::Initialized) {
-    *start = start_;
-    *end = end_;
-    return true;
-  }
-  if (status_ == FileStatus::Error) {
+bool MmapFile::FileChangedLocked() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+  if (now.tv_sec < last_check_time_ + kRecheckIntervalSeconds) {
     return false;
   }
+  last_check_time_ = now.tv_sec;
+
+  struct stat current;
+  if (stat(filename_, &current) == -1) current = {};
+  return !SameFile(current, file_stat_);
+}
+
+bool MmapFile::GetFileLocked() {
+  if (status_ != FileStatus::Uninitialized && !FileChangedLocked()) {
+    return status_ == FileStatus::Initialized;
+  }
+
+  UnmapLocked();
+
+  // This is stat'ed separately from the fd that's mapped, so that a missing file has a stat
+  // (all zeroes) to compare against too.
+  if (stat(filename_, &file_stat_) == -1) file_stat_ = {};
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+  last_check_time_ = now.tv_sec;
 
   if (!DoMmap()) {
     status_ = FileStatus::Error;
     return false;
   }
-
+  // Set this before BuildIndex so that UnmapLocked will clean up if it fails.
   status_ = FileStatus::Initialized;
-  *start = start_;
-  *end = end_;
+  if (!BuildIndex()) {
+    UnmapLocked();
+    status_ = FileStatus::Error;
+    return false;
+  }
   return true;
 }
 
@@ -239,6 +294,10 @@ bool MmapFile::DoMmap() {
   }
 
   auto mmap_size = fd_stat.st_size;
+  // Line offsets in the index are 32-bit.
+  if (mmap_size == 0 || static_cast<uint64_t>(mmap_size) >= UINT32_MAX) {
+    return false;
+  }
 
   void* map_result = mmap(nullptr, mmap_size, PROT_READ, MAP_SHARED, fd.get(), 0);
   if (map_result == MAP_FAILED) {
@@ -250,31 +309,56 @@ bool MmapFile::DoMmap() {
 
   if (*end_ != '\n') {
     munmap(map_result, mmap_size);
+    start_ = nullptr;
+    end_ = nullptr;
     return false;
   }
 
   return true;
 }
 
-template <typename Line, typename Predicate>
-bool MmapFile::Find(Line* line, Predicate predicate) {
-  const char* start;
-  const char* end;
-  if (!GetFile(&start, &end)) {
-    return false;
+bool MmapFile::BuildIndex() {
+  size_t line_count = 0;
+  for (const char* p = start_; p <= end_; ++p) {
+    p = static_cast<const char*>(memchr(p, '\n', end_ - p + 1));
+    ++line_count;
   }
 
-  const char* line_beginning = start;
-
-  while (line_beginning < end) {
-    line_beginning = ParseLine(line_beginning, end, line->fields, line->kNumFields);
+  // Keep the tables at most half full, so that probe sequences stay short.
+  size_t capacity = 16;
+  while (capacity < 2 * line_count) capacity *= 2;
+  size_t index_size = 2 * capacity * sizeof(*index_);
+  void* map_result =
+      mmap(nullptr, index_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (map_result == MAP_FAILED) {
+    return false;
+  }
+  prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, map_result, index_size, "passwd/group index");
+  index_ = static_cast<uint32_t*>(map_result);
+  index_capacity_ = capacity;
+
+  auto insert = [this](IndexTable table, uint32_t hash, uint32_t offset) {
+    uint32_t* slots = index_ + table * index_capacity_;
+    size_t mask = index_capacity_ - 1;
+    size_t i = hash & mask;
+    while (slots[i] != 0) i = (i + 1) & mask;
+    slots[i] = offset + 1;
+  };
+
+  // Lines are inserted in file order, so a lookup's probe sequence reaches the first of any
+  // duplicates first, just as a linear scan would.
+  const char* line_beginning = start_;
+  while (line_beginning < end_) {
+    const char* fields[3] = {};
+    uint32_t offset = line_beginning - start_;
+    line_beginning = ParseLine(line_beginning, end_, fields, arraysize(fields));
 #if defined(__ANDROID__)
     // To comply with Treble, users/groups from each partition need to be prefixed with
     // the partition name.
     if (required_prefix_ != nullptr) {
-      if (strncmp(line->fields[0], required_prefix_, strlen(required_prefix_)) != 0) {
+      if (strncmp(fields[0], required_prefix_, strlen(required_prefix_)) != 0) {
         char name[kGrpPwdBufferSize];
-        CopyFieldToString(name, line->fields[0], sizeof(name));
+        CopyFieldToString(name, fields[0], sizeof(name));
         async_safe_format_log(ANDROID_LOG_ERROR, "libc",
                               "Found user/group name '%s' in '%s' without required prefix '%s'",
                               name, filename_, required_prefix_);
@@ -282,15 +366,40 @@ bool MmapFile::Find(Line* line, Predicate predicate) {
       }
     }
 #endif
-    if (predicate(line)) return true;
+    insert(kByName, HashName(fields[0]), offset);
+    uid_t id;
+    if (FieldToUid(fields[2], &id)) {
+      insert(kById, HashId(id), offset);
+    }
+  }
+
+  return true;
+}
+
+template <typename Line, typename State, typename Predicate>
+bool MmapFile::Find(Line* line, State* state, IndexTable table, uint32_t hash,
+                    Predicate predicate) {
+  // The lock is held until the line has been copied into `state`, so that the file can't be
+  // remapped underneath us.
+  LockGuard guard(lock_);
+  if (!GetFileLocked()) {
+    return false;
+  }
+
+  const uint32_t* slots = index_ + table * index_capacity_;
+  size_t mask = index_capacity_ - 1;
+  for (size_t i = hash & mask; slots[i] != 0; i = (i + 1) & mask) {
+    *line = {};
+    ParseLine(start_ + slots[i] - 1, end_, line->fields, line->kNumFields);
+    if (predicate(line)) return line->ToState(state);
   }
 
   return false;
 }
 
-template <typename Line>
-bool MmapFile::FindById(uid_t uid, Line* line) {
-  return Find(line, [uid](const auto& line) {
+template <typename Line, typename State>
+bool MmapFile::FindById(uid_t uid, Line* line, State* state) {
+  return Find(line, state, kById, HashId(uid), [uid](const auto& line) {
     uid_t line_id;
     if (!FieldToUid(line->fields[2], &line_id)) {
       return false;
@@ -300,9 +409,9 @@ bool MmapFile::FindById(uid_t uid, Line* line) {
   });
 }
 
-template <typename Line>
-bool MmapFile::FindByName(const char* name, Line* line) {
-  return Find(line, [name](const auto& line) {
+template <typename Line, typename State>
+bool MmapFile::FindByName(const char* name, Line* line, State* state) {
+  return Find(line, state, kByName, HashName(name), [name](const auto& line) {
     const char* line_name = line->fields[0];
     if (line_name == nullptr) {
       return false;
@@ -326,13 +435,13 @@ PasswdFile::PasswdFile(const char* filename, const char* required_prefix)
 bool PasswdFile::FindById(uid_t id, passwd_state_t* passwd_state) {
   ErrnoRestorer errno_restorer;
   PasswdLine passwd_line;
-  return mmap_file_.FindById(id, &passwd_line) && passwd_line.ToPasswdState(passwd_state);
+  return mmap_file_.FindById(id, &passwd_line, passwd_state);
 }
 
 bool PasswdFile::FindByName(const char* name, passwd_state_t* passwd_state) {
   ErrnoRestorer errno_restorer;
   PasswdLine passwd_line;
-  return mmap_file_.FindByName(name, &passwd_line) && passwd_line.ToPasswdState(passwd_state);
+  return mmap_file_.FindByName(name, &passwd_line, passwd_state);
 }
 
 GroupFile::GroupFile(const char* filename, const char* required_prefix)
@@ -342,11 +451,11 @@ GroupFile::GroupFile(const char* filename, const char* required_prefix)
 bool GroupFile::FindById(gid_t id, group_state_t* group_state) {
   ErrnoRestorer errno_restorer;
   GroupLine group_line;
-  return mmap_file_.FindById(id, &group_line) && group_line.ToGroupState(group_state);
+  return mmap_file_.FindById(id, &group_line, group_state);
 }
 
 bool GroupFile::FindByName(const char* name, group_state_t* group_state) {
   ErrnoRestorer errno_restorer;
   GroupLine group_line;
-  return mmap_file_.FindByName(name, &group_line) && group_line.ToGroupState(group_state);
+  return mmap_file_.FindByName(name, &group_line, group_state);
 }
@@ -30,6 +30,9 @@
 
 #include <grp.h>
 #include <pwd.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <time.h>
 
 #include "private/bionic_lock.h"
 #include "platform/bionic/macros.h"
@@ -39,10 +42,11 @@ class MmapFile {
  public:
   MmapFile(const char* filename, const char* required_prefix);
 
-  template <typename Line>
-  bool FindById(uid_t uid, Line* line);
-  template <typename Line>
-  bool FindByName(const char* name, Line* line);
+  // On success, these fill in `state` from the first line matching `uid` or `name`.
+  template <typename Line, typename State>
+  bool FindById(uid_t uid, Line* line, State* state);
+  template <typename Line, typename State>
+  bool FindByName(const char* name, Line* line, State* state);
   void Unmap();
 
   BIONIC_DISALLOW_IMPLICIT_CONSTRUCTORS(MmapFile);
@@ -54,17 +58,31 @@ class MmapFile {
     Error,
   };
 
-  bool GetFile(const char** start, const char** end);
+  // The index has two open-addressed hash tables of index_capacity_ slots each, one keyed by
+  // name and then one keyed by id. A slot holds one plus the offset of a line, or 0 if empty.
+  enum IndexTable {
+    kByName = 0,
+    kById = 1,
+  };
+
+  bool GetFileLocked();
+  bool FileChangedLocked();
+  void UnmapLocked();
   bool DoMmap();
+  bool BuildIndex();
 
-  template <typename Line, typename Predicate>
-  bool Find(Line* line, Predicate predicate);
+  template <typename Line, typename State, typename Predicate>
+  bool Find(Line* line, State* state, IndexTable table, uint32_t hash, Predicate predicate);
 
   FileStatus status_ = FileStatus::Uninitialized;
   Lock lock_;
   const char* filename_ = nullptr;
   const char* start_ = nullptr;
   const char* end_ = nullptr;
+  uint32_t* index_ = nullptr;
+  size_t index_capacity_ = 0;
+  struct stat file_stat_ = {};
+  time_t last_check_time_ = 0;
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wunused-private-field"
   const char* required_prefix_;
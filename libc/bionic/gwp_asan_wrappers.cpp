@@ -29,6 +29,8 @@
 #include <alloca.h>
 #include <assert.h>
 #include <ctype.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -53,7 +55,7 @@
 #include "bionic/malloc_common_dynamic.h"
 #endif  // LIBC_STATIC
 
-static gwp_asan::GuardedPoolAllocator GuardedAlloc;
+gwp_asan::GuardedPoolAllocator GuardedAlloc;
 static const MallocDispatch* prev_dispatch;
 
 using Action = android_mallopt_gwp_asan_options_t::Action;
@@ -63,24 +65,138 @@ using Options = gwp_asan::options::Options;
 // want (don't touch my string!).
 extern "C" const char* __gnu_basename(const char* path);
 
-namespace {
+// ============================================================================
+// Sampling, and lazy initialization of the guarded pool.
+// ============================================================================
+
+// The pool and its metadata are mapped by the first sample rather than when
+// GWP-ASan is enabled, so a process doesn't pay for them until it needs them.
+enum PoolState : int {
+  kPoolUnmapped,
+  kPoolMapping,
+  kPoolMapped,
+};
+static _Atomic(int) pool_state = kPoolUnmapped;
+static Options pool_options;
+// Held across the whole of the mapping, and by the fork handlers, so that a
+// child never inherits a half-mapped pool that it would never sample from.
+static pthread_mutex_t pool_mapping_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Each thread's countdowns are uniform in [1, countdown_range], so samples are
+// SampleRate allocations apart on average, but can't be predicted.
+static uint32_t countdown_range;
+static uint32_t countdown_seed;
+
+static bool MaybeMapPool() {
+  int state = atomic_load_explicit(&pool_state, memory_order_acquire);
+  if (__predict_true(state == kPoolMapped)) return true;
+  // If another thread is mapping the pool, or fork() is under way, this
+  // allocation just isn't sampled. The same goes for any allocation init()
+  // makes itself, and for a fork handler's malloc() while the lock is held.
+  if (state != kPoolUnmapped || pthread_mutex_trylock(&pool_mapping_lock) != 0) {
+    return false;
+  }
+  if (!atomic_compare_exchange_strong(&pool_state, &state, kPoolMapping)) {
+    pthread_mutex_unlock(&pool_mapping_lock);
+    return state == kPoolMapped;
+  }
+
+  GuardedAlloc.init(pool_options);
+  __libc_shared_globals()->gwp_asan_state = GuardedAlloc.getAllocatorState();
+  __libc_shared_globals()->gwp_asan_metadata = GuardedAlloc.getMetadataRegion();
+
+  atomic_store_explicit(&pool_state, kPoolMapped, memory_order_release);
+  pthread_mutex_unlock(&pool_mapping_lock);
+  return true;
+}
+
+static void PoolPrepareFork() {
+  pthread_mutex_lock(&pool_mapping_lock);
+  GuardedAlloc.disable();
+}
+
+static void PoolAfterFork() {
+  GuardedAlloc.enable();
+  pthread_mutex_unlock(&pool_mapping_lock);
+}
+
+static uint32_t NextCountdown(bionic_tls& tls) {
+  // A xorshift generator, seeded from the thread's TLS address so that
+  // threads don't sample in step.
+  uint32_t x = tls.gwp_asan_random;
+  if (__predict_false(x == 0)) {
+    uint32_t tls_bits = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&tls) >> 12);
+    x = (countdown_seed ^ tls_bits * 0x9e3779b9u) | 1;
+  }
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  tls.gwp_asan_random = x;
+  return x % countdown_range + 1;
+}
+
+bool GwpAsanCountdownExpired() {
+  bionic_tls& tls = __get_bionic_tls();
+  // Zero means this is the thread's first allocation, which just arms it.
+  bool expired = tls.gwp_asan_countdown != 0;
+  tls.gwp_asan_countdown = NextCountdown(tls);
+  return expired && MaybeMapPool();
+}
 
 // ============================================================================
 // Implementation of GWP-ASan malloc wrappers.
 // ============================================================================
 
-void* gwp_asan_calloc(size_t n_elements, size_t elem_size) {
-  if (__predict_false(GuardedAlloc.shouldSample())) {
-    size_t bytes;
-    if (!__builtin_mul_overflow(n_elements, elem_size, &bytes)) {
-      if (void* result = GuardedAlloc.allocate(bytes)) {
-        return result;
-      }
+void* GwpAsanSampledCalloc(size_t n_elements, size_t elem_size) {
+  size_t bytes;
+  if (!__builtin_mul_overflow(n_elements, elem_size, &bytes)) {
+    if (void* result = GuardedAlloc.allocate(bytes)) {
+      return result;
     }
   }
   return prev_dispatch->calloc(n_elements, elem_size);
 }
 
+void* GwpAsanSampledMalloc(size_t bytes) {
+  if (void* result = GuardedAlloc.allocate(bytes)) {
+    return result;
+  }
+  return prev_dispatch->malloc(bytes);
+}
+
+void GwpAsanFree(void* mem) {
+  GuardedAlloc.deallocate(mem);
+}
+
+size_t GwpAsanMallocUsableSize(const void* mem) {
+  return GuardedAlloc.getSize(mem);
+}
+
+void* GwpAsanRealloc(void* old_mem, size_t bytes) {
+  if (__predict_false(bytes == 0)) {
+    GuardedAlloc.deallocate(old_mem);
+    return nullptr;
+  }
+  void* new_ptr = __predict_false(GwpAsanShouldSample()) ? GwpAsanSampledMalloc(bytes)
+                                                         : prev_dispatch->malloc(bytes);
+  // If malloc() fails, then don't destroy the old memory.
+  if (__predict_false(new_ptr == nullptr)) return nullptr;
+
+  size_t old_size = GuardedAlloc.getSize(old_mem);
+  memcpy(new_ptr, old_mem, (bytes < old_size) ? bytes : old_size);
+  GuardedAlloc.deallocate(old_mem);
+  return new_ptr;
+}
+
+namespace {
+
+void* gwp_asan_calloc(size_t n_elements, size_t elem_size) {
+  if (__predict_false(GwpAsanShouldSample())) {
+    return GwpAsanSampledCalloc(n_elements, elem_size);
+  }
+  return prev_dispatch->calloc(n_elements, elem_size);
+}
+
 void gwp_asan_free(void* mem) {
   if (__predict_false(GuardedAlloc.pointerIsMine(mem))) {
     GuardedAlloc.deallocate(mem);
@@ -90,10 +206,8 @@ void gwp_asan_free(void* mem) {
 }
 
 void* gwp_asan_malloc(size_t bytes) {
-  if (__predict_false(GuardedAlloc.shouldSample())) {
-    if (void* result = GuardedAlloc.allocate(bytes)) {
-      return result;
-    }
+  if (__predict_false(GwpAsanShouldSample())) {
+    return GwpAsanSampledMalloc(bytes);
   }
   return prev_dispatch->malloc(bytes);
 }
@@ -111,18 +225,7 @@ void* gwp_asan_realloc(void* old_mem, size_t bytes) {
   // technically missing some coverage, but reducing an extra conditional
   // branch.
   if (__predict_false(GuardedAlloc.pointerIsMine(old_mem))) {
-    if (__predict_false(bytes == 0)) {
-      GuardedAlloc.deallocate(old_mem);
-      return nullptr;
-    }
-    void* new_ptr = gwp_asan_malloc(bytes);
-    // If malloc() fails, then don't destroy the old memory.
-    if (__predict_false(new_ptr == nullptr)) return nullptr;
-
-    size_t old_size = GuardedAlloc.getSize(old_mem);
-    memcpy(new_ptr, old_mem, (bytes < old_size) ? bytes : old_size);
-    GuardedAlloc.deallocate(old_mem);
-    return new_ptr;
+    return GwpAsanRealloc(old_mem, bytes);
   }
   return prev_dispatch->realloc(old_mem, bytes);
 }
@@ -376,26 +479,29 @@ bool MaybeInitGwpAsan(libc_globals* globals,
     return false;
   }
 
+  // The pool is mapped lazily, from inside malloc(). That might be a fork
+  // handler's malloc(), with the atfork lock held, so init() mustn't register
+  // its fork handlers: do it now instead.
+  options.InstallForkHandlers = false;
+  if (pthread_atfork(PoolPrepareFork, PoolAfterFork, PoolAfterFork) != 0) {
+    return false;
+  }
+
+  pool_options = options;
+  uint64_t range = 2 * static_cast<uint64_t>(options.SampleRate) - 1;
+  countdown_range = range > UINT32_MAX ? UINT32_MAX : range;
+  __libc_safe_arc4random_buf(&countdown_seed, sizeof(countdown_seed));
+
   // GWP-ASan's initialization is always called in a single-threaded context, so
   // we can initialize lock-free.
-  // Set GWP-ASan as the malloc dispatch table.
+  // Set GWP-ASan as the malloc dispatch table. It's left out of
+  // current_dispatch_table: malloc and friends sample inline instead.
   globals->malloc_dispatch_table = gwp_asan_dispatch;
   atomic_store(&globals->default_dispatch_table, &gwp_asan_dispatch);
-
-  // If malloc_limit isn't installed, we can skip the default_dispatch_table
-  // lookup.
-  if (GetDispatchTable() == nullptr) {
-    atomic_store(&globals->current_dispatch_table, &gwp_asan_dispatch);
-  }
-
-  GwpAsanInitialized = true;
-
   prev_dispatch = NativeAllocatorDispatch();
+  globals->gwp_asan_enabled = true;
 
-  GuardedAlloc.init(options);
-
-  __libc_shared_globals()->gwp_asan_state = GuardedAlloc.getAllocatorState();
-  __libc_shared_globals()->gwp_asan_metadata = GuardedAlloc.getMetadataRegion();
+  GwpAsanInitialized = true;
 
   return true;
 }
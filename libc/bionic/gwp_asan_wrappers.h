@@ -30,10 +30,13 @@
 
 #include <stddef.h>
 
+#include "bionic/pthread_internal.h"
+#include "gwp_asan/guarded_pool_allocator.h"
 #include "gwp_asan/options.h"
 #include "platform/bionic/malloc.h"
 #include "private/bionic_globals.h"
 #include "private/bionic_malloc_dispatch.h"
+#include "private/bionic_tls.h"
 
 // Enable GWP-ASan, used by android_mallopt. Should always be called in a
 // single-threaded context.
@@ -46,3 +49,49 @@ bool MaybeInitGwpAsanFromLibc(libc_globals* globals);
 // heapprofd's signal-initialization sequence to determine the intermediate
 // dispatch pointer to use when initing.
 bool DispatchIsGwpAsan(const MallocDispatch* dispatch);
+
+// GWP-ASan is installed as the default dispatch table, so that malloc_limit,
+// heapprofd, and the malloc hooks chain through it, but not as the current
+// one: malloc and friends call the functions below from the native
+// allocator's fast path instead, so the calls that aren't sampled don't pay
+// for an indirect call.
+
+// The guarded pool. It's only mapped by the first sample, and until then its
+// bounds are zero, so pointerIsMine() is false for every pointer.
+__LIBC_HIDDEN__ extern gwp_asan::GuardedPoolAllocator GuardedAlloc;
+
+// Slow path of GwpAsanShouldSample(): re-arms the calling thread's countdown,
+// and returns whether this allocation should be sampled.
+bool GwpAsanCountdownExpired();
+
+// Returns whether the calling thread's next allocation should come from
+// GWP-ASan. Each thread counts down to its next sample in its bionic TLS, so
+// all but about one in every SampleRate allocations cost a decrement.
+static inline bool GwpAsanShouldSample() {
+  if (__predict_true(!__libc_globals->gwp_asan_enabled)) return false;
+  bionic_tls& tls = __get_bionic_tls();
+  if (__predict_true(tls.gwp_asan_countdown > 1)) {
+    tls.gwp_asan_countdown--;
+    return false;
+  }
+  return GwpAsanCountdownExpired();
+}
+
+// Returns whether |mem| came from the guarded pool. Like GwpAsanShouldSample(),
+// it checks the flag in the libc globals that malloc() and friends have just
+// read the dispatch table from first, so that processes without GWP-ASan don't
+// touch GuardedAlloc on every free().
+static inline bool GwpAsanPointerIsMine(const void* mem) {
+  if (__predict_true(!__libc_globals->gwp_asan_enabled)) return false;
+  return GuardedAlloc.pointerIsMine(mem);
+}
+
+// The GWP-ASan versions of the functions it intercepts, for the native
+// allocator's fast path. The first two are for allocations
+// GwpAsanShouldSample() chose, and fall back to the native allocator if the
+// pool is full; the rest are for pointers GwpAsanPointerIsMine().
+void* GwpAsanSampledMalloc(size_t bytes);
+void* GwpAsanSampledCalloc(size_t n_elements, size_t elem_size);
+void GwpAsanFree(void* mem);
+size_t GwpAsanMallocUsableSize(const void* mem);
+void* GwpAsanRealloc(void* old_mem, size_t bytes);
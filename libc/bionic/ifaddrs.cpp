@@ -40,7 +40,9 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "platform/bionic/getifaddrs_cache.h"
 #include "private/ErrnoRestorer.h"
+#include "private/bionic_lock.h"
 
 #include "bionic_netlink.h"
 
@@ -61,6 +63,10 @@ struct ifaddrs_storage {
   sockaddr_storage ifa_ifu;
   char name[IFNAMSIZ + 1];
 
+  // True for the first entry of a list that was allocated as a single block (a copy of the
+  // cache), which freeifaddrs frees in one go.
+  bool is_block;
+
   explicit ifaddrs_storage(ifaddrs** list) {
     memset(this, 0, sizeof(*this));
 
@@ -105,6 +111,15 @@ struct ifaddrs_storage {
     ifa.ifa_addr = CopyAddress(family, data, byteCount, &addr);
   }
 
+  // Copies this entry to `dst`, with the pointers pointing into `dst` rather than this.
+  void CopyTo(ifaddrs_storage* dst) const {
+    memcpy(dst, this, sizeof(*this));
+    dst->ifa.ifa_name = Rebase(ifa.ifa_name, dst);
+    dst->ifa.ifa_addr = Rebase(ifa.ifa_addr, dst);
+    dst->ifa.ifa_netmask = Rebase(ifa.ifa_netmask, dst);
+    dst->ifa.ifa_broadaddr = Rebase(ifa.ifa_broadaddr, dst);
+  }
+
   // Netlink gives us the prefix length as a bit count. We need to turn
   // that into a BSD-compatible netmask represented by a sockaddr*.
   void SetNetmask(int family, size_t prefix_length) {
@@ -126,6 +141,13 @@ struct ifaddrs_storage {
   }
 
  private:
+  template <typename T>
+  T* Rebase(T* p, const ifaddrs_storage* dst) const {
+    if (p == nullptr) return nullptr;
+    ptrdiff_t offset = reinterpret_cast<const char*>(p) - reinterpret_cast<const char*>(this);
+    return reinterpret_cast<T*>(const_cast<char*>(reinterpret_cast<const char*>(dst) + offset));
+  }
+
   sockaddr* CopyAddress(int family, const void* data, size_t byteCount, sockaddr_storage* ss) {
     // Netlink gives us the address family in the header, and the
     // sockaddr_in or sockaddr_in6 bytes as the payload. We need to
@@ -300,7 +322,7 @@ static void get_interface_flags_via_ioctl(ifaddrs** list) {
   }
 }
 
-int getifaddrs(ifaddrs** out) {
+static int getifaddrs_uncached(ifaddrs** out) {
   // We construct the result directly into `out`, so terminate the list.
   *out = nullptr;
 
@@ -333,7 +355,104 @@ int getifaddrs(ifaddrs** out) {
   return 0;
 }
 
+// The process-wide cache enabled by android_set_getifaddrs_cache_enabled. Rather than dump every
+// link and address from the kernel on each call, getifaddrs keeps a snapshot and listens for
+// netlink notifications of link and address changes. Only when there have been some (or some
+// were lost) is the snapshot dumped again. Each call gets a copy of the snapshot in a single
+// allocation.
+static Lock g_ifaddrs_cache_lock;
+static bool g_ifaddrs_cache_enabled;
+static pid_t g_ifaddrs_cache_pid;
+static NetlinkMonitor g_ifaddrs_cache_monitor;
+static ifaddrs* g_ifaddrs_cache_snapshot;
+static bool g_ifaddrs_cache_snapshot_valid;
+
+static constexpr uint32_t kIfaddrsCacheGroups =
+    RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+
+static void invalidate_ifaddrs_cache() {
+  freeifaddrs(g_ifaddrs_cache_snapshot);
+  g_ifaddrs_cache_snapshot = nullptr;
+  g_ifaddrs_cache_snapshot_valid = false;
+}
+
+static int copy_ifaddrs(const ifaddrs* list, ifaddrs** out) {
+  size_t count = 0;
+  for (const ifaddrs* ifa = list; ifa != nullptr; ifa = ifa->ifa_next) ++count;
+  if (count == 0) return 0;
+
+  ifaddrs_storage* block = static_cast<ifaddrs_storage*>(malloc(count * sizeof(ifaddrs_storage)));
+  if (block == nullptr) {
+    errno = ENOMEM;
+    return -1;
+  }
+
+  size_t i = 0;
+  for (const ifaddrs* ifa = list; ifa != nullptr; ifa = ifa->ifa_next, ++i) {
+    reinterpret_cast<const ifaddrs_storage*>(ifa)->CopyTo(&block[i]);
+    block[i].ifa.ifa_next = (i + 1 < count) ? &block[i + 1].ifa : nullptr;
+    block[i].is_block = false;
+  }
+  block[0].is_block = true;
+  *out = &block[0].ifa;
+  return 0;
+}
+
+static int getifaddrs_cached(ifaddrs** out) {
+  LockGuard guard(g_ifaddrs_cache_lock);
+  if (!g_ifaddrs_cache_enabled) return getifaddrs_uncached(out);
+
+  // A forked child mustn't share the parent's notifications: whichever process read one first
+  // would leave the other with a stale snapshot.
+  if (g_ifaddrs_cache_pid != getpid()) {
+    g_ifaddrs_cache_monitor.Close();
+    invalidate_ifaddrs_cache();
+    if (!g_ifaddrs_cache_monitor.Open(kIfaddrsCacheGroups)) {
+      __atomic_store_n(&g_ifaddrs_cache_enabled, false, __ATOMIC_RELAXED);
+      return getifaddrs_uncached(out);
+    }
+    g_ifaddrs_cache_pid = getpid();
+  }
+
+  // Drain before dumping, so that changes made during the dump are noticed next time.
+  if (g_ifaddrs_cache_monitor.Drain()) {
+    invalidate_ifaddrs_cache();
+  }
+  if (!g_ifaddrs_cache_snapshot_valid) {
+    if (getifaddrs_uncached(&g_ifaddrs_cache_snapshot) == -1) return -1;
+    g_ifaddrs_cache_snapshot_valid = true;
+  }
+  return copy_ifaddrs(g_ifaddrs_cache_snapshot, out);
+}
+
+int getifaddrs(ifaddrs** out) {
+  *out = nullptr;
+  if (__atomic_load_n(&g_ifaddrs_cache_enabled, __ATOMIC_RELAXED)) {
+    return getifaddrs_cached(out);
+  }
+  return getifaddrs_uncached(out);
+}
+
+bool android_set_getifaddrs_cache_enabled(bool enabled) {
+  LockGuard guard(g_ifaddrs_cache_lock);
+  if (enabled == g_ifaddrs_cache_enabled) return true;
+
+  if (enabled) {
+    if (!g_ifaddrs_cache_monitor.Open(kIfaddrsCacheGroups)) return false;
+    g_ifaddrs_cache_pid = getpid();
+  } else {
+    g_ifaddrs_cache_monitor.Close();
+    invalidate_ifaddrs_cache();
+  }
+  __atomic_store_n(&g_ifaddrs_cache_enabled, enabled, __ATOMIC_RELAXED);
+  return true;
+}
+
 void freeifaddrs(ifaddrs* list) {
+  if (list != nullptr && reinterpret_cast<ifaddrs_storage*>(list)->is_block) {
+    free(list);
+    return;
+  }
   while (list != nullptr) {
     ifaddrs* current = list;
     list = list->ifa_next;
@@ -45,10 +45,10 @@
 #include <async_safe/log.h>
 
 #include "private/WriteProtected.h"
+#include "private/bionic_arc4random.h"
 #include "private/bionic_defs.h"
 #include "private/bionic_globals.h"
 #include "private/bionic_tls.h"
-#include "private/thread_private.h"
 #include "pthread_internal.h"
 
 extern "C" int __system_properties_init(void);
@@ -81,11 +81,6 @@ static void __check_max_thread_id() {
 }
 #endif
 
-static void arc4random_fork_handler() {
-  _rs_forked = 1;
-  _thread_arc4_lock();
-}
-
 __BIONIC_WEAK_FOR_NATIVE_BRIDGE
 void __libc_init_scudo() {
   // Heap tagging level *must* be set before interacting with Scudo, otherwise
@@ -125,11 +120,17 @@ void __libc_init_common() {
   __system_properties_init(); // Requires 'environ'.
   __libc_init_fdsan(); // Requires system properties (for debug.fdsan).
   __libc_init_fdtrack();
+  __libc_init_fast_exit(); // Requires 'environ'.
+
+  // Only libc's copy of libasync_safe keeps its logd socket open.
+  async_safe_log_keep_socket(true);
 }
 
 void __libc_init_fork_handler() {
-  // Register atfork handlers to take and release the arc4random lock.
-  pthread_atfork(arc4random_fork_handler, _thread_arc4_unlock, _thread_arc4_unlock);
+  // Register an atfork handler to reseed arc4random in the child.
+  pthread_atfork(nullptr, nullptr, __libc_arc4random_fork_child);
+  // And one to close the logd socket in the child, which a zygote's children mustn't inherit.
+  pthread_atfork(nullptr, nullptr, async_safe_log_close);
 }
 
 extern "C" void scudo_malloc_set_add_large_allocation_slack(int add_slack);
@@ -250,6 +251,7 @@ static bool __is_unsafe_environment_variable(const char* name) {
       "LD_SHOW_AUXV",
       "LD_USE_LOAD_BIAS",
       "LIBC_DEBUG_MALLOC_OPTIONS",
+      "LIBC_FAST_EXIT",
       "LIBC_HOOKS_ENABLE",
       "LOCALDOMAIN",
       "LOCPATH",
@@ -44,6 +44,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <elf.h>
+#include "atexit.h"
 #include "libc_init_common.h"
 
 #include "private/bionic_defs.h"
@@ -112,6 +113,10 @@ static void __libc_preinit_impl() {
 
   __libc_shared_globals()->set_target_sdk_version_hook = __libc_set_target_sdk_version;
 
+  // Batch the write-protection of atexit handlers registered by each library's constructors.
+  __libc_shared_globals()->constructors_begin_hook = __libc_atexit_batch_begin;
+  __libc_shared_globals()->constructors_end_hook = __libc_atexit_batch_end;
+
   netdClientInit();
 }
 
@@ -36,6 +36,7 @@
 #include <sys/auxv.h>
 #include <sys/mman.h>
 
+#include "atexit.h"
 #include "libc_init_common.h"
 #include "pthread_internal.h"
 #include "sysprop_helpers.h"
@@ -360,8 +361,10 @@ __noreturn static void __real_libc_init(void *raw_args,
   // Several Linux ABIs don't pass the onexit pointer, and the ones that
   // do never use it.  Therefore, we ignore it.
 
+  __libc_atexit_batch_begin();
   call_array(structors->preinit_array, args.argc, args.argv, args.envp);
   call_array(structors->init_array, args.argc, args.argv, args.envp);
+  __libc_atexit_batch_end();
 
   // The executable may have its own destructors listed in its .fini_array
   // so we need to ensure that these are called when the program exits
@@ -37,8 +37,10 @@
 #include <errno.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <sys/mman.h>
 
 #include <platform/bionic/malloc.h>
+#include <platform/bionic/page.h>
 #include <private/ScopedPthreadMutexLocker.h>
 #include <private/bionic_config.h>
 
@@ -68,7 +70,12 @@ extern "C" void* calloc(size_t n_elements, size_t elem_size) {
   if (__predict_false(dispatch_table != nullptr)) {
     return MaybeTagPointer(dispatch_table->calloc(n_elements, elem_size));
   }
-  void* result = Malloc(calloc)(n_elements, elem_size);
+  void* result;
+  if (__predict_false(GwpAsanShouldSample())) {
+    result = GwpAsanSampledCalloc(n_elements, elem_size);
+  } else {
+    result = Malloc(calloc)(n_elements, elem_size);
+  }
   if (__predict_false(result == nullptr)) {
     warning_log("calloc(%zu, %zu) failed: returning null pointer", n_elements, elem_size);
   }
@@ -80,6 +87,8 @@ extern "C" void free(void* mem) {
   mem = MaybeUntagAndCheckPointer(mem);
   if (__predict_false(dispatch_table != nullptr)) {
     dispatch_table->free(mem);
+  } else if (__predict_false(GwpAsanPointerIsMine(mem))) {
+    GwpAsanFree(mem);
   } else {
     Malloc(free)(mem);
   }
@@ -123,6 +132,8 @@ extern "C" void* malloc(size_t bytes) {
   void *result;
   if (__predict_false(dispatch_table != nullptr)) {
     result = dispatch_table->malloc(bytes);
+  } else if (__predict_false(GwpAsanShouldSample())) {
+    result = GwpAsanSampledMalloc(bytes);
   } else {
     result = Malloc(malloc)(bytes);
   }
@@ -139,6 +150,9 @@ extern "C" size_t malloc_usable_size(const void* mem) {
   if (__predict_false(dispatch_table != nullptr)) {
     return dispatch_table->malloc_usable_size(mem);
   }
+  if (__predict_false(GwpAsanPointerIsMine(mem))) {
+    return GwpAsanMallocUsableSize(mem);
+  }
   return Malloc(malloc_usable_size)(mem);
 }
 
@@ -186,6 +200,9 @@ extern "C" __attribute__((__noinline__)) void* realloc(void* old_mem, size_t byt
   if (__predict_false(dispatch_table != nullptr)) {
     return MaybeTagPointer(dispatch_table->realloc(old_mem, bytes));
   }
+  if (__predict_false(GwpAsanPointerIsMine(old_mem))) {
+    return MaybeTagPointer(GwpAsanRealloc(old_mem, bytes));
+  }
   void* result = Malloc(realloc)(old_mem, bytes);
   if (__predict_false(result == nullptr && bytes != 0)) {
     warning_log("realloc(%p, %zu) failed: returning null pointer", old_mem, bytes);
@@ -247,6 +264,17 @@ void CallbackWrapper(uintptr_t base, size_t size, void* arg) {
 // Exported for use by libmemunreachable.
 // =============================================================================
 
+// GWP-ASan samples from the fast paths above rather than as the current
+// dispatch table, but the heap walk has to know about its pool too, so that
+// uses GWP-ASan's table (the default one) when nothing else is installed.
+static const MallocDispatch* GetHeapWalkDispatchTable() {
+  auto dispatch_table = GetDispatchTable();
+  if (__predict_false(dispatch_table == nullptr && __libc_globals->gwp_asan_enabled)) {
+    dispatch_table = GetDefaultDispatchTable();
+  }
+  return dispatch_table;
+}
+
 // Calls callback for every allocation in the anonymous heap mapping
 // [base, base+size). Must be called between malloc_disable and malloc_enable.
 // `base` in this can take either a tagged or untagged pointer, but we always
@@ -254,7 +282,7 @@ void CallbackWrapper(uintptr_t base, size_t size, void* arg) {
 // supports tagged pointers.
 extern "C" int malloc_iterate(uintptr_t base, size_t size,
     void (*callback)(uintptr_t base, size_t size, void* arg), void* arg) {
-  auto dispatch_table = GetDispatchTable();
+  auto dispatch_table = GetHeapWalkDispatchTable();
   // Wrap the malloc_iterate callback we were provided, in order to provide
   // pointer tagging support.
   CallbackWrapperArg wrapper_arg;
@@ -273,7 +301,7 @@ extern "C" int malloc_iterate(uintptr_t base, size_t size,
 // Disable calls to malloc so malloc_iterate gets a consistent view of
 // allocated memory.
 extern "C" void malloc_disable() {
-  auto dispatch_table = GetDispatchTable();
+  auto dispatch_table = GetHeapWalkDispatchTable();
   if (__predict_false(dispatch_table != nullptr)) {
     return dispatch_table->malloc_disable();
   }
@@ -282,13 +310,103 @@ extern "C" void malloc_disable() {
 
 // Re-enable calls to malloc after a previous call to malloc_disable.
 extern "C" void malloc_enable() {
-  auto dispatch_table = GetDispatchTable();
+  auto dispatch_table = GetHeapWalkDispatchTable();
   if (__predict_false(dispatch_table != nullptr)) {
     return dispatch_table->malloc_enable();
   }
   return Malloc(malloc_enable)();
 }
 
+struct IncrementalIterateArg {
+  void (*callback)(uintptr_t base, size_t size, void* arg);
+  void* arg;
+  uint64_t generation;
+};
+
+static void IncrementalIterateCallback(uintptr_t base, size_t size, void* arg) {
+  IncrementalIterateArg* iterate_arg = reinterpret_cast<IncrementalIterateArg*>(arg);
+  if (iterate_arg->callback != nullptr) {
+    iterate_arg->callback(base, size, iterate_arg->arg);
+  }
+  // The generation is a sum of hashes of each allocation's address and size,
+  // so it doesn't depend on the order the allocator reports them in.
+  uint64_t h = (static_cast<uint64_t>(base) ^ (static_cast<uint64_t>(size) << 32)) *
+               0x9e3779b97f4a7c15ULL;
+  h ^= h >> 29;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  iterate_arg->generation += h ^ (h >> 32);
+}
+
+// Walks the chunk_index'th chunk of [base, base+size) with malloc disabled.
+static int IterateChunk(uintptr_t base, size_t size, size_t chunk_size, size_t chunk_index,
+                        IncrementalIterateArg* arg) {
+  size_t offset = chunk_index * chunk_size;
+  size_t length = size - offset < chunk_size ? size - offset : chunk_size;
+  malloc_disable();
+  int result = malloc_iterate(base + offset, length, IncrementalIterateCallback, arg);
+  malloc_enable();
+  return result;
+}
+
+// Both allocators report each allocation once, to the walk of the range that
+// contains its start, so the chunks split the allocations between them just
+// as separate mappings do. Only jemalloc limits the work to the range, though:
+// Scudo's iterateOverChunks() visits every block of every region and filters
+// by address afterwards, so splitting the range would cost a whole-heap walk
+// per chunk without making any one pause shorter.
+#if defined(USE_SCUDO)
+static constexpr bool kAllocatorWalksOnlyRange = false;
+#else
+static constexpr bool kAllocatorWalksOnlyRange = true;
+#endif
+
+extern "C" ssize_t android_malloc_iterate_incremental(
+    uintptr_t base, size_t size, size_t chunk_size,
+    void (*callback)(uintptr_t base, size_t size, void* arg), void* arg, bool verify) {
+  if (chunk_size == 0) {
+    errno = EINVAL;
+    return -1;
+  }
+  // Without a range-limited walk, one walk of the whole range is the cheapest.
+  if (!kAllocatorWalksOnlyRange && size != 0) chunk_size = size;
+  size_t chunk_count = size / chunk_size + (size % chunk_size != 0);
+
+  // The first pass's generations go in memory of our own, because allocating
+  // it would change the heap being checked.
+  uint64_t* generations = nullptr;
+  size_t generations_size = 0;
+  if (verify) {
+    generations_size = PAGE_END(chunk_count * sizeof(uint64_t));
+    void* map = mmap(nullptr, generations_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) return -1;
+    generations = reinterpret_cast<uint64_t*>(map);
+  }
+
+  ssize_t result = 0;
+  for (size_t i = 0; i < chunk_count; ++i) {
+    IncrementalIterateArg iterate_arg = {callback, arg, 0};
+    if (IterateChunk(base, size, chunk_size, i, &iterate_arg) != 0) {
+      result = -1;
+      break;
+    }
+    if (verify) generations[i] = iterate_arg.generation;
+  }
+  if (verify && result == 0) {
+    for (size_t i = 0; i < chunk_count; ++i) {
+      IncrementalIterateArg iterate_arg = {nullptr, nullptr, 0};
+      if (IterateChunk(base, size, chunk_size, i, &iterate_arg) != 0) {
+        result = -1;
+        break;
+      }
+      if (iterate_arg.generation != generations[i]) ++result;
+    }
+  }
+
+  if (generations != nullptr) munmap(generations, generations_size);
+  return result;
+}
+
 #if defined(LIBC_STATIC)
 extern "C" ssize_t malloc_backtrace(void*, uintptr_t*, size_t) {
   return 0;
@@ -76,8 +76,18 @@ __END_DECLS
 
 const MallocDispatch* NativeAllocatorDispatch();
 
+// Returns the dispatch table malloc and friends should call through, or null
+// to call the native allocator directly. Null is by far the common case, and
+// every allocation asks, so that case is just a plain load and a branch: the
+// acquire ordering needed to read the table is only paid for when there is
+// one. (An acquire load is an ldar rather than an ldr on arm64.)
 static inline const MallocDispatch* GetDispatchTable() {
-  return atomic_load_explicit(&__libc_globals->current_dispatch_table, memory_order_acquire);
+  const MallocDispatch* dispatch_table =
+      atomic_load_explicit(&__libc_globals->current_dispatch_table, memory_order_relaxed);
+  if (__predict_false(dispatch_table != nullptr)) {
+    atomic_thread_fence(memory_order_acquire);
+  }
+  return dispatch_table;
 }
 
 static inline const MallocDispatch* GetDefaultDispatchTable() {
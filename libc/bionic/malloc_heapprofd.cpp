@@ -403,7 +403,9 @@ extern "C" void* MallocInitHeapprofdHook(size_t bytes) {
         const MallocDispatch* previous_dispatch = atomic_load(&gPreviousDefaultDispatchTable);
         atomic_store(&globals->default_dispatch_table, previous_dispatch);
         if (!MallocLimitInstalled()) {
-          atomic_store(&globals->current_dispatch_table, previous_dispatch);
+          // GWP-ASan samples inline, so it's never the current dispatch table.
+          atomic_store(&globals->current_dispatch_table,
+                       DispatchIsGwpAsan(previous_dispatch) ? nullptr : previous_dispatch);
         }
       });
       atomic_store(&gHeapprofdState, kInitialState);
@@ -459,7 +461,9 @@ static bool DispatchReset() {
         const MallocDispatch* previous_dispatch = atomic_load(&gPreviousDefaultDispatchTable);
         atomic_store(&globals->default_dispatch_table, previous_dispatch);
         if (!MallocLimitInstalled()) {
-          atomic_store(&globals->current_dispatch_table, previous_dispatch);
+          // GWP-ASan samples inline, so it's never the current dispatch table.
+          atomic_store(&globals->current_dispatch_table,
+                       DispatchIsGwpAsan(previous_dispatch) ? nullptr : previous_dispatch);
         }
       });
       atomic_store(&gHeapprofdState, kInitialState);
@@ -76,6 +76,9 @@ class pthread_internal_t {
  public:
   bool is_vforked() { return vforked_; }
 
+  // For posix_spawn, whose CLONE_VM child runs on this thread's TLS just like a vfork child.
+  void set_vforked(bool value) { vforked_ = value; }
+
   pid_t invalidate_cached_pid() {
     pid_t old_value;
     get_cached_pid(&old_value);
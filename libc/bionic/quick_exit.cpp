@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+// The at_quick_exit() handlers, most recently registered first. quick_exit()
+// runs them, and so does exit() in fast exit mode (see exit.cpp).
+struct QuickExitHandler {
+  QuickExitHandler* next;
+  void (*fn)();
+};
+
+static pthread_mutex_t g_quick_exit_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Atomic(QuickExitHandler*) g_quick_exit_handlers = nullptr;
+
+int at_quick_exit(void (*fn)()) {
+  QuickExitHandler* handler = static_cast<QuickExitHandler*>(malloc(sizeof(QuickExitHandler)));
+  if (handler == nullptr) return 1;
+  handler->fn = fn;
+
+  pthread_mutex_lock(&g_quick_exit_lock);
+  handler->next = atomic_load_explicit(&g_quick_exit_handlers, memory_order_relaxed);
+  atomic_store_explicit(&g_quick_exit_handlers, handler, memory_order_release);
+  pthread_mutex_unlock(&g_quick_exit_lock);
+  return 0;
+}
+
+// Doesn't take the lock, so that a handler can register another (which isn't
+// run) rather than deadlock.
+extern "C" __LIBC_HIDDEN__ void __libc_run_quick_exit_handlers() {
+  for (QuickExitHandler* handler = atomic_load_explicit(&g_quick_exit_handlers,
+                                                        memory_order_acquire);
+       handler != nullptr; handler = handler->next) {
+    handler->fn();
+  }
+}
+
+void quick_exit(int status) {
+  __libc_run_quick_exit_handlers();
+  _Exit(status);
+}
@@ -23,9 +23,26 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <algorithm>
+
+#include "platform/bionic/dirent_batch.h"
 #include "platform/bionic/macros.h"
 #include "private/ScopedReaddir.h"
 
+// Entries are packed at dirent's alignment, since d_ino and d_off are 64-bit.
+static size_t AlignDirent(size_t size) {
+  return (size + alignof(dirent) - 1) & ~(alignof(dirent) - 1);
+}
+
+static void SortNames(dirent** names, size_t size,
+                      int (*comparator)(const dirent**, const dirent**)) {
+  // If we have entries and a comparator, sort them.
+  if (size > 0 && comparator != nullptr) {
+    qsort(names, size, sizeof(dirent*),
+          reinterpret_cast<int (*)(const void*, const void*)>(comparator));
+  }
+}
+
 // A smart pointer to the scandir dirent**.
 class ScandirResult {
  public:
@@ -33,8 +50,9 @@ class ScandirResult {
   }
 
   ~ScandirResult() {
-    // We always call release(), so this can't happen.
-    if (names_ != nullptr) __assert(__FILE__, __LINE__, "missing call to release()");
+    // Only reached with entries still held if the scan failed part way through.
+    for (size_t i = 0; i < size_; ++i) free(names_[i]);
+    free(names_);
   }
 
   size_t size() {
@@ -48,9 +66,9 @@ class ScandirResult {
     return result;
   }
 
-  bool Add(dirent* entry) {
+  bool Add(const dirent* entry) {
     if (size_ >= capacity_) {
-      size_t new_capacity = capacity_ + 32;
+      size_t new_capacity = std::max<size_t>(capacity_ * 2, 32);
       dirent** new_names =
           reinterpret_cast<dirent**>(realloc(names_, new_capacity * sizeof(dirent*)));
       if (new_names == nullptr) {
@@ -69,11 +87,7 @@ class ScandirResult {
   }
 
   void Sort(int (*comparator)(const dirent**, const dirent**)) {
-    // If we have entries and a comparator, sort them.
-    if (size_ > 0 && comparator != nullptr) {
-      qsort(names_, size_, sizeof(dirent*),
-            reinterpret_cast<int (*)(const void*, const void*)>(comparator));
-    }
+    SortNames(names_, size_, comparator);
   }
 
  private:
@@ -81,10 +95,13 @@ class ScandirResult {
   size_t size_;
   size_t capacity_;
 
-  static dirent* CopyDirent(dirent* original) {
+  static dirent* CopyDirent(const dirent* original) {
     // Allocate the minimum number of bytes necessary, rounded up to a 4-byte boundary.
     size_t size = ((original->d_reclen + 3) & ~3);
     dirent* copy = reinterpret_cast<dirent*>(malloc(size));
+    if (copy == nullptr) {
+      return nullptr;
+    }
     memcpy(copy, original, original->d_reclen);
     return copy;
   }
@@ -92,9 +109,74 @@ class ScandirResult {
   BIONIC_DISALLOW_COPY_AND_ASSIGN(ScandirResult);
 };
 
-int scandirat(int parent_fd, const char* dir_name, dirent*** name_list,
-              int (*filter)(const dirent*),
-              int (*comparator)(const dirent**, const dirent**)) {
+// The android_scandirat dirent**: the entries are packed into one growing buffer, and the pointer
+// array is put in front of them at the end, so the caller frees the lot with one free().
+class ScandirArena {
+ public:
+  ScandirArena() : data_(nullptr), used_(0), capacity_(0), size_(0) {
+  }
+
+  ~ScandirArena() {
+    free(data_);
+  }
+
+  size_t size() {
+    return size_;
+  }
+
+  // Returns nullptr if there isn't enough memory for the pointer array.
+  dirent** release() {
+    size_t index_size = AlignDirent(size_ * sizeof(dirent*));
+    char* result = reinterpret_cast<char*>(
+        realloc(data_, std::max(index_size + used_, sizeof(dirent*))));
+    if (result == nullptr) {
+      return nullptr;
+    }
+    data_ = nullptr;
+
+    memmove(result + index_size, result, used_);
+    dirent** names = reinterpret_cast<dirent**>(result);
+    char* next = result + index_size;
+    for (size_t i = 0; i < size_; ++i) {
+      names[i] = reinterpret_cast<dirent*>(next);
+      next += AlignDirent(names[i]->d_reclen);
+    }
+    used_ = capacity_ = size_ = 0;
+    return names;
+  }
+
+  bool Add(const dirent* entry) {
+    size_t entry_size = AlignDirent(entry->d_reclen);
+    if (used_ + entry_size > capacity_) {
+      size_t new_capacity = std::max<size_t>(capacity_ * 2, 16 * 1024);
+      new_capacity = std::max(new_capacity, used_ + entry_size);
+      char* new_data = reinterpret_cast<char*>(realloc(data_, new_capacity));
+      if (new_data == nullptr) {
+        return false;
+      }
+      data_ = new_data;
+      capacity_ = new_capacity;
+    }
+    memcpy(data_ + used_, entry, entry->d_reclen);
+    used_ += entry_size;
+    ++size_;
+    return true;
+  }
+
+ private:
+  char* data_;
+  size_t used_;
+  size_t capacity_;
+  size_t size_;
+
+  BIONIC_DISALLOW_COPY_AND_ASSIGN(ScandirArena);
+};
+
+// Adds each entry of the directory that `filter` accepts to `names`, a batch at a time. Returns
+// false with errno set if the directory can't be opened or read, or an entry can't be added.
+template <typename ResultT>
+static bool ScanDirectory(int parent_fd, const char* dir_name, int (*filter)(const dirent*),
+                          ResultT& names) {
   DIR* dir = nullptr;
   if (parent_fd == AT_FDCWD) {
     dir = opendir(dir_name);
@@ -107,17 +189,35 @@ int scandirat(int parent_fd, const char* dir_name, dirent*** name_list,
 
   ScopedReaddir reader(dir);
   if (reader.IsBad()) {
-    return -1;
+    return false;
   }
 
-  ScandirResult names;
-  dirent* entry;
-  while ((entry = reader.ReadEntry()) != nullptr) {
-    // If we have a filter, skip names that don't match.
-    if (filter != nullptr && !(*filter)(entry)) {
-      continue;
+  dirent* batch;
+  ssize_t batch_size;
+  while ((batch_size = reader.ReadBatch(&batch)) > 0) {
+    char* end = reinterpret_cast<char*>(batch) + batch_size;
+    for (char* p = reinterpret_cast<char*>(batch); p < end;) {
+      dirent* entry = reinterpret_cast<dirent*>(p);
+      p += entry->d_reclen;
+      // If we have a filter, skip names that don't match.
+      if (filter != nullptr && !(*filter)(entry)) {
+        continue;
+      }
+      if (!names.Add(entry)) {
+        errno = ENOMEM;
+        return false;
+      }
     }
-    names.Add(entry);
+  }
+  return batch_size == 0;
+}
+
+int scandirat(int parent_fd, const char* dir_name, dirent*** name_list,
+              int (*filter)(const dirent*),
+              int (*comparator)(const dirent**, const dirent**)) {
+  ScandirResult names;
+  if (!ScanDirectory(parent_fd, dir_name, filter, names)) {
+    return -1;
   }
 
   names.Sort(comparator);
@@ -134,3 +234,22 @@ int scandir(const char* dir_path, dirent*** name_list,
   return scandirat(AT_FDCWD, dir_path, name_list, filter, comparator);
 }
 __strong_alias(scandir64, scandir);
+
+int android_scandirat(int parent_fd, const char* dir_name, dirent*** name_list,
+                      int (*filter)(const dirent*),
+                      int (*comparator)(const dirent**, const dirent**)) {
+  ScandirArena names;
+  if (!ScanDirectory(parent_fd, dir_name, filter, names)) {
+    return -1;
+  }
+
+  size_t size = names.size();
+  dirent** result = names.release();
+  if (result == nullptr) {
+    errno = ENOMEM;
+    return -1;
+  }
+  SortNames(result, size, comparator);
+  *name_list = result;
+  return size;
+}
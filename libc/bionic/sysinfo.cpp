@@ -29,10 +29,13 @@
 #include <sys/sysinfo.h>
 
 #include <dirent.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
+#include "private/bionic_cpu_topology.h"
 #include "private/get_cpu_count_from_string.h"
 #include "private/ScopedReaddir.h"
 
@@ -62,7 +65,24 @@ int get_nprocs_conf() {
   return result;
 }
 
-int get_nprocs() {
+// Thread pools and the like call get_nprocs (or sysconf(_SC_NPROCESSORS_ONLN)) a lot, so rather
+// than read sysfs every time, the count is kept for a while. CPUs rarely come and go, and
+// android_cpu_topology_changed() drops the cached count when they do.
+static constexpr int64_t kNprocsCacheNs = 100'000'000;
+static atomic_int g_nprocs;
+static atomic_llong g_nprocs_expiry_ns;
+
+static int64_t CoarseNowNs() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+}
+
+void __invalidate_nprocs() {
+  atomic_store_explicit(&g_nprocs_expiry_ns, 0, memory_order_release);
+}
+
+static int read_nprocs() {
   int cpu_count = 1;
   FILE* fp = fopen("/sys/devices/system/cpu/online", "re");
   if (fp != nullptr) {
@@ -77,6 +97,17 @@ int get_nprocs() {
   return cpu_count;
 }
 
+int get_nprocs() {
+  int64_t now = CoarseNowNs();
+  if (now < atomic_load_explicit(&g_nprocs_expiry_ns, memory_order_acquire)) {
+    return atomic_load_explicit(&g_nprocs, memory_order_relaxed);
+  }
+  int cpu_count = read_nprocs();
+  atomic_store_explicit(&g_nprocs, cpu_count, memory_order_relaxed);
+  atomic_store_explicit(&g_nprocs_expiry_ns, now + kNprocsCacheNs, memory_order_release);
+  return cpu_count;
+}
+
 long get_phys_pages() {
   struct sysinfo si;
   sysinfo(&si);
@@ -42,6 +42,7 @@
  */
 void sethostent_r(FILE **);
 struct hostent	*netbsd_gethostent_r(FILE *, struct hostent *, char *, size_t, int *);
+struct hostent	*netbsd_gethostent_line(const char *, struct hostent *, char *, size_t, int *);
 void endhostent_r(FILE **);
 
 /*
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/*
+ * A process-wide index of _PATH_HOSTS, so that hosts file lookups are hash
+ * probes rather than a parse of the whole file.
+ *
+ * The index is built lazily from an mmap of the file the first time it is
+ * needed, and rebuilt whenever stat(2) reports a different device, inode,
+ * size or mtime. The file should be replaced by rename(2) rather than
+ * rewritten in place.
+ *
+ * Matching lines are handed to the callback one at a time, in file order,
+ * as a writable NUL-terminated copy (including the trailing '\n' or comment)
+ * that the callback is free to tokenize. The callback returns non-zero to
+ * stop the walk. Lines too long to fit in a hostent line buffer are skipped,
+ * as are lines with neither a newline nor a comment, as the stdio-based
+ * parsers always did.
+ */
+typedef int (*hc_line_callback)(char* line, void* arg);
+
+/*
+ * Calls |cb| for each line that lists |name| (compared case-insensitively)
+ * as its canonical name or as an alias. Returns 0 on success, or -1 if the
+ * hosts file couldn't be read.
+ */
+int hc_foreach_name(const char* name, hc_line_callback cb, void* arg);
+
+/*
+ * Calls |cb| for each line whose address is the |len|-byte address |addr|.
+ * The callback still needs to apply the af/length filters of the caller.
+ * Returns 0 on success, or -1 if the hosts file couldn't be read.
+ */
+int hc_foreach_addr(const void* addr, int len, hc_line_callback cb, void* arg);
+
+__END_DECLS
@@ -55,6 +55,19 @@ _resolv_cache_lookup( unsigned              netid,
                       int                   answersize,
                       int                  *answerlen );
 
+/* same as _resolv_cache_lookup, but instead of waiting for another
+ * thread's outstanding request for the same query to complete, return
+ * RESOLV_CACHE_UNSUPPORTED (as if the query couldn't be cached)
+ */
+__LIBC_HIDDEN__
+extern ResolvCacheStatus
+_resolv_cache_lookup_nowait( unsigned              netid,
+                             const void*           query,
+                             int                   querylen,
+                             void*                 answer,
+                             int                   answersize,
+                             int                  *answerlen );
+
 /* add a (query,answer) to the cache, only call if _resolv_cache_lookup
  * did return RESOLV_CACHE_NOTFOUND
  */
@@ -94,6 +94,33 @@ struct hostent *android_gethostbynamefornetcontext(const char *, int, const stru
 int android_getaddrinfofornetcontext(const char *, const char *, const struct addrinfo *,
     const struct android_net_context *, struct addrinfo **) __used_in_netd;
 
+/*
+ * One lookup in a batch passed to android_getaddrinfo_batchfornet{,context}().
+ * hostname, servname and hints are as for getaddrinfo(); res and error are
+ * set to its results, and res is to be freed with freeaddrinfo().
+ */
+struct android_getaddrinfo_request {
+    const char *hostname;
+    const char *servname;
+    const struct addrinfo *hints;
+    struct addrinfo *res;
+    int error;
+};
+
+/*
+ * Resolves every request in |reqs|, with the DNS queries for all of them in
+ * flight at once rather than one name after another.  The results are the
+ * same as from android_getaddrinfofornet{,context}(), except that a name
+ * none of whose queries gets a reply within |timeout_ms| fails with
+ * EAI_AGAIN, and a name only some of whose queries time out (AAAA on an
+ * IPv4-only network, say) gets the addresses that the others found.
+ * Returns the number of requests that succeeded.
+ */
+int android_getaddrinfo_batchfornet(struct android_getaddrinfo_request *, size_t, unsigned,
+    unsigned, int) __used_in_netd;
+int android_getaddrinfo_batchfornetcontext(struct android_getaddrinfo_request *, size_t,
+    const struct android_net_context *, int) __used_in_netd;
+
 /* set name servers for a network */
 extern int _resolv_set_nameservers_for_net(unsigned netid, const char** servers,
         unsigned numservers, const char *domains, const struct __res_params* params) __used_in_netd;
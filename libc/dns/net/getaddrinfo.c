@@ -93,6 +93,7 @@
 #include <errno.h>
 #include <netdb.h>
 #include "NetdClientDispatch.h"
+#include "hosts_cache.h"
 #include "resolv_cache.h"
 #include "resolv_netid.h"
 #include "resolv_private.h"
@@ -238,10 +239,9 @@ static int ip6_str2scopeid(char *, struct sockaddr_in6 *, u_int32_t *);
 static struct addrinfo *getanswer(const querybuf *, int, const char *, int,
 	const struct addrinfo *);
 static int _dns_getaddrinfo(void *, void *, va_list);
-static void _sethtent(FILE **);
-static void _endhtent(FILE **);
-static struct addrinfo *_gethtent(FILE **, const char *,
+static struct addrinfo *_gethtent(char *, const char *,
     const struct addrinfo *);
+static int _files_getaddrinfo_line(char *, void *);
 static int _files_getaddrinfo(void *, void *, va_list);
 static int _find_src_addr(const struct sockaddr *, struct sockaddr *, unsigned , uid_t);
 
@@ -792,6 +792,286 @@ android_getaddrinfofornetcontext(const char *hostname, const char *servname,
 	return error;
 }
 
+/*
+ * Batched lookups.
+ *
+ * Rather than a second resolver, the batch primes the resolver cache: the
+ * first DNS query that each name's lookup would send is built up front and
+ * every one that the cache can't answer is sent at once with
+ * res_nsend_batch(), sharing one socket per nameserver.  The answers go into
+ * the cache, and then each request is looked up normally, so the results are
+ * exactly those of android_getaddrinfofornetcontext().  Names that can't be
+ * primed (because they're in the hosts file, need a search domain beyond the
+ * first, were truncated or are already being looked up by another thread)
+ * just take the normal path.
+ */
+struct batch_query {
+	u_char buf[PACKETSZ];
+	int len;
+	size_t request;
+	u_int type;
+};
+
+/* What priming found out about each request. */
+#define BATCH_A		0x1
+#define BATCH_AAAA	0x2
+struct batch_result {
+	u_int wanted;		/* BATCH_A and/or BATCH_AAAA */
+	u_int timed_out;	/* the subset of those that got no reply */
+};
+
+static int
+batch_hosts_cb(char *line __unused, void *arg)
+{
+	*(int *)arg = 1;
+	return 1;
+}
+
+/*
+ * Returns true if |hostname| would be looked up in DNS at all, rather than
+ * parsed as a numeric address or found in the hosts file.
+ */
+static bool
+batch_wants_dns(const char *hostname, const struct addrinfo *hints)
+{
+	struct in_addr in;
+	int in_hosts = 0;
+
+	if (hostname == NULL || *hostname == '\0')
+		return false;
+	if (hints != NULL && (hints->ai_flags & AI_NUMERICHOST))
+		return false;
+	/* DNS names never contain ':' or '%', but numeric IPv6 addresses do. */
+	if (strpbrk(hostname, ":%") != NULL || inet_aton(hostname, &in))
+		return false;
+	hc_foreach_name(hostname, batch_hosts_cb, &in_hosts);
+	return !in_hosts;
+}
+
+/*
+ * Builds the first query that res_searchN() would send for |name|.  Returns
+ * its length, or -1 if there isn't one worth sending ahead of time.
+ */
+static int
+batch_mkquery(res_state res, const char *name, int type, u_char *buf, int buflen)
+{
+	char nbuf[MAXDNAME];
+	const char *cp;
+	u_int dots;
+	int n;
+
+	dots = 0;
+	for (cp = name; *cp; cp++)
+		dots += (*cp == '.');
+
+	if (cp[-1] == '.') {
+		/* res_querydomainN() drops the trailing dot. */
+		if ((size_t)(cp - name) > sizeof(nbuf))
+			return -1;
+		snprintf(nbuf, sizeof(nbuf), "%.*s", (int)(cp - name - 1), name);
+	} else if (!dots && __hostalias(name) != NULL) {
+		return -1;
+	} else if (dots < res->ndots &&
+	    (res->options & (dots ? RES_DNSRCH : RES_DEFNAMES)) &&
+	    res->dnsrch[0] != NULL) {
+		if (snprintf(nbuf, sizeof(nbuf), "%s.%s", name, res->dnsrch[0]) >=
+		    (int)sizeof(nbuf))
+			return -1;
+	} else {
+		if (strlcpy(nbuf, name, sizeof(nbuf)) >= sizeof(nbuf))
+			return -1;
+	}
+
+	n = res_nmkquery(res, QUERY, nbuf, C_IN, type, NULL, 0, NULL, buf, buflen);
+#ifdef RES_USE_EDNS0
+	if (n > 0 && (res->_flags & RES_F_EDNS0ERR) == 0 &&
+	    (res->options & (RES_USE_EDNS0|RES_USE_DNSSEC)) != 0)
+		n = res_nopt(res, n, buf, buflen, MAXPACKET);
+#endif
+	return n;
+}
+
+/*
+ * Sends the first DNS query of every request that needs one in a single
+ * round, and adds the answers to the cache.  results[i] records which record
+ * types request i looks up, and which of its queries got no reply at all in
+ * |timeout_ms|.
+ */
+static void
+batch_prime_cache(struct android_getaddrinfo_request *reqs, size_t count,
+    const struct android_net_context *netcontext, int timeout_ms,
+    struct batch_result *results)
+{
+	struct batch_query *queries;
+	const u_char **bufs;
+	u_char **answers;
+	int *lens, *anslens;
+	u_char ans[MAXPACKET];
+	res_state res;
+	size_t i, nq;
+	int anslen, fd;
+
+	/* netd does its own caching, and its own lookups. */
+	fd = __netdClientDispatch.dnsOpenProxy();
+	if (fd >= 0) {
+		close(fd);
+		return;
+	}
+	if (netcontext->qhook != NULL)
+		return;
+
+	res = __res_get_state();
+	if (res == NULL)
+		return;
+	res_setnetcontext(res, netcontext);
+	_resolv_populate_res_for_net(res);
+
+	queries = calloc(count * 2, sizeof(*queries));
+	bufs = calloc(count * 2, sizeof(*bufs));
+	lens = calloc(count * 2, sizeof(*lens));
+	answers = calloc(count * 2, sizeof(*answers));
+	anslens = calloc(count * 2, sizeof(*anslens));
+	if (res->nscount == 0 || queries == NULL || bufs == NULL || lens == NULL ||
+	    answers == NULL || anslens == NULL)
+		goto out;
+
+	nq = 0;
+	for (i = 0; i < count; i++) {
+		const struct addrinfo *hints = reqs[i].hints;
+		int family = hints ? hints->ai_family : AF_UNSPEC;
+		int types[2], ntypes = 0, t;
+
+		if (!batch_wants_dns(reqs[i].hostname, hints))
+			continue;
+		/* Same order as _dns_getaddrinfo(). */
+		if (family == AF_UNSPEC) {
+			bool addrconfig = hints && (hints->ai_flags & AI_ADDRCONFIG);
+			if (!addrconfig || _have_ipv6(netcontext->app_mark, netcontext->uid))
+				types[ntypes++] = T_AAAA;
+			if (!addrconfig || _have_ipv4(netcontext->app_mark, netcontext->uid))
+				types[ntypes++] = T_A;
+		} else if (family == AF_INET6) {
+			types[ntypes++] = T_AAAA;
+		} else if (family == AF_INET) {
+			types[ntypes++] = T_A;
+		}
+
+		for (t = 0; t < ntypes; t++) {
+			struct batch_query *q = &queries[nq];
+
+			q->type = (types[t] == T_A) ? BATCH_A : BATCH_AAAA;
+			results[i].wanted |= q->type;
+			q->len = batch_mkquery(res, reqs[i].hostname, types[t], q->buf,
+			    sizeof(q->buf));
+			if (q->len <= 0)
+				continue;
+			/*
+			 * A miss makes us responsible for the query: it has to be
+			 * either added or failed, or other threads asking the same
+			 * question will wait.  Queries that another thread (or an
+			 * earlier request in this batch) is already sending are
+			 * left alone, rather than waiting for them here.
+			 */
+			if (_resolv_cache_lookup_nowait(res->netid, q->buf, q->len, ans,
+			    sizeof(ans), &anslen) != RESOLV_CACHE_NOTFOUND)
+				continue;
+			q->request = i;
+			bufs[nq] = q->buf;
+			lens[nq] = q->len;
+			nq++;
+		}
+	}
+	if (nq == 0)
+		goto out;
+
+	res_nsend_batch(res, bufs, lens, answers, MAXPACKET, anslens, (int)nq,
+	    timeout_ms);
+
+	for (i = 0; i < nq; i++) {
+		if (anslens[i] > 0) {
+			_resolv_cache_add(res->netid, bufs[i], lens[i], answers[i],
+			    anslens[i]);
+		} else {
+			_resolv_cache_query_failed(res->netid, bufs[i], lens[i]);
+			if (anslens[i] == 0)
+				results[queries[i].request].timed_out |= queries[i].type;
+		}
+		free(answers[i]);
+	}
+out:
+	free(queries);
+	free(bufs);
+	free(lens);
+	free(answers);
+	free(anslens);
+	__res_put_state(res);
+}
+
+int
+android_getaddrinfo_batchfornet(struct android_getaddrinfo_request *reqs,
+    size_t count, unsigned netid, unsigned mark, int timeout_ms)
+{
+	struct android_net_context netcontext = {
+		.app_netid = netid,
+		.app_mark = mark,
+		.dns_netid = netid,
+		.dns_mark = mark,
+		.uid = NET_CONTEXT_INVALID_UID,
+	};
+	return android_getaddrinfo_batchfornetcontext(reqs, count, &netcontext,
+	    timeout_ms);
+}
+
+int
+android_getaddrinfo_batchfornetcontext(struct android_getaddrinfo_request *reqs,
+    size_t count, const struct android_net_context *netcontext, int timeout_ms)
+{
+	struct batch_result *results;
+	size_t i;
+	int resolved = 0;
+
+	assert(reqs != NULL || count == 0);
+	assert(netcontext != NULL);
+
+	results = calloc(count ? count : 1, sizeof(*results));
+	if (results != NULL)
+		batch_prime_cache(reqs, count, netcontext, timeout_ms, results);
+
+	for (i = 0; i < count; i++) {
+		const struct addrinfo *hints = reqs[i].hints;
+		struct addrinfo narrowed;
+
+		reqs[i].res = NULL;
+		if (results != NULL && results[i].timed_out != 0) {
+			/*
+			 * Don't start a query that timed out again from scratch:
+			 * we're out of time.  If every query timed out, so does the
+			 * request; otherwise, like the serial path when one of its
+			 * queries times out, it gets whatever the others found.
+			 */
+			if (results[i].timed_out == results[i].wanted) {
+				reqs[i].error = EAI_AGAIN;
+				continue;
+			}
+			if (hints != NULL)
+				narrowed = *hints;
+			else
+				memset(&narrowed, 0, sizeof(narrowed));
+			narrowed.ai_family =
+			    (results[i].timed_out & BATCH_A) ? AF_INET6 : AF_INET;
+			hints = &narrowed;
+		}
+		reqs[i].error = android_getaddrinfofornetcontext(reqs[i].hostname,
+		    reqs[i].servname, hints, netcontext, &reqs[i].res);
+		if (reqs[i].error == 0)
+			resolved++;
+		else if (hints == &narrowed)
+			reqs[i].error = EAI_AGAIN;
+	}
+	free(results);
+	return resolved;
+}
+
 /*
  * FQDN hostname, DNS lookup
  */
@@ -2026,52 +2306,30 @@ _dns_getaddrinfo(void *rv, void	*cb_data, va_list ap)
 	return NS_SUCCESS;
 }
 
-static void
-_sethtent(FILE **hostf)
-{
-
-	if (!*hostf)
-		*hostf = fopen(_PATH_HOSTS, "re");
-	else
-		rewind(*hostf);
-}
-
-static void
-_endhtent(FILE **hostf)
-{
-
-	if (*hostf) {
-		(void) fclose(*hostf);
-		*hostf = NULL;
-	}
-}
-
+/*
+ * Parses one hosts file line, as handed out by the hosts cache, and returns
+ * its addresses if it lists |name|.
+ */
 static struct addrinfo *
-_gethtent(FILE **hostf, const char *name, const struct addrinfo *pai)
+_gethtent(char *p, const char *name, const struct addrinfo *pai)
 {
-	char *p;
 	char *cp, *tname, *cname;
 	struct addrinfo hints, *res0, *res;
 	int error;
 	const char *addr;
-	char hostbuf[8*1024];
 
 //	fprintf(stderr, "_gethtent() name = '%s'\n", name);
+	assert(p != NULL);
 	assert(name != NULL);
 	assert(pai != NULL);
 
-	if (!*hostf && !(*hostf = fopen(_PATH_HOSTS, "re")))
-		return (NULL);
- again:
-	if (!(p = fgets(hostbuf, sizeof hostbuf, *hostf)))
-		return (NULL);
 	if (*p == '#')
-		goto again;
+		return (NULL);
 	if (!(cp = strpbrk(p, "#\n")))
-		goto again;
+		return (NULL);
 	*cp = '\0';
 	if (!(cp = strpbrk(p, " \t")))
-		goto again;
+		return (NULL);
 	*cp++ = '\0';
 	addr = p;
 	/* if this is not something we're looking for, skip it. */
@@ -2090,14 +2348,14 @@ _gethtent(FILE **hostf, const char *name, const struct addrinfo *pai)
 		if (strcasecmp(name, tname) == 0)
 			goto found;
 	}
-	goto again;
+	return (NULL);
 
 found:
 	hints = *pai;
 	hints.ai_flags = AI_NUMERICHOST;
 	error = getaddrinfo(addr, NULL, &hints, &res0);
 	if (error)
-		goto again;
+		return (NULL);
 	for (res = res0; res; res = res->ai_next) {
 		/* cover it up */
 		res->ai_flags = pai->ai_flags;
@@ -2105,37 +2363,48 @@ found:
 		if (pai->ai_flags & AI_CANONNAME) {
 			if (get_canonname(pai, res, cname) != 0) {
 				freeaddrinfo(res0);
-				goto again;
+				return (NULL);
 			}
 		}
 	}
 	return res0;
 }
 
+struct files_getaddrinfo_state {
+	const char *name;
+	const struct addrinfo *pai;
+	struct addrinfo *cur;
+};
+
+static int
+_files_getaddrinfo_line(char *line, void *arg)
+{
+	struct files_getaddrinfo_state *state = arg;
+	struct addrinfo *p;
+
+	if ((p = _gethtent(line, state->name, state->pai)) != NULL) {
+		state->cur->ai_next = p;
+		while (state->cur && state->cur->ai_next)
+			state->cur = state->cur->ai_next;
+	}
+	return 0;
+}
+
 /*ARGSUSED*/
 static int
 _files_getaddrinfo(void *rv, void *cb_data, va_list ap)
 {
-	const char *name;
-	const struct addrinfo *pai;
-	struct addrinfo sentinel, *cur;
-	struct addrinfo *p;
-	FILE *hostf = NULL;
+	struct files_getaddrinfo_state state;
+	struct addrinfo sentinel;
 
-	name = va_arg(ap, char *);
-	pai = va_arg(ap, struct addrinfo *);
+	state.name = va_arg(ap, char *);
+	state.pai = va_arg(ap, struct addrinfo *);
 
-//	fprintf(stderr, "_files_getaddrinfo() name = '%s'\n", name);
+//	fprintf(stderr, "_files_getaddrinfo() name = '%s'\n", state.name);
 	memset(&sentinel, 0, sizeof(sentinel));
-	cur = &sentinel;
+	state.cur = &sentinel;
 
-	_sethtent(&hostf);
-	while ((p = _gethtent(&hostf, name, pai)) != NULL) {
-		cur->ai_next = p;
-		while (cur && cur->ai_next)
-			cur = cur->ai_next;
-	}
-	_endhtent(&hostf);
+	hc_foreach_name(state.name, _files_getaddrinfo_line, &state);
 
 	*((struct addrinfo **)rv) = sentinel.ai_next;
 	if (sentinel.ai_next == NULL)
@@ -924,8 +924,26 @@ android_gethostbyaddrfornetcontext_proxy_internal(const void* addr, socklen_t le
 	return result;
 }
 
-struct hostent*
-netbsd_gethostent_r(FILE *hf, struct hostent *hent, char *buf, size_t buflen, int *he)
+/*
+ * Reads the next hosts file line into |p|: from |hf| if it's non-NULL, and
+ * otherwise from the single pre-read line in |*line|, which is consumed.
+ */
+static char *
+hostent_next_line(FILE *hf, const char **line, char *p, size_t size)
+{
+	if (hf != NULL)
+		return fgets(p, size, hf);
+	if (*line == NULL)
+		return NULL;
+	if (strlcpy(p, *line, size) >= size)
+		p = NULL;
+	*line = NULL;
+	return p;
+}
+
+static struct hostent*
+gethostent_r_internal(FILE *hf, const char *line, struct hostent *hent, char *buf, size_t buflen,
+    int *he)
 {
 	char *p, *name;
 	char *cp, **q;
@@ -935,11 +953,6 @@ netbsd_gethostent_r(FILE *hf, struct hostent *hent, char *buf, size_t buflen, in
 	size_t maxaliases;
 	struct in6_addr host_addr;
 
-	if (hf == NULL) {
-		*he = NETDB_INTERNAL;
-		errno = EINVAL;
-		return NULL;
-	}
 	p = NULL;
 	setup(aliases, maxaliases);
 
@@ -953,7 +966,7 @@ netbsd_gethostent_r(FILE *hf, struct hostent *hent, char *buf, size_t buflen, in
 	  goto nospc;
 	}
 	for (;;) {
-		if (!fgets(p, line_buf_size, hf)) {
+		if (!hostent_next_line(hf, &line, p, line_buf_size)) {
 			free(p);
 			free(aliases);
 			*he = HOST_NOT_FOUND;
@@ -1038,6 +1051,23 @@ nospc:
 	return NULL;
 }
 
+struct hostent*
+netbsd_gethostent_r(FILE *hf, struct hostent *hent, char *buf, size_t buflen, int *he)
+{
+	if (hf == NULL) {
+		*he = NETDB_INTERNAL;
+		errno = EINVAL;
+		return NULL;
+	}
+	return gethostent_r_internal(hf, NULL, hent, buf, buflen, he);
+}
+
+struct hostent*
+netbsd_gethostent_line(const char *line, struct hostent *hent, char *buf, size_t buflen, int *he)
+{
+	return gethostent_r_internal(NULL, line, hent, buf, buflen, he);
+}
+
 static void
 map_v4v6_address(const char *src, char *dst)
 {
@@ -29,12 +29,15 @@
 #include <netdb.h>
 
 #include <endian.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "resolv_static.h"
 #include "services.h"
 
+#define NELEM(a) (sizeof(a) / sizeof((a)[0]))
+
 struct servent* getservent_r(struct res_static* rs) {
     const char*  p;
     const char*  q;
@@ -118,34 +121,117 @@ struct servent* getservent(void) {
   return rs ? getservent_r(rs) : NULL;
 }
 
+// Must match services_hash() in libc/tools/genserv.py, which generates the
+// perfect hash tables in services.h.
+static uint32_t services_hash(uint32_t seed, const void* key, size_t key_len, char proto) {
+  const unsigned char* p = key;
+  uint32_t h = 2166136261u ^ seed;
+  for (size_t i = 0; i < key_len; ++i) {
+    h ^= p[i];
+    h *= 16777619u;
+  }
+  h ^= (unsigned char) proto;
+  h *= 16777619u;
+  h ^= h >> 16;
+  h *= 0x85ebca6bu;
+  h ^= h >> 13;
+  return h;
+}
+
+// Returns the only record that could have the given key, which the caller must still check.
+static const char* services_lookup(const uint16_t* seeds, size_t seed_count,
+                                   const uint16_t* slots, size_t slot_count,
+                                   const void* key, size_t key_len, char proto) {
+  uint32_t seed = seeds[services_hash(0, key, key_len, proto) % seed_count];
+  return _services + slots[services_hash(seed, key, key_len, proto) % slot_count];
+}
+
+static const char* services_find_name(const char* name, size_t name_len, char proto) {
+  const char* p = services_lookup(_services_name_seeds, NELEM(_services_name_seeds),
+                                  _services_name_slots, NELEM(_services_name_slots),
+                                  name, name_len, proto);
+  size_t len = (unsigned char) p[0];
+  if (len != name_len || memcmp(p + 1, name, len) != 0 || p[1 + len + 2] != proto) return NULL;
+  return p;
+}
+
+static const char* services_find_port(const unsigned char port[2], char proto) {
+  const char* p = services_lookup(_services_port_seeds, NELEM(_services_port_seeds),
+                                  _services_port_slots, NELEM(_services_port_slots),
+                                  port, 2, proto);
+  size_t len = (unsigned char) p[0];
+  if (memcmp(p + 1 + len, port, 2) != 0 || p[1 + len + 2] != proto) return NULL;
+  return p;
+}
+
+// Both lookups return the first matching record in _services, so with a NULL
+// proto we take whichever of the tcp and udp records comes first.
+static const char* services_first(const char* tcp, const char* udp) {
+  if (tcp == NULL) return udp;
+  if (udp == NULL) return tcp;
+  return (tcp < udp) ? tcp : udp;
+}
+
+static struct servent* services_servent(struct res_static* rs, const char* record) {
+  if (record == NULL) return NULL;
+
+  const char* old_servent_ptr = rs->servent_ptr;
+  rs->servent_ptr = record;
+  struct servent* s = getservent_r(rs);
+  rs->servent_ptr = old_servent_ptr;
+  return s;
+}
+
+static int services_proto(const char* proto, char* proto_char) {
+  if (proto == NULL) {
+    *proto_char = 0;
+  } else if (strcmp(proto, "tcp") == 0) {
+    *proto_char = 't';
+  } else if (strcmp(proto, "udp") == 0) {
+    *proto_char = 'u';
+  } else {
+    return -1;
+  }
+  return 0;
+}
+
 struct servent* getservbyname(const char* name, const char* proto) {
   struct res_static* rs = __res_get_static();
   if (rs == NULL) return NULL;
 
-  const char* old_servent_ptr = rs->servent_ptr;
-  rs->servent_ptr = NULL;
-  struct servent* s;
-  while ((s = getservent_r(rs)) != NULL) {
-    if (strcmp(s->s_name, name) == 0 && (proto == NULL || strcmp(s->s_proto, proto) == 0)) {
-      break;
-    }
+  char proto_char;
+  if (services_proto(proto, &proto_char) == -1) return NULL;
+
+  size_t name_len = strlen(name);
+  if (name_len > 255) return NULL;
+
+  const char* record;
+  if (proto_char != 0) {
+    record = services_find_name(name, name_len, proto_char);
+  } else {
+    record = services_first(services_find_name(name, name_len, 't'),
+                            services_find_name(name, name_len, 'u'));
   }
-  rs->servent_ptr = old_servent_ptr;
-  return s;
+  return services_servent(rs, record);
 }
 
 struct servent* getservbyport(int port, const char* proto) {
   struct res_static* rs = __res_get_static();
   if (rs == NULL) return NULL;
 
-  const char* old_servent_ptr = rs->servent_ptr;
-  rs->servent_ptr = NULL;
-  struct servent* s;
-  while ((s = getservent_r(rs)) != NULL) {
-    if (s->s_port == port && (proto == NULL || strcmp(s->s_proto, proto) == 0)) {
-      break;
-    }
+  char proto_char;
+  if (services_proto(proto, &proto_char) == -1) return NULL;
+
+  // s_port is in network byte order, so that's how the caller passes it too.
+  if (port < 0 || port > 0xffff) return NULL;
+  uint16_t host_port = ntohs((uint16_t) port);
+  unsigned char key[2] = { (unsigned char) (host_port >> 8), (unsigned char) host_port };
+
+  const char* record;
+  if (proto_char != 0) {
+    record = services_find_port(key, proto_char);
+  } else {
+    record = services_first(services_find_port(key, 't'), services_find_port(key, 'u'));
   }
-  rs->servent_ptr = old_servent_ptr;
-  return s;
+  return services_servent(rs, record);
 }
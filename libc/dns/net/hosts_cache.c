@@ -0,0 +1,410 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "hosts_cache.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+/* The stdio-based parsers read lines with fgets into an 8KiB buffer. */
+#define HC_LINE_MAX	(8 * 1024)
+
+#define HC_NONE		UINT32_MAX
+
+struct hc_line {
+	uint32_t offset;
+	uint32_t length;
+};
+
+struct hc_name {
+	uint32_t hash;
+	uint32_t next;
+	uint32_t line;
+	uint32_t offset;
+	uint32_t length;
+};
+
+struct hc_addr {
+	uint32_t hash;
+	uint32_t next;
+	uint32_t line;
+	uint32_t length;
+	unsigned char bytes[sizeof(struct in6_addr)];
+};
+
+struct hc_snapshot {
+	int refs;
+
+	dev_t dev;
+	ino_t ino;
+	off_t size;
+	struct timespec mtime;
+
+	char* map;
+	size_t map_size;
+
+	struct hc_line* lines;
+	uint32_t line_count;
+
+	struct hc_name* names;
+	uint32_t name_count;
+	uint32_t* name_buckets;
+	uint32_t name_bucket_count;
+
+	struct hc_addr* addrs;
+	uint32_t addr_count;
+	uint32_t* addr_buckets;
+	uint32_t addr_bucket_count;
+};
+
+static pthread_mutex_t g_hc_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct hc_snapshot* g_hc_current;
+
+static uint32_t
+hc_hash_name(const char* s, size_t n)
+{
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < n; ++i) {
+		h ^= (unsigned char)tolower((unsigned char)s[i]);
+		h *= 16777619u;
+	}
+	return h;
+}
+
+static uint32_t
+hc_hash_addr(const void* p, size_t n)
+{
+	const unsigned char* s = p;
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < n; ++i) {
+		h ^= s[i];
+		h *= 16777619u;
+	}
+	return h;
+}
+
+static int
+hc_grow(void** array, uint32_t* capacity, uint32_t count, size_t element_size)
+{
+	if (count < *capacity)
+		return 0;
+	uint32_t new_capacity = *capacity ? *capacity * 2 : 64;
+	void* p = realloc(*array, new_capacity * element_size);
+	if (p == NULL)
+		return -1;
+	*array = p;
+	*capacity = new_capacity;
+	return 0;
+}
+
+static uint32_t*
+hc_make_buckets(uint32_t entry_count, uint32_t* bucket_count)
+{
+	uint32_t n = 16;
+	while (n < entry_count)
+		n *= 2;
+	uint32_t* buckets = malloc(n * sizeof(*buckets));
+	if (buckets == NULL)
+		return NULL;
+	memset(buckets, 0xff, n * sizeof(*buckets));
+	*bucket_count = n;
+	return buckets;
+}
+
+static void
+hc_snapshot_free(struct hc_snapshot* s)
+{
+	if (s->map != NULL)
+		munmap(s->map, s->map_size);
+	free(s->lines);
+	free(s->names);
+	free(s->name_buckets);
+	free(s->addrs);
+	free(s->addr_buckets);
+	free(s);
+}
+
+/*
+ * Indexes every line of the mapped file that the stdio-based parsers would
+ * have considered, by each distinct name on the line and by its address.
+ */
+static int
+hc_snapshot_index(struct hc_snapshot* s)
+{
+	uint32_t line_capacity = 0, name_capacity = 0, addr_capacity = 0;
+	const char* map = s->map;
+	size_t pos = 0;
+
+	while (pos < s->map_size) {
+		const char* start = map + pos;
+		const char* nl = memchr(start, '\n', s->map_size - pos);
+		size_t length = nl ? (size_t)(nl - start) + 1 : s->map_size - pos;
+		pos += length;
+
+		if (length >= HC_LINE_MAX || *start == '#')
+			continue;
+
+		/* Both parsers ignore lines with neither a comment nor a newline. */
+		const char* end = start;
+		while (end < start + length && *end != '#' && *end != '\n')
+			end++;
+		if (end == start + length)
+			continue;
+
+		const char* cp = start;
+		while (cp < end && *cp != ' ' && *cp != '\t')
+			cp++;
+		if (cp == end)
+			continue;
+
+		uint32_t line = s->line_count;
+		if (hc_grow((void**)&s->lines, &line_capacity, s->line_count, sizeof(*s->lines)) == -1)
+			return -1;
+		s->lines[line].offset = (uint32_t)(start - map);
+		s->lines[line].length = (uint32_t)length;
+		s->line_count++;
+
+		char addr_text[INET6_ADDRSTRLEN + 1];
+		size_t addr_length = (size_t)(cp - start);
+		if (addr_length < sizeof(addr_text)) {
+			struct hc_addr a;
+			memcpy(addr_text, start, addr_length);
+			addr_text[addr_length] = '\0';
+			if (inet_pton(AF_INET6, addr_text, a.bytes) > 0) {
+				a.length = sizeof(struct in6_addr);
+			} else if (inet_pton(AF_INET, addr_text, a.bytes) > 0) {
+				a.length = sizeof(struct in_addr);
+			} else {
+				a.length = 0;
+			}
+			if (a.length != 0) {
+				if (hc_grow((void**)&s->addrs, &addr_capacity, s->addr_count, sizeof(*s->addrs)) == -1)
+					return -1;
+				a.hash = hc_hash_addr(a.bytes, a.length);
+				a.line = line;
+				s->addrs[s->addr_count++] = a;
+			}
+		}
+
+		uint32_t first_name = s->name_count;
+		while (cp < end) {
+			if (*cp == ' ' || *cp == '\t') {
+				cp++;
+				continue;
+			}
+			const char* token = cp;
+			while (cp < end && *cp != ' ' && *cp != '\t')
+				cp++;
+			uint32_t token_length = (uint32_t)(cp - token);
+			uint32_t hash = hc_hash_name(token, token_length);
+
+			/* A line is reported once however many times it names the host. */
+			int duplicate = 0;
+			for (uint32_t i = first_name; i < s->name_count; ++i) {
+				struct hc_name* n = &s->names[i];
+				if (n->hash == hash && n->length == token_length &&
+				    strncasecmp(map + n->offset, token, token_length) == 0) {
+					duplicate = 1;
+					break;
+				}
+			}
+			if (duplicate)
+				continue;
+
+			if (hc_grow((void**)&s->names, &name_capacity, s->name_count, sizeof(*s->names)) == -1)
+				return -1;
+			struct hc_name* n = &s->names[s->name_count++];
+			n->hash = hash;
+			n->line = line;
+			n->offset = (uint32_t)(token - map);
+			n->length = token_length;
+		}
+	}
+
+	/* Chain in reverse so that each bucket lists its lines in file order. */
+	s->name_buckets = hc_make_buckets(s->name_count, &s->name_bucket_count);
+	s->addr_buckets = hc_make_buckets(s->addr_count, &s->addr_bucket_count);
+	if (s->name_buckets == NULL || s->addr_buckets == NULL)
+		return -1;
+	for (uint32_t i = s->name_count; i-- > 0;) {
+		uint32_t* b = &s->name_buckets[s->names[i].hash & (s->name_bucket_count - 1)];
+		s->names[i].next = *b;
+		*b = i;
+	}
+	for (uint32_t i = s->addr_count; i-- > 0;) {
+		uint32_t* b = &s->addr_buckets[s->addrs[i].hash & (s->addr_bucket_count - 1)];
+		s->addrs[i].next = *b;
+		*b = i;
+	}
+	return 0;
+}
+
+static struct hc_snapshot*
+hc_snapshot_load(void)
+{
+	int fd = open(_PATH_HOSTS, O_RDONLY | O_CLOEXEC);
+	if (fd == -1)
+		return NULL;
+
+	struct hc_snapshot* s = calloc(1, sizeof(*s));
+	struct stat sb;
+	if (s == NULL || fstat(fd, &sb) == -1 || (uint64_t)sb.st_size > UINT32_MAX)
+		goto fail;
+	s->dev = sb.st_dev;
+	s->ino = sb.st_ino;
+	s->size = sb.st_size;
+	s->mtime = sb.st_mtim;
+
+	if (sb.st_size > 0) {
+		void* map = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map == MAP_FAILED)
+			goto fail;
+		s->map = map;
+		s->map_size = (size_t)sb.st_size;
+	}
+	close(fd);
+	fd = -1;
+
+	if (hc_snapshot_index(s) == -1)
+		goto fail;
+	s->refs = 1;
+	return s;
+
+fail:
+	if (fd != -1)
+		close(fd);
+	if (s != NULL)
+		hc_snapshot_free(s);
+	return NULL;
+}
+
+static void
+hc_snapshot_put_locked(struct hc_snapshot* s)
+{
+	if (--s->refs == 0)
+		hc_snapshot_free(s);
+}
+
+/* Returns a referenced snapshot that matches the file currently on disk. */
+static struct hc_snapshot*
+hc_snapshot_get(void)
+{
+	struct stat sb;
+	int have_stat = stat(_PATH_HOSTS, &sb) == 0;
+
+	pthread_mutex_lock(&g_hc_lock);
+	struct hc_snapshot* s = g_hc_current;
+	if (s != NULL && (!have_stat || s->dev != sb.st_dev || s->ino != sb.st_ino ||
+	    s->size != sb.st_size || s->mtime.tv_sec != sb.st_mtim.tv_sec ||
+	    s->mtime.tv_nsec != sb.st_mtim.tv_nsec)) {
+		g_hc_current = NULL;
+		hc_snapshot_put_locked(s);
+		s = NULL;
+	}
+	if (s == NULL && have_stat) {
+		s = g_hc_current = hc_snapshot_load();
+	}
+	if (s != NULL)
+		s->refs++;
+	pthread_mutex_unlock(&g_hc_lock);
+	return s;
+}
+
+static void
+hc_snapshot_put(struct hc_snapshot* s)
+{
+	pthread_mutex_lock(&g_hc_lock);
+	hc_snapshot_put_locked(s);
+	pthread_mutex_unlock(&g_hc_lock);
+}
+
+/* Copies a line into |buf| for the callback; the mapping is read-only. */
+static int
+hc_call(const struct hc_snapshot* s, uint32_t line, char* buf, hc_line_callback cb, void* arg)
+{
+	const struct hc_line* l = &s->lines[line];
+	memcpy(buf, s->map + l->offset, l->length);
+	buf[l->length] = '\0';
+	return cb(buf, arg);
+}
+
+int
+hc_foreach_name(const char* name, hc_line_callback cb, void* arg)
+{
+	struct hc_snapshot* s = hc_snapshot_get();
+	if (s == NULL)
+		return -1;
+
+	char buf[HC_LINE_MAX];
+	size_t length = strlen(name);
+	uint32_t hash = hc_hash_name(name, length);
+	for (uint32_t i = s->name_buckets[hash & (s->name_bucket_count - 1)]; i != HC_NONE;
+	     i = s->names[i].next) {
+		const struct hc_name* n = &s->names[i];
+		if (n->hash == hash && n->length == length &&
+		    strncasecmp(s->map + n->offset, name, length) == 0 &&
+		    hc_call(s, n->line, buf, cb, arg) != 0)
+			break;
+	}
+
+	hc_snapshot_put(s);
+	return 0;
+}
+
+int
+hc_foreach_addr(const void* addr, int len, hc_line_callback cb, void* arg)
+{
+	struct hc_snapshot* s = hc_snapshot_get();
+	if (s == NULL)
+		return -1;
+
+	char buf[HC_LINE_MAX];
+	uint32_t hash = hc_hash_addr(addr, (size_t)len);
+	for (uint32_t i = s->addr_buckets[hash & (s->addr_bucket_count - 1)]; i != HC_NONE;
+	     i = s->addrs[i].next) {
+		const struct hc_addr* a = &s->addrs[i];
+		if (a->hash == hash && a->length == (uint32_t)len &&
+		    memcmp(a->bytes, addr, a->length) == 0 &&
+		    hc_call(s, a->line, buf, cb, arg) != 0)
+			break;
+	}
+
+	hc_snapshot_put(s);
+	return 0;
+}
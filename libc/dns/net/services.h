@@ -547,3 +547,185 @@ static const char  _services[] = "\
 \4fido\353\23t\0\
 \0";
 
+/* offsets into _services, keyed by (name, proto) and by (port, proto) */
+static const uint16_t _services_name_seeds[137] = {
+  109, 118, 69, 1, 94, 2, 20, 1,
+  23, 3, 197, 43, 9, 399, 133, 7,
+  15, 8, 15, 8, 3, 44, 5, 23,
+  6, 5, 67, 3, 50, 1, 147, 15,
+  145, 60, 3, 1, 131, 138, 31, 37,
+  77, 1, 5, 3, 37, 84, 9, 272,
+  3, 278, 3, 1, 7, 65, 5, 946,
+  61, 14, 2, 58, 37, 32, 1, 19,
+  5, 102, 0, 24, 9, 4, 4, 5,
+  550, 137, 1, 2, 19, 32, 9, 848,
+  4, 376, 66, 6, 262, 87, 4, 2,
+  11, 551, 40, 12, 1, 1, 14, 2,
+  98, 335, 10, 49, 2, 690, 1151, 764,
+  620, 158, 863, 211, 183, 895, 1051, 1288,
+  29, 266, 35, 504, 816, 3, 272, 280,
+  1, 4, 141, 860, 1, 302, 29, 0,
+  11, 389, 15, 1406, 177, 94, 784, 87,
+  397,
+};
+static const uint16_t _services_name_slots[545] = {
+  3004, 6164, 3768, 7347, 5807, 6518, 1655, 5462,
+  2872, 7297, 6200, 1241, 1943, 7219, 1554, 6818,
+  6034, 157, 2021, 934, 7106, 5312, 3269, 6352,
+  6873, 819, 114, 3258, 3183, 1702, 2030, 3099,
+  3211, 1730, 7198, 1906, 6900, 743, 6956, 5676,
+  2984, 3332, 473, 414, 2097, 4774, 1882, 1074,
+  7186, 520, 183, 4253, 1333, 7473, 7230, 1147,
+  284, 6134, 1589, 2559, 4367, 4025, 7285, 7392,
+  3051, 6778, 5101, 5797, 7309, 4576, 7499, 4613,
+  1058, 3630, 3665, 3433, 1814, 4559, 4585, 1416,
+  2525, 6252, 6095, 1162, 5842, 2416, 5859, 6025,
+  4409, 6642, 6548, 5208, 6440, 6104, 2441, 7150,
+  6601, 7003, 5570, 3151, 339, 3979, 1600, 2076,
+  3783, 5908, 1952, 2731, 303, 243, 1679, 1844,
+  1507, 2579, 2088, 5074, 7012, 5408, 0, 3799,
+  4487, 2461, 6808, 4701, 141, 4448, 6400, 7023,
+  3018, 7534, 4641, 6043, 3487, 3371, 3835, 4320,
+  5698, 5878, 4601, 3999, 7141, 531, 7116, 3619,
+  6797, 1210, 4049, 4731, 6381, 1178, 7077, 6005,
+  709, 1376, 3294, 4908, 4984, 4519, 1742, 2994,
+  6827, 4796, 6054, 904, 7274, 4419, 3109, 3579,
+  6574, 2192, 3119, 1035, 1545, 5989, 1486, 1085,
+  1858, 4503, 1664, 540, 3723, 5044, 1478, 956,
+  5953, 3913, 2248, 4428, 6718, 2154, 6393, 2797,
+  6630, 1012, 7441, 562, 2106, 4239, 7337, 1132,
+  6290, 6337, 509, 7368, 1297, 3738, 2334, 3753,
+  5152, 5288, 7453, 73, 4593, 5480, 5557, 2960,
+  1786, 7046, 627, 2047, 6496, 3707, 6932, 1447,
+  3027, 4954, 2128, 6654, 6924, 3039, 3827, 7463,
+  3554, 4281, 4787, 2623, 1764, 2788, 1361, 4495,
+  4964, 6074, 4625, 259, 7429, 2925, 978, 1970,
+  4348, 1494, 6838, 3895, 1635, 230, 6065, 7265,
+  2779, 6765, 377, 5232, 3417, 7491, 90, 5372,
+  720, 1226, 4149, 5084, 3940, 1578, 3401, 5444,
+  6584, 3089, 4225, 4900, 1694, 498, 3689, 2146,
+  6666, 3843, 4535, 5769, 11, 919, 7034, 4189,
+  222, 4171, 2304, 5963, 551, 2660, 2162, 5726,
+  6410, 4511, 4891, 3964, 2368, 7257, 668, 2352,
+  6987, 4761, 5426, 863, 6467, 2749, 388, 3565,
+  7510, 6015, 839, 4974, 7163, 4311, 251, 2470,
+  6618, 577, 4012, 2764, 1981, 4104, 5024, 6309,
+  1346, 126, 2695, 5336, 3129, 3071, 5741, 1265,
+  5927, 5512, 2002, 5272, 6971, 2360, 7086, 5064,
+  4870, 5528, 2403, 5618, 4551, 6367, 2012, 1406,
+  29, 4473, 7095, 1256, 209, 322, 5544, 51,
+  2841, 5354, 5034, 149, 3641, 4329, 4180, 5711,
+  20, 459, 7417, 5973, 2543, 3358, 5783, 5390,
+  6677, 2430, 2393, 4095, 610, 2343, 5602, 2649,
+  429, 5496, 2916, 2887, 4805, 4398, 6318, 1612,
+  2504, 3865, 359, 6086, 4087, 5897, 889, 1646,
+  4113, 1624, 6739, 5944, 4930, 5118, 4829, 1992,
+  1710, 851, 2634, 3247, 6425, 4994, 761, 2972,
+  4300, 6944, 4207, 2713, 6752, 5135, 4671, 3460,
+  1934, 3854, 1520, 2934, 1528, 1720, 270, 4273,
+  799, 3593, 3989, 7323, 5586, 4633, 4437, 4289,
+  3080, 2222, 7483, 601, 1320, 7357, 6850, 102,
+  399, 6480, 1066, 1536, 1566, 4079, 3543, 2825,
+  2117, 5817, 4263, 3061, 780, 4037, 5919, 6788,
+  7379, 1114, 4160, 1774, 1798, 3140, 6730, 2480,
+  1830, 2897, 2677, 487, 451, 2612, 2377, 4387,
+  4459, 4567, 7068, 4131, 3606, 440, 6886, 2137,
+  4377, 3171, 6696, 5054, 3949, 1396, 1194, 4916,
+  5655, 2943, 1920, 6454, 6706, 1274, 1386, 6220,
+  5935, 3195, 5256, 5004, 1961, 4882, 5014, 3319,
+  3386, 5180, 3237, 4853, 3161, 588, 7058, 2064,
+  2274, 3698, 6860, 7174, 3880, 2600, 7405, 5825,
+  2857, 1754, 7524, 6687, 6914, 3515, 1021, 4944,
+  6327, 3345, 1096, 4064, 5755, 2907, 3931, 3227,
+  5634,
+};
+static const uint16_t _services_port_seeds[136] = {
+  46, 2, 35, 5, 2, 65, 12, 16,
+  158, 72, 84, 61, 202, 16, 9, 18,
+  53, 276, 1, 96, 247, 26, 9, 4,
+  235, 77, 29, 154, 3, 7, 1, 204,
+  8, 147, 87, 79, 54, 76, 3, 546,
+  18, 354, 9, 0, 42, 3, 2, 1,
+  16, 16, 2, 72, 505, 100, 1, 5,
+  8, 1, 464, 4, 124, 4, 85, 35,
+  68, 612, 19, 150, 1, 628, 2, 1,
+  42, 184, 193, 8, 71, 370, 2, 134,
+  200, 10, 924, 139, 6, 31, 262, 552,
+  1, 139, 3, 6, 9, 273, 223, 5,
+  2408, 174, 11, 327, 838, 1018, 4, 55,
+  11, 744, 1, 175, 5, 783, 516, 2,
+  28, 84, 2, 665, 429, 3, 944, 20,
+  7, 30, 1372, 1, 1, 599, 426, 3,
+  1042, 17, 3, 1387, 2, 845, 2261, 193,
+};
+static const uint16_t _services_port_slots[543] = {
+  4900, 3258, 3151, 1920, 4805, 7368, 4300, 2504,
+  4459, 863, 4954, 6015, 1406, 322, 284, 3964,
+  1664, 4535, 3843, 5897, 3386, 4377, 577, 2146,
+  6352, 1545, 889, 3195, 7023, 114, 1396, 7499,
+  4064, 5528, 4701, 5586, 5444, 839, 5014, 934,
+  720, 3018, 2117, 4559, 4087, 2430, 2764, 498,
+  141, 4593, 4289, 3319, 1612, 7141, 1256, 3515,
+  551, 5634, 4104, 4787, 1478, 1210, 2360, 1578,
+  4367, 1194, 2343, 222, 6425, 5963, 1943, 3211,
+  4487, 4320, 1786, 451, 4641, 1906, 1074, 2600,
+  0, 1386, 1981, 429, 1566, 3989, 5074, 1742,
+  5044, 2377, 2047, 5004, 3332, 6944, 6808, 1624,
+  7150, 2192, 3641, 4225, 1085, 209, 6467, 6220,
+  6400, 6687, 2934, 90, 4551, 4908, 2106, 7337,
+  799, 4625, 3099, 3768, 2304, 1754, 7058, 7012,
+  3027, 3999, 2779, 5570, 6618, 7003, 1694, 743,
+  2660, 2857, 1507, 5256, 5312, 3071, 5878, 2623,
+  3880, 7116, 2559, 7106, 5935, 4329, 3940, 956,
+  5618, 520, 2797, 4916, 1992, 610, 2634, 11,
+  4448, 6480, 2825, 1844, 5908, 2352, 7417, 6104,
+  4079, 3460, 562, 4160, 4281, 6584, 440, 1710,
+  5034, 2064, 2012, 3827, 3665, 2525, 1147, 1416,
+  1274, 243, 6696, 2872, 5944, 4984, 4761, 6886,
+  2713, 3895, 2841, 2403, 1720, 780, 1814, 5512,
+  3707, 5927, 5557, 1961, 6309, 2162, 339, 2334,
+  7309, 5919, 3161, 4239, 1730, 5953, 5711, 978,
+  5973, 851, 4273, 6034, 4503, 627, 4853, 6337,
+  4131, 6252, 6043, 668, 3371, 5676, 6134, 2907,
+  3753, 4511, 3227, 7463, 6318, 6860, 126, 6838,
+  5496, 2649, 6818, 7379, 7257, 459, 4974, 2030,
+  2274, 4829, 183, 3630, 259, 4171, 4428, 7219,
+  1679, 709, 4409, 2731, 4398, 4633, 4731, 2612,
+  1066, 6393, 5842, 1114, 1012, 7297, 5755, 3865,
+  2943, 7453, 1058, 2002, 5797, 3487, 3854, 1333,
+  6164, 2972, 7095, 7441, 3783, 919, 6873, 1486,
+  4207, 6086, 509, 5064, 3554, 5024, 3358, 1361,
+  4253, 3269, 6642, 1241, 1178, 5180, 7524, 388,
+  2416, 1600, 6630, 4601, 5152, 2984, 6788, 4149,
+  5655, 399, 5372, 5272, 3080, 3433, 4585, 6574,
+  6797, 2097, 3401, 251, 3579, 6367, 3061, 4025,
+  3698, 601, 3140, 4994, 1346, 4113, 4387, 5989,
+  4263, 4519, 3171, 6924, 7357, 29, 5602, 2154,
+  5101, 4012, 1830, 1646, 1764, 6956, 5208, 7534,
+  7274, 6065, 1162, 3619, 1882, 7077, 2393, 6987,
+  819, 6739, 3979, 2461, 1494, 7405, 5408, 5817,
+  2543, 1536, 2470, 270, 4180, 3949, 1635, 761,
+  6765, 414, 1132, 6025, 7265, 3183, 2088, 6900,
+  2076, 1858, 2788, 6200, 5084, 5825, 7429, 1376,
+  5426, 6778, 540, 4671, 6548, 473, 4613, 3593,
+  4473, 5288, 2480, 3417, 7086, 4495, 2994, 7347,
+  6932, 7034, 2441, 5462, 2749, 7163, 303, 487,
+  4567, 6971, 5807, 2579, 1096, 2368, 5390, 6381,
+  4095, 2222, 2887, 4037, 3294, 5232, 7392, 7473,
+  7285, 1934, 4964, 1528, 7510, 1952, 2916, 2677,
+  6914, 5769, 1520, 7186, 2248, 5783, 7323, 3723,
+  6827, 3119, 1035, 3089, 1970, 2960, 2897, 3345,
+  3606, 1226, 3004, 6706, 5054, 3913, 5726, 1655,
+  4774, 6005, 1297, 377, 904, 6454, 7483, 5118,
+  6290, 4049, 3931, 7174, 6677, 3129, 6518, 3689,
+  4891, 359, 51, 5741, 1589, 531, 6752, 2695,
+  4944, 4437, 6654, 6666, 1021, 6095, 5336, 6410,
+  5480, 4930, 6496, 5544, 3247, 3109, 3565, 4348,
+  4882, 3039, 73, 2128, 102, 3543, 3237, 1774,
+  4796, 149, 4189, 6601, 4870, 4419, 7046, 5859,
+  6718, 5354, 588, 230, 3835, 1320, 1554, 1798,
+  7068, 3738, 4311, 6440, 6054, 1265, 6074, 2021,
+  7491, 2137, 157, 20, 3051, 7230, 4576, 1702,
+  6327, 2925, 7198, 5698, 6850, 5135, 1447,
+};
+
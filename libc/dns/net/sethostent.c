@@ -53,6 +53,7 @@ __RCSID("$NetBSD: sethostent.c,v 1.20 2014/03/17 13:24:23 christos Exp $");
 #include <stdlib.h>
 
 #include "hostent.h"
+#include "hosts_cache.h"
 #include "resolv_private.h"
 
 #ifndef _REENTRANT
@@ -135,82 +136,112 @@ _hf_gethtbyname(void *rv, void *cb_data, va_list ap)
 	return NS_SUCCESS;
 }
 
+struct hf_gethtbyname_state {
+	const char *name;
+	int af;
+	struct getnamaddr *info;
+	struct hostent hent;
+	char *buf;
+	char *ptr;
+	size_t len;
+	size_t anum;
+	size_t num;
+	char *aliases[MAXALIASES];
+	char *addr_ptrs[MAXADDRS];
+	int nospc;
+};
+
+static int
+_hf_gethtbyname2_line(char *line, void *arg)
+{
+	struct hf_gethtbyname_state *st = arg;
+	struct getnamaddr *info = st->info;
+	struct hostent *hp;
+
+	info->hp->h_addrtype = st->af;
+	info->hp->h_length = 0;
+
+	hp = netbsd_gethostent_line(line, info->hp, info->buf, info->buflen,
+	    info->he);
+	if (hp == NULL) {
+		if (*info->he == NETDB_INTERNAL && errno == ENOSPC) {
+			goto nospc; // glibc compatibility.
+		}
+		return 0;
+	}
+
+	if (strcasecmp(hp->h_name, st->name) != 0) {
+		char **cp;
+		for (cp = hp->h_aliases; *cp != NULL; cp++)
+			if (strcasecmp(*cp, st->name) == 0)
+				break;
+		if (*cp == NULL) return 0;
+	}
+
+	if (st->num == 0) {
+		st->hent.h_addrtype = st->af = hp->h_addrtype;
+		st->hent.h_length = hp->h_length;
+
+		HENT_SCOPY(st->hent.h_name, hp->h_name, st->ptr, st->len);
+		for (st->anum = 0; hp->h_aliases[st->anum]; st->anum++) {
+			if (st->anum >= MAXALIASES)
+				goto nospc;
+			HENT_SCOPY(st->aliases[st->anum], hp->h_aliases[st->anum],
+			    st->ptr, st->len);
+		}
+		st->ptr = (void *)ALIGN(st->ptr);
+		if ((size_t)(st->ptr - st->buf) >= info->buflen)
+			goto nospc;
+	}
+
+	if (st->num >= MAXADDRS)
+		goto nospc;
+	HENT_COPY(st->addr_ptrs[st->num], hp->h_addr_list[0], hp->h_length,
+	    st->ptr, st->len);
+	st->num++;
+	return st->num >= MAXADDRS;
+nospc:
+	st->nospc = 1;
+	return 1;
+}
+
 struct hostent *
 _hf_gethtbyname2(const char *name, int af, struct getnamaddr *info)
 {
-	struct hostent *hp, hent;
+	struct hostent *hp;
 	char *buf, *ptr;
-	size_t len, anum, num, i;
-	FILE *hf;
-	char *aliases[MAXALIASES];
-	char *addr_ptrs[MAXADDRS];
+	size_t len, i;
+	struct hf_gethtbyname_state st;
 
 	_DIAGASSERT(name != NULL);
 
-	hf = NULL;
-	sethostent_r(&hf);
-	if (hf == NULL) {
-		errno = EINVAL;
+	if ((buf = malloc(info->buflen)) == NULL) {
 		*info->he = NETDB_INTERNAL;
 		return NULL;
 	}
 
-	if ((ptr = buf = malloc(len = info->buflen)) == NULL) {
+	st.name = name;
+	st.af = af;
+	st.info = info;
+	st.buf = st.ptr = buf;
+	st.len = info->buflen;
+	st.anum = 0;
+	st.num = 0;
+	st.nospc = 0;
+	st.hent.h_name = NULL;
+	st.hent.h_addrtype = 0;
+	st.hent.h_length = 0;
+
+	if (hc_foreach_name(name, _hf_gethtbyname2_line, &st) == -1) {
+		free(buf);
+		errno = EINVAL;
 		*info->he = NETDB_INTERNAL;
 		return NULL;
 	}
+	if (st.nospc)
+		goto nospc;
 
-	anum = 0;		/* XXX: gcc */
-	hent.h_name = NULL;	/* XXX: gcc */
-	hent.h_addrtype = 0;	/* XXX: gcc */
-	hent.h_length = 0;	/* XXX: gcc */
-
-	for (num = 0; num < MAXADDRS;) {
-		info->hp->h_addrtype = af;
-		info->hp->h_length = 0;
-
-		hp = netbsd_gethostent_r(hf, info->hp, info->buf, info->buflen,
-		    info->he);
-		if (hp == NULL) {
-			if (*info->he == NETDB_INTERNAL && errno == ENOSPC) {
-				goto nospc; // glibc compatibility.
-			}
-			break;
-		}
-
-		if (strcasecmp(hp->h_name, name) != 0) {
-			char **cp;
-			for (cp = hp->h_aliases; *cp != NULL; cp++)
-				if (strcasecmp(*cp, name) == 0)
-					break;
-			if (*cp == NULL) continue;
-		}
-
-		if (num == 0) {
-			hent.h_addrtype = af = hp->h_addrtype;
-			hent.h_length = hp->h_length;
-
-			HENT_SCOPY(hent.h_name, hp->h_name, ptr, len);
-			for (anum = 0; hp->h_aliases[anum]; anum++) {
-				if (anum >= MAXALIASES)
-					goto nospc;
-				HENT_SCOPY(aliases[anum], hp->h_aliases[anum],
-				    ptr, len);
-			}
-			ptr = (void *)ALIGN(ptr);
-			if ((size_t)(ptr - buf) >= info->buflen)
-				goto nospc;
-		}
-
-		if (num >= MAXADDRS)
-			goto nospc;
-		HENT_COPY(addr_ptrs[num], hp->h_addr_list[0], hp->h_length, ptr,
-		    len);
-		num++;
-	}
-	endhostent_r(&hf);
-
-	if (num == 0) {
+	if (st.num == 0) {
 		*info->he = HOST_NOT_FOUND;
 		free(buf);
 		return NULL;
@@ -220,22 +251,22 @@ _hf_gethtbyname2(const char *name, int af, struct getnamaddr *info)
 	ptr = info->buf;
 	len = info->buflen;
 
-	hp->h_addrtype = hent.h_addrtype;
-	hp->h_length = hent.h_length;
+	hp->h_addrtype = st.hent.h_addrtype;
+	hp->h_length = st.hent.h_length;
 
-	HENT_ARRAY(hp->h_aliases, anum, ptr, len);
-	HENT_ARRAY(hp->h_addr_list, num, ptr, len);
+	HENT_ARRAY(hp->h_aliases, st.anum, ptr, len);
+	HENT_ARRAY(hp->h_addr_list, st.num, ptr, len);
 
-	for (i = 0; i < num; i++)
-		HENT_COPY(hp->h_addr_list[i], addr_ptrs[i], hp->h_length, ptr,
+	for (i = 0; i < st.num; i++)
+		HENT_COPY(hp->h_addr_list[i], st.addr_ptrs[i], hp->h_length, ptr,
 		    len);
-	hp->h_addr_list[num] = NULL;
+	hp->h_addr_list[st.num] = NULL;
 
-	HENT_SCOPY(hp->h_name, hent.h_name, ptr, len);
+	HENT_SCOPY(hp->h_name, st.hent.h_name, ptr, len);
 
-	for (i = 0; i < anum; i++)
-		HENT_SCOPY(hp->h_aliases[i], aliases[i], ptr, len);
-	hp->h_aliases[anum] = NULL;
+	for (i = 0; i < st.anum; i++)
+		HENT_SCOPY(hp->h_aliases[i], st.aliases[i], ptr, len);
+	hp->h_aliases[st.anum] = NULL;
 
 	free(buf);
 	return hp;
@@ -246,34 +277,50 @@ nospc:
 	return NULL;
 }
 
+struct hf_gethtbyaddr_state {
+	const unsigned char *addr;
+	struct getnamaddr *info;
+	struct hostent *hp;
+};
+
+static int
+_hf_gethtbyaddr_line(char *line, void *arg)
+{
+	struct hf_gethtbyaddr_state *st = arg;
+	struct getnamaddr *info = st->info;
+	struct hostent *hp;
+
+	hp = netbsd_gethostent_line(line, info->hp, info->buf, info->buflen,
+	    info->he);
+	if (hp == NULL)
+		return *info->he == NETDB_INTERNAL && errno == ENOSPC;
+	if (memcmp(hp->h_addr_list[0], st->addr, (size_t)hp->h_length))
+		return 0;
+	st->hp = hp;
+	return 1;
+}
+
 /*ARGSUSED*/
 int
 _hf_gethtbyaddr(void *rv, void *cb_data, va_list ap)
 {
-	struct hostent *hp;
-	const unsigned char *addr;
+	struct hf_gethtbyaddr_state st;
 	struct getnamaddr *info = rv;
-	FILE *hf;
 
 	_DIAGASSERT(rv != NULL);
 
-	addr = va_arg(ap, unsigned char *);
+	st.addr = va_arg(ap, unsigned char *);
+	st.info = info;
+	st.hp = NULL;
 	info->hp->h_length = va_arg(ap, int);
 	info->hp->h_addrtype = va_arg(ap, int);
 
-	hf = NULL;
-	sethostent_r(&hf);
-	if (hf == NULL) {
+	if (hc_foreach_addr(st.addr, info->hp->h_length, _hf_gethtbyaddr_line,
+	    &st) == -1) {
 		*info->he = NETDB_INTERNAL;
 		return NS_UNAVAIL;
 	}
-	while ((hp = netbsd_gethostent_r(hf, info->hp, info->buf, info->buflen,
-	    info->he)) != NULL)
-		if (!memcmp(hp->h_addr_list[0], addr, (size_t)hp->h_length))
-			break;
-	endhostent_r(&hf);
-
-	if (hp == NULL) {
+	if (st.hp == NULL) {
 		if (errno == ENOSPC) return NS_UNAVAIL; // glibc compatibility.
 		*info->he = HOST_NOT_FOUND;
 		return NS_NOTFOUND;
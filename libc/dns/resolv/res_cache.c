@@ -753,123 +753,45 @@ _dnsPacket_bprintQuery( DnsPacket*  packet, char*  p, char*  end )
  ** BEEN SUCCESFULLY CHECKED.
  **/
 
-/* use 32-bit FNV hash function */
-#define  FNV_MULT   16777619U
-#define  FNV_BASIS  2166136261U
-
-static unsigned
-_dnsPacket_hashBytes( DnsPacket*  packet, int  numBytes, unsigned  hash )
-{
-    const uint8_t*  p   = packet->cursor;
-    const uint8_t*  end = packet->end;
-
-    while (numBytes > 0 && p < end) {
-        hash = hash*FNV_MULT ^ *p++;
-    }
-    packet->cursor = p;
-    return hash;
-}
-
-
-static unsigned
-_dnsPacket_hashQName( DnsPacket*  packet, unsigned  hash )
-{
-    const uint8_t*  p   = packet->cursor;
-    const uint8_t*  end = packet->end;
-
-    for (;;) {
-        int  c;
-
-        if (p >= end) {  /* should not happen */
-            XLOG("%s: INTERNAL_ERROR: read-overflow !!\n", __FUNCTION__);
-            break;
-        }
-
-        c = *p++;
-
-        if (c == 0)
-            break;
-
-        if (c >= 64) {
-            XLOG("%s: INTERNAL_ERROR: malformed domain !!\n", __FUNCTION__);
-            break;
-        }
-        if (p + c >= end) {
-            XLOG("%s: INTERNAL_ERROR: simple label read-overflow !!\n",
-                    __FUNCTION__);
-            break;
-        }
-        while (c > 0) {
-            hash = hash*FNV_MULT ^ *p++;
-            c   -= 1;
-        }
-    }
-    packet->cursor = p;
-    return hash;
-}
-
-static unsigned
-_dnsPacket_hashQR( DnsPacket*  packet, unsigned  hash )
-{
-    hash = _dnsPacket_hashQName(packet, hash);
-    hash = _dnsPacket_hashBytes(packet, 4, hash); /* TYPE and CLASS */
-    return hash;
-}
-
-static unsigned
-_dnsPacket_hashRR( DnsPacket*  packet, unsigned  hash )
-{
-    int rdlength;
-    hash = _dnsPacket_hashQR(packet, hash);
-    hash = _dnsPacket_hashBytes(packet, 4, hash); /* TTL */
-    rdlength = _dnsPacket_readInt16(packet);
-    hash = _dnsPacket_hashBytes(packet, rdlength, hash); /* RDATA */
-    return hash;
-}
+/* The hash covers the RD bit, the second flags byte and everything after
+ * them, which includes all that _dnsPacket_isEqualQuery looks at. Rather than
+ * walking the records, the bytes are mixed in 64 bits at a time: this is on
+ * the path of every lookup, and most queries are only a few words long.
+ */
+#define  HASH_MULT  0x9e3779b97f4a7c15ULL
 
 static unsigned
 _dnsPacket_hashQuery( DnsPacket*  packet )
 {
-    unsigned  hash = FNV_BASIS;
-    int       count, arcount;
-    _dnsPacket_rewind(packet);
+    const uint8_t*  p    = packet->base;
+    const uint8_t*  end  = packet->end;
+    uint64_t        hash, word;
+    size_t          tail;
 
-    /* ignore the ID */
-    _dnsPacket_skip(packet, 2);
+    if (end - p < DNS_HEADER_SIZE) {  /* rejected by _dnsPacket_checkQuery */
+        return 0;
+    }
 
-    /* we ignore the TC bit for reasons explained in
-     * _dnsPacket_checkQuery().
-     *
-     * however we hash the RD bit to differentiate
-     * between answers for recursive and non-recursive
-     * queries.
+    /* we ignore the ID and the TC bit for reasons explained in
+     * _dnsPacket_checkQuery(), but hash the RD bit to differentiate
+     * between answers for recursive and non-recursive queries.
      */
-    hash = hash*FNV_MULT ^ (packet->base[2] & 1);
-
-    /* mark the first header byte as processed */
-    _dnsPacket_skip(packet, 1);
-
-    /* process the second header byte */
-    hash = _dnsPacket_hashBytes(packet, 1, hash);
+    hash = ((uint64_t)(p[2] & 1) << 8 | p[3]) * HASH_MULT;
 
-    /* read QDCOUNT */
-    count = _dnsPacket_readInt16(packet);
-
-    /* assume: ANcount and NScount are 0 */
-    _dnsPacket_skip(packet, 4);
-
-    /* read ARCOUNT */
-    arcount = _dnsPacket_readInt16(packet);
-
-    /* hash QDCOUNT QRs */
-    for ( ; count > 0; count-- )
-        hash = _dnsPacket_hashQR(packet, hash);
+    for (p += 4; end - p >= 8; p += 8) {
+        memcpy(&word, p, sizeof(word));
+        hash = (hash ^ word) * HASH_MULT;
+        hash ^= hash >> 29;
+    }
 
-    /* hash ARCOUNT RRs */
-    for ( ; arcount > 0; arcount-- )
-        hash = _dnsPacket_hashRR(packet, hash);
+    /* the length goes in with the tail, so that trailing zeroes count */
+    tail = end - p;
+    word = 0;
+    memcpy(&word, p, tail);
+    hash = (hash ^ word ^ (uint64_t)tail << 56) * HASH_MULT;
+    hash ^= hash >> 32;
 
-    return hash;
+    return (unsigned)hash;
 }
 
 
@@ -1157,12 +1079,24 @@ answer_getTTL(const void* answer, int answerlen)
     return result;
 }
 
+/* an entry and its query and answer are allocated as a single block, which
+ * comes from the cache's slabs (see _cache_get_slot) if it fits in a slot */
+#define  ENTRY_SLOT_SIZE    384
+#define  ENTRY_INLINE_SIZE  (ENTRY_SLOT_SIZE - (int)sizeof(Entry))
+
+struct resolv_cache;
+static Entry*  _cache_get_slot( struct resolv_cache*  cache );
+static void    _cache_put_slot( struct resolv_cache*  cache, Entry*  e );
+
 static void
-entry_free( Entry*  e )
+entry_free( struct resolv_cache*  cache, Entry*  e )
 {
-    /* everything is allocated in a single memory block */
     if (e) {
-        free(e);
+        if (e->querylen + e->answerlen <= ENTRY_INLINE_SIZE) {
+            _cache_put_slot(cache, e);
+        } else {
+            free(e);
+        }
     }
 }
 
@@ -1216,13 +1150,17 @@ entry_init_key( Entry*  e, const void*  query, int  querylen )
 
 /* allocate a new entry as a cache node */
 static Entry*
-entry_alloc( const Entry*  init, const void*  answer, int  answerlen )
+entry_alloc( struct resolv_cache*  cache, const Entry*  init, const void*  answer, int  answerlen )
 {
     Entry*  e;
-    int     size;
 
-    size = sizeof(*e) + init->querylen + answerlen;
-    e    = calloc(size, 1);
+    if (init->querylen + answerlen <= ENTRY_INLINE_SIZE) {
+        e = _cache_get_slot(cache);
+        if (e != NULL)
+            memset(e, 0, sizeof(*e));
+    } else {
+        e = calloc(sizeof(*e) + init->querylen + answerlen, 1);
+    }
     if (e == NULL)
         return e;
 
@@ -1248,6 +1186,13 @@ entry_equals( const Entry*  e1, const Entry*  e2 )
     if (e1->querylen != e2->querylen) {
         return 0;
     }
+    /* equal queries almost always only differ in their ID (and maybe TC),
+     * which memcmp() can confirm far faster than walking the records */
+    if (e1->querylen >= DNS_HEADER_SIZE &&
+        (e1->query[2] & 1) == (e2->query[2] & 1) &&
+        memcmp(e1->query + 3, e2->query + 3, e1->querylen - 3) == 0) {
+        return 1;
+    }
     _dnsPacket_init(pack1, e1->query, e1->querylen);
     _dnsPacket_init(pack2, e2->query, e2->querylen);
 
@@ -1276,15 +1221,74 @@ typedef struct pending_req_info {
     struct pending_req_info*    next;
 } PendingReqInfo;
 
+/* Entries that fit in a slot are carved out of slabs of ENTRY_SLAB_SLOTS
+ * slots each. Slabs are only released when their cache is deleted: removed
+ * entries go on the cache's free list (linked through hlink), so that a busy
+ * cache recycles slots rather than calling malloc and free for every answer.
+ */
+#define  ENTRY_SLAB_SLOTS  32
+
+typedef struct entry_slab {
+    struct entry_slab*  next;
+    /* followed by ENTRY_SLAB_SLOTS slots of ENTRY_SLOT_SIZE bytes */
+} EntrySlab;
+
 typedef struct resolv_cache {
     int              max_entries;
     int              num_entries;
     Entry            mru_list;
     int              last_id;
-    Entry*           entries;
+    Entry**          entries;
     PendingReqInfo   pending_requests;
+    EntrySlab*       slabs;
+    Entry*           free_slots;
 } Cache;
 
+static Entry*
+_cache_get_slot( Cache*  cache )
+{
+    Entry*  e;
+
+    if (cache->free_slots == NULL) {
+        EntrySlab*  slab = malloc(sizeof(*slab) + ENTRY_SLAB_SLOTS * ENTRY_SLOT_SIZE);
+        uint8_t*    slot;
+        int         nn;
+
+        if (slab == NULL)
+            return NULL;
+        slab->next   = cache->slabs;
+        cache->slabs = slab;
+
+        slot = (uint8_t*)(slab + 1);
+        for (nn = 0; nn < ENTRY_SLAB_SLOTS; nn++, slot += ENTRY_SLOT_SIZE) {
+            e = (Entry*)(void*)slot;
+            e->hlink = cache->free_slots;
+            cache->free_slots = e;
+        }
+    }
+    e = cache->free_slots;
+    cache->free_slots = e->hlink;
+    return e;
+}
+
+static void
+_cache_put_slot( Cache*  cache, Entry*  e )
+{
+    e->hlink = cache->free_slots;
+    cache->free_slots = e;
+}
+
+static void
+_cache_free_slabs( Cache*  cache )
+{
+    while (cache->slabs != NULL) {
+        EntrySlab*  slab = cache->slabs;
+        cache->slabs = slab->next;
+        free(slab);
+    }
+    cache->free_slots = NULL;
+}
+
 struct resolv_cache_info {
     unsigned                    netid;
     Cache*                      cache;
@@ -1330,6 +1334,20 @@ _cache_flush_pending_requests_locked( struct resolv_cache* cache )
     }
 }
 
+/* Return 1 if another request matching the key is outstanding. */
+static int
+_cache_has_pending_request_locked( struct resolv_cache* cache, Entry* key )
+{
+    struct pending_req_info *ri;
+
+    for (ri = cache->pending_requests.next; ri != NULL; ri = ri->next) {
+        if (ri->hash == key->hash) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 /* Return 0 if no pending request is found matching the key.
  * If a matching request is found the calling thread will wait until
  * the matching request completes, then update *cache and return 1. */
@@ -1431,12 +1449,12 @@ _cache_flush_locked( Cache*  cache )
 
     for (nn = 0; nn < cache->max_entries; nn++)
     {
-        Entry**  pnode = (Entry**) &cache->entries[nn];
+        Entry**  pnode = &cache->entries[nn];
 
         while (*pnode != NULL) {
             Entry*  node = *pnode;
             *pnode = node->hlink;
-            entry_free(node);
+            entry_free(cache, node);
         }
     }
 
@@ -1575,7 +1593,7 @@ _cache_lookup_p( Cache*   cache,
                  Entry*   key )
 {
     int      index = key->hash % cache->max_entries;
-    Entry**  pnode = (Entry**) &cache->entries[ index ];
+    Entry**  pnode = &cache->entries[ index ];
 
     while (*pnode != NULL) {
         Entry*  node = *pnode;
@@ -1625,7 +1643,7 @@ _cache_remove_p( Cache*   cache,
 
     entry_mru_remove(e);
     *lookup = e->hlink;
-    entry_free(e);
+    entry_free(cache, e);
     cache->num_entries -= 1;
 }
 
@@ -1670,13 +1688,14 @@ static void _cache_remove_expired(Cache* cache) {
     }
 }
 
-ResolvCacheStatus
-_resolv_cache_lookup( unsigned              netid,
-                      const void*           query,
-                      int                   querylen,
-                      void*                 answer,
-                      int                   answersize,
-                      int                  *answerlen )
+static ResolvCacheStatus
+_resolv_cache_lookup_impl( unsigned              netid,
+                           const void*           query,
+                           int                   querylen,
+                           void*                 answer,
+                           int                   answersize,
+                           int                  *answerlen,
+                           int                   wait )
 {
     Entry      key[1];
     Entry**    lookup;
@@ -1712,6 +1731,10 @@ _resolv_cache_lookup( unsigned              netid,
 
     if (e == NULL) {
         XLOG( "NOT IN CACHE");
+        if (!wait && _cache_has_pending_request_locked(cache, key)) {
+            result = RESOLV_CACHE_UNSUPPORTED;
+            goto Exit;
+        }
         // calling thread will wait if an outstanding request is found
         // that matching this query
         if (!_cache_check_pending_request_locked(&cache, key, netid) || cache == NULL) {
@@ -1759,6 +1782,28 @@ Exit:
     return result;
 }
 
+ResolvCacheStatus
+_resolv_cache_lookup( unsigned              netid,
+                      const void*           query,
+                      int                   querylen,
+                      void*                 answer,
+                      int                   answersize,
+                      int                  *answerlen )
+{
+    return _resolv_cache_lookup_impl(netid, query, querylen, answer, answersize, answerlen, 1);
+}
+
+ResolvCacheStatus
+_resolv_cache_lookup_nowait( unsigned              netid,
+                             const void*           query,
+                             int                   querylen,
+                             void*                 answer,
+                             int                   answersize,
+                             int                  *answerlen )
+{
+    return _resolv_cache_lookup_impl(netid, query, querylen, answer, answersize, answerlen, 0);
+}
+
 
 void
 _resolv_cache_add( unsigned              netid,
@@ -1821,7 +1866,7 @@ _resolv_cache_add( unsigned              netid,
 
     ttl = answer_getTTL(answer, answerlen);
     if (ttl > 0) {
-        e = entry_alloc(key, answer, answerlen);
+        e = entry_alloc(cache, key, answer, answerlen);
         if (e != NULL) {
             e->expires = ttl + _time_now();
             _cache_add_p(cache, lookup, e);
@@ -1931,6 +1976,7 @@ void _resolv_delete_cache_for_net(unsigned netid)
         if (cache_info->netid == netid) {
             prev_cache_info->next = cache_info->next;
             _cache_flush_locked(cache_info->cache);
+            _cache_free_slabs(cache_info->cache);
             free(cache_info->cache->entries);
             free(cache_info->cache);
             _free_nameservers_locked(cache_info);
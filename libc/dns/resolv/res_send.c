@@ -138,6 +138,7 @@ __RCSID("$NetBSD: res_send.c,v 1.9 2006/01/24 17:41:25 christos Exp $");
 
 static int		get_salen __P((const struct sockaddr *));
 static struct sockaddr * get_nsaddr __P((res_state, size_t));
+static struct timespec	get_timeout(const res_state, const struct __res_params *, const int);
 static int		send_vc(res_state, struct __res_params *params, const u_char *, int,
 				u_char *, int, int *, int, time_t *, int *, int *);
 static int		send_dg(res_state, struct __res_params *params, const u_char *, int,
@@ -677,6 +678,238 @@ res_nsend(res_state statp,
 	return (-1);
 }
 
+static void
+batch_add_sample(res_state statp, const struct __res_params *params,
+    int revision_id, int ns, int rcode, int delay)
+{
+	struct __res_sample sample;
+
+	_res_stats_set_sample(&sample, time(NULL), rcode, delay);
+	_resolv_cache_add_resolver_stats_sample(statp->netid, revision_id, ns,
+	    &sample, params->max_samples);
+}
+
+/*
+ * Sends |count| queries to the nameservers of |statp| all at once, without
+ * consulting the cache or the hooks, and collects the answers as they come
+ * in.  Every unanswered query goes to the first usable nameserver, then to
+ * the next one when that server's timeout expires, and so on for
+ * statp->retry rounds, but never for longer than |timeout_ms| in all.  Each
+ * nameserver gets a single datagram socket that all the queries share, and
+ * replies are matched back to their queries by id and question.
+ *
+ * answers[i] is set to a malloc()ed copy of the answer to bufs[i], at most
+ * |anssiz| bytes long, and anslens[i] to its length.  If there was no usable
+ * answer, answers[i] is NULL and anslens[i] is 0 if no server replied in
+ * time, or -1 if the reply needs more than a datagram can do (it was
+ * truncated, or every server that replied rejected the query); the caller is
+ * expected to leave those queries to res_nsend().  Returns the number of
+ * queries answered.
+ *
+ * Like res_nsend(), this records a sample in the nameserver stats for each
+ * query on the first round only: the rcode of the server's reply, or a
+ * timeout if the server's own timeout passed without one.
+ */
+int
+res_nsend_batch(res_state statp, const u_char * const *bufs, const int *buflens,
+    u_char **answers, int anssiz, int *anslens, int count, int timeout_ms)
+{
+	struct timespec deadline;
+	struct pollfd fds[MAXNS];
+	struct timespec sent_at[MAXNS];
+	struct __res_params params;
+	u_char *rejected, *unsampled, *ans;
+	int try, ns, i, remaining, revision_id = -1;
+
+	for (ns = 0; ns < MAXNS; ns++) {
+		fds[ns].fd = -1;
+		fds[ns].events = POLLIN;
+	}
+	for (i = 0; i < count; i++) {
+		answers[i] = NULL;
+		anslens[i] = 0;
+	}
+	if (count <= 0 || anssiz < HFIXEDSZ)
+		return 0;
+
+	/* one bit per nameserver that answered SERVFAIL, NOTIMP or REFUSED */
+	rejected = calloc((size_t)count, 1);
+	/* one bit per nameserver asked in the first round without a sample yet */
+	unsampled = calloc((size_t)count, 1);
+	ans = malloc((size_t)anssiz);
+	if (rejected == NULL || unsampled == NULL || ans == NULL) {
+		free(rejected);
+		free(unsampled);
+		free(ans);
+		return 0;
+	}
+
+	deadline = evAddTime(evNowTime(),
+	    evConsTime(timeout_ms / 1000, (timeout_ms % 1000) * 1000000L));
+	remaining = count;
+	for (try = 0; try < statp->retry && remaining > 0; try++) {
+		struct __res_stats stats[MAXNS];
+		bool usable_servers[MAXNS];
+		int id;
+
+		id = _resolv_cache_get_resolver_stats(statp->netid, &params, stats);
+		if (try == 0)
+			revision_id = id;
+		android_net_res_stats_get_usable_servers(&params, stats, statp->nscount,
+			usable_servers);
+
+		for (ns = 0; ns < statp->nscount && remaining > 0; ns++) {
+			struct timespec now, finish;
+			int sent = 0, clipped = 0;
+
+			if (!usable_servers[ns])
+				continue;
+			if (fds[ns].fd == -1) {
+				const struct sockaddr *nsap = get_nsaddr(statp, (size_t)ns);
+				int s = socket(nsap->sa_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+				if (s < 0)
+					continue;
+				fchown(s, AID_DNS, -1);
+				if ((statp->_mark != MARK_UNSET &&
+				     setsockopt(s, SOL_SOCKET, SO_MARK, &statp->_mark,
+					 sizeof(statp->_mark)) < 0) ||
+				    random_bind(s, nsap->sa_family) < 0 ||
+				    __connect(s, nsap, (socklen_t)get_salen(nsap)) < 0) {
+					close(s);
+					continue;
+				}
+				fds[ns].fd = s;
+			}
+
+			sent_at[ns] = evNowTime();
+			for (i = 0; i < count; i++) {
+				if (anslens[i] != 0 || (rejected[i] & (1 << ns)))
+					continue;
+				if (send(fds[ns].fd, bufs[i], (size_t)buflens[i], 0) == buflens[i]) {
+					sent++;
+					if (try == 0)
+						unsampled[i] |= 1 << ns;
+				}
+			}
+			if (sent == 0)
+				continue;
+
+			now = evNowTime();
+			finish = evAddTime(now, get_timeout(statp, &params, ns));
+			if (evCmpTime(finish, deadline) > 0) {
+				finish = deadline;
+				clipped = 1;
+			}
+
+			/* Replies from the servers asked earlier are still welcome. */
+			while (remaining > 0) {
+				struct timespec timeout;
+				int n, k;
+
+				now = evNowTime();
+				if (evCmpTime(finish, now) <= 0)
+					break;
+				timeout = evSubTime(finish, now);
+				n = ppoll(fds, (nfds_t)statp->nscount, &timeout, NULL);
+				if (n < 0 && errno == EINTR)
+					continue;
+				if (n <= 0)
+					break;
+
+				for (k = 0; k < statp->nscount; k++) {
+					const HEADER *anhp = (const HEADER *)(void *)ans;
+					int resplen;
+
+					if (fds[k].fd == -1 || fds[k].revents == 0)
+						continue;
+					resplen = recv(fds[k].fd, ans, (size_t)anssiz,
+					    MSG_DONTWAIT | MSG_TRUNC);
+					if (resplen < 0) {
+						if (errno != EAGAIN && errno != EINTR) {
+							/* ECONNREFUSED and the like: stop using this server. */
+							close(fds[k].fd);
+							fds[k].fd = -1;
+						}
+						continue;
+					}
+					if (resplen < HFIXEDSZ || resplen > anssiz)
+						continue;
+					for (i = 0; i < count; i++) {
+						const HEADER *hp = (const HEADER *)(const void *)bufs[i];
+
+						if (anslens[i] != 0 || hp->id != anhp->id)
+							continue;
+						if (res_queriesmatch(bufs[i], bufs[i] + buflens[i],
+						    ans, ans + anssiz))
+							break;
+					}
+					if (i == count)
+						continue;	/* late, duplicate or bogus */
+
+					if (unsampled[i] & (1 << k)) {
+						struct timespec done = evNowTime();
+
+						unsampled[i] &= ~(1 << k);
+						batch_add_sample(statp, &params, revision_id, k,
+						    anhp->rcode,
+						    _res_stats_calculate_rtt(&done, &sent_at[k]));
+					}
+					if (anhp->rcode == SERVFAIL || anhp->rcode == NOTIMP ||
+					    anhp->rcode == REFUSED) {
+						rejected[i] |= 1 << k;
+						continue;
+					}
+					if (anhp->rcode == FORMERR ||
+					    (!(statp->options & RES_IGNTC) && anhp->tc)) {
+						/* Leave EDNS0 fallback and TCP to res_nsend(). */
+						anslens[i] = -1;
+					} else if ((answers[i] = malloc((size_t)resplen)) != NULL) {
+						memcpy(answers[i], ans, (size_t)resplen);
+						anslens[i] = resplen;
+					} else {
+						anslens[i] = -1;
+					}
+					remaining--;
+				}
+			}
+			/*
+			 * If the server's timeout ran out, whatever it hasn't answered
+			 * has timed out.  Our own deadline running out first says
+			 * nothing about the server.
+			 */
+			if (try == 0 && !clipped && evCmpTime(evNowTime(), finish) >= 0) {
+				for (i = 0; i < count; i++) {
+					if (!(unsampled[i] & (1 << ns)))
+						continue;
+					unsampled[i] &= ~(1 << ns);
+					batch_add_sample(statp, &params, revision_id, ns,
+					    RCODE_TIMEOUT, 0);
+				}
+			}
+			if (evCmpTime(evNowTime(), deadline) >= 0)
+				goto done;
+		}
+	}
+done:
+	for (ns = 0; ns < MAXNS; ns++) {
+		if (fds[ns].fd != -1)
+			close(fds[ns].fd);
+	}
+	free(ans);
+
+	remaining = 0;
+	for (i = 0; i < count; i++) {
+		if (anslens[i] == 0 && rejected[i] != 0)
+			anslens[i] = -1;
+		else if (anslens[i] > 0)
+			remaining++;
+	}
+	free(rejected);
+	free(unsampled);
+	return remaining;
+}
+
 /* Private */
 
 static int
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#pragma once
+
+/**
+ * @file android/math_array.h
+ * @brief Functions that compute exp, log, or sincos of every element of an array.
+ */
+
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+__BEGIN_DECLS
+
+/*
+ * On arm64 and x86_64, libm has functions that compute exp, log or sincos (and
+ * their float variants) of every element of an array, with the same kernels as
+ * the vector versions declared in <math.h>. They work on whole vectors at a
+ * time, so the per-call and argument reduction costs of the scalar functions
+ * are paid once per vector rather than once per element. Like the vector
+ * versions, they're within 4 ULP (2 ULP for float) and don't set errno. __y (or
+ * __sin and __cos) may be __x.
+ */
+#if defined(__aarch64__) || defined(__x86_64__)
+void android_exp_array(const double* __x, double* __y, size_t __n) __INTRODUCED_IN(34);
+void android_expf_array(const float* __x, float* __y, size_t __n) __INTRODUCED_IN(34);
+void android_log_array(const double* __x, double* __y, size_t __n) __INTRODUCED_IN(34);
+void android_logf_array(const float* __x, float* __y, size_t __n) __INTRODUCED_IN(34);
+void android_sincos_array(const double* __x, double* __sin, double* __cos, size_t __n) __INTRODUCED_IN(34);
+void android_sincosf_array(const float* __x, float* __sin, float* __cos, size_t __n) __INTRODUCED_IN(34);
+#endif
+
+__END_DECLS
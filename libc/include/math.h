@@ -405,4 +405,35 @@ void sincosl(long double __x, long double* __sin, long double* __cos);
 #define M_SQRT1_2l      0.707106781186547524400844362104849039L /* 1/sqrt(2) */
 #endif
 
+/*
+ * On arm64 and x86_64, libm also has vector versions of cos, exp, log, pow and
+ * sin (and their float variants), with the names the architecture's vector
+ * function ABI gives them (_ZGVnN2v_sin, _ZGVdN4v_exp, ...). When OpenMP is
+ * enabled, these declarations let the compiler call them from vectorized
+ * loops. They're within 4 ULP of the right answer, and don't set errno.
+ */
+#if (defined(__aarch64__) || defined(__x86_64__)) && !defined(__ARM_FEATURE_SVE) && \
+    defined(_OPENMP) && __ANDROID_API__ >= 34
+#pragma omp declare simd notinbranch
+double cos(double __x);
+#pragma omp declare simd notinbranch
+float cosf(float __x);
+#pragma omp declare simd notinbranch
+double exp(double __x);
+#pragma omp declare simd notinbranch
+float expf(float __x);
+#pragma omp declare simd notinbranch
+double log(double __x);
+#pragma omp declare simd notinbranch
+float logf(float __x);
+#pragma omp declare simd notinbranch
+double pow(double __x, double __y);
+#pragma omp declare simd notinbranch
+float powf(float __x, float __y);
+#pragma omp declare simd notinbranch
+double sin(double __x);
+#pragma omp declare simd notinbranch
+float sinf(float __x);
+#endif
+
 __END_DECLS
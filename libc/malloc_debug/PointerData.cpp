@@ -483,19 +483,26 @@ void PointerData::LogLeaks() {
   std::lock_guard<std::mutex> frame_guard(frame_mutex_);
   GetList(&list, false);
 
+  // There can be thousands of lines of these, so send them to the log in batches.
+  async_safe_log_batch batch;
+  async_safe_log_batch_init(&batch, ANDROID_LOG_ERROR, "malloc_debug");
+
   size_t track_count = 0;
   for (const auto& list_info : list) {
-    error_log("+++ %s leaked block of size %zu at 0x%" PRIxPTR " (leak %zu of %zu)", getprogname(),
-              list_info.size, list_info.pointer, ++track_count, list.size());
+    async_safe_log_batch_format(
+        &batch, "+++ %s leaked block of size %zu at 0x%" PRIxPTR " (leak %zu of %zu)",
+        getprogname(), list_info.size, list_info.pointer, ++track_count, list.size());
     if (list_info.backtrace_info != nullptr) {
-      error_log("Backtrace at time of allocation:");
-      UnwindLog(*list_info.backtrace_info);
+      async_safe_log_batch_write(&batch, "Backtrace at time of allocation:");
+      UnwindLog(*list_info.backtrace_info, &batch);
     } else if (list_info.frame_info != nullptr) {
-      error_log("Backtrace at time of allocation:");
-      backtrace_log(list_info.frame_info->frames.data(), list_info.frame_info->frames.size());
+      async_safe_log_batch_write(&batch, "Backtrace at time of allocation:");
+      backtrace_log(list_info.frame_info->frames.data(), list_info.frame_info->frames.size(),
+                    &batch);
     }
     // Do not bother to free the pointers, we are about to exit any way.
   }
+  async_safe_log_batch_flush(&batch);
 }
 
 void PointerData::GetAllocList(std::vector<ListInfoType>* list) {
@@ -102,7 +102,8 @@ bool Unwind(std::vector<uintptr_t>* frames, std::vector<unwindstack::FrameData>*
   return true;
 }
 
-void UnwindLog(const std::vector<unwindstack::FrameData>& frame_info) {
+void UnwindLog(const std::vector<unwindstack::FrameData>& frame_info,
+               async_safe_log_batch* batch) {
   for (size_t i = 0; i < frame_info.size(); i++) {
     const unwindstack::FrameData* info = &frame_info[i];
     auto map_info = info->map_info;
@@ -134,6 +135,10 @@ void UnwindLog(const std::vector<unwindstack::FrameData>& frame_info) {
       }
       line += ")";
     }
-    error_log_string(line.c_str());
+    if (batch != nullptr) {
+      async_safe_log_batch_write(batch, line.c_str());
+    } else {
+      error_log_string(line.c_str());
+    }
   }
 }
@@ -30,6 +30,8 @@
 
 #include <stdint.h>
 
+#include <async_safe/log.h>
+
 #include <string>
 #include <vector>
 
@@ -39,4 +41,6 @@
 bool Unwind(std::vector<uintptr_t>* frames, std::vector<unwindstack::FrameData>* info,
             size_t max_frames);
 
-void UnwindLog(const std::vector<unwindstack::FrameData>& frame_info);
+// Logs each frame on its own line, through `batch` if it's non-null.
+void UnwindLog(const std::vector<unwindstack::FrameData>& frame_info,
+               async_safe_log_batch* batch = nullptr);
@@ -184,6 +184,11 @@ std::string backtrace_string(const uintptr_t* frames, size_t frame_count) {
   return str;
 }
 
-void backtrace_log(const uintptr_t* frames, size_t frame_count) {
-  error_log_string(backtrace_string(frames, frame_count).c_str());
+void backtrace_log(const uintptr_t* frames, size_t frame_count, async_safe_log_batch* batch) {
+  std::string str = backtrace_string(frames, frame_count);
+  if (batch != nullptr) {
+    async_safe_log_batch_write(batch, str.c_str());
+  } else {
+    error_log_string(str.c_str());
+  }
 }
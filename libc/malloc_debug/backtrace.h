@@ -33,8 +33,11 @@
 
 #include <string>
 
+#include <async_safe/log.h>
+
 void backtrace_startup();
 void backtrace_shutdown();
 size_t backtrace_get(uintptr_t* frames, size_t frame_count);
-void backtrace_log(const uintptr_t* frames, size_t frame_count);
+void backtrace_log(const uintptr_t* frames, size_t frame_count,
+                   async_safe_log_batch* batch = nullptr);
 std::string backtrace_string(const uintptr_t* frames, size_t frame_count);
@@ -54,9 +54,13 @@ size_t backtrace_get(uintptr_t* frames, size_t frame_num) {
   return total_frames;
 }
 
-void backtrace_log(const uintptr_t* frames, size_t frame_count) {
+void backtrace_log(const uintptr_t* frames, size_t frame_count, async_safe_log_batch* batch) {
   for (size_t i = 0; i < frame_count; i++) {
-    error_log("  #%02zd pc %p", i, reinterpret_cast<void*>(frames[i]));
+    if (batch != nullptr) {
+      async_safe_log_batch_format(batch, "  #%02zd pc %p", i, reinterpret_cast<void*>(frames[i]));
+    } else {
+      error_log("  #%02zd pc %p", i, reinterpret_cast<void*>(frames[i]));
+    }
   }
 }
 
@@ -85,4 +89,5 @@ bool Unwind(std::vector<uintptr_t>* frames, std::vector<unwindstack::FrameData>*
   return true;
 }
 
-void UnwindLog(const std::vector<unwindstack::FrameData>& /*frame_info*/) {}
+void UnwindLog(const std::vector<unwindstack::FrameData>& /*frame_info*/,
+               async_safe_log_batch* /*batch*/) {}
@@ -20,6 +20,7 @@
 #include <string>
 
 #include <android-base/stringprintf.h>
+#include <async_safe/log.h>
 #include <log/log.h>
 
 // Forward declarations.
@@ -63,6 +64,37 @@ extern "C" int async_safe_write_log(int priority, const char* tag, const char* m
   return 0;
 }
 
+extern "C" void async_safe_log_close() {}
+
+// Batched messages are logged immediately, so that they're interleaved with unbatched ones
+// exactly as they would be in the real log.
+extern "C" void async_safe_log_batch_init(async_safe_log_batch* batch, int priority,
+                                          const char* tag) {
+  batch->priority = priority;
+  batch->tag = tag;
+}
+
+extern "C" int async_safe_log_batch_format(async_safe_log_batch* batch, const char* format, ...) {
+  g_fake_log_print += std::to_string(batch->priority) + ' ' + batch->tag + ' ';
+
+  va_list ap;
+  va_start(ap, format);
+  android::base::StringAppendV(&g_fake_log_print, format, ap);
+  va_end(ap);
+
+  g_fake_log_print += '\n';
+
+  return 0;
+}
+
+extern "C" int async_safe_log_batch_write(async_safe_log_batch* batch, const char* msg) {
+  return async_safe_write_log(batch->priority, batch->tag, msg);
+}
+
+extern "C" int async_safe_log_batch_flush(async_safe_log_batch*) {
+  return 0;
+}
+
 extern "C" int __android_log_buf_write(int bufId, int prio, const char* tag, const char* msg) {
   g_fake_log_buf += std::to_string(bufId) + ' ' + std::to_string(prio) + ' ';
   g_fake_log_buf += tag;
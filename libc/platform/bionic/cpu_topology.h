@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <sched.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+// A group of CPUs with the same capacity that share a frequency domain: on a
+// big.LITTLE (or DynamIQ) SoC, one per kind of core.
+struct android_cpu_cluster {
+  // The CPUs in the cluster, online or not. Only CPUs below CPU_SETSIZE fit,
+  // which on LP32 is just 32.
+  cpu_set_t cpus;
+
+  // The number of CPUs in the cluster, including any that don't fit in `cpus`.
+  int cpu_count;
+
+  // The kernel's capacity for these CPUs, relative to 1024 for the biggest
+  // CPU in the system, or 0 if the kernel doesn't say.
+  uint32_t capacity;
+
+  // The highest frequency these CPUs can run at, in kHz, or 0 if unknown.
+  uint32_t max_freq_khz;
+};
+
+// Fills in up to `count` clusters, ordered from the lowest capacity to the
+// highest, and returns the total number of clusters (which may be more than
+// `count`). The topology is read from sysfs the first time and then cached.
+size_t android_get_cpu_clusters(struct android_cpu_cluster* clusters, size_t count);
+
+// Drops libc's cached view of the CPUs: the cluster list, and the online CPU
+// count returned by get_nprocs() and sysconf(_SC_NPROCESSORS_ONLN), which is
+// otherwise only re-read from sysfs at most every 100ms. Call this after
+// bringing CPUs online or taking them offline.
+void android_cpu_topology_changed(void);
+
+__END_DECLS
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <dirent.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+__BEGIN_DECLS
+
+// Returns the next batch of entries from `dir` in place, without copying them
+// out of the buffer getdents64 filled: `*entries` is set to the first entry,
+// and each entry's d_reclen is the offset of the next. The return value is
+// the size of the batch in bytes, 0 at the end of the directory, or -1 with
+// errno set on failure. The batch is only valid until the next call to this
+// function, readdir(), rewinddir(), seekdir(), or closedir() on `dir`.
+//
+// The buffer starts at about 4KiB and grows while reads keep filling it, so
+// large directories come back in fewer, bigger batches.
+ssize_t android_readdir_batch(DIR* dir, struct dirent** entries);
+
+// Like scandirat(), but the array and all the entries it points to are a
+// single allocation: free `*name_list` and nothing else. Pass a null
+// `comparator` to get the entries in directory order, skipping the sort.
+int android_scandirat(int parent_fd, const char* dir_name, struct dirent*** name_list,
+                      int (*filter)(const struct dirent*),
+                      int (*comparator)(const struct dirent**, const struct dirent**));
+
+__END_DECLS
@@ -31,6 +31,7 @@
 #include <malloc.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <sys/types.h>
 
 // Structures for android_mallopt.
 
@@ -137,3 +138,31 @@ typedef struct {
 //
 // On success, returns true. On failure, returns false and sets errno.
 extern "C" bool android_mallopt(int opcode, void* arg, size_t arg_size);
+
+// Calls `callback` for every allocation that starts in [base, base+size), like
+// malloc_iterate(), but without keeping every other thread out of malloc for
+// the whole walk. The range is walked `chunk_size` bytes at a time, each chunk
+// between its own malloc_disable() and malloc_enable(), so other threads can
+// allocate between chunks. This needs an allocator that can walk part of its
+// heap: jemalloc only visits the chunk's own extents, but Scudo visits every
+// block of every region and filters by address. With Scudo, `chunk_size` is
+// ignored and the range is walked in one go, exactly as malloc_iterate()
+// would, since splitting it would multiply the cost without shortening any
+// pause. As with malloc_iterate(), `callback` is called with malloc disabled,
+// so it mustn't allocate.
+//
+// Each chunk is seen as it was at one moment, but different chunks are seen at
+// different moments: an allocation can be freed from a chunk that's already
+// been walked, or made in one that hasn't. With `verify`, every chunk is
+// walked again after the first pass, and a fingerprint of its allocations (a
+// per-chunk generation) is compared with the one from the first pass. If no
+// chunk changed, what `callback` saw is the whole heap range as it was at the
+// end of the first pass, barring a chunk changing and changing back exactly.
+//
+// Returns the number of chunks that changed (always 0 without `verify`), or -1
+// on failure.
+extern "C" ssize_t android_malloc_iterate_incremental(uintptr_t base, size_t size,
+                                                      size_t chunk_size,
+                                                      void (*callback)(uintptr_t base, size_t size,
+                                                                       void* arg),
+                                                      void* arg, bool verify);
@@ -18,6 +18,7 @@
 
 #include <dirent.h>
 
+#include "platform/bionic/dirent_batch.h"
 #include "platform/bionic/macros.h"
 
 class ScopedReaddir {
@@ -43,6 +44,10 @@ class ScopedReaddir {
     return readdir(dir_);
   }
 
+  ssize_t ReadBatch(dirent** entries) {
+    return android_readdir_batch(dir_, entries);
+  }
+
  private:
   DIR* dir_;
 
@@ -30,6 +30,20 @@
 #define _PRIVATE_BIONIC_ARC4RANDOM_H_
 
 #include <stddef.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+// Each thread's arc4random(3) state (a ChaCha20 key and a buffer of its
+// keystream), which lives in its bionic_tls. All zeroes means "not yet seeded".
+struct arc4random_state_t {
+  uint32_t input[16];
+  uint8_t buf[512];
+  size_t have;
+  size_t count;
+  // The process the state was seeded in, or 0 if it hasn't been.
+  pid_t pid;
+};
 
 // arc4random(3) aborts if it's unable to fetch entropy, which is always
 // the case for init on devices. GCE kernels have a workaround to ensure
@@ -38,4 +52,8 @@
 // entropy for getrandom(2) or /dev/urandom.
 void __libc_safe_arc4random_buf(void* buf, size_t n);
 
+// Discards the calling thread's arc4random(3) state, so that a fork child
+// doesn't produce the same output as its parent.
+__LIBC_HIDDEN__ void __libc_arc4random_fork_child();
+
 #endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2008 The Android Open Source Project
+ * Copyright (C) 2022 The Android Open Source Project
  * All rights reserved.
  *
  * Redistribution and use in source and binary forms, with or without
@@ -26,17 +26,12 @@
  * SUCH DAMAGE.
  */
 
-#include <pthread.h>
-#include "private/thread_private.h"
+#pragma once
 
-// Some simple glue used to make BSD code thread-safe.
+#include <sys/cdefs.h>
 
-static pthread_mutex_t g_arc4_lock = PTHREAD_MUTEX_INITIALIZER;
+// Answers sysconf's _SC_LEVEL*_CACHE_* queries from CPUID (x86) or sysfs.
+__LIBC_HIDDEN__ long __sysconf_cache(int name);
 
-void _thread_arc4_lock() {
-  pthread_mutex_lock(&g_arc4_lock);
-}
-
-void _thread_arc4_unlock() {
-  pthread_mutex_unlock(&g_arc4_lock);
-}
+// Makes the next get_nprocs() re-read the online CPUs from sysfs.
+__LIBC_HIDDEN__ void __invalidate_nprocs();
@@ -62,6 +62,11 @@ struct libc_globals {
   // limit is enabled and some other hook is enabled at the same time.
   _Atomic(const MallocDispatch*) default_dispatch_table;
   MallocDispatch malloc_dispatch_table;
+
+  // Set when GWP-ASan is enabled. Its sampling is inlined into the native
+  // allocator's fast path rather than installed as the current dispatch table
+  // (see gwp_asan_wrappers.h).
+  bool gwp_asan_enabled;
 };
 
 __LIBC_HIDDEN__ extern WriteProtected<libc_globals> __libc_globals;
@@ -99,6 +104,9 @@ struct libc_shared_globals {
   void (*load_hook)(ElfW(Addr) base, const ElfW(Phdr)* phdr, ElfW(Half) phnum) = nullptr;
   void (*unload_hook)(ElfW(Addr) base, const ElfW(Phdr)* phdr, ElfW(Half) phnum) = nullptr;
   void (*set_target_sdk_version_hook)(int target) = nullptr;
+  // Called around each library's constructors.
+  void (*constructors_begin_hook)() = nullptr;
+  void (*constructors_end_hook)() = nullptr;
 
   // Values passed from the linker to libc.so.
   const char* init_progname = nullptr;
@@ -117,6 +125,7 @@ struct libc_shared_globals {
 __LIBC_HIDDEN__ libc_shared_globals* __libc_shared_globals();
 __LIBC_HIDDEN__ void __libc_init_fdsan();
 __LIBC_HIDDEN__ void __libc_init_fdtrack();
+__LIBC_HIDDEN__ void __libc_init_fast_exit();
 __LIBC_HIDDEN__ void __libc_init_profiling_handlers();
 
 __LIBC_HIDDEN__ void __libc_init_malloc(libc_globals* globals);
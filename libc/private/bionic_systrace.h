@@ -35,3 +35,8 @@ class __LIBC_HIDDEN__ ScopedTrace {
 
 void bionic_trace_begin(const char* message);
 void bionic_trace_end();
+
+// When buffered tracing is on, these write out the calling thread's buffered events.
+// bionic_trace_thread_exit also frees the buffer.
+void bionic_trace_flush();
+void bionic_trace_thread_exit();
@@ -31,14 +31,18 @@
 #include <locale.h>
 #include <mntent.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <sys/cdefs.h>
 #include <sys/param.h>
 
 #include <platform/bionic/tls.h>
 
 #include "platform/bionic/macros.h"
+#include "bionic_arc4random.h"
 #include "grp_pwd.h"
 
+struct bionic_trace_buffer;
+
 /** WARNING WARNING WARNING
  **
  ** This header file is *NOT* part of the public Bionic ABI/API and should not
@@ -128,14 +132,25 @@ struct bionic_tls {
   group_state_t group;
   passwd_state_t passwd;
 
+  arc4random_state_t arc4random_state;
+
+  // Allocated on the thread's first event when buffered tracing is on (see bionic_systrace.cpp).
+  bionic_trace_buffer* trace_buffer;
+
   char fdtrack_disabled;
   char bionic_systrace_disabled;
   char padding[2];
 
+  // Allocations left until this thread's next GWP-ASan sample, or zero before
+  // its first allocation, and the state of the generator that picks each one.
+  uint32_t gwp_asan_countdown;
+  uint32_t gwp_asan_random;
+
   // Initialize the main thread's final object using its bootstrap object.
-  void copy_from_bootstrap(const bionic_tls* boot __attribute__((unused))) {
-    // Nothing in bionic_tls needs to be preserved in the transition to the
-    // final TLS objects, so don't copy anything.
+  void copy_from_bootstrap(const bionic_tls* boot) {
+    // Only the trace buffer needs to be preserved in the transition to the final TLS objects,
+    // so that events recorded while the linker was starting the process aren't lost.
+    trace_buffer = boot->trace_buffer;
   }
 };
 
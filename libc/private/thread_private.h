@@ -24,13 +24,4 @@ __BEGIN_DECLS
 #define _MUTEX_LOCK(l) pthread_mutex_lock((pthread_mutex_t*) l)
 #define _MUTEX_UNLOCK(l) pthread_mutex_unlock((pthread_mutex_t*) l)
 
-__LIBC_HIDDEN__ void    _thread_arc4_lock(void);
-__LIBC_HIDDEN__ void    _thread_arc4_unlock(void);
-
-#define _ARC4_LOCK() _thread_arc4_lock()
-#define _ARC4_UNLOCK() _thread_arc4_unlock()
-#define _ARC4_ATFORK(f) pthread_atfork(NULL, NULL, (f))
-
-extern volatile sig_atomic_t _rs_forked;
-
 __END_DECLS
@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+
+"""Converts the files written by bionic's buffered tracing to JSON.
+
+When the libc.debug.systrace.dir property is set and bionic tracing is enabled
+(the ATRACE_TAG_BIONIC bit of debug.atrace.tags.enableflags), bionic records
+its trace events (dlopen, constructors, pthread contention...) in memory and
+writes them to <dir>/bionic_trace.<pid> rather than to the kernel's
+trace_marker. See libc/bionic/bionic_systrace.cpp for the file format.
+
+This writes the events in the Chrome JSON trace format, which Perfetto's UI
+(https://ui.perfetto.dev) and chrome://tracing can open.
+
+  usage: bionic_trace_to_json.py [-o trace.json] bionic_trace.1234 [...]
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+HEADER = struct.Struct("<4sIII")
+CHUNK = struct.Struct("<4sII")
+EVENT = struct.Struct("<QBB")
+
+
+def parse(path, events):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    pid = 0
+    pos = 0
+    while pos + 4 <= len(data):
+        magic = data[pos:pos + 4]
+        if magic == b"BTRH":
+            _, version, pid, _ = HEADER.unpack_from(data, pos)
+            if version != 1:
+                sys.exit("%s: unsupported version %d" % (path, version))
+            pos += HEADER.size
+        elif magic == b"BTRC":
+            _, tid, size = CHUNK.unpack_from(data, pos)
+            pos += CHUNK.size
+            end = pos + size
+            while pos < end:
+                timestamp_ns, event_type, length = EVENT.unpack_from(data, pos)
+                pos += EVENT.size
+                event = {
+                    "ph": chr(event_type),
+                    "ts": timestamp_ns / 1000.0,
+                    "pid": pid,
+                    "tid": tid,
+                }
+                if event_type == ord("B"):
+                    event["name"] = data[pos:pos + length].decode(errors="replace")
+                pos += length
+                events.append(event)
+        else:
+            sys.exit("%s: corrupt block at offset %d" % (path, pos))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-o", "--output", help="output file (default stdout)")
+    parser.add_argument("traces", nargs="+", help="bionic_trace.<pid> files")
+    args = parser.parse_args()
+
+    events = []
+    for path in args.traces:
+        parse(path, events)
+    # Threads' buffers are written out as they fill, so the file isn't in time order.
+    events.sort(key=lambda e: e["ts"])
+
+    output = open(args.output, "w") if args.output else sys.stdout
+    json.dump({"traceEvents": events, "displayTimeUnit": "ns"}, output)
+    output.write("\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -4,12 +4,13 @@
 import sys, os, string, re
 
 def usage():
-    print """\
-  usage:  genserv < /etc/services > libc/netbsd/net/services.h
+    print("""\
+  usage:  genserv < /etc/services > libc/dns/net/services.h
 
   this program is used to generate the hard-coded internet service list for the
-  Bionic C library.
-"""
+  Bionic C library, along with perfect hash tables that let getservbyname and
+  getservbyport find a record without scanning the list.
+""")
 
 re_service = re.compile(r"([\d\w\-_]+)\s+(\d+)/(tcp|udp)(.*)")
 re_alias   = re.compile(r"([\d\w\-_]+)(.*)")
@@ -20,10 +21,25 @@ class Service:
         self.port    = port
         self.proto   = proto
         self.aliases = []
+        self.offset  = 0
 
     def add_alias(self,alias):
         self.aliases.append(alias)
 
+    def encode(self):
+        result  = bytes([len(self.name)]) + self.name.encode()
+        result += bytes([(self.port >> 8) & 255, self.port & 255])
+        result += self.proto_char()
+        result += bytes([len(self.aliases)])
+        for alias in self.aliases:
+            result += bytes([len(alias)]) + alias.encode()
+        return result
+
+    def proto_char(self):
+        if self.proto == "tcp":
+            return b"t"
+        return b"u"
+
     def __str__(self):
         result  = "\\%0o%s" % (len(self.name),self.name)
         result += "\\%0o\\%0o" % (((self.port >> 8) & 255), self.port & 255)
@@ -40,35 +56,102 @@ class Service:
 
 def parse(f):
     result = []  # list of Service objects
-    for line in f.xreadlines():
+    for line in f:
         if len(line) > 0 and line[-1] == "\n":
             line = line[:-1]
         if len(line) > 0 and line[-1] == "\r":
             line = line[:-1]
 
-        line = string.strip(line)
+        line = line.strip()
         if len(line) == 0 or line[0] == "#":
             continue
 
         m = re_service.match(line)
         if m:
             service = Service( m.group(1), int(m.group(2)), m.group(3) )
-            rest    = string.strip(m.group(4))
+            rest    = m.group(4).strip()
 
             while 1:
                 m = re_alias.match(rest)
                 if not m:
                     break
                 service.add_alias(m.group(1))
-                rest = string.strip(m.group(2))
+                rest = m.group(2).strip()
 
             result.append(service)
 
     return result
 
+# Must match services_hash() in libc/dns/net/getservent.c.
+def services_hash(seed, key):
+    h = (2166136261 ^ seed) & 0xffffffff
+    for b in key:
+        h ^= b
+        h = (h * 16777619) & 0xffffffff
+    h ^= h >> 16
+    h = (h * 0x85ebca6b) & 0xffffffff
+    h ^= h >> 13
+    return h
+
+# Builds a minimal perfect hash ("hash and displace"): each key's bucket is
+# chosen with seed 0, and each bucket gets the first seed that sends all of
+# its keys to distinct free slots. Returns (seeds, slots).
+def perfect_hash(keys):
+    slot_count = len(keys)
+    bucket_count = max(1, (slot_count + 3) // 4)
+    buckets = [[] for _ in range(bucket_count)]
+    for key, value in keys:
+        buckets[services_hash(0, key) % bucket_count].append((key, value))
+
+    seeds = [0] * bucket_count
+    slots = [None] * slot_count
+    order = sorted(range(bucket_count), key=lambda b: -len(buckets[b]))
+    for b in order:
+        if not buckets[b]:
+            continue
+        for seed in range(1, 65536):
+            chosen = [services_hash(seed, key) % slot_count for key, _ in buckets[b]]
+            if len(set(chosen)) == len(chosen) and all(slots[s] is None for s in chosen):
+                break
+        else:
+            raise Exception("couldn't find a perfect hash seed")
+        seeds[b] = seed
+        for s, (_, value) in zip(chosen, buckets[b]):
+            slots[s] = value
+    return seeds, slots
+
+def c_array(name, values):
+    result = "static const uint16_t %s[%d] = {\n" % (name, len(values))
+    for i in range(0, len(values), 8):
+        result += "  " + " ".join("%d," % v for v in values[i:i+8]) + "\n"
+    result += "};\n"
+    return result
+
 services = parse(sys.stdin)
+
+offset = 0
+by_name = {}
+by_port = {}
+for s in services:
+    s.offset = offset
+    offset += len(s.encode())
+    # getservbyname/getservbyport return the first match, so keep the first.
+    by_name.setdefault(s.name.encode() + s.proto_char(), s.offset)
+    by_port.setdefault(bytes([(s.port >> 8) & 255, s.port & 255]) + s.proto_char(), s.offset)
+if offset >= 65536:
+    raise Exception("_services is too large for 16-bit offsets")
+
 line = '/* generated by genserv.py - do not edit */\nstatic const char  _services[] = "\\\n'
 for s in services:
     line += str(s)+"\\\n"
 line += '\\0";\n'
-print line
+
+name_seeds, name_slots = perfect_hash(sorted(by_name.items()))
+port_seeds, port_slots = perfect_hash(sorted(by_port.items()))
+
+line += "\n/* offsets into _services, keyed by (name, proto) and by (port, proto) */\n"
+line += c_array("_services_name_seeds", name_seeds)
+line += c_array("_services_name_slots", name_slots)
+line += c_array("_services_port_seeds", port_seeds)
+line += c_array("_services_port_slots", port_slots)
+print(line)
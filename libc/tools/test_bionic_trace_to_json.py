@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+# Unit tests for bionic_trace_to_json.py
+
+import os
+import struct
+import tempfile
+import unittest
+
+import bionic_trace_to_json
+
+CLOCK_MONOTONIC = 1
+
+
+def header(pid):
+  return struct.pack("<4sIII", b"BTRH", 1, pid, CLOCK_MONOTONIC)
+
+
+def chunk(tid, *events):
+  data = b""
+  for timestamp_ns, event_type, message in events:
+    data += struct.pack("<QBB", timestamp_ns, ord(event_type), len(message)) + message
+  return struct.pack("<4sII", b"BTRC", tid, len(data)) + data
+
+
+class TestBionicTraceToJson(unittest.TestCase):
+  def parse(self, data):
+    with tempfile.NamedTemporaryFile(delete=False) as f:
+      f.write(data)
+    try:
+      events = []
+      bionic_trace_to_json.parse(f.name, events)
+      return events
+    finally:
+      os.unlink(f.name)
+
+  def test_events(self):
+    events = self.parse(header(100) +
+                        chunk(101, (2000, "B", b"dlopen"), (5000, "E", b"")) +
+                        chunk(100, (1000, "B", b"pthread_create"), (1500, "E", b"")))
+    self.assertEqual(events, [
+        {"ph": "B", "ts": 2.0, "pid": 100, "tid": 101, "name": "dlopen"},
+        {"ph": "E", "ts": 5.0, "pid": 100, "tid": 101},
+        {"ph": "B", "ts": 1.0, "pid": 100, "tid": 100, "name": "pthread_create"},
+        {"ph": "E", "ts": 1.5, "pid": 100, "tid": 100},
+    ])
+
+  def test_header_per_open(self):
+    # The linker and libc each write a header when they open the file.
+    events = self.parse(header(7) + chunk(7, (1000, "B", b"linker")) +
+                        header(7) + chunk(7, (2000, "E", b"")))
+    self.assertEqual([e["pid"] for e in events], [7, 7])
+    self.assertEqual([e["ph"] for e in events], ["B", "E"])
+
+  def test_empty_file(self):
+    self.assertEqual(self.parse(b""), [])
+
+  def test_bad_version(self):
+    with self.assertRaises(SystemExit):
+      self.parse(struct.pack("<4sIII", b"BTRH", 2, 1, CLOCK_MONOTONIC))
+
+  def test_corrupt_block(self):
+    with self.assertRaises(SystemExit):
+      self.parse(header(1) + b"XXXX")
+
+
+if __name__ == '__main__':
+  unittest.main()
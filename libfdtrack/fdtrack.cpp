@@ -26,23 +26,30 @@
  * SUCH DAMAGE.
  */
 
+#include <dlfcn.h>
 #include <inttypes.h>
+#include <link.h>
+#include <pthread.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include <algorithm>
 #include <array>
-#include <mutex>
+#include <atomic>
+#include <memory>
 #include <string>
-#include <string_view>
 #include <thread>
 #include <utility>
 #include <vector>
 
 #include <android/fdsan.h>
 #include <android/set_abort_message.h>
+#include <bionic/android_unsafe_frame_pointer_chase.h>
 #include <bionic/fdtrack.h>
 
 #include <android-base/no_destructor.h>
-#include <android-base/thread_annotations.h>
+#include <android-base/properties.h>
 #include <async_safe/log.h>
 #include <bionic/reserved_signals.h>
 #include <unwindstack/Maps.h>
@@ -50,9 +57,19 @@
 #include <unwindstack/RegsGetLocal.h>
 #include <unwindstack/Unwinder.h>
 
-struct FdEntry {
-  std::mutex mutex;
-  std::vector<unwindstack::FrameData> backtrace GUARDED_BY(mutex);
+// Only unwind up to 32 frames outside of libfdtrack.so.
+static constexpr size_t kStackDepth = 32;
+
+// A deduplicated creation backtrace. Once published in the intern table these are immutable and
+// never freed, so readers don't need any locking.
+struct InternedStack {
+  size_t index = 0;  // The slot in interned_stacks.
+  uint64_t hash = 0;
+  size_t depth = 0;
+  uint64_t pcs[kStackDepth] = {};
+  std::string names[kStackDepth];
+  const char* function_names[kStackDepth] = {};
+  uint64_t function_offsets[kStackDepth] = {};
 };
 
 extern "C" void fdtrack_dump();
@@ -62,19 +79,65 @@ using fdtrack_callback_t = bool (*)(int fd, const char* const* function_names,
                                     const uint64_t* function_offsets, size_t count, void* arg);
 extern "C" void fdtrack_iterate(fdtrack_callback_t callback, void* arg);
 
+using fdtrack_stack_callback_t = bool (*)(size_t fd_count, const char* const* function_names,
+                                          const uint64_t* function_offsets, size_t count,
+                                          void* arg);
+extern "C" void fdtrack_iterate_stacks(fdtrack_stack_callback_t callback, void* arg);
+
 static void fd_hook(android_fdtrack_event* event);
 
 // Backtraces for the first 4k file descriptors ought to be enough to diagnose an fd leak.
 static constexpr size_t kFdTableSize = 4096;
 
-// Only unwind up to 32 frames outside of libfdtrack.so.
-static constexpr size_t kStackDepth = 32;
+// Distinct creation backtraces are far rarer than fds. Once this many have been seen, fds created
+// from new backtraces aren't tracked.
+static constexpr size_t kInternTableSize = 4096;
 
 // Skip any initial frames from libfdtrack.so.
 static std::vector<std::string> kSkipFdtrackLib [[clang::no_destroy]] = {"libfdtrack.so"};
 
+// Setting debug.fdtrack.unwinder to "fp" before libfdtrack is loaded unwinds by following frame
+// pointers rather than with libunwindstack. That's cheap enough to leave on, but it can't unwind
+// through code built without frame pointers (including ART's managed frames). It's not available
+// on 32-bit ARM, where frame records have no standard layout.
+enum class UnwindMode {
+  kFull,
+  kFramePointer,
+};
+
+static UnwindMode unwind_mode = UnwindMode::kFull;
+
+// Setting debug.fdtrack.sample_interval to N records the backtraces of roughly 1 in N fd
+// creations, chosen at random. Counts reported per backtrace are scaled back up by N.
+static uint32_t sample_interval = 1;
+
 static bool installed = false;
-static std::array<FdEntry, kFdTableSize> stack_traces [[clang::no_destroy]];
+static std::array<std::atomic<InternedStack*>, kFdTableSize> fd_stacks;
+static std::array<std::atomic<InternedStack*>, kInternTableSize> interned_stacks;
+static std::atomic<size_t> intern_overflows = 0;
+
+// The number of sampled fds currently open from each interned backtrace, split across threads so
+// that threads creating fds from the same backtrace don't fight over one counter's cache line.
+// Only the owning thread writes a buffer, so updates are plain loads and stores rather than atomic
+// read-modify-writes; fd_hook can't nest, since bionic disables fdtrack while it runs. An fd closed
+// on another thread is subtracted from that thread's buffer, so a single buffer's count can go
+// negative and only the sum over all of them is meaningful. Buffers are never freed: a thread
+// that exits hands its buffer, counts and all, to the next thread that needs one.
+struct ThreadCounts {
+  std::atomic<bool> in_use = true;
+  ThreadCounts* next = nullptr;
+  std::array<std::atomic<int32_t>, kInternTableSize> live_fds = {};
+};
+
+static std::atomic<ThreadCounts*> thread_counts_list = nullptr;
+static thread_local ThreadCounts* thread_counts = nullptr;
+static pthread_key_t thread_counts_key;
+static bool have_thread_counts_key = false;
+
+// The extent of libfdtrack.so's own mappings, for skipping its frames in frame pointer unwinds.
+static uintptr_t self_start = 0;
+static uintptr_t self_end = 0;
+
 static unwindstack::LocalUpdatableMaps& Maps() {
   static android::base::NoDestructor<unwindstack::LocalUpdatableMaps> maps;
   return *maps.get();
@@ -84,10 +147,87 @@ static std::shared_ptr<unwindstack::Memory>& ProcessMemory() {
   return *process_memory.get();
 }
 
-__attribute__((constructor)) static void ctor() {
-  for (auto& entry : stack_traces) {
-    entry.backtrace.reserve(kStackDepth);
+static void FindSelf() {
+  Dl_info info;
+  if (dladdr(reinterpret_cast<void*>(&fd_hook), &info) == 0) return;
+  dl_iterate_phdr(
+      [](dl_phdr_info* info, size_t, void* base) {
+        if (reinterpret_cast<void*>(info->dlpi_addr) != base) return 0;
+        for (size_t i = 0; i < info->dlpi_phnum; ++i) {
+          const ElfW(Phdr)& phdr = info->dlpi_phdr[i];
+          if (phdr.p_type != PT_LOAD) continue;
+          uintptr_t start = info->dlpi_addr + phdr.p_vaddr;
+          uintptr_t end = start + phdr.p_memsz;
+          if (self_start == 0 || start < self_start) self_start = start;
+          if (end > self_end) self_end = end;
+        }
+        return 1;
+      },
+      info.dli_fbase);
+}
+
+static void ReadOptions() {
+  if (android::base::GetProperty("debug.fdtrack.unwinder", "") == "fp") {
+#if defined(__arm__)
+    async_safe_format_log(ANDROID_LOG_WARN, "fdtrack",
+                          "frame pointer unwinding isn't supported on 32-bit ARM");
+#else
+    unwind_mode = UnwindMode::kFramePointer;
+#endif
+  }
+  sample_interval = android::base::GetUintProperty<uint32_t>("debug.fdtrack.sample_interval", 1);
+  if (sample_interval == 0) sample_interval = 1;
+}
+
+static void ReleaseThreadCounts(void* counts) {
+  thread_counts = nullptr;
+  static_cast<ThreadCounts*>(counts)->in_use.store(false, std::memory_order_release);
+}
+
+static ThreadCounts* GetThreadCounts() {
+  if (thread_counts != nullptr) return thread_counts;
+
+  ThreadCounts* head = thread_counts_list.load(std::memory_order_acquire);
+  for (ThreadCounts* counts = head; counts != nullptr; counts = counts->next) {
+    bool in_use = false;
+    if (!counts->in_use.load(std::memory_order_relaxed) &&
+        counts->in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire)) {
+      thread_counts = counts;
+      break;
+    }
+  }
+  if (thread_counts == nullptr) {
+    ThreadCounts* counts = new ThreadCounts;
+    counts->next = head;
+    while (!thread_counts_list.compare_exchange_weak(counts->next, counts,
+                                                     std::memory_order_acq_rel)) {
+    }
+    thread_counts = counts;
+  }
+
+  if (have_thread_counts_key) pthread_setspecific(thread_counts_key, thread_counts);
+  return thread_counts;
+}
+
+static void AddLiveFds(InternedStack* stack, int32_t delta) {
+  std::atomic<int32_t>& count = GetThreadCounts()->live_fds[stack->index];
+  count.store(count.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+static size_t LiveFds(InternedStack* stack) {
+  int64_t total = 0;
+  for (ThreadCounts* counts = thread_counts_list.load(std::memory_order_acquire);
+       counts != nullptr; counts = counts->next) {
+    total += counts->live_fds[stack->index].load(std::memory_order_relaxed);
   }
+  // The buffers aren't read at a single instant, so a close can be seen without its create.
+  return total > 0 ? total : 0;
+}
+
+__attribute__((constructor)) static void ctor() {
+  ReadOptions();
+  FindSelf();
+  have_thread_counts_key = pthread_key_create(&thread_counts_key, ReleaseThreadCounts) == 0;
 
   struct sigaction sa = {};
   sa.sa_sigaction = [](int, siginfo_t* siginfo, void*) {
@@ -116,71 +256,179 @@ __attribute__((destructor)) static void dtor() {
   }
 }
 
-FdEntry* GetFdEntry(int fd) {
+std::atomic<InternedStack*>* GetFdEntry(int fd) {
   if (fd >= 0 && fd < static_cast<int>(kFdTableSize)) {
-    return &stack_traces[fd];
+    return &fd_stacks[fd];
+  }
+  return nullptr;
+}
+
+static uint64_t HashPcs(const uint64_t* pcs, size_t depth) {
+  uint64_t hash = depth;
+  for (size_t i = 0; i < depth; ++i) {
+    hash = (hash ^ pcs[i]) * 0x100000001b3ULL;
+    hash ^= hash >> 29;
+  }
+  return hash;
+}
+
+// Returns the interned copy of the backtrace `pcs`, or nullptr if the table is full. `symbolize`
+// fills in the names and offsets of a new entry, so it's only called for backtraces that haven't
+// been seen before.
+template <typename Symbolize>
+static InternedStack* Intern(const uint64_t* pcs, size_t depth, Symbolize symbolize) {
+  uint64_t hash = HashPcs(pcs, depth);
+  InternedStack* candidate = nullptr;
+  size_t mask = kInternTableSize - 1;
+  for (size_t probes = 0, i = hash & mask; probes < kInternTableSize;
+       ++probes, i = (i + 1) & mask) {
+    InternedStack* existing = interned_stacks[i].load(std::memory_order_acquire);
+    if (existing == nullptr) {
+      if (candidate == nullptr) {
+        candidate = new InternedStack;
+        candidate->hash = hash;
+        candidate->depth = depth;
+        memcpy(candidate->pcs, pcs, depth * sizeof(*pcs));
+        symbolize(candidate);
+        for (size_t j = 0; j < depth; ++j) {
+          candidate->function_names[j] = candidate->names[j].c_str();
+        }
+      }
+      candidate->index = i;
+      if (interned_stacks[i].compare_exchange_strong(existing, candidate,
+                                                     std::memory_order_acq_rel)) {
+        return candidate;
+      }
+      // Another thread claimed this slot first; `existing` is now its entry.
+    }
+    if (existing->hash == hash && existing->depth == depth &&
+        memcmp(existing->pcs, pcs, depth * sizeof(*pcs)) == 0) {
+      delete candidate;
+      return existing;
+    }
   }
+
+  delete candidate;
+  ++intern_overflows;
   return nullptr;
 }
 
+// Fills in the function names and offsets of a newly interned backtrace from its pcs.
+static void SymbolizePcs(InternedStack* stack) {
+  unwindstack::Unwinder unwinder(kStackDepth, &Maps(), ProcessMemory());
+  unwinder.SetArch(unwindstack::Regs::CurrentArch());
+  for (size_t i = 0; i < stack->depth; ++i) {
+    unwindstack::FrameData frame = unwinder.BuildFrameFromPcOnly(stack->pcs[i]);
+    stack->names[i] = frame.function_name;
+    stack->function_offsets[i] = frame.function_offset;
+  }
+}
+
+static InternedStack* CaptureFull() {
+  std::unique_ptr<unwindstack::Regs> regs(unwindstack::Regs::CreateFromLocal());
+  unwindstack::RegsGetLocal(regs.get());
+  unwindstack::Unwinder unwinder(kStackDepth, &Maps(), regs.get(), ProcessMemory());
+  // Looking up function names is most of the cost of an unwind, and only a new backtrace needs
+  // them, so SymbolizePcs resolves them from the pcs instead.
+  unwinder.SetResolveNames(false);
+  unwinder.Unwind(&kSkipFdtrackLib);
+
+  const std::vector<unwindstack::FrameData>& frames = unwinder.frames();
+  uint64_t pcs[kStackDepth];
+  size_t depth = std::min(frames.size(), kStackDepth);
+  for (size_t i = 0; i < depth; ++i) {
+    pcs[i] = frames[i].pc;
+  }
+  return Intern(pcs, depth, SymbolizePcs);
+}
+
+static InternedStack* CaptureFramePointers() {
+  // Leave room for the frames in libfdtrack.so that are skipped.
+  uintptr_t frames[kStackDepth + 8];
+  size_t frame_count =
+      std::min(android_unsafe_frame_pointer_chase(frames, std::size(frames)), std::size(frames));
+  size_t first = 0;
+  while (first < frame_count && frames[first] >= self_start && frames[first] < self_end) {
+    ++first;
+  }
+
+  uint64_t pcs[kStackDepth];
+  size_t depth = std::min(frame_count - first, kStackDepth);
+  for (size_t i = 0; i < depth; ++i) {
+    pcs[i] = frames[first + i];
+  }
+  return Intern(pcs, depth, SymbolizePcs);
+}
+
+// Each thread counts down to its next sample independently, so sampling needs no shared state.
+// The intervals are randomized so that periodic patterns of fd creation can't alias with them.
+static bool ShouldSample() {
+  if (sample_interval == 1) return true;
+
+  static thread_local uint32_t countdown = 0;
+  if (countdown == 0) {
+    countdown = 1 + arc4random_uniform(2 * sample_interval - 1);
+  }
+  return --countdown == 0;
+}
+
+static void SetFdStack(std::atomic<InternedStack*>* entry, InternedStack* stack) {
+  if (stack != nullptr) AddLiveFds(stack, 1);
+  InternedStack* old = entry->exchange(stack, std::memory_order_acq_rel);
+  if (old != nullptr) AddLiveFds(old, -1);
+}
+
 static void fd_hook(android_fdtrack_event* event) {
+  std::atomic<InternedStack*>* entry = GetFdEntry(event->fd);
+  if (!entry) return;
+
   if (event->type == ANDROID_FDTRACK_EVENT_TYPE_CREATE) {
-    if (FdEntry* entry = GetFdEntry(event->fd); entry) {
-      std::lock_guard<std::mutex> lock(entry->mutex);
-      entry->backtrace.clear();
-
-      std::unique_ptr<unwindstack::Regs> regs(unwindstack::Regs::CreateFromLocal());
-      unwindstack::RegsGetLocal(regs.get());
-      unwindstack::Unwinder unwinder(kStackDepth, &Maps(), regs.get(), ProcessMemory());
-      unwinder.Unwind(&kSkipFdtrackLib);
-      entry->backtrace = unwinder.ConsumeFrames();
+    InternedStack* stack = nullptr;
+    if (ShouldSample()) {
+      stack = (unwind_mode == UnwindMode::kFramePointer) ? CaptureFramePointers() : CaptureFull();
     }
+    SetFdStack(entry, stack);
   } else if (event->type == ANDROID_FDTRACK_EVENT_TYPE_CLOSE) {
-    if (FdEntry* entry = GetFdEntry(event->fd); entry) {
-      std::lock_guard<std::mutex> lock(entry->mutex);
-      entry->backtrace.clear();
-    }
+    SetFdStack(entry, nullptr);
   }
 }
 
 void fdtrack_iterate(fdtrack_callback_t callback, void* arg) {
   bool prev = android_fdtrack_set_enabled(false);
 
-  for (int fd = 0; fd < static_cast<int>(stack_traces.size()); ++fd) {
-    const char* function_names[kStackDepth];
-    uint64_t function_offsets[kStackDepth];
-    FdEntry* entry = GetFdEntry(fd);
+  for (int fd = 0; fd < static_cast<int>(fd_stacks.size()); ++fd) {
+    std::atomic<InternedStack*>* entry = GetFdEntry(fd);
     if (!entry) {
       continue;
     }
 
-    if (!entry->mutex.try_lock()) {
-      async_safe_format_log(ANDROID_LOG_WARN, "fdtrack", "fd %d locked, skipping", fd);
-      continue;
-    }
-
-    if (entry->backtrace.empty()) {
-      entry->mutex.unlock();
+    InternedStack* stack = entry->load(std::memory_order_acquire);
+    if (stack == nullptr || stack->depth == 0) {
       continue;
-    } else if (entry->backtrace.size() < 2) {
+    } else if (stack->depth < 2) {
       async_safe_format_log(ANDROID_LOG_WARN, "fdtrack", "fd %d missing frames: size = %zu", fd,
-                            entry->backtrace.size());
-
-      entry->mutex.unlock();
+                            stack->depth);
       continue;
     }
 
-    for (size_t i = 0; i < entry->backtrace.size(); ++i) {
-      function_names[i] = entry->backtrace[i].function_name.c_str();
-      function_offsets[i] = entry->backtrace[i].function_offset;
+    if (!callback(fd, stack->function_names, stack->function_offsets, stack->depth, arg)) {
+      break;
     }
+  }
 
-    bool should_continue =
-        callback(fd, function_names, function_offsets, entry->backtrace.size(), arg);
+  android_fdtrack_set_enabled(prev);
+}
 
-    entry->mutex.unlock();
+void fdtrack_iterate_stacks(fdtrack_stack_callback_t callback, void* arg) {
+  bool prev = android_fdtrack_set_enabled(false);
 
-    if (!should_continue) {
+  for (auto& slot : interned_stacks) {
+    InternedStack* stack = slot.load(std::memory_order_acquire);
+    if (stack == nullptr) continue;
+    size_t live_fds = LiveFds(stack);
+    if (live_fds == 0 || stack->depth == 0) continue;
+    if (!callback(live_fds * sample_interval, stack->function_names, stack->function_offsets,
+                  stack->depth, arg)) {
       break;
     }
   }
@@ -188,17 +436,6 @@ void fdtrack_iterate(fdtrack_callback_t callback, void* arg) {
   android_fdtrack_set_enabled(prev);
 }
 
-static size_t hash_stack(const char* const* function_names, const uint64_t* function_offsets,
-                         size_t stack_depth) {
-  size_t hash = 0;
-  for (size_t i = 0; i < stack_depth; ++i) {
-    // To future maintainers: if a libc++ update ever makes this invalid, replace this with +.
-    hash = std::__hash_combine(hash, std::hash<std::string_view>()(function_names[i]));
-    hash = std::__hash_combine(hash, std::hash<uint64_t>()(function_offsets[i]));
-  }
-  return hash;
-}
-
 static void fdtrack_dump_impl(bool fatal) {
   if (!installed) {
     async_safe_format_log(ANDROID_LOG_INFO, "fdtrack", "fdtrack not installed");
@@ -206,29 +443,9 @@ static void fdtrack_dump_impl(bool fatal) {
     async_safe_format_log(ANDROID_LOG_INFO, "fdtrack", "fdtrack dumping...");
   }
 
-  // If we're aborting, identify the most common stack in the hopes that it's the culprit,
-  // and emit that in the abort message so crash reporting can separate different fd leaks out.
-  // This is horrible and quadratic, but we need to avoid allocation since this can happen in
-  // response to a signal generated asynchronously. We're only going to dump 1k fds by default,
-  // and we're about to blow up the entire system, so this isn't too expensive.
-  struct StackInfo {
-    size_t hash = 0;
-    size_t count = 0;
-
-    size_t stack_depth = 0;
-    const char* function_names[kStackDepth];
-    uint64_t function_offsets[kStackDepth];
-  };
-  struct StackList {
-    size_t count = 0;
-    std::array<StackInfo, 128> data;
-  };
-  static StackList stacks;
-
   fdtrack_iterate(
       [](int fd, const char* const* function_names, const uint64_t* function_offsets,
-         size_t stack_depth, void* stacks_ptr) {
-        auto stacks = static_cast<StackList*>(stacks_ptr);
+         size_t stack_depth, void*) {
         uint64_t fdsan_owner = android_fdsan_get_owner_tag(fd);
         if (fdsan_owner != 0) {
           async_safe_format_log(ANDROID_LOG_INFO, "fdtrack", "fd %d: (owner = 0x%" PRIx64 ")", fd,
@@ -242,46 +459,35 @@ static void fdtrack_dump_impl(bool fatal) {
                                 function_names[i], function_offsets[i]);
         }
 
-        if (stacks) {
-          size_t hash = hash_stack(function_names, function_offsets, stack_depth);
-          bool found_stack = false;
-          for (size_t i = 0; i < stacks->count; ++i) {
-            if (stacks->data[i].hash == hash) {
-              ++stacks->data[i].count;
-              found_stack = true;
-              break;
-            }
-          }
-
-          if (!found_stack) {
-            if (stacks->count < stacks->data.size()) {
-              auto& stack = stacks->data[stacks->count++];
-              stack.hash = hash;
-              stack.count = 1;
-              stack.stack_depth = stack_depth;
-              for (size_t i = 0; i < stack_depth; ++i) {
-                stack.function_names[i] = function_names[i];
-                stack.function_offsets[i] = function_offsets[i];
-              }
-            }
-          }
-        }
-
         return true;
       },
-      fatal ? &stacks : nullptr);
-
-  if (fatal) {
-    // Find the most common stack.
-    size_t max = 0;
-    StackInfo* stack = nullptr;
-    for (size_t i = 0; i < stacks.count; ++i) {
-      if (stacks.data[i].count > max) {
-        stack = &stacks.data[i];
-        max = stack->count;
-      }
+      nullptr);
+
+  // Backtraces are interned with a count of their open fds, so the most likely culprit for a leak
+  // can be found without allocating, which matters because this can happen in response to a
+  // signal generated asynchronously.
+  InternedStack* stack = nullptr;
+  size_t max = 0;
+  for (auto& slot : interned_stacks) {
+    InternedStack* candidate = slot.load(std::memory_order_acquire);
+    if (candidate == nullptr || candidate->depth == 0) continue;
+    size_t live_fds = LiveFds(candidate);
+    if (live_fds > max) {
+      stack = candidate;
+      max = live_fds;
     }
+  }
+  if (stack != nullptr) {
+    async_safe_format_log(ANDROID_LOG_INFO, "fdtrack",
+                          "most common stack: %zu fds (1 in %" PRIu32 " sampled)",
+                          max * sample_interval, sample_interval);
+  }
+  if (intern_overflows != 0) {
+    async_safe_format_log(ANDROID_LOG_WARN, "fdtrack", "%zu fds from untracked stacks",
+                          intern_overflows.load());
+  }
 
+  if (fatal) {
     static char buf[1024];
 
     if (!stack) {
@@ -292,7 +498,7 @@ static void fdtrack_dump_impl(bool fatal) {
       p += async_safe_format_buffer(buf, sizeof(buf),
                                     "aborting due to fd leak: most common stack =\n");
 
-      for (size_t i = 0; i < stack->stack_depth; ++i) {
+      for (size_t i = 0; i < stack->depth; ++i) {
         ssize_t bytes_left = buf + sizeof(buf) - p;
         if (bytes_left > 0) {
           p += async_safe_format_buffer(p, buf + sizeof(buf) - p, "  %zu: %s+%" PRIu64 "\n", i,
@@ -30,9 +30,12 @@
 #include <err.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <map>
+#include <thread>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -109,3 +112,87 @@ TEST(fdtrack, close) {
   ASSERT_NE(nullptr, strstr(result[fd1].at(0).function_name, "open"));
   ASSERT_NE(nullptr, strstr(result[fd3].at(0).function_name, "open"));
 }
+
+TEST(fdtrack, iterate_stacks) {
+  void* libfdtrack = dlopen("libfdtrack.so", RTLD_NOW);
+  ASSERT_NE(nullptr, libfdtrack) << dlerror();
+
+  using fdtrack_stack_callback_t =
+      bool (*)(size_t fd_count, const char* const* function_names,
+               const uint64_t* function_offsets, size_t count, void* arg);
+  auto fdtrack_iterate_stacks = reinterpret_cast<void (*)(fdtrack_stack_callback_t, void* arg)>(
+      dlsym(libfdtrack, "fdtrack_iterate_stacks"));
+  ASSERT_NE(nullptr, fdtrack_iterate_stacks);
+
+  // Every fd opened by this loop has the same backtrace, so they should be reported together.
+  std::vector<int> fds;
+  for (int i = 0; i < 4; ++i) {
+    fds.push_back(open("/dev/null", O_RDONLY | O_CLOEXEC));
+    ASSERT_NE(-1, fds.back());
+  }
+
+  size_t max_count = 0;
+  fdtrack_iterate_stacks(
+      [](size_t fd_count, const char* const* function_names, const uint64_t*, size_t count,
+         void* arg) {
+        if (count > 0 && strstr(function_names[0], "open") != nullptr) {
+          size_t* max_count = static_cast<size_t*>(arg);
+          *max_count = std::max(*max_count, fd_count);
+        }
+        return true;
+      },
+      &max_count);
+
+  for (int fd : fds) close(fd);
+  ASSERT_GE(max_count, 4U);
+}
+
+static int __attribute__((noinline)) OpenOnOtherThread() {
+  return open("/dev/null", O_RDONLY | O_CLOEXEC);
+}
+
+TEST(fdtrack, iterate_stacks_close_on_other_thread) {
+  void* libfdtrack = dlopen("libfdtrack.so", RTLD_NOW);
+  ASSERT_NE(nullptr, libfdtrack) << dlerror();
+
+  using fdtrack_stack_callback_t =
+      bool (*)(size_t fd_count, const char* const* function_names,
+               const uint64_t* function_offsets, size_t count, void* arg);
+  auto fdtrack_iterate_stacks = reinterpret_cast<void (*)(fdtrack_stack_callback_t, void* arg)>(
+      dlsym(libfdtrack, "fdtrack_iterate_stacks"));
+  ASSERT_NE(nullptr, fdtrack_iterate_stacks);
+
+  auto count_fds = [fdtrack_iterate_stacks]() {
+    size_t total = 0;
+    fdtrack_iterate_stacks(
+        [](size_t fd_count, const char* const* function_names, const uint64_t*, size_t count,
+           void* arg) {
+          for (size_t i = 0; i < count; ++i) {
+            if (strstr(function_names[i], "OpenOnOtherThread") != nullptr) {
+              *static_cast<size_t*>(arg) += fd_count;
+              break;
+            }
+          }
+          return true;
+        },
+        &total);
+    return total;
+  };
+
+  // Counts are kept per thread, so fds opened on other threads and closed on this one have to
+  // come out right once they're added up.
+  std::vector<int> fds(4, -1);
+  for (int& fd : fds) {
+    std::thread([&fd]() { fd = OpenOnOtherThread(); }).join();
+    ASSERT_NE(-1, fd);
+  }
+  ASSERT_EQ(4U, count_fds());
+
+  close(fds[0]);
+  close(fds[1]);
+  ASSERT_EQ(2U, count_fds());
+
+  close(fds[2]);
+  close(fds[3]);
+  ASSERT_EQ(0U, count_fds());
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vector_math.h"
+
+// The AArch64 vector function ABI's names for Advanced SIMD: _ZGVn, N for
+// unmasked, the lane count, then one v per vector argument. With no simdlen,
+// `#pragma omp declare simd` asks for both 64-bit and 128-bit variants, so the
+// float functions come in two widths. The ABI also says these use the vector
+// PCS, which keeps more of the SIMD registers live across the call.
+
+typedef double double2 __attribute__((__vector_size__(16)));
+typedef double double4 __attribute__((__vector_size__(32)));
+typedef float float2 __attribute__((__vector_size__(8)));
+typedef float float4 __attribute__((__vector_size__(16)));
+
+#define VECTOR_PCS extern "C" __attribute__((__aarch64_vector_pcs__))
+
+VECTOR_PCS double2 _ZGVnN2v_cos(double2 x) { return vm_cos(x); }
+VECTOR_PCS double2 _ZGVnN2v_exp(double2 x) { return vm_exp(x); }
+VECTOR_PCS double2 _ZGVnN2v_log(double2 x) { return vm_log(x); }
+VECTOR_PCS double2 _ZGVnN2vv_pow(double2 x, double2 y) { return vm_pow<double2, double>(x, y, pow); }
+VECTOR_PCS double2 _ZGVnN2v_sin(double2 x) { return vm_sin(x); }
+
+#define FLOAT_FUNCTIONS(F, VF, VFD)                                                      \
+  VECTOR_PCS VF _ZGVnN##F##v_cosf(VF x) { return vm_cosf<VF, VFD>(x); }                  \
+  VECTOR_PCS VF _ZGVnN##F##v_expf(VF x) { return vm_expf(x); }                           \
+  VECTOR_PCS VF _ZGVnN##F##v_logf(VF x) { return vm_logf(x); }                           \
+  VECTOR_PCS VF _ZGVnN##F##vv_powf(VF x, VF y) { return vm_pow<VF, float>(x, y, powf); } \
+  VECTOR_PCS VF _ZGVnN##F##v_sinf(VF x) { return vm_sinf<VF, VFD>(x); }
+
+FLOAT_FUNCTIONS(2, float2, double2)
+FLOAT_FUNCTIONS(4, float4, double4)
+
+// The array functions use the widest Advanced SIMD vectors.
+
+extern "C" void android_exp_array(const double* x, double* y, size_t n) {
+  vm_array<double2, double, vm_exp>(x, y, n);
+}
+extern "C" void android_expf_array(const float* x, float* y, size_t n) {
+  vm_array<float4, float, vm_expf>(x, y, n);
+}
+extern "C" void android_log_array(const double* x, double* y, size_t n) {
+  vm_array<double2, double, vm_log>(x, y, n);
+}
+extern "C" void android_logf_array(const float* x, float* y, size_t n) {
+  vm_array<float4, float, vm_logf>(x, y, n);
+}
+extern "C" void android_sincos_array(const double* x, double* s, double* c, size_t n) {
+  vm_array2<double2, double, vm_sincos>(x, s, c, n);
+}
+extern "C" void android_sincosf_array(const float* x, float* s, float* c, size_t n) {
+  vm_array2<float4, float, vm_sincosf<float4, double4>>(x, s, c, n);
+}
@@ -0,0 +1,783 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Table-driven sin, cos, sincos, tan, atan, atan2, asin and acos.
+//
+// These replace FreeBSD's s_sin.c, e_atan2.c and friends where fma() is a
+// single instruction. Rather than FreeBSD's branches on the size of the
+// argument and rational approximations with a division in them, the argument
+// is split into a table entry plus a small remainder, and the few steps that
+// need more than double precision use fma() to get the rounding error of a
+// product exactly. The results are within about 0.55 ULP.
+//
+// Only huge trigonometric arguments (|x| >= 2^23) still go through FreeBSD's
+// __ieee754_rem_pio2.
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define INLINE_REM_PIO2
+#include "math_private.h"
+#include "e_rem_pio2.c"
+
+// pi/2 and pi, as hi + lo.
+static const double kPiOver2Hi = 0x1.921fb54442d18p+0;
+static const double kPiOver2Lo = 0x1.1a62633145c07p-54;
+static const double kPiHi = 0x1.921fb54442d18p+1;
+static const double kPiLo = 0x1.1a62633145c07p-53;
+
+// Returns (oh + ol) + (hi + lo), for |hi| <= |oh|.
+static inline double add_angle(double oh, double ol, double hi, double lo) {
+  double s = oh + hi;
+  return s + (((oh - s) + hi) + (ol + lo));
+}
+
+//
+// sin, cos, sincos and tan.
+//
+// x = k*pi/64 + r, with |r| <= pi/128, and then
+//   sin(x) = sin(k*pi/64)*cos(r) + cos(k*pi/64)*sin(r)
+// where cos(k*pi/64) is just sin((k+32)*pi/64).
+//
+
+// sin(j*pi/64), as hi + lo.
+static const double kSinTable[128][2] = {
+  {0.0, 0.0},
+  {0x1.91f65f10dd814p-5, -0x1.912bd0d569a90p-61},
+  {0x1.917a6bc29b42cp-4, -0x1.e2718d26ed688p-60},
+  {0x1.2c8106e8e613ap-3, 0x1.13000a89a11e0p-58},
+  {0x1.8f8b83c69a60bp-3, -0x1.26d19b9ff8d82p-57},
+  {0x1.f19f97b215f1bp-3, -0x1.42deef11da2c4p-57},
+  {0x1.294062ed59f06p-2, -0x1.5d28da2c4612dp-56},
+  {0x1.58f9a75ab1fddp-2, -0x1.efdc0d58cf620p-62},
+  {0x1.87de2a6aea963p-2, -0x1.72cedd3d5a610p-57},
+  {0x1.b5d1009e15cc0p-2, 0x1.5b362cb974183p-57},
+  {0x1.e2b5d3806f63bp-2, 0x1.e0d891d3c6841p-58},
+  {0x1.073879922ffeep-1, -0x1.a5a014347406cp-55},
+  {0x1.1c73b39ae68c8p-1, 0x1.b25dd267f6600p-55},
+  {0x1.30ff7fce17035p-1, -0x1.efcc626f74a6fp-57},
+  {0x1.44cf325091dd6p-1, 0x1.8076a2cfdc6b3p-57},
+  {0x1.57d69348ceca0p-1, -0x1.75720992bfbb2p-55},
+  {0x1.6a09e667f3bcdp-1, -0x1.bdd3413b26456p-55},
+  {0x1.7b5df226aafafp-1, -0x1.0f537acdf0ad7p-56},
+  {0x1.8bc806b151741p-1, -0x1.2c5e12ed1336dp-55},
+  {0x1.9b3e047f38741p-1, -0x1.30ee286712474p-55},
+  {0x1.a9b66290ea1a3p-1, 0x1.9f630e8b6dac8p-60},
+  {0x1.b728345196e3ep-1, -0x1.bc69f324e6d61p-55},
+  {0x1.c38b2f180bdb1p-1, -0x1.6e0b1757c8d07p-56},
+  {0x1.ced7af43cc773p-1, -0x1.e7b6bb5ab58aep-58},
+  {0x1.d906bcf328d46p-1, 0x1.457e610231ac2p-56},
+  {0x1.e212104f686e5p-1, -0x1.014c76c126527p-55},
+  {0x1.e9f4156c62ddap-1, 0x1.760b1e2e3f81ep-55},
+  {0x1.f0a7efb9230d7p-1, 0x1.52c7adc6b4989p-56},
+  {0x1.f6297cff75cb0p-1, 0x1.562172a361fd3p-56},
+  {0x1.fa7557f08a517p-1, -0x1.7a0a8ca13571fp-55},
+  {0x1.fd88da3d12526p-1, -0x1.87df6378811c7p-55},
+  {0x1.ff621e3796d7ep-1, -0x1.c57bc2e24aa15p-57},
+  {1.0, 0.0},
+  {0x1.ff621e3796d7ep-1, -0x1.c57bc2e24aa15p-57},
+  {0x1.fd88da3d12526p-1, -0x1.87df6378811c7p-55},
+  {0x1.fa7557f08a517p-1, -0x1.7a0a8ca13571fp-55},
+  {0x1.f6297cff75cb0p-1, 0x1.562172a361fd3p-56},
+  {0x1.f0a7efb9230d7p-1, 0x1.52c7adc6b4989p-56},
+  {0x1.e9f4156c62ddap-1, 0x1.760b1e2e3f81ep-55},
+  {0x1.e212104f686e5p-1, -0x1.014c76c126527p-55},
+  {0x1.d906bcf328d46p-1, 0x1.457e610231ac2p-56},
+  {0x1.ced7af43cc773p-1, -0x1.e7b6bb5ab58aep-58},
+  {0x1.c38b2f180bdb1p-1, -0x1.6e0b1757c8d07p-56},
+  {0x1.b728345196e3ep-1, -0x1.bc69f324e6d61p-55},
+  {0x1.a9b66290ea1a3p-1, 0x1.9f630e8b6dac8p-60},
+  {0x1.9b3e047f38741p-1, -0x1.30ee286712474p-55},
+  {0x1.8bc806b151741p-1, -0x1.2c5e12ed1336dp-55},
+  {0x1.7b5df226aafafp-1, -0x1.0f537acdf0ad7p-56},
+  {0x1.6a09e667f3bcdp-1, -0x1.bdd3413b26456p-55},
+  {0x1.57d69348ceca0p-1, -0x1.75720992bfbb2p-55},
+  {0x1.44cf325091dd6p-1, 0x1.8076a2cfdc6b3p-57},
+  {0x1.30ff7fce17035p-1, -0x1.efcc626f74a6fp-57},
+  {0x1.1c73b39ae68c8p-1, 0x1.b25dd267f6600p-55},
+  {0x1.073879922ffeep-1, -0x1.a5a014347406cp-55},
+  {0x1.e2b5d3806f63bp-2, 0x1.e0d891d3c6841p-58},
+  {0x1.b5d1009e15cc0p-2, 0x1.5b362cb974183p-57},
+  {0x1.87de2a6aea963p-2, -0x1.72cedd3d5a610p-57},
+  {0x1.58f9a75ab1fddp-2, -0x1.efdc0d58cf620p-62},
+  {0x1.294062ed59f06p-2, -0x1.5d28da2c4612dp-56},
+  {0x1.f19f97b215f1bp-3, -0x1.42deef11da2c4p-57},
+  {0x1.8f8b83c69a60bp-3, -0x1.26d19b9ff8d82p-57},
+  {0x1.2c8106e8e613ap-3, 0x1.13000a89a11e0p-58},
+  {0x1.917a6bc29b42cp-4, -0x1.e2718d26ed688p-60},
+  {0x1.91f65f10dd814p-5, -0x1.912bd0d569a90p-61},
+  {0.0, 0.0},
+  {-0x1.91f65f10dd814p-5, 0x1.912bd0d569a90p-61},
+  {-0x1.917a6bc29b42cp-4, 0x1.e2718d26ed688p-60},
+  {-0x1.2c8106e8e613ap-3, -0x1.13000a89a11e0p-58},
+  {-0x1.8f8b83c69a60bp-3, 0x1.26d19b9ff8d82p-57},
+  {-0x1.f19f97b215f1bp-3, 0x1.42deef11da2c4p-57},
+  {-0x1.294062ed59f06p-2, 0x1.5d28da2c4612dp-56},
+  {-0x1.58f9a75ab1fddp-2, 0x1.efdc0d58cf620p-62},
+  {-0x1.87de2a6aea963p-2, 0x1.72cedd3d5a610p-57},
+  {-0x1.b5d1009e15cc0p-2, -0x1.5b362cb974183p-57},
+  {-0x1.e2b5d3806f63bp-2, -0x1.e0d891d3c6841p-58},
+  {-0x1.073879922ffeep-1, 0x1.a5a014347406cp-55},
+  {-0x1.1c73b39ae68c8p-1, -0x1.b25dd267f6600p-55},
+  {-0x1.30ff7fce17035p-1, 0x1.efcc626f74a6fp-57},
+  {-0x1.44cf325091dd6p-1, -0x1.8076a2cfdc6b3p-57},
+  {-0x1.57d69348ceca0p-1, 0x1.75720992bfbb2p-55},
+  {-0x1.6a09e667f3bcdp-1, 0x1.bdd3413b26456p-55},
+  {-0x1.7b5df226aafafp-1, 0x1.0f537acdf0ad7p-56},
+  {-0x1.8bc806b151741p-1, 0x1.2c5e12ed1336dp-55},
+  {-0x1.9b3e047f38741p-1, 0x1.30ee286712474p-55},
+  {-0x1.a9b66290ea1a3p-1, -0x1.9f630e8b6dac8p-60},
+  {-0x1.b728345196e3ep-1, 0x1.bc69f324e6d61p-55},
+  {-0x1.c38b2f180bdb1p-1, 0x1.6e0b1757c8d07p-56},
+  {-0x1.ced7af43cc773p-1, 0x1.e7b6bb5ab58aep-58},
+  {-0x1.d906bcf328d46p-1, -0x1.457e610231ac2p-56},
+  {-0x1.e212104f686e5p-1, 0x1.014c76c126527p-55},
+  {-0x1.e9f4156c62ddap-1, -0x1.760b1e2e3f81ep-55},
+  {-0x1.f0a7efb9230d7p-1, -0x1.52c7adc6b4989p-56},
+  {-0x1.f6297cff75cb0p-1, -0x1.562172a361fd3p-56},
+  {-0x1.fa7557f08a517p-1, 0x1.7a0a8ca13571fp-55},
+  {-0x1.fd88da3d12526p-1, 0x1.87df6378811c7p-55},
+  {-0x1.ff621e3796d7ep-1, 0x1.c57bc2e24aa15p-57},
+  {-1.0, 0.0},
+  {-0x1.ff621e3796d7ep-1, 0x1.c57bc2e24aa15p-57},
+  {-0x1.fd88da3d12526p-1, 0x1.87df6378811c7p-55},
+  {-0x1.fa7557f08a517p-1, 0x1.7a0a8ca13571fp-55},
+  {-0x1.f6297cff75cb0p-1, -0x1.562172a361fd3p-56},
+  {-0x1.f0a7efb9230d7p-1, -0x1.52c7adc6b4989p-56},
+  {-0x1.e9f4156c62ddap-1, -0x1.760b1e2e3f81ep-55},
+  {-0x1.e212104f686e5p-1, 0x1.014c76c126527p-55},
+  {-0x1.d906bcf328d46p-1, -0x1.457e610231ac2p-56},
+  {-0x1.ced7af43cc773p-1, 0x1.e7b6bb5ab58aep-58},
+  {-0x1.c38b2f180bdb1p-1, 0x1.6e0b1757c8d07p-56},
+  {-0x1.b728345196e3ep-1, 0x1.bc69f324e6d61p-55},
+  {-0x1.a9b66290ea1a3p-1, -0x1.9f630e8b6dac8p-60},
+  {-0x1.9b3e047f38741p-1, 0x1.30ee286712474p-55},
+  {-0x1.8bc806b151741p-1, 0x1.2c5e12ed1336dp-55},
+  {-0x1.7b5df226aafafp-1, 0x1.0f537acdf0ad7p-56},
+  {-0x1.6a09e667f3bcdp-1, 0x1.bdd3413b26456p-55},
+  {-0x1.57d69348ceca0p-1, 0x1.75720992bfbb2p-55},
+  {-0x1.44cf325091dd6p-1, -0x1.8076a2cfdc6b3p-57},
+  {-0x1.30ff7fce17035p-1, 0x1.efcc626f74a6fp-57},
+  {-0x1.1c73b39ae68c8p-1, -0x1.b25dd267f6600p-55},
+  {-0x1.073879922ffeep-1, 0x1.a5a014347406cp-55},
+  {-0x1.e2b5d3806f63bp-2, -0x1.e0d891d3c6841p-58},
+  {-0x1.b5d1009e15cc0p-2, -0x1.5b362cb974183p-57},
+  {-0x1.87de2a6aea963p-2, 0x1.72cedd3d5a610p-57},
+  {-0x1.58f9a75ab1fddp-2, 0x1.efdc0d58cf620p-62},
+  {-0x1.294062ed59f06p-2, 0x1.5d28da2c4612dp-56},
+  {-0x1.f19f97b215f1bp-3, 0x1.42deef11da2c4p-57},
+  {-0x1.8f8b83c69a60bp-3, 0x1.26d19b9ff8d82p-57},
+  {-0x1.2c8106e8e613ap-3, -0x1.13000a89a11e0p-58},
+  {-0x1.917a6bc29b42cp-4, 0x1.e2718d26ed688p-60},
+  {-0x1.91f65f10dd814p-5, 0x1.912bd0d569a90p-61},
+};
+
+// 64/pi, and pi/64 split into three parts.
+static const double kInvPiOver64 = 0x1.45f306dc9c883p+4;
+static const double kPiOver64_1 = 0x1.921fb54442d18p-5;
+static const double kPiOver64_2 = 0x1.1a62633145c07p-59;
+static const double kPiOver64_3 = -0x1.f1976b7ed8fbcp-115;
+
+// Taylor coefficients for sin(r) - r and cos(r) - 1; |r| <= pi/128 makes the
+// first omitted terms smaller than 2^-62 relative.
+static const double S1 = -0x1.5555555555555p-3;
+static const double S2 = 0x1.1111111111111p-7;
+static const double S3 = -0x1.a01a01a01a01ap-13;
+static const double C1 = -0.5;
+static const double C2 = 0x1.5555555555555p-5;
+static const double C3 = -0x1.6c16c16c16c17p-10;
+
+// Reduces xh + xl (with |xh| < 2^23) to r = rh + rl, returning k.
+static inline int64_t reduce_pi_over_64(double xh, double xl, double* rh, double* rl) {
+  // Round to the nearest integer without a conversion or a branch.
+  double kd = (xh * kInvPiOver64 + 0x1.8p52) - 0x1.8p52;
+
+  // Unless kd is 0, xh - kd*kPiOver64_1 is a multiple of 2^-58 smaller
+  // than 2^-5, so the first step is exact. The second is a product
+  // split exactly with fma() and an exact two-sum, which keeps r accurate
+  // even when xh is very close to a multiple of pi/64.
+  double r0 = __builtin_fma(-kd, kPiOver64_1, xh);
+  double ph = kd * kPiOver64_2;
+  double pl = __builtin_fma(kd, kPiOver64_2, -ph);
+  double r = r0 - ph;
+  double z = r - r0;
+  double e = (r0 - (r - z)) - (ph + z);
+  *rh = r;
+  *rl = xl + (e - pl - kd * kPiOver64_3);
+  return (int64_t) kd;
+}
+
+// Reduces a finite x to r = rh + rl, returning k.
+static inline int64_t trig_reduce(double x, double* rh, double* rl) {
+  if (__predict_true(__builtin_fabs(x) < 0x1p23)) return reduce_pi_over_64(x, 0.0, rh, rl);
+  double y[2];
+  int n = __ieee754_rem_pio2(x, y);
+  return 32 * (int64_t) n + reduce_pi_over_64(y[0], y[1], rh, rl);
+}
+
+// The Taylor polynomials for sin(r) - r and cos(r) - 1. Every table entry
+// uses the same two, so sincos and tan only evaluate them once.
+static inline void trig_poly(double rh, double* sin_r, double* cos_r) {
+  double r2 = rh * rh;
+  *sin_r = rh * r2 * (S1 + r2 * (S2 + r2 * S3));
+  *cos_r = r2 * (C1 + r2 * (C2 + r2 * C3));
+}
+
+// Returns sin(j*pi/64 + r) as the return value plus *lo.
+static inline double sin_table(double rh, double rl, double sin_r, double cos_r, unsigned j,
+                               double* lo) {
+  double sh = kSinTable[j & 127][0];
+  double sl = kSinTable[j & 127][1];
+  double ch = kSinTable[(j + 32) & 127][0];
+  double cl = kSinTable[(j + 32) & 127][1];
+
+  // sh + ch*r is the bulk of the result, so it's summed exactly. |ch*r| is
+  // smaller than any non-zero |sh| (and sh is exactly zero for j = 0 and 64).
+  double p = ch * rh;
+  double pe = __builtin_fma(ch, rh, -p);
+  double hi = sh + p;
+  *lo = ((sh - hi) + p) + (pe + (sl + cl * rh + ch * rl) + (ch * sin_r + sh * cos_r));
+  return hi;
+}
+
+double sin(double x) {
+  double ax = __builtin_fabs(x);
+  if (__predict_false(ax < 0x1p-27)) return x;
+  if (__predict_false(!isfinite(x))) return x - x;
+
+  double rh, rl, sin_r, cos_r, lo;
+  int64_t k = trig_reduce(x, &rh, &rl);
+  trig_poly(rh, &sin_r, &cos_r);
+  double hi = sin_table(rh, rl, sin_r, cos_r, k, &lo);
+  return hi + lo;
+}
+
+double cos(double x) {
+  if (__predict_false(!isfinite(x))) return x - x;
+
+  double rh, rl, sin_r, cos_r, lo;
+  int64_t k = trig_reduce(x, &rh, &rl);
+  trig_poly(rh, &sin_r, &cos_r);
+  double hi = sin_table(rh, rl, sin_r, cos_r, k + 32, &lo);
+  return hi + lo;
+}
+
+// One reduction and one pair of polynomials; only the table lookups and the
+// final sums are done twice.
+void sincos(double x, double* s, double* c) {
+  if (__predict_false(__builtin_fabs(x) < 0x1p-27)) {
+    *s = x;
+    *c = 1.0;
+    return;
+  }
+  if (__predict_false(!isfinite(x))) {
+    *s = *c = x - x;
+    return;
+  }
+
+  double rh, rl, sin_r, cos_r, lo;
+  int64_t k = trig_reduce(x, &rh, &rl);
+  trig_poly(rh, &sin_r, &cos_r);
+  double hi = sin_table(rh, rl, sin_r, cos_r, k, &lo);
+  *s = hi + lo;
+  hi = sin_table(rh, rl, sin_r, cos_r, k + 32, &lo);
+  *c = hi + lo;
+}
+
+double tan(double x) {
+  if (__predict_false(__builtin_fabs(x) < 0x1p-27)) return x;
+  if (__predict_false(!isfinite(x))) return x - x;
+
+  double rh, rl, sin_r, cos_r, sl, cl;
+  int64_t k = trig_reduce(x, &rh, &rl);
+  trig_poly(rh, &sin_r, &cos_r);
+  double sh = sin_table(rh, rl, sin_r, cos_r, k, &sl);
+  double ch = sin_table(rh, rl, sin_r, cos_r, k + 32, &cl);
+
+  // Renormalize (the low parts can still hold the whole polynomial), and then
+  // divide. Only the reciprocal of the cosine (which is never exactly zero) is
+  // an actual division: s*r is within a couple of ULP of s/c, and the
+  // remainder, computed exactly with fma(), corrects it.
+  double s = sh + sl;
+  sl -= s - sh;
+  double c = ch + cl;
+  cl -= c - ch;
+  double r = 1.0 / c;
+  double q = s * r;
+  return q + (__builtin_fma(-q, c, s) + sl - q * cl) * r;
+}
+
+//
+// atan, atan2, asin and acos.
+//
+// For 0 <= u <= 1 (or 0 <= u <= 1/2 for asin), u = c + d with c = j/64 and
+// |d| <= 1/128, and then
+//   f(u) = f(c) + a1*d + a2*d^2 + ... + a8*d^8
+// where the a_k are f's Taylor coefficients at c, straight from a table. There
+// are no divisions: atan of anything bigger than 1 is pi/2 - atan(1/u), atan2
+// is atan of y/x or x/y, and asin of anything bigger than 1/2 is
+//   pi/2 - 2*asin(sqrt((1 - u)/2))
+// which is also how acos is computed.
+//
+
+// For each j, f(j/64) as hi + lo, a1 as hi + lo, and a2 to a8.
+typedef double TaylorTable[11];
+
+// atan around j/64.
+static const TaylorTable kAtanTable[65] = {
+  {0.0, 0.0, 0x1.0000000000000p+0, 0.0,
+   0.0, -0x1.5555555555555p-2, 0.0, 0x1.999999999999ap-3,
+   0.0, -0x1.2492492492492p-3, 0.0},
+  {0x1.fff555bbb729bp-7, -0x1.220c39d4dff50p-61, 0x1.ffe001ffe0020p-1, -0x1.ffe001ffe0020p-61,
+   -0x1.ffc005ff800a0p-7, -0x1.54d56953003c0p-2, 0x1.ff601bfc406dfp-7, 0x1.981a09849cb13p-3,
+   -0x1.fed5a944d7f05p-7, -0x1.229338e29faefp-3, 0x1.fe20c5ca6b2a1p-7},
+  {0x1.ffd55bba97625p-6, -0x1.5ec431444912cp-60, 0x1.ff801ff801ff8p-1, 0x1.ff801ff801ff8p-61,
+   -0x1.ff005fe009fd0p-6, -0x1.535694c03bea0p-2, 0x1.fd81bf106dd29p-6, 0x1.93a0945cb009fp-3,
+   -0x1.fb5a9137ef3f6p-6, -0x1.1ca138b1f15e5p-3, 0x1.f88c52a3243fcp-6},
+  {0x1.7fb818430da2ap-5, -0x1.86ef8f794f105p-63, 0x1.fee0a1a513254p-1, -0x1.3c4e1414b45a9p-55,
+   -0x1.7e516b6f5fb61p-5, -0x1.50dba2b652209p-2, 0x1.7bce9d05eab95p-5, 0x1.8c3cce1b89dc7p-3,
+   -0x1.7833cbf47e098p-5, -0x1.12dd7e8827ec8p-3, 0x1.73868acdf7c56p-5},
+  {0x1.ff55bb72cfdeap-5, -0x1.c934d86d23f1dp-60, 0x1.fe01fe01fe020p-1, -0x1.fe01fe01fe020p-57,
+   -0x1.fc05f809f40dfp-5, -0x1.4d69303ba878bp-2, 0x1.f61bc46d4b167p-5, 0x1.82084cab634d0p-3,
+   -0x1.eda84feb05beap-5, -0x1.057e3669247d6p-3, 0x1.e2c2b10d370ecp-5},
+  {0x1.3f59f0e7c559dp-4, 0x1.ac4ce285df847p-58, 0x1.fce4da6ab93e9p-1, -0x1.be46b18a97736p-57,
+   -0x1.3c2114d22b635p-4, -0x1.49059c4d74033p-2, 0x1.36662c0896a7cp-4, 0x1.75261a13a97a2p-3,
+   -0x1.2e4315fdd1509p-4, -0x1.e99996e52db32p-4, 0x1.23da4b0a71e9fp-4},
+  {0x1.7ee182602f10fp-4, -0x1.cfb654c0c3d98p-58, 0x1.fb8a096acfaccp-1, -0x1.2962e18495af3p-55,
+   -0x1.7956846635c89p-4, -0x1.43b8f2037b997p-2, 0x1.6f8857900c4eep-4, 0x1.65c1f4409ba0ep-3,
+   -0x1.61b651d176e0cp-4, -0x1.c24738ad65152p-4, 0x1.5033f7bc246c1p-4},
+  {0x1.be39ebe6f07c3p-4, 0x1.f7b8f29a05987p-58, 0x1.f9f2893bb9192p-1, 0x1.8260b7cd1bdabp-56,
+   -0x1.b578772759741p-4, -0x1.3d8ccd45bbe91p-2, 0x1.a61404fa31d26p-4, 0x1.540f60668fd66p-3,
+   -0x1.9092dcb2f6e8fp-4, -0x1.95d668d902073p-4, 0x1.75a3e99c53d16p-4},
+  {0x1.fd5ba9aac2f6ep-4, -0x1.cd37686760c17p-59, 0x1.f81f81f81f820p-1, -0x1.f81f81f81f820p-55,
+   -0x1.f05e09d0dc11bp-4, -0x1.368c3aa76e1d7p-2, 0x1.d9b16b391c2e3p-4, 0x1.4048994488c86p-3,
+   -0x1.ba55da98401c8p-4, -0x1.652e4e5127e64p-4, 0x1.93943442e53aep-4},
+  {0x1.1e1fafb043727p-3, -0x1.b485914dacf8cp-59, 0x1.f612438a14f5ep-1, 0x1.98e9e001f6124p-56,
+   -0x1.14f0459d3fb7cp-3, -0x1.2ec3931219b34p-2, 0x1.0509268736312p-3, 0x1.2aad607eca5ecp-3,
+   -0x1.de969e19fe31cp-4, -0x1.31455db6b9127p-4, 0x1.a9a62f53dd9eep-4},
+  {0x1.3d6eee8c6626cp-3, 0x1.61a3b0ce9281bp-57, 0x1.f3cc435b0713cp-1, 0x1.1d0a7e69ea094p-55,
+   -0x1.30eddb7d169f0p-3, -0x1.264053fd62b3cp-2, 0x1.1b795e8e57ee3p-3, 0x1.1381bbe93b8e5p-3,
+   -0x1.fd07f394e1bf7p-4, -0x1.f634c37bb5315p-5, 0x1.b7b30e501e57bp-4},
+  {0x1.5c9811e3ec26ap-3, -0x1.054ab2c010f3dp-58, 0x1.f14f19cce28ebp-1, -0x1.b7c252708cd6ep-55,
+   -0x1.4c16f42678d07p-3, -0x1.1d10f4fccc153p-2, 0x1.300cd74979f8cp-3, 0x1.f6194fbe70208p-4,
+   -0x1.0abc54b1c266fp-3, -0x1.875b23b74e858p-5, 0x1.bdca692e46f11p-4},
+  {0x1.7b97b4bce5b02p-3, 0x1.347b0b4f881cap-58, 0x1.ee9c7f8458e02p-1, -0x1.163807ba71fe1p-57,
+   -0x1.665c226d69eebp-3, -0x1.1344bb737e8f3p-2, 0x1.42aca8b929b0bp-3, 0x1.c32d8f683981cp-4,
+   -0x1.13e9ad22d5eccp-3, -0x1.17f3ed35c8c33p-5, 0x1.bc2ee2a73307ep-4},
+  {0x1.9a6a8e96c8626p-3, 0x1.cf601e7b4348ep-59, 0x1.ebb64a8c932d7p-1, 0x1.0538d79aae302p-61,
+   -0x1.7faf6f88295fep-3, -0x1.08eb8d3f5a07bp-2, 0x1.53479d6814372p-3, 0x1.8ed239c562d77p-4,
+   -0x1.1a0ec2cdd89fdp-3, -0x1.53bd4fec9df82p-6, 0x1.b3512d9d3f0f6p-4},
+  {0x1.b90d7529260a2p-3, 0x1.17b10d2e0e5abp-61, 0x1.e89e6b5ccf172p-1, 0x1.20357153be26ap-55,
+   -0x1.980467f79bfd6p-3, -0x1.fc2b8650d32f4p-3, 0x1.61d22d625e475p-3, 0x1.599799e54f300p-4,
+   -0x1.1d3b0365c2b85p-3, -0x1.f6cc90afb6b97p-8, 0x1.a3c9c28035c12p-4},
+  {0x1.d77d5df205736p-3, 0x1.c648d1534597ep-57, 0x1.e556e9c86d7c6p-1, -0x1.30c2534c9abfdp-55,
+   -0x1.af50242f10c89p-3, -0x1.e5a7f7b1596d9p-3, 0x1.6e466171949b1p-3, 0x1.2409fa3d6f244p-4,
+   -0x1.1d8980dceacbfp-3, 0x1.3c3b6dc715080p-8, 0x1.8e519f78687abp-4},
+  {0x1.f5b75f92c80ddp-3, 0x1.8ab6e3cf7afbdp-57, 0x1.e1e1e1e1e1e1ep-1, 0x1.e1e1e1e1e1e1ep-57,
+   -0x1.c5894d10d4986p-3, -0x1.ce6de0253d27ep-3, 0x1.78a3a08d88b02p-3, 0x1.dd5f26a622b44p-5,
+   -0x1.1b1faecd7c4e0p-3, 0x1.0fc3e1fc8b549p-6, 0x1.73ba725728acfp-4},
+  {0x1.09dc597d86362p-2, 0x1.62e47390cb865p-56, 0x1.de4180d8b5ae6p-1, 0x1.1929823f66cf0p-56,
+   -0x1.daa81c655a596p-3, -0x1.b69e91974fd6cp-3, 0x1.80ee69dcd2641p-3, 0x1.740d764b143bep-5,
+   -0x1.162bf4b6b7330p-3, 0x1.c21477a20d203p-6, 0x1.54e68a0d6b625p-4},
+  {0x1.18bf5a30bf178p-2, 0x1.30ca4748b1bf9p-57, 0x1.da7801da7801ep-1, -0x1.61ff8961ff896p-55,
+   -0x1.eea659814cb11p-3, -0x1.9e5aef76f9fa1p-3, 0x1.872ffdf090624p-3, 0x1.0d08b83fe02bcp-5,
+   -0x1.0ee4231b98637p-3, 0x1.320e65b309f28p-5, 0x1.32c0e755cbc43p-4},
+  {0x1.278372057ef46p-2, -0x1.077cdd36dfc81p-56, 0x1.d687aafdfd5bap-1, -0x1.82e68e19d8d3dp-56,
+   -0x1.00bfa92db6fdbp-2, -0x1.85c325b640da2p-3, 0x1.8b75fa1da32d2p-3, 0x1.524adee810d60p-6,
+   -0x1.0583d95a69deap-3, 0x1.7a3792b4d3decp-5, 0x1.0e35ba3290dfep-4},
+  {0x1.362773707ebccp-2, -0x1.963a544b672d8p-57, 0x1.d272ca3fc5b1ap-1, 0x1.ae01d272ca3fcp-55,
+   -0x1.0997e8aec9d8ep-2, -0x1.6cf6666d5c0ffp-3, 0x1.8dd1e8f2617b5p-3, 0x1.2483b33966883p-7,
+   -0x1.f495d2b05b16bp-4, 0x1.b9096074fdeafp-5, 0x1.d05719c4605c9p-5},
+  {0x1.44aa436c2af0ap-2, -0x1.5d5e43c55b3bap-56, 0x1.ce3bb295c0773p-1, -0x1.26fd591851b41p-55,
+   -0x1.11db08221a582p-2, -0x1.5412aeb9ef661p-3, 0x1.8e58cacc06b3ap-3, -0x1.25ff7cfe3f01ep-9,
+   -0x1.daf789dae4b1cp-4, 0x1.ee3fb8e4e3e16p-5, 0x1.82fa9c2c60fedp-5},
+  {0x1.530ad9951cd4ap-2, -0x1.2566480884082p-57, 0x1.c9e4b91ff8d87p-1, -0x1.723ff1b0da370p-56,
+   -0x1.1988d432f5908p-2, -0x1.3b3493403e07cp-3, 0x1.8d22997d0e938p-3, -0x1.a3464c2fe9cdep-7,
+   -0x1.beb3fefb6f244p-4, 0x1.0ce5a39e67c0bp-4, 0x1.35eab93b4fb73p-5},
+  {0x1.614840309cfe2p-2, -0x1.a725715711f00p-56, 0x1.c570327afd9ebp-1, 0x1.3c2abb32c1d72p-57,
+   -0x1.20a1c06000419p-2, -0x1.22771486ad2c8p-3, 0x1.8a49c9d027817p-3, -0x1.73831eaabcb23p-6,
+   -0x1.a051d8c46fbcep-4, 0x1.1de669132e9ccp-4, 0x1.d5269d48d5d65p-6},
+  {0x1.6f61941e4def1p-2, -0x1.c63aae6f6e918p-56, 0x1.c0e070381c0e0p-1, 0x1.c0e070381c0e0p-55,
+   -0x1.2726dd135c174p-2, -0x1.09f37b38cc8cfp-3, 0x1.85eacd7da413cp-3, -0x1.04d6980fcc815p-5,
+   -0x1.8054c1df326f9p-4, 0x1.2a47e082bda60p-4, 0x1.446397091d5a4p-6},
+  {0x1.7d5604b63b3f7p-2, 0x1.69c885c2b249ap-56, 0x1.bc37be7ec7a8dp-1, -0x1.f12462b0e2727p-57,
+   -0x1.2d19ccfbdd7fap-2, -0x1.e382786f8309bp-4, 0x1.802397e6de8dep-3, -0x1.49cf94f6d8017p-5,
+   -0x1.5f3b3de917e27p-4, 0x1.324208e455cc2p-4, 0x1.77470b9fc88fep-7},
+  {0x1.8b24d394a1b25p-2, 0x1.b6d0ba3748fa8p-56, 0x1.b77861d9cdc98p-1, -0x1.2e22c345bd7a8p-57,
+   -0x1.327cb9d57b8f5p-2, -0x1.b3ebc8761b154p-4, 0x1.7913279f68c54p-3, -0x1.888285872d73cp-5,
+   -0x1.3d7cd567be750p-4, 0x1.361c00a24fc71p-4, 0x1.e4b7a46aa98b6p-9},
+  {0x1.98cd5454d6b18p-2, 0x1.9e6c988fd0a77p-56, 0x1.b2a495323eb6ap-1, -0x1.7220270cc9678p-58,
+   -0x1.375248cd58cc4p-2, -0x1.854a154d5f784p-4, 0x1.70d9167aa0c46p-3, -0x1.c0db0d0665a46p-5,
+   -0x1.1b889b428e30dp-4, 0x1.3628d134448b0p-4, -0x1.bbbc167619c9cp-9},
+  {0x1.a64eec3cc23fdp-2, -0x1.24dec1b50b7ffp-56, 0x1.adbe87f94905ep-1, 0x1.adbe87f94905ep-61,
+   -0x1.3b9d8eab54af9p-2, -0x1.57c09645a7f9ep-4, 0x1.67953180938f2p-3, -0x1.f2d8bff0ea012p-5,
+   -0x1.f388166c7250cp-5, 0x1.32c44c95ff694p-4, -0x1.3f3f025d7ff49p-7},
+  {0x1.b3a911da65c6cp-2, 0x1.ae187b1ca5040p-56, 0x1.a8c85c81a2254p-1, -0x1.3c1918d67728bp-55,
+   -0x1.3f6203e8218e0p-2, -0x1.2b6e8adb5f398p-4, 0x1.5d6719d9e25fcp-3, -0x1.0f46a19cc29a0p-4,
+   -0x1.b1147c1a69750p-5, 0x1.2c5012c826e6bp-4, -0x1.f6a95cbc1b186p-7},
+  {0x1.c0db4c94ec9f0p-2, -0x1.cc1ce70934c34p-56, 0x1.a3c4268881898p-1, 0x1.f907fe5c3bd97p-55,
+   -0x1.42a378d38076dp-2, -0x1.006f45a36f1bdp-4, 0x1.526def7221a2ap-3, -0x1.220d267b0229ap-4,
+   -0x1.7056dc74d0c66p-5, 0x1.2330d0ff472e2p-4, -0x1.4a5e99cb74216p-6},
+  {0x1.cde53432c1351p-2, -0x1.a2cfa4418f1adp-56, 0x1.9eb3e9edacaccp-1, -0x1.942c587d23ca5p-55,
+   -0x1.456609eaa285dp-2, -0x1.adb4828319af3p-5, 0x1.46c805c4ee7c2p-3, -0x1.31d7ca73bc33fp-4,
+   -0x1.31d98b8a731f5p-5, 0x1.17cbc798f7481p-4, -0x1.8ccf3f977e9cap-6},
+  {0x1.dac670561bb4fp-2, 0x1.a2b7f222f65e2p-56, 0x1.999999999999ap-1, -0x1.999999999999ap-55,
+   -0x1.47ae147ae147bp-2, -0x1.5d867c3ece2a5p-5, 0x1.3a92a30553261p-3, -0x1.3ec460ed80a18p-4,
+   -0x1.ec21b514d88d8p-6, 0x1.0a849f929a833p-4, -0x1.c2f8b88dfb80cp-6},
+  {0x1.e77eb7f175a34p-2, 0x1.0e53dc1bf3435p-56, 0x1.9477169044ba4p-1, -0x1.d53e292d5fbc1p-56,
+   -0x1.49802ba91fd89p-2, -0x1.1074cf33546d5p-5, 0x1.2de9c99222665p-3, -0x1.48f5afa031cb1p-4,
+   -0x1.7ab74bc0c6420p-6, 0x1.f7772876d0f75p-5, -0x1.ed628e431fc96p-6},
+  {0x1.f40dd0b541418p-2, -0x1.a3992dc382a23p-57, 0x1.8f4e2f2efd135p-1, -0x1.4c3c0d4218911p-56,
+   -0x1.4ae10df24b2d1p-2, -0x1.8d31fd7365f3fp-6, 0x1.20e80b7567664p-3, -0x1.5092724d80dddp-4,
+   -0x1.100881b0516abp-6, 0x1.d797e4a356567p-5, -0x1.065f8e14758edp-5},
+  {0x1.0039c73c1a40cp-1, -0x1.b32c949c9d593p-55, 0x1.8a209e931fcd3p-1, 0x1.cb8f08e68c94cp-57,
+   -0x1.4bd59b35ad2d8p-2, -0x1.000c36dc339efp-6, 0x1.13a667812ee2dp-3, -0x1.55c46b5955c9cp-4,
+   -0x1.5906b0fd2b503p-7, 0x1.b615d577de2dap-5, -0x1.10f0aa34d31ecp-5},
+  {0x1.0657e94db30d0p-1, -0x1.d5b495f6349e6p-56, 0x1.84f00c2780614p-1, -0x1.fe7b0ff3d87fap-56,
+   -0x1.4c62cb562c625p-2, -0x1.e6495b3a4bcb7p-8, 0x1.063c2f78c0dc4p-3, -0x1.58b78459eb443p-4,
+   -0x1.41c831386e6b4p-8, 0x1.938d6944ff706p-5, -0x1.16d9966ad4037p-5},
+  {0x1.0c6145b5b43dap-1, 0x1.974fa13b5404fp-58, 0x1.7fbe0b560d35cp-1, -0x1.4f066ae5a0887p-55,
+   -0x1.4c8da57c2e1cbp-2, 0x1.8b34161c69f3cp-12, 0x1.f17ded351e8edp-4, -0x1.599900e77234cp-4,
+   0x1.006ef99f594eep-12, 0x1.708bf1a75a6ccp-5, -0x1.1896731a471d5p-5},
+  {0x1.1255d9bfbd2a9p-1, -0x1.2bdaee1c0ee35p-58, 0x1.7a8c1b5b1ffa1p-1, 0x1.73e4a4e005ea3p-55,
+   -0x1.4c5b37fead5b8p-2, 0x1.fcb3101e4c970p-8, 0x1.d6850f983ecf1p-4, -0x1.5896c532f49b6p-4,
+   0x1.432e2eaefcf7fp-8, 0x1.4d8efe1db38f0p-5, -0x1.16a6a7c5c9defp-5},
+  {0x1.1835a88be7c13p-1, 0x1.c621cec00c301p-55, 0x1.755ba737d49cap-1, -0x1.abaf3d4cb44c6p-55,
+   -0x1.4bd090f73c4b3p-2, 0x1.e2e4f8920477fp-7, 0x1.bbb1c53aaefa0p-4, -0x1.55deb13f5f619p-4,
+   0x1.2bf14e675741ep-7, 0x1.2b042a05e0ebfp-5, -0x1.11898bf95c5c1p-5},
+  {0x1.1e00babdefeb4p-1, -0x1.928df287a668fp-58, 0x1.702e05c0b8170p-1, 0x1.702e05c0b8170p-56,
+   -0x1.4af2b78215a76p-2, 0x1.5d0b7e9e4a9d0p-6, 0x1.a1247ca629942p-4, -0x1.519e1100385b4p-4,
+   0x1.a759232616ed8p-7, 0x1.09494cda1223ap-5, -0x1.09bb9a5a5c251p-5},
+  {0x1.23b71e2cc9e6ap-1, 0x1.c421c9f38224ep-57, 0x1.6b0479c620595p-1, 0x1.867df07d7f0c2p-55,
+   -0x1.49c6a5a920887p-2, 0x1.c20cfbb7e5931p-6, 0x1.86fa2451c4a5dp-4, -0x1.4c012120917dap-4,
+   0x1.0a1da6b9c3fadp-6, 0x1.d159f708543e5p-6, -0x1.ff6856d929bcep-6},
+  {0x1.2958e59308e31p-1, -0x1.09e73b0c6c087p-56, 0x1.65e032538713cp-1, -0x1.0139242c09163p-57,
+   -0x1.485142f6d4575p-2, 0x1.104979386fd1dp-5, 0x1.6d4c43fc6c180p-4, -0x1.4532a7ca4cfd0p-4,
+   0x1.3991d90eb1d30p-6, 0x1.92de946163051p-6, -0x1.e7c762de874ffp-6},
+  {0x1.2ee628406cbcap-1, 0x1.c5d5e9ff0cf8dp-55, 0x1.60c24b0350d38p-1, 0x1.1ffe9f3db4fcbp-55,
+   -0x1.46975fac420bdp-2, 0x1.3c5fad098b4eep-5, 0x1.54311d57c5b53p-4, -0x1.3d5ba071017e0p-4,
+   0x1.625b9f11b08a7p-6, 0x1.57857e25bbc6fp-6, -0x1.cd64d7384981fp-6},
+  {0x1.345f01cce37bbp-1, 0x1.1021137c71102p-55, 0x1.5babcc647fa91p-1, 0x1.4339b8056eaf3p-55,
+   -0x1.449db094286d0p-2, 0x1.655caac4cf102p-5, 0x1.3bbbd2933dd9cp-4, -0x1.34a2f9636afc9p-4,
+   0x1.84d71a2400f6fp-6, 0x1.1f9acfcc53cabp-6, -0x1.b0ff09ec31ef1p-6},
+  {0x1.39c391cd4171ap-1, -0x1.2304331d8bf46p-55, 0x1.569dac6feb417p-1, 0x1.03ce50625e450p-55,
+   -0x1.4268cb6bde980p-2, 0x1.8b56386705749p-5, 0x1.23fc9171a8768p-4, -0x1.2b2d61b8904fdp-4,
+   0x1.a1677ca70ce88p-6, 0x1.d6a8162963581p-7, -0x1.9341232c353bbp-6},
+  {0x1.3f13fb89e96f4p-1, 0x1.ecf8b492644f0p-56, 0x1.5198cf0ab6f99p-1, 0x1.1b8755e1ffabap-56,
+   -0x1.3ffd23da059f4p-2, 0x1.ae63f4c5d36dcp-5, 0x1.0d00c1b178adap-4, -0x1.211d261093929p-4,
+   0x1.b874b30c5dd59p-6, 0x1.75a50b0b899edp-7, -0x1.74c2b9c404912p-6},
+  {0x1.445065b795b56p-1, -0x1.f76d0163f79c8p-56, 0x1.4c9e0693e0015p-1, -0x1.b0fcb60fff59bp-56,
+   -0x1.3d5f08ea521a8p-2, 0x1.ce9f01d4b9b62p-5, 0x1.eda66b5db8847p-5, -0x1.16921a92559e3p-4,
+   0x1.ca69513b2a17dp-6, 0x1.1c4bb355982b3p-7, -0x1.5607f65bec936p-6},
+  {0x1.4978fa3269ee1p-1, 0x1.2419a87f2a458p-56, 0x1.47ae147ae147bp-1, -0x1.eb851eb851eb8p-57,
+   -0x1.3a92a30553261p-2, 0x1.ec21b514d88d8p-5, 0x1.c2f8b88dfb80cp-5, -0x1.0ba9908c71945p-4,
+   0x1.d7b0c3d79f13fp-6, 0x1.95393357dfc67p-8, -0x1.378223aa97829p-6},
+  {0x1.4e8de5bb6ec04p-1, 0x1.4a33dbeb3796cp-55, 0x1.42c9a9dd8fdc1p-1, 0x1.192daaf80050bp-58,
+   -0x1.379bf25adf97fp-2, 0x1.0383a724dbb01p-4, 0x1.9a04e646e65dfp-5, -0x1.007e562771c79p-4,
+   0x1.e0b5c37a45544p-6, 0x1.00fc754993092p-8, -0x1.1990937534c25p-6},
+  {0x1.538f57b89061fp-1, -0x1.1bb74abda520cp-55, 0x1.3df1682b78014p-1, -0x1.074bea43ff610p-56,
+   -0x1.347ecdb5be2e4p-2, 0x1.0fb5da3a11be4p-4, 0x1.72d3716778170p-5, -0x1.ea517d4cdbd49p-5,
+   0x1.e5e106bc61b6fp-6, 0x1.ee0afd0517524p-10, -0x1.f90384f2ec799p-7},
+  {0x1.587d81f732fbbp-1, -0x1.5e5c9d8c5a950p-56, 0x1.3925e1cd28c98p-1, 0x1.c84431ffec6dap-55,
+   -0x1.313ee1af2c622p-2, 0x1.1ab59c7f683c3p-4, 0x1.4d693a7039179p-5, -0x1.d37d6391400b3p-5,
+   0x1.e7982f2148a36p-6, 0x1.12956b6df63cap-14, -0x1.c1294fbd0f7eep-7},
+  {0x1.5d58987169b18p-1, 0x1.0028e4bc5e7cap-57, 0x1.34679ace01346p-1, 0x1.e6b3804d19e6bp-55,
+   -0x1.2ddfb03913da2p-2, 0x1.2491307b46905p-4, 0x1.29c7e4b96b773p-5, -0x1.bca781f071f44p-5,
+   0x1.e63cec4b7b7c4p-6, -0x1.9529a125f35b0p-10, -0x1.8bf43ed369b2bp-7},
+  {0x1.6220d115d7b8ep-1, -0x1.2b785350ee8c1p-57, 0x1.2fb7098736048p-1, 0x1.7a7514df7c4fap-55,
+   -0x1.2a64907603054p-2, 0x1.2d56da0cac592p-4, 0x1.07ee31fa53ce5p-5, -0x1.a5f2821eb5271p-5,
+   0x1.e22c508df7f4fp-6, -0x1.83dca107b528fp-9, -0x1.59acc0a22f693p-7},
+  {0x1.66d663923e087p-1, -0x1.6ea6febe8bbbap-56, 0x1.2b14974aea886p-1, 0x1.68ffda9d6d16ap-55,
+   -0x1.26d0aed65571ep-2, 0x1.3514c8be1339fp-4, 0x1.cfb0b300f8f9bp-6, -0x1.8f7ccf34b004fp-5,
+   0x1.dbbe51bd3bde0p-6, -0x1.126379bf7dcebp-8, -0x1.2a84ea146e5b2p-7},
+  {0x1.6b798920b3d99p-1, -0x1.a80386188c50ep-55, 0x1.2680a10e5813ep-1, -0x1.f54972242a6bcp-55,
+   -0x1.23270d725fa1cp-2, 0x1.3bd904bf2f124p-4, 0x1.9300b53ea1533p-6, -0x1.7960d53a4e537p-5,
+   0x1.d345711f5f086p-6, -0x1.5776019baa1dap-8, -0x1.fd36ab2a2ca7ep-8},
+  {0x1.700a7c5784634p-1, -0x1.8c34d25aadef6p-56, 0x1.21fb78121fb78p-1, 0x1.21fb78121fb78p-57,
+   -0x1.1f6a8499e4889p-2, 0x1.41b15e5decb17p-4, 0x1.59bc940a374b5p-6, -0x1.63b54400d3c9ap-5,
+   0x1.c90e857717232p-6, -0x1.91f786bfa704ep-8, -0x1.abfbc643da6ddp-8},
+  {0x1.748978fba8e0fp-1, 0x1.7b2a6165884a1p-59, 0x1.1d856287ffb8ap-1, -0x1.58a1ffee27a9dp-57,
+   -0x1.1b9dc39195240p-2, 0x1.46ab5fd4fa866p-4, 0x1.23d13384eda2cp-6, -0x1.4e8d53cff324cp-5,
+   0x1.bd60a25b0d0adp-6, -0x1.c2bb4e063d1e6p-8, -0x1.61589dcb54dd5p-8},
+  {0x1.78f6bbd5d315ep-1, 0x1.406a089803740p-55, 0x1.191e9c35424cap-1, -0x1.fa3c1f4be863fp-55,
+   -0x1.17c35177d9a85p-2, 0x1.4ad44144fffaep-4, 0x1.e2516fb2b5523p-7, -0x1.39f90aa1cc641p-5,
+   0x1.b07d185304289p-6, -0x1.ea930756fd193p-8, -0x1.1d352e2a9a0dep-8},
+  {0x1.7d528289fa093p-1, 0x1.560821e2f3aa9p-55, 0x1.14c75711551bbp-1, -0x1.0c88e71970f2cp-55,
+   -0x1.13dd8e4aa5095p-2, 0x1.4e38dead4c211p-4, 0x1.8355ff6b74576p-7, -0x1.260580de0faaap-5,
+   0x1.a29f8989371f0p-6, -0x1.052612b085d9ap-7, -0x1.beccb2511c555p-9},
+  {0x1.819d0b7158a4dp-1, -0x1.bf76229d3b917p-56, 0x1.107fbbe011080p-1, -0x1.107fbbe011080p-55,
+   -0x1.0feeb40894fcdp-2, 0x1.50e5afb9125f7p-4, 0x1.2a7c2843ba55ap-7, -0x1.12bd24b4ae875p-5,
+   0x1.93fe0f3b1b1eep-6, -0x1.1156dd4c2083bp-7, -0x1.4f63b0c35aa9cp-9},
+  {0x1.85d69576cc2c5p-1, 0x1.6b66e7fc8b8c3p-57, 0x1.0c47eac74fadcp-1, -0x1.035f877bb1887p-55,
+   -0x1.0bf8d7e8202a9p-2, 0x1.52e6c13725c73p-4, 0x1.af1a37d9c2711p-8, -0x1.0027fb643d11fp-5,
+   0x1.84c96c756b7d7p-6, -0x1.1a3b66c3ca3aep-7, -0x1.d747013459246p-10},
+  {0x1.89ff5ff57f1f8p-1, -0x1.55b9a5e177a1bp-55, 0x1.081ffbdf80108p-1, 0x1.ffbdf80108200p-57,
+   -0x1.07fdeba010928p-2, 0x1.5447b0136e69fp-4, 0x1.149fc55103947p-8, -0x1.dc97bfbe9a2eep-6,
+   0x1.752d4b08adda9p-6, -0x1.202e8b540d106p-7, -0x1.25de5859de3e9p-10},
+  {0x1.8e17aa99cc05ep-1, -0x1.ec182ab042f61p-56, 0x1.0407ffbefe001p-1, 0x1.01ffefbf80041p-59,
+   -0x1.03ffbebd00209p-2, 0x1.5513a5aaf6d91p-4, 0x1.0a27fc6ac4038p-9, -0x1.ba597ccd6032ap-6,
+   0x1.65508002bb974p-6, -0x1.23860d2d1068bp-7, -0x1.1277e666265bcp-11},
+  {0x1.921fb54442d18p-1, 0x1.1a62633145c07p-55, 0x1.0000000000000p-1, 0.0,
+   -0x1.0000000000000p-2, 0x1.5555555555555p-4, 0.0, -0x1.999999999999ap-6,
+   0x1.5555555555555p-6, -0x1.2492492492492p-7, 0.0},
+};
+
+// asin around j/64.
+static const TaylorTable kAsinTable[33] = {
+  {0.0, 0.0, 0x1.0000000000000p+0, 0.0,
+   0.0, 0x1.5555555555555p-3, 0.0, 0x1.3333333333333p-4,
+   0.0, 0x1.6db6db6db6db7p-5, 0.0},
+  {0x1.0002aabdde94cp-6, 0x1.130cd26cdfa37p-62, 0x1.0008006005004p+0, 0x1.80fc0e70d68c9p-54,
+   0x1.001801e023027p-7, 0x1.55b561d69c1d9p-3, 0x1.80640f51d8b1ap-8, 0x1.3423707d8a98bp-4,
+   0x1.40a37eb4c82d1p-8, 0x1.6fe7c7e95018dp-5, 0x1.18ec996b7bac0p-8},
+  {0x1.000aabde0b9c8p-5, 0x1.d6d94551be3e9p-61, 0x1.0020060140461p+0, -0x1.e3194a6d70f37p-59,
+   0x1.00601e08c276bp-6, 0x1.56d61da71d91fp-3, 0x1.8190f57651b41p-7, 0x1.36f709ca192f4p-4,
+   0x1.428fecb2dd781p-7, 0x1.7685ae5c79889p-5, 0x1.1bb69af2382f9p-7},
+  {0x1.8024091fdb0a9p-5, 0x1.80650020adbcap-60, 0x1.00481e6e44059p+0, 0x1.03acae7576bffp-54,
+   0x1.8144e465df560p-6, 0x1.58b94d7a886dep-3, 0x1.22a6a630e08e8p-6, 0x1.3bb6b206050e7p-4,
+   0x1.e8b0bf3a8df99p-7, 0x1.81b246668f2e5p-5, 0x1.b0a02677abecbp-7},
+  {0x1.002abde953619p-4, 0x1.182e2dc6ddeedp-58, 0x1.00806050463f4p+0, -0x1.828b6295ee621p-54,
+   0x1.0181e23278b7fp-5, 0x1.5b61e9ddafe71p-3, 0x1.864f6db9edae1p-6, 0x1.427119fb2aadbp-4,
+   0x1.4a5f258b28dc2p-6, 0x1.91a6dfa5adec1p-5, 0x1.271ec0e36e2b1p-6},
+  {0x1.405390240e6fdp-4, 0x1.1ed0159037972p-58, 0x1.00c8eb92d0899p+0, -0x1.21bd3807a2df1p-56,
+   0x1.42f3c358bf56fp-5, 0x1.5ed42868f5c98p-3, 0x1.ec64492a26c6ap-6, 0x1.4b3b3bb8bb4fdp-4,
+   0x1.a47096ab28fccp-6, 0x1.a6b61a98ef9c9p-5, 0x1.7bee41e38745cp-6},
+  {0x1.809092913e52ep-4, 0x1.cf6b1f9befb16p-60, 0x1.0121e99650547p+0, -0x1.ef574385b7b2ap-54,
+   0x1.851e62bfa7b80p-5, 0x1.631588e23b648p-3, 0x1.2ac723cfd763cp-5, 0x1.5630c74c11239p-4,
+   0x1.01db090c55949p-5, 0x1.c14e6b9bd36ddp-5, 0x1.d89487c1a54c1p-6},
+  {0x1.c0e5e80f7172dp-4, 0x1.d8eeba8bc0030p-58, 0x1.018b8d7225808p+0, 0x1.5f957888f35b7p-56,
+   0x1.c82935bc525d2p-5, 0x1.682ce69278d34p-3, 0x1.61401f0b4814ap-5, 0x1.6374b418a219cp-4,
+   0x1.34ba3c6600d13p-5, 0x1.e1fd8373b6ebfp-5, 0x1.1f92fa17fafa0p-5},
+  {0x1.00abe0c129e1ep-3, 0x1.7ceb0ee49d42ap-60, 0x1.02061446ffa9ap+0, -0x1.3e4dd7a0f0c8dp-54,
+   0x1.061e8e8103b88p-4, 0x1.6e228e2a0d52fp-3, 0x1.99fc94d904350p-5, 0x1.7331fb4c6e147p-4,
+   0x1.6b89bd1c4ff93p-5, 0x1.04ba61ae9f4bbp-4, 0x1.5903c0422cd36p-5},
+  {0x1.20f530308cc20p-3, -0x1.ed63934b583b4p-57, 0x1.0291c5a2914b9p+0, -0x1.99132ef934ec5p-54,
+   0x1.28c2562b1dbb8p-4, 0x1.750058a89f789p-3, 0x1.d56369ba8f121p-5, 0x1.859c814ebea71p-4,
+   0x1.a712fe05a369dp-5, 0x1.1c477799bc02ap-4, 0x1.9a02418651aecp-5},
+  {0x1.41510cb011423p-3, -0x1.15d675180eda8p-58, 0x1.032ef3f5dc32cp+0, 0x1.b9f313919470ap-57,
+   0x1.4c163be9c863ep-4, 0x1.7cd1cbdad651ap-3, 0x1.09f2314e3cd56p-4, 0x1.9af235aa4669dp-4,
+   0x1.e839f4c62cc13p-5, 0x1.382baffe36223p-4, 0x1.e434955f7ffe2p-5},
+  {0x1.61c1ab9d55d30p-3, -0x1.95a37debb0f64p-57, 0x1.03ddfd1f9dd13p+0, -0x1.c95a31ca69f7dp-59,
+   0x1.7031b3ec22c6ap-4, 0x1.85a441225beb2p-3, 0x1.2afce8950b937p-4, 0x1.b37c72ee5a759p-4,
+   0x1.180171efa661ap-4, 0x1.59098674f52e2p-4, 0x1.1cc8c531de934p-4},
+  {0x1.82494ed0e78fcp-3, -0x1.443c2697a7d2fp-57, 0x1.049f4b0cadb3bp+0, 0x1.bb890653e497cp-54,
+   0x1.952d8a70fd76cp-4, 0x1.8f871364b45f7p-3, 0x1.4e153e6ec33c2p-4, 0x1.cf91aa6f3828bp-4,
+   0x1.3fcca03287c26p-4, 0x1.7fa5ed07e4435p-4, 0x1.4e3a70e328fa4p-4},
+  {0x1.a2ea462b4998ep-3, -0x1.51d494caa9d70p-57, 0x1.057354707655fp+0, 0x1.58d85a325840bp-54,
+   0x1.bb241663384e7p-4, 0x1.9a8bd52d07cd0p-3, 0x1.7385eae2eda93p-4, 0x1.ef976acc50af3p-4,
+   0x1.6c2bfd3fd3a39p-4, 0x1.acef5e41c4bcap-4, 0x1.87dc51150705ep-4},
+  {0x1.c3a6f13aae84bp-3, -0x1.7739d10fe8bc1p-57, 0x1.065a9d98132e6p+0, -0x1.549771762b513p-54,
+   0x1.e231717821274p-4, 0x1.a6c69045eb07ep-3, 0x1.9ba2404c9cc04p-4, 0x1.0a0269f0229f8p-3,
+   0x1.9de9c0e525a3dp-4, 0x1.e206b6dd81823p-4, 0x1.cb6a80d04ce9fp-4},
+  {0x1.e481c0fce7134p-3, 0x1.c9bcb7ab7132bp-62, 0x1.0755b95b10b0ep+0, -0x1.f223ae7a5bbafp-54,
+   0x1.0539db627862bp-3, 0x1.b44e1054d3541p-3, 0x1.c6c7a77648ca0p-4, 0x1.1eb2c7b821295p-3,
+   0x1.d5f2faea626fbp-4, 0x1.102527c6624eep-3, 0x1.0d82379f994c2p-3},
+  {0x1.02be9ce0b87cdp-2, 0x1.e5d09da2e0f04p-58, 0x1.08654a2d4f6dbp+0, -0x1.fcd7aa9a877b8p-54,
+   0x1.1a05a47498fd8p-3, 0x1.c33c3a5427fc0p-3, 0x1.f55f5d410ffb9p-4, 0x1.362eb5f045f67p-3,
+   0x1.0aaf844bee781p-3, 0x1.34b1f9c970a7cp-3, 0x1.3ca358067b593p-3},
+  {0x1.134dfa9805147p-2, -0x1.bbe27a4ac52e2p-56, 0x1.098a035626467p+0, 0x1.079a4ca43d3c9p-57,
+   0x1.2f8d908e98498p-3, 0x1.d3ae732e8c418p-3, 0x1.13f03ff0ec572p-3, 0x1.50d65ee118d16p-3,
+   0x1.2ebc612dbc4d4p-3, 0x1.5fad407f66227p-3, 0x1.74b60ccdf5a33p-3},
+  {0x1.23f0523c5dc2bp-2, 0x1.4fc2674a3d6b2p-59, 0x1.0ac4aa5195bf3p+0, -0x1.138c42820d226p-54,
+   0x1.45e49457b8d60p-3, 0x1.e5c6183ac4587p-3, 0x1.2f693e7e09901p-3, 0x1.6f1adb5c8ae8ap-3,
+   0x1.57e4eb1106519p-3, 0x1.92541faf106e5p-3, 0x1.b7bc3ff02093bp-3},
+  {0x1.34a709597aab1p-2, -0x1.70f1371722985p-56, 0x1.0c16186135911p+0, 0x1.d0c42851f934fp-54,
+   0x1.5d1f4f628f5f2p-3, 0x1.f9a90cf194a64p-3, 0x1.4d67fafd77761p-3, 0x1.9181765593578p-3,
+   0x1.8714726ce0ad8p-3, 0x1.ce2ba7d8c6267p-3, 0x1.041c09b10f33bp-2},
+  {0x1.457393b90e2aap-2, 0x1.b1f64d329fe98p-56, 0x1.0d7f3c53851c3p+0, -0x1.95634658de958p-59,
+   0x1.755446452737bp-3, 0x1.07c130faff1d6p-2, 0x1.6e451a9f5f5c3p-3, 0x1.b8a7ae2299f55p-3,
+   0x1.bd659333127ffp-3, 0x1.0a89831af219ep-2, 0x1.34a8081c9b80bp-2},
+  {0x1.565774cb66f02p-2, -0x1.c537759c5cce1p-56, 0x1.0f011c89781dap+0, -0x1.de4795ed6a448p-56,
+   0x1.8e9c25360fb82p-3, 0x1.13c18d3b33bfap-2, 0x1.9266aaacd0ef5p-3, 0x1.e548236d1a856p-3,
+   0x1.fc2d497cd6888p-3, 0x1.34ad7378fd33bp-2, 0x1.6f7f54ac89338p-2},
+  {0x1.675441329986ep-2, 0x1.d027ed2bb2edap-56, 0x1.109cd94386664p+0, -0x1.825e2e62128bcp-54,
+   0x1.a9120cbe5685ep-3, 0x1.20f18b0be2ac0p-2, 0x1.ba42a20e8ba32p-3, 0x1.0c2059c61b8f2p-2,
+   0x1.2284782be1355p-2, 0x1.66f1d7d122428p-2, 0x1.b728803f36897p-2},
+  {0x1.786ba074fef93p-2, -0x1.73b1910f90a93p-56, 0x1.1253af413d3b5p+0, 0x1.5d2143ddf7dcdp-59,
+   0x1.c4d3ea6338818p-3, 0x1.2f711389ff8a4p-2, 0x1.e661eb1c69d77p-3, 0x1.294d070ff18d9p-2,
+   0x1.4cf803fc0b3cfp-2, 0x1.a322664329898p-2, 0x1.076e975910b62p-1},
+  {0x1.899f4edc962d3p-2, 0x1.3e919701b7c6dp-60, 0x1.1426fac0654dbp+0, -0x1.094cdd1bdfbc0p-54,
+   0x1.e202df90fb4b1p-3, 0x1.3f64af08aaa6ap-2, 0x1.0bb20b9b6a221p-2, 0x1.4ac896e03961dp-2,
+   0x1.7ea574d1b4122p-2, 0x1.eb800c9c5d2ecp-2, 0x1.3d60fa4e04a35p-1},
+  {0x1.9af11f89ba61cp-2, 0x1.a884c2416dce8p-56, 0x1.16183aeb573c3p+0, 0x1.8baf670d1405bp-56,
+   0x1.0061dcc826883p-2, 0x1.50f64bcbdfb22p-2, 0x1.2701f37c70ae5p-2, 0x1.71519dce85895p-2,
+   0x1.b907f9bc1bf4dp-2, 0x1.2171636b39548p-1, 0x1.8018d3ade3b92p-1},
+  {0x1.ac62fec0b2a92p-2, 0x1.cb9f9a052f11fp-56, 0x1.182915c92f066p+0, -0x1.96040f1fedc7dp-56,
+   0x1.109fbef7deb6ep-2, 0x1.64562d09aa292p-2, 0x1.458e6f03ee033p-2, 0x1.9dce487781efcp-2,
+   0x1.fdf49fcf1ed2fp-2, 0x1.56733ba605254p-1, 0x1.d311d218ee5b6p-1},
+  {0x1.bdf6f47ae6904p-2, 0x1.e7bfe76547424p-56, 0x1.1a5b5cc659574p+0, -0x1.dab16f444e53ap-54,
+   0x1.21d207ca4ca5ep-2, 0x1.79bc0b9f13dedp-2, 0x1.67d914d3f69b1p-2, 0x1.d155e1b760053p-2,
+   0x1.27d96e421efb7p-1, 0x1.97136076362edp-1, 0x1.1d6df25777019p+0},
+  {0x1.cfaf27460fe9fp-2, -0x1.8bf75f355f723p-57, 0x1.1cb111f0a37bcp+0, -0x1.86634f69e42e2p-55,
+   0x1.341278d2eebedp-2, 0x1.91687471015e6p-2, 0x1.8e7b9b5b3dd4fp-2, 0x1.069e7e5d35ba5p-1,
+   0x1.588e5aa2f5378p-1, 0x1.e647c0e02135ap-1, 0x1.5ebde54c356bdp+0},
+  {0x1.e18ddf7da106bp-2, -0x1.58029cecb4d7bp-58, 0x1.1f2c6e07c5944p+0, -0x1.78cb398dbb5d3p-59,
+   0x1.477e1764a53b6p-2, 0x1.aba673c3a4c6dp-2, 0x1.ba2d38394ad5fp-2, 0x1.29928bf012631p-1,
+   0x1.92e497493946bp-1, 0x1.23f278d2e44a7p+0, 0x1.b178b88f23e24p+0},
+  {0x1.f3958aecddef4p-2, -0x1.fc135930a7786p-58, 0x1.21cfe78a9e62ap+0, 0x1.be6debdf33777p-55,
+   0x1.5c35b665d4687p-2, 0x1.c8cda1320fcb1p-2, 0x1.ebc9642da3280p-2, 0x1.52886c9a5ab93p-1,
+   0x1.d9225c6a3ecbep-1, 0x1.607458864a77dp+0, 0x1.0d7d27ade5071p+1},
+  {0x1.02e46075785a1p-1, 0x1.d1c9139aa7a36p-56, 0x1.249e3af272a2fp+0, -0x1.90699e6080472p-56,
+   0x1.725e9b73b49e3p-2, 0x1.e944a5ba62b0ep-2, 0x1.122c37169efdap-1, 0x1.82bf37a2f1a3ap-1,
+   0x1.17173471984fcp+0, 0x1.abf04eb435d2cp+0, 0x1.51401929e64efp+1},
+  {0x1.0c152382d7366p-1, -0x1.ee6913347c2a6p-55, 0x1.279a74590331cp+0, 0x1.34863e0792bedp-54,
+   0x1.8a2345cc04426p-2, 0x1.06c22e8802d6ep-1, 0x1.328d364958a56p-1, 0x1.bbc51b62dcf93p-1,
+   0x1.4ae18feda4c2cp+0, 0x1.055e46aa8225bp+1, 0x1.a8f48424a8f02p+1},
+};
+
+// Returns f(uh + ul) as the return value plus *lo, where |ul| is at most about
+// ulp(uh) and uh is in the range of table.
+static inline double taylor_table(const TaylorTable* table, double uh, double ul, double* lo) {
+  // Round to the nearest multiple of 1/64 without a conversion on the
+  // critical path, and then d = uh - c exactly.
+  double jd = (uh * 64.0 + 0x1.8p52) - 0x1.8p52;
+  const double* a = table[(int) jd];
+  double d = __builtin_fma(jd, -0x1p-6, uh);
+
+  double d2 = d * d;
+  double d4 = d2 * d2;
+  double poly = d2 * ((a[4] + d * a[5]) + d2 * (a[6] + d * a[7]) + d4 * (a[8] + d * a[9] + d2 * a[10]));
+
+  // f(c) + a1*d is the bulk of the result, so it's summed exactly. |a1*d| is
+  // smaller than any non-zero f(c).
+  double p = a[2] * d;
+  double pe = __builtin_fma(a[2], d, -p);
+  double hi = a[0] + p;
+  *lo = ((a[0] - hi) + p) + (a[1] + pe + a[3] * d + a[2] * ul + poly);
+  return hi;
+}
+
+double atan(double x) {
+  double ax = __builtin_fabs(x);
+  if (__predict_false(ax < 0x1p-27)) return x;
+  if (__predict_false(!(ax <= 0x1p66))) return isnan(x) ? x + x : __builtin_copysign(kPiOver2Hi, x);
+
+  double lo, result;
+  if (ax <= 1.0) {
+    double hi = taylor_table(kAtanTable, ax, 0.0, &lo);
+    result = hi + lo;
+  } else {
+    double uh = 1.0 / ax;
+    double ul = __builtin_fma(-uh, ax, 1.0) * uh;
+    double hi = taylor_table(kAtanTable, uh, ul, &lo);
+    result = add_angle(kPiOver2Hi, kPiOver2Lo, -hi, -lo);
+  }
+  return __builtin_copysign(result, x);
+}
+
+double atan2(double y, double x) {
+  double ax = __builtin_fabs(x);
+  double ay = __builtin_fabs(y);
+  bool negate_x = __builtin_signbit(x);
+
+  if (__predict_false(isnan(x) || isnan(y))) return x + y;
+  if (__predict_false(ay == 0.0)) return negate_x ? __builtin_copysign(kPiHi, y) : y;
+  if (__predict_false(ax == 0.0)) return __builtin_copysign(kPiOver2Hi, y);
+  if (__predict_false(isinf(ax) || isinf(ay))) {
+    double result;
+    if (isinf(ax) && isinf(ay)) {
+      result = negate_x ? 3.0 * (kPiOver2Hi / 2.0) : kPiOver2Hi / 2.0;
+    } else if (isinf(ay)) {
+      result = kPiOver2Hi;
+    } else {
+      result = negate_x ? kPiHi : 0.0;
+    }
+    return __builtin_copysign(result, y);
+  }
+
+  // u is y/x or x/y, whichever is at most 1. Only the reciprocal of the
+  // denominator is an actual division: n*r is within a couple of ULP of n/d,
+  // and the remainder, computed exactly with fma(), makes up the difference.
+  bool swap = ay > ax;
+  double n = swap ? ax : ay;
+  double d = swap ? ay : ax;
+  if (__predict_false(n < 0x1p-960 || d > 0x1p1020)) {
+    // Keep 1/d and the remainder out of the subnormals.
+    int e = ilogb(d);
+    n = scalbn(n, -e);
+    d = scalbn(d, -e);
+  }
+  double r = 1.0 / d;
+  double uh = n * r;
+  double ul = __builtin_fma(-uh, d, n) * r;
+
+  double lo;
+  double hi = taylor_table(kAtanTable, uh, ul, &lo);
+  double result;
+  if (swap) {
+    // pi/2 - atan(u), or pi/2 + atan(u).
+    result = negate_x ? add_angle(kPiOver2Hi, kPiOver2Lo, hi, lo)
+                      : add_angle(kPiOver2Hi, kPiOver2Lo, -hi, -lo);
+  } else {
+    // atan(u), or pi - atan(u).
+    result = negate_x ? add_angle(kPiHi, kPiLo, -hi, -lo) : hi + lo;
+  }
+  return __builtin_copysign(result, y);
+}
+
+// Returns asin(sqrt((1 - ax)/2)) as the return value plus *lo, for
+// 1/2 <= ax < 1.
+static inline double asin_half_angle(double ax, double* lo) {
+  // 1 - ax is exact (Sterbenz), and so is halving it.
+  double w = (1.0 - ax) * 0.5;
+  double zh = __builtin_sqrt(w);
+  double zl = __builtin_fma(-zh, zh, w) / (2.0 * zh);
+  return taylor_table(kAsinTable, zh, zl, lo);
+}
+
+double asin(double x) {
+  double ax = __builtin_fabs(x);
+  if (__predict_false(!(ax < 1.0))) {
+    if (ax == 1.0) return __builtin_copysign(kPiOver2Hi, x);
+    return (x - x) / (x - x);
+  }
+  if (__predict_false(ax < 0x1p-27)) return x;
+
+  double lo, result;
+  if (ax <= 0.5) {
+    double hi = taylor_table(kAsinTable, ax, 0.0, &lo);
+    result = hi + lo;
+  } else {
+    double hi = asin_half_angle(ax, &lo);
+    result = add_angle(kPiOver2Hi, kPiOver2Lo, -2.0 * hi, -2.0 * lo);
+  }
+  return __builtin_copysign(result, x);
+}
+
+double acos(double x) {
+  double ax = __builtin_fabs(x);
+  if (__predict_false(!(ax < 1.0))) {
+    if (x == 1.0) return 0.0;
+    if (x == -1.0) return kPiHi;
+    return (x - x) / (x - x);
+  }
+
+  double lo;
+  if (ax <= 0.5) {
+    // pi/2 - asin(x).
+    double hi = taylor_table(kAsinTable, ax, 0.0, &lo);
+    if (x > 0.0) {
+      hi = -hi;
+      lo = -lo;
+    }
+    return add_angle(kPiOver2Hi, kPiOver2Lo, hi, lo);
+  }
+  // 2*asin(sqrt((1 - x)/2)), or pi - 2*asin(sqrt((1 + x)/2)).
+  double hi = asin_half_angle(ax, &lo);
+  if (x > 0.0) return 2.0 * hi + 2.0 * lo;
+  return add_angle(kPiHi, kPiLo, -2.0 * hi, -2.0 * lo);
+}
@@ -0,0 +1,390 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+// The kernels behind libm's vector function ABI entry points (_ZGVbN2v_sin and
+// friends) and array functions (android_sincosf_array() and friends), defined in
+// arm64/vector_math.cpp and x86_64/vector_math.cpp.
+//
+// They're written with the compiler's generic vector extensions so that one
+// definition serves every vector width: each entry point instantiates them
+// with its own vector type, in a function compiled for its own ISA. The
+// algorithms and coefficients are the FreeBSD ones the scalar functions use,
+// minus the branches.
+//
+// Lanes the fast paths don't cover (huge arguments, infinities, NaNs, zeros
+// and negative numbers for log, ...) are recomputed with the scalar function,
+// so results there are exactly the scalar ones. Everywhere else the error is
+// at most 4 ULP (2 ULP for the float functions). Like the rest of libm, none of
+// these set errno.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define VM_INLINE static inline __attribute__((__always_inline__))
+
+// The signed integer vector with the same lane width as V, which is also what
+// comparing two Vs gives.
+template <typename V>
+using VMask = decltype(V{} < V{});
+
+template <typename V>
+VM_INLINE constexpr size_t Lanes() {
+  return sizeof(V) / sizeof(V{}[0]);
+}
+
+template <typename V, typename T>
+VM_INLINE V Splat(T value) {
+  // Not V{} + value, which would turn -0.0 into 0.0.
+  V result = {};
+  for (size_t i = 0; i < Lanes<V>(); ++i) result[i] = value;
+  return result;
+}
+
+template <typename V>
+VM_INLINE V Select(VMask<V> mask, V a, V b) {
+  return (V)(((VMask<V>)a & mask) | ((VMask<V>)b & ~mask));
+}
+
+template <typename V>
+VM_INLINE V Abs(V x) {
+  return (V)((VMask<V>)x & ~(VMask<V>)Splat<V>(-0.0));
+}
+
+template <typename V>
+VM_INLINE bool Any(VMask<V> mask) {
+  for (size_t i = 0; i < Lanes<V>(); ++i) {
+    if (mask[i]) return true;
+  }
+  return false;
+}
+
+template <typename V, typename T>
+VM_INLINE V FixUp(V result, V x, VMask<V> special, T (*fn)(T)) {
+  if (__predict_false(Any<V>(special))) {
+    for (size_t i = 0; i < Lanes<V>(); ++i) {
+      if (special[i]) result[i] = fn(x[i]);
+    }
+  }
+  return result;
+}
+
+// exp(x) = 2^k * exp(r), with |r| <= ln2/2, as in e_exp.c. The _finite
+// kernels assume |x| <= 708, so that neither the result nor 2^k is subnormal
+// or infinite.
+template <typename V>
+VM_INLINE V vm_exp_finite(V x) {
+  typedef VMask<V> I;
+  const V shift = Splat<V>(0x1.8p52);
+  V t = x * 1.44269504088896338700e+00 + shift;
+  V k = t - shift;
+  I ki = (I)t - (I)shift;
+  V hi = x - k * 6.93147180369123816490e-01;
+  V lo = k * 1.90821492927058770002e-10;
+  V r = hi - lo;
+
+  V rr = r * r;
+  V c = r - rr * (1.66666666666666019037e-01 +
+                  rr * (-2.77777777770155933842e-03 +
+                        rr * (6.61375632143793436117e-05 +
+                              rr * (-1.65339022054652515390e-06 +
+                                    rr * 4.13813679705723846039e-08))));
+  V y = 1.0 - ((lo - (r * c) / (2.0 - c)) - hi);
+  return y * (V)((ki + 1023) << 52);
+}
+
+template <typename V>
+VM_INLINE V vm_exp(V x) {
+  VMask<V> special = ~(Abs(x) <= 708.0);
+  return FixUp<V, double>(vm_exp_finite(x), x, special, exp);
+}
+
+template <typename V>
+VM_INLINE V vm_expf(V x) {
+  typedef VMask<V> I;
+  const V shift = Splat<V>(0x1.8p23f);
+  I special = ~(Abs(x) <= 86.0f);
+
+  V t = x * 1.4426950216e+00f + shift;
+  V k = t - shift;
+  I ki = (I)t - (I)shift;
+  V hi = x - k * 6.9314575195e-01f;
+  V lo = k * 1.4286067653e-06f;
+  V r = hi - lo;
+
+  V rr = r * r;
+  V c = r - rr * (1.6666625440e-1f + rr * -2.7667332906e-3f);
+  V y = 1.0f - ((lo - (r * c) / (2.0f - c)) - hi);
+  V result = y * (V)((ki + 127) << 23);
+  return FixUp<V, float>(result, x, special, expf);
+}
+
+// log(x) = k*ln2 + log(1+f), with 1+f in [sqrt(2)/2, sqrt(2)), as in e_log.c.
+// The _finite kernel assumes x is positive, normal and finite.
+template <typename V>
+VM_INLINE V vm_log_finite(V x) {
+  typedef VMask<V> I;
+  I ix = (I)x;
+  I tmp = ix - 0x3fe6a09e667f3bcd;
+  I k = tmp >> 52;
+  V f = (V)(ix - (tmp & (I)Splat<I>(0xfff0000000000000))) - 1.0;
+  // Not __builtin_convertvector, because x86 before AVX-512 can't convert
+  // 64-bit integers in vector registers.
+  const V shift = Splat<V>(0x1.8p52);
+  V dk = (V)(k + (I)shift) - shift;
+
+  V s = f / (2.0 + f);
+  V z = s * s;
+  V w = z * z;
+  V t1 = w * (3.999999999940941908e-01 +
+              w * (2.222219843214978396e-01 + w * 1.531383769920937332e-01));
+  V t2 = z * (6.666666666666735130e-01 +
+              w * (2.857142874366239149e-01 +
+                   w * (1.818357216161805012e-01 + w * 1.479819860511658591e-01)));
+  V hfsq = 0.5 * f * f;
+  return dk * 6.93147180369123816490e-01 -
+         ((hfsq - (s * (hfsq + t1 + t2) + dk * 1.90821492927058770002e-10)) - f);
+}
+
+template <typename V>
+VM_INLINE V vm_log(V x) {
+  VMask<V> ix = (VMask<V>)x;
+  VMask<V> special = (ix < 0x0010000000000000) | (ix >= 0x7ff0000000000000);
+  return FixUp<V, double>(vm_log_finite(x), x, special, log);
+}
+
+template <typename V>
+VM_INLINE V vm_logf(V x) {
+  typedef VMask<V> I;
+  I ix = (I)x;
+  I special = (ix < 0x00800000) | (ix >= 0x7f800000);
+
+  I tmp = ix - 0x3f3504f3;
+  I k = tmp >> 23;
+  V f = (V)(ix - (tmp & (I)Splat<I>(0xff800000))) - 1.0f;
+  V dk = __builtin_convertvector(k, V);
+
+  V s = f / (2.0f + f);
+  V z = s * s;
+  V w = z * z;
+  V t1 = w * (0xccce13.0p-25f + w * 0xf89e26.0p-26f);
+  V t2 = z * (0xaaaaaa.0p-24f + w * 0x91e9ee.0p-25f);
+  V hfsq = 0.5f * f * f;
+  V result = dk * 6.9313812256e-01f -
+             ((hfsq - (s * (hfsq + t1 + t2) + dk * 9.0580006145e-06f)) - f);
+  return FixUp<V, float>(result, x, special, logf);
+}
+
+// sin and cos reduce x by n*pi/2 as e_rem_pio2.c does for medium-sized
+// arguments, then use the k_sin.c and k_cos.c polynomials on what's left.
+// Both polynomials are always evaluated, so sin, cos and sincos share this,
+// returning n: cos(x) is sin(x + pi/2), so it's just one more quadrant.
+template <typename V>
+VM_INLINE VMask<V> vm_sin_cos_kernel(V x, V* s, V* c) {
+  typedef VMask<V> I;
+  const V shift = Splat<V>(0x1.8p52);
+  V t = x * 6.36619772367581382433e-01 + shift;
+  V n = t - shift;
+  // Subtract n*pi/2 in three pieces, keeping the rounding error of each step.
+  // e_rem_pio2.c only takes the second and third steps when the first cancels
+  // too much, but doing them every time is cheaper than branching per lane.
+  V r0 = x - n * 1.57079632673412561417e+00;
+  V w = n * 6.07710050630396597660e-11;
+  V r1 = r0 - w;
+  V e = (r0 - r1) - w;
+  w = n * 2.02226624871116645580e-21;
+  V r2 = r1 - w;
+  e += (r1 - r2) - w;
+  V y = r2 - (n * 8.47842766036889956997e-32 - e);
+
+  V z = y * y;
+  V zz = z * z;
+  V rs = 8.33333333332248946124e-03 +
+         z * (-1.98412698298579493134e-04 + z * 2.75573137070700676789e-06) +
+         z * zz * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10);
+  *s = y + (z * y) * (-1.66666666666666324348e-01 + z * rs);
+  V rc = z * (4.16666666666666019037e-02 +
+              z * (-1.38888888888741095749e-03 + z * 2.48015872894767294178e-05)) +
+         zz * zz * (-2.75573143513906633035e-07 +
+                    z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11));
+  V hz = 0.5 * z;
+  V c1 = 1.0 - hz;
+  *c = c1 + (((1.0 - c1) - hz) + z * rc);
+  return (I)t - (I)shift;
+}
+
+// sin(n*pi/2 + y), given sin(y) and cos(y). Only the low two bits of n matter.
+template <typename V>
+VM_INLINE V vm_quadrant(VMask<V> n, V s, V c) {
+  V result = Select<V>((n & 1) != 0, c, s);
+  return (V)((VMask<V>)result ^ ((n & 2) << (sizeof(V{}[0]) * 8 - 2)));
+}
+
+// Past 2^20*pi/2, n*pio2_1 is no longer exact.
+template <typename V>
+VM_INLINE VMask<V> vm_sin_cos_special(V x) {
+  return ~(Abs(x) <= 0x1.921fb54442d18p20);
+}
+
+template <typename V, int kQuadrant>
+VM_INLINE V vm_sin_quadrant(V x) {
+  V s, c;
+  VMask<V> n = vm_sin_cos_kernel(x, &s, &c);
+  V result = vm_quadrant<V>(n + kQuadrant, s, c);
+  if (kQuadrant == 0) {
+    // The polynomial turns sin(-0.0) into 0.0.
+    result = Select<V>(x == 0.0, x, result);
+    return FixUp<V, double>(result, x, vm_sin_cos_special(x), sin);
+  }
+  return FixUp<V, double>(result, x, vm_sin_cos_special(x), cos);
+}
+
+template <typename V>
+VM_INLINE V vm_sin(V x) {
+  return vm_sin_quadrant<V, 0>(x);
+}
+
+template <typename V>
+VM_INLINE V vm_cos(V x) {
+  return vm_sin_quadrant<V, 1>(x);
+}
+
+template <typename V>
+VM_INLINE void vm_sincos(V x, V* sin_x, V* cos_x) {
+  V s, c;
+  VMask<V> n = vm_sin_cos_kernel(x, &s, &c);
+  VMask<V> special = vm_sin_cos_special(x);
+  V sin_result = Select<V>(x == 0.0, x, vm_quadrant<V>(n, s, c));
+  *sin_x = FixUp<V, double>(sin_result, x, special, sin);
+  *cos_x = FixUp<V, double>(vm_quadrant<V>(n + 1, s, c), x, special, cos);
+}
+
+// The float versions work in double, as the scalar ones do: one subtraction
+// reduces the argument, and the k_sinf.c and k_cosf.c polynomials need no
+// extra precision tricks. VD is the double vector with as many lanes as VF.
+template <typename VD>
+VM_INLINE VMask<VD> vm_sinf_cosf_kernel(VD x, VD* s, VD* c) {
+  typedef VMask<VD> I;
+  const VD shift = Splat<VD>(0x1.8p52);
+  VD t = x * 6.36619772367581382433e-01 + shift;
+  VD n = t - shift;
+  VD y = (x - n * 1.57079631090164184570e+00) - n * 1.58932547735281966916e-08;
+
+  VD z = y * y;
+  VD w = z * z;
+  VD sz = z * y;
+  *s = (y + sz * (-0x15555554cbac77.0p-55 + z * 0x111110896efbb2.0p-59)) +
+       sz * w * (-0x1a00f9e2cae774.0p-65 + z * 0x16cd878c3b46a7.0p-71);
+  *c = ((1.0 + z * -0x1ffffffd0c5e81.0p-54) + w * 0x155553e1053a42.0p-57) +
+       (w * z) * (-0x16c087e80f1e27.0p-62 + z * 0x199342e0ee5069.0p-68);
+  return (I)t - (I)shift;
+}
+
+template <typename VF>
+VM_INLINE VMask<VF> vm_sinf_cosf_special(VF x) {
+  return ~(Abs(x) <= 0x1p28f);
+}
+
+template <typename VF, typename VD, int kQuadrant>
+VM_INLINE VF vm_sinf_quadrant(VF xf) {
+  VD s, c;
+  VMask<VD> n = vm_sinf_cosf_kernel(__builtin_convertvector(xf, VD), &s, &c);
+  VF result = __builtin_convertvector(vm_quadrant<VD>(n + kQuadrant, s, c), VF);
+  if (kQuadrant == 0) {
+    result = Select<VF>(xf == 0.0f, xf, result);
+    return FixUp<VF, float>(result, xf, vm_sinf_cosf_special(xf), sinf);
+  }
+  return FixUp<VF, float>(result, xf, vm_sinf_cosf_special(xf), cosf);
+}
+
+template <typename VF, typename VD>
+VM_INLINE VF vm_sinf(VF x) {
+  return vm_sinf_quadrant<VF, VD, 0>(x);
+}
+
+template <typename VF, typename VD>
+VM_INLINE VF vm_cosf(VF x) {
+  return vm_sinf_quadrant<VF, VD, 1>(x);
+}
+
+template <typename VF, typename VD>
+VM_INLINE void vm_sincosf(VF xf, VF* sin_x, VF* cos_x) {
+  VD s, c;
+  VMask<VD> n = vm_sinf_cosf_kernel(__builtin_convertvector(xf, VD), &s, &c);
+  VMask<VF> special = vm_sinf_cosf_special(xf);
+  VF sin_result = __builtin_convertvector(vm_quadrant<VD>(n, s, c), VF);
+  sin_result = Select<VF>(xf == 0.0f, xf, sin_result);
+  *sin_x = FixUp<VF, float>(sin_result, xf, special, sinf);
+  VF cos_result = __builtin_convertvector(vm_quadrant<VD>(n + 1, s, c), VF);
+  *cos_x = FixUp<VF, float>(cos_result, xf, special, cosf);
+}
+
+// pow() and powf() just call the scalar function for each lane. Getting
+// within a few ULP needs the extra precision e_pow.c and the optimized-routines
+// powf() get from table-driven logarithms, and a vector version built from
+// vm_log and vm_exp was slower than the scalar powf(). The entry points still
+// let loops calling pow() be vectorized around the calls.
+template <typename V, typename T>
+VM_INLINE V vm_pow(V x, V y, T (*fn)(T, T)) {
+  V result = {};
+  for (size_t i = 0; i < Lanes<V>(); ++i) result[i] = fn(x[i], y[i]);
+  return result;
+}
+
+// The array functions (android_expf_array() and friends) run a kernel over whole
+// vectors of x, and then over one more vector for the last few elements. That
+// one is padded with copies of the last element, so the padding lanes can't
+// take a slow path or raise a floating-point exception that the real elements
+// don't. x and the outputs may be the same array.
+template <typename V, typename T, V (*kernel)(V)>
+VM_INLINE void vm_array(const T* x, T* y, size_t n) {
+  size_t i = 0;
+  for (; i + Lanes<V>() <= n; i += Lanes<V>()) {
+    V v;
+    __builtin_memcpy(&v, x + i, sizeof(v));
+    V result = kernel(v);
+    __builtin_memcpy(y + i, &result, sizeof(result));
+  }
+  if (i < n) {
+    V v = Splat<V>(x[n - 1]);
+    for (size_t j = 0; i + j < n; ++j) v[j] = x[i + j];
+    V result = kernel(v);
+    for (size_t j = 0; i + j < n; ++j) y[i + j] = result[j];
+  }
+}
+
+template <typename V, typename T, void (*kernel)(V, V*, V*)>
+VM_INLINE void vm_array2(const T* x, T* y1, T* y2, size_t n) {
+  size_t i = 0;
+  for (; i + Lanes<V>() <= n; i += Lanes<V>()) {
+    V v, r1, r2;
+    __builtin_memcpy(&v, x + i, sizeof(v));
+    kernel(v, &r1, &r2);
+    __builtin_memcpy(y1 + i, &r1, sizeof(r1));
+    __builtin_memcpy(y2 + i, &r2, sizeof(r2));
+  }
+  if (i < n) {
+    V v = Splat<V>(x[n - 1]), r1, r2;
+    for (size_t j = 0; i + j < n; ++j) v[j] = x[i + j];
+    kernel(v, &r1, &r2);
+    for (size_t j = 0; i + j < n; ++j) {
+      y1[i + j] = r1[j];
+      y2[i + j] = r2[j];
+    }
+  }
+}
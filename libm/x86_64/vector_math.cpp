@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vector_math.h"
+
+#include "private/bionic_ifuncs.h"
+
+// The x86-64 vector function ABI's names: _ZGV, the ISA (b for SSE, c for AVX,
+// d for AVX2, e for AVX-512), N for unmasked, the lane count, then one v per
+// vector argument. These are the variants `#pragma omp declare simd notinbranch`
+// in <math.h> makes the compiler call, so each one assumes its ISA: a caller
+// only uses the AVX2 ones when it was itself compiled for AVX2.
+
+typedef double double2 __attribute__((__vector_size__(16)));
+typedef double double4 __attribute__((__vector_size__(32)));
+typedef double double8 __attribute__((__vector_size__(64)));
+typedef double double16 __attribute__((__vector_size__(128)));
+typedef float float4 __attribute__((__vector_size__(16)));
+typedef float float8 __attribute__((__vector_size__(32)));
+typedef float float16 __attribute__((__vector_size__(64)));
+
+#define VECTOR_MATH_FUNCTIONS(ISA, TARGET, D, VD, F, VF, VFD)                                         \
+  extern "C" TARGET VD _ZGV##ISA##N##D##v_cos(VD x) { return vm_cos(x); }                             \
+  extern "C" TARGET VD _ZGV##ISA##N##D##v_exp(VD x) { return vm_exp(x); }                             \
+  extern "C" TARGET VD _ZGV##ISA##N##D##v_log(VD x) { return vm_log(x); }                             \
+  extern "C" TARGET VD _ZGV##ISA##N##D##vv_pow(VD x, VD y) { return vm_pow<VD, double>(x, y, pow); }  \
+  extern "C" TARGET VD _ZGV##ISA##N##D##v_sin(VD x) { return vm_sin(x); }                             \
+  extern "C" TARGET VF _ZGV##ISA##N##F##v_cosf(VF x) { return vm_cosf<VF, VFD>(x); }                  \
+  extern "C" TARGET VF _ZGV##ISA##N##F##v_expf(VF x) { return vm_expf(x); }                           \
+  extern "C" TARGET VF _ZGV##ISA##N##F##v_logf(VF x) { return vm_logf(x); }                           \
+  extern "C" TARGET VF _ZGV##ISA##N##F##vv_powf(VF x, VF y) { return vm_pow<VF, float>(x, y, powf); } \
+  extern "C" TARGET VF _ZGV##ISA##N##F##v_sinf(VF x) { return vm_sinf<VF, VFD>(x); }
+
+VECTOR_MATH_FUNCTIONS(b, , 2, double2, 4, float4, double4)
+VECTOR_MATH_FUNCTIONS(c, __attribute__((__target__("avx"))), 4, double4, 8, float8, double8)
+VECTOR_MATH_FUNCTIONS(d, __attribute__((__target__("avx2"))), 4, double4, 8, float8, double8)
+VECTOR_MATH_FUNCTIONS(e, __attribute__((__target__("avx512f"))), 8, double8, 16, float16, double16)
+
+// FreeBSD's s_sincos.c reduces the argument with branches on its size and
+// then runs __kernel_sin and __kernel_cos one after the other. SSE2 is always
+// there, so the scalar sincos() runs the vector kernel on a two-lane vector
+// instead: both polynomials are evaluated side by side, and huge, infinite and
+// NaN arguments still go to the scalar sin() and cos().
+extern "C" void sincos(double x, double* sin_x, double* cos_x) {
+  double2 s, c;
+  vm_sincos<double2>(double2{x, x}, &s, &c);
+  *sin_x = s[0];
+  *cos_x = c[0];
+}
+
+// The array functions aren't tied to an ISA by their callers, so they use AVX2
+// when the CPU has it. AVX-512 isn't used: on many CPUs, its frequency drop
+// costs more than the wider vectors win.
+
+#define ARRAY_FUNCTIONS(ISA, TARGET, VD, VF, VFD)                                                      \
+  extern "C" TARGET void android_exp_array_##ISA(const double* x, double* y, size_t n) {               \
+    vm_array<VD, double, vm_exp>(x, y, n);                                                             \
+  }                                                                                                    \
+  extern "C" TARGET void android_expf_array_##ISA(const float* x, float* y, size_t n) {                \
+    vm_array<VF, float, vm_expf>(x, y, n);                                                             \
+  }                                                                                                    \
+  extern "C" TARGET void android_log_array_##ISA(const double* x, double* y, size_t n) {               \
+    vm_array<VD, double, vm_log>(x, y, n);                                                             \
+  }                                                                                                    \
+  extern "C" TARGET void android_logf_array_##ISA(const float* x, float* y, size_t n) {                \
+    vm_array<VF, float, vm_logf>(x, y, n);                                                             \
+  }                                                                                                    \
+  extern "C" TARGET void android_sincos_array_##ISA(const double* x, double* s, double* c, size_t n) { \
+    vm_array2<VD, double, vm_sincos>(x, s, c, n);                                                      \
+  }                                                                                                    \
+  extern "C" TARGET void android_sincosf_array_##ISA(const float* x, float* s, float* c, size_t n) {   \
+    vm_array2<VF, float, vm_sincosf<VF, VFD>>(x, s, c, n);                                             \
+  }
+
+ARRAY_FUNCTIONS(sse2, __attribute__((__visibility__("hidden"))), double2, float4, double4)
+ARRAY_FUNCTIONS(avx2, __attribute__((__target__("avx2"), __visibility__("hidden"))), double4,
+                float8, double8)
+
+extern "C" {
+
+#define ARRAY_IFUNC(NAME, ...)                                               \
+  typedef void NAME##_func(__VA_ARGS__);                                     \
+  DEFINE_IFUNC_FOR(NAME) {                                                   \
+    __builtin_cpu_init();                                                    \
+    if (__builtin_cpu_supports("avx2")) RETURN_FUNC(NAME##_func, NAME##_avx2); \
+    RETURN_FUNC(NAME##_func, NAME##_sse2);                                   \
+  }
+
+ARRAY_IFUNC(android_exp_array, const double*, double*, size_t)
+ARRAY_IFUNC(android_expf_array, const float*, float*, size_t)
+ARRAY_IFUNC(android_log_array, const double*, double*, size_t)
+ARRAY_IFUNC(android_logf_array, const float*, float*, size_t)
+ARRAY_IFUNC(android_sincos_array, const double*, double*, double*, size_t)
+ARRAY_IFUNC(android_sincosf_array, const float*, float*, float*, size_t)
+
+}  // extern "C"
@@ -45,6 +45,8 @@
 #include "linker_relocate.h"
 #include "linker_utils.h"
 
+#include "private/bionic_globals.h"
+
 // Enable the slow lookup path if symbol lookups should be logged.
 static bool is_lookup_tracing_enabled() {
   return g_ld_debug_verbosity > LINKER_VERBOSITY_TRACE && DO_TRACE_LOOKUP;
@@ -543,10 +545,18 @@ void soinfo::call_constructors() {
     bionic_trace_begin((std::string("calling constructors: ") + get_realpath()).c_str());
   }
 
+  // libc.so installs these hooks from its own constructor, so read them both up front to keep
+  // the calls paired.
+  auto begin_hook = __libc_shared_globals()->constructors_begin_hook;
+  auto end_hook = __libc_shared_globals()->constructors_end_hook;
+  if (begin_hook != nullptr && end_hook != nullptr) begin_hook();
+
   // DT_INIT should be called before DT_INIT_ARRAY if both are present.
   call_function("DT_INIT", init_func_, get_realpath());
   call_array("DT_INIT_ARRAY", init_array_, init_array_count_, false, get_realpath());
 
+  if (begin_hook != nullptr && end_hook != nullptr) end_hook();
+
   if (!is_linker()) {
     bionic_trace_end();
   }
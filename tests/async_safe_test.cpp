@@ -16,9 +16,24 @@
 
 #include <gtest/gtest.h>
 
+#include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include <set>
+
+#include "utils.h"
 
 #if defined(__BIONIC__)
+#include <android/fdsan.h>
 #include <async_safe/log.h>
 #endif // __BIONIC__
 
@@ -245,3 +260,200 @@ TEST(async_safe_format_buffer, percent_m_fits_in_buffer) {
   GTEST_SKIP() << "bionic-only test";
 #endif  // __BIONIC__
 }
+
+#if defined(__BIONIC__)
+static std::set<int> OpenFds() {
+  std::set<int> fds;
+  DIR* d = opendir("/proc/self/fd");
+  int dir_fd = dirfd(d);
+  dirent* e;
+  while ((e = readdir(d)) != nullptr) {
+    int fd = atoi(e->d_name);
+    if (e->d_name[0] != '.' && fd != dir_fd) fds.insert(fd);
+  }
+  closedir(d);
+  return fds;
+}
+
+// Returns an open socket to logd whose fdsan owner has the given type, or -1.
+static int FindLogSocket(android_fdsan_owner_type type) {
+  for (int fd : OpenFds()) {
+    uint64_t tag = android_fdsan_get_owner_tag(fd);
+    if (tag == 0 || android_fdsan_get_tag_type(tag) != type) continue;
+    sockaddr_un addr = {};
+    socklen_t addr_len = sizeof(addr);
+    if (getpeername(fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0 &&
+        addr.sun_family == AF_UNIX && strcmp(addr.sun_path, "/dev/socket/logdw") == 0) {
+      return fd;
+    }
+  }
+  return -1;
+}
+
+// Logs a message, and returns the fd of the logd socket it opened (or -1 if it didn't open one).
+static int LogAndFindNewSocket() {
+  std::set<int> before = OpenFds();
+  async_safe_format_log(ANDROID_LOG_INFO, "async_safe_test", "finding the log socket");
+  std::set<int> after = OpenFds();
+  for (int fd : after) {
+    if (before.count(fd) == 0) return fd;
+  }
+  return -1;
+}
+#endif  // __BIONIC__
+
+TEST(async_safe_log, socket_per_message_by_default) {
+#if defined(__BIONIC__)
+  if (access("/dev/socket/logdw", W_OK) != 0) GTEST_SKIP() << "no logd socket";
+  async_safe_log_keep_socket(false);
+
+  // Each message opens and closes its own socket, leaving nothing behind.
+  std::set<int> fds = OpenFds();
+  ASSERT_GT(async_safe_write_log(ANDROID_LOG_INFO, "async_safe_test", "one socket per message"), 0);
+  ASSERT_EQ(fds, OpenFds());
+#else   // __BIONIC__
+  GTEST_SKIP() << "bionic-only test";
+#endif  // __BIONIC__
+}
+
+TEST(async_safe_log, socket_closed_in_forked_child) {
+#if defined(__BIONIC__)
+  if (access("/dev/socket/logdw", W_OK) != 0) GTEST_SKIP() << "no logd socket";
+  // syslog() logs through libc's own copy, which keeps its socket.
+  syslog(LOG_INFO, "async_safe_test: opening libc's log socket");
+  int fd = FindLogSocket(ANDROID_FDSAN_OWNER_TYPE_GENERIC_00);
+  ASSERT_NE(-1, fd);
+
+  // A forked child (a zygote's, say) doesn't inherit it.
+  pid_t pid = fork();
+  ASSERT_NE(-1, pid);
+  if (pid == 0) _exit(FindLogSocket(ANDROID_FDSAN_OWNER_TYPE_GENERIC_00) == -1 ? 0 : 1);
+  AssertChildExited(pid, 0);
+  ASSERT_EQ(fd, FindLogSocket(ANDROID_FDSAN_OWNER_TYPE_GENERIC_00));
+#else   // __BIONIC__
+  GTEST_SKIP() << "bionic-only test";
+#endif  // __BIONIC__
+}
+
+TEST(async_safe_log, socket_reused_and_closed) {
+#if defined(__BIONIC__)
+  if (access("/dev/socket/logdw", W_OK) != 0) GTEST_SKIP() << "no logd socket";
+  // This is the test's own copy of libasync_safe, which doesn't keep its socket unless asked to.
+  async_safe_log_keep_socket(true);
+  async_safe_log_close();
+
+  int fd = LogAndFindNewSocket();
+  ASSERT_NE(-1, fd);
+  // The socket is owned with fdsan, and later messages use it rather than opening another.
+  ASSERT_NE(0U, android_fdsan_get_owner_tag(fd));
+  std::set<int> fds = OpenFds();
+  async_safe_format_log(ANDROID_LOG_INFO, "async_safe_test", "reusing the log socket");
+  ASSERT_EQ(fds, OpenFds());
+
+  async_safe_log_close();
+  ASSERT_EQ(-1, fcntl(fd, F_GETFD));
+  ASSERT_EQ(EBADF, errno);
+  async_safe_log_keep_socket(false);
+#else   // __BIONIC__
+  GTEST_SKIP() << "bionic-only test";
+#endif  // __BIONIC__
+}
+
+TEST(async_safe_log, socket_fd_reused_by_someone_else) {
+#if defined(__BIONIC__)
+  if (access("/dev/socket/logdw", W_OK) != 0) GTEST_SKIP() << "no logd socket";
+  // This is the test's own copy of libasync_safe, which doesn't keep its socket unless asked to.
+  async_safe_log_keep_socket(true);
+  async_safe_log_close();
+
+  int fd = LogAndFindNewSocket();
+  ASSERT_NE(-1, fd);
+
+  // Close the socket behind async_safe's back (as code that closes every fd would, having taken
+  // over ownership), and reuse its fd for something else.
+  android_fdsan_exchange_owner_tag(fd, android_fdsan_get_owner_tag(fd), 0);
+  ASSERT_EQ(0, close(fd));
+  int null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+  ASSERT_EQ(fd, null_fd);
+
+  // The next message notices that the fd isn't its socket any more, and opens a new one rather
+  // than writing to, or closing, /dev/null.
+  int new_fd = LogAndFindNewSocket();
+  ASSERT_NE(-1, new_fd);
+  ASSERT_NE(-1, fcntl(null_fd, F_GETFD));
+  ASSERT_EQ(0U, android_fdsan_get_owner_tag(null_fd));
+
+  async_safe_log_close();
+  ASSERT_NE(-1, fcntl(null_fd, F_GETFD));
+  ASSERT_EQ(-1, fcntl(new_fd, F_GETFD));
+  close(null_fd);
+  async_safe_log_keep_socket(false);
+#else   // __BIONIC__
+  GTEST_SKIP() << "bionic-only test";
+#endif  // __BIONIC__
+}
+
+TEST(async_safe_log, reconnects_after_ECONNREFUSED) {
+#if defined(__BIONIC__)
+  if (access("/dev/socket/logdw", W_OK) != 0) GTEST_SKIP() << "no logd socket";
+  // This is the test's own copy of libasync_safe, which doesn't keep its socket unless asked to.
+  async_safe_log_keep_socket(true);
+  async_safe_log_close();
+
+  int fd = LogAndFindNewSocket();
+  ASSERT_NE(-1, fd);
+
+  // Swap in a socket whose peer has gone away, as if logd had restarted.
+  sockaddr_un addr = {.sun_family = AF_UNIX};
+  snprintf(addr.sun_path + 1, sizeof(addr.sun_path) - 1, "async_safe_test_%d", getpid());
+  socklen_t addr_len = offsetof(sockaddr_un, sun_path) + 1 + strlen(addr.sun_path + 1);
+  int server = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  ASSERT_EQ(0, bind(server, reinterpret_cast<sockaddr*>(&addr), addr_len));
+  int client = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  ASSERT_EQ(0, connect(client, reinterpret_cast<sockaddr*>(&addr), addr_len));
+  close(server);
+  ASSERT_EQ(fd, dup3(client, fd, O_CLOEXEC));
+  close(client);
+
+  // The send fails with ECONNREFUSED, and the message is sent again on a new socket.
+  ASSERT_GT(async_safe_write_log(ANDROID_LOG_INFO, "async_safe_test", "reconnected"), 0);
+  async_safe_log_keep_socket(false);
+#else   // __BIONIC__
+  GTEST_SKIP() << "bionic-only test";
+#endif  // __BIONIC__
+}
+
+TEST(async_safe_log, batch) {
+#if defined(__BIONIC__)
+  async_safe_log_batch batch;
+  async_safe_log_batch_init(&batch, ANDROID_LOG_INFO, "async_safe_test");
+  ASSERT_EQ(0, async_safe_log_batch_flush(&batch));
+
+  ASSERT_EQ(6, async_safe_log_batch_format(&batch, "line %d", 1));
+  ASSERT_EQ(6, async_safe_log_batch_write(&batch, "line 2"));
+  ASSERT_EQ(2U, batch.count);
+  ASSERT_STREQ("line 1", batch.buffer + batch.entries[0].offset);
+  ASSERT_EQ(6U, batch.entries[0].length);
+  ASSERT_STREQ("line 2", batch.buffer + batch.entries[1].offset);
+
+  // Filling the batch flushes it, so there's always room for the next message.
+  for (size_t i = 0; i < ASYNC_SAFE_LOG_BATCH_ENTRIES; ++i) {
+    async_safe_log_batch_format(&batch, "filler %zu", i);
+  }
+  ASSERT_EQ(2U, batch.count);
+  ASSERT_STREQ("filler 31", batch.buffer + batch.entries[1].offset);
+
+  // Messages longer than the buffer are truncated rather than dropped.
+  char long_message[ASYNC_SAFE_LOG_BATCH_BUFFER_SIZE + 100];
+  memset(long_message, 'x', sizeof(long_message) - 1);
+  long_message[sizeof(long_message) - 1] = '\0';
+  async_safe_log_batch_format(&batch, "%s", long_message);
+  ASSERT_EQ(1U, batch.count);
+  ASSERT_EQ(ASYNC_SAFE_LOG_BATCH_BUFFER_SIZE - 1U, batch.entries[0].length);
+
+  ASSERT_GE(async_safe_log_batch_flush(&batch), 0);
+  ASSERT_EQ(0U, batch.count);
+#else   // __BIONIC__
+  GTEST_SKIP() << "bionic-only test";
+#endif  // __BIONIC__
+}
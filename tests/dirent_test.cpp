@@ -20,6 +20,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <string.h>
 #include <sys/cdefs.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -28,6 +29,14 @@
 #include <algorithm>
 #include <set>
 #include <string>
+#include <vector>
+
+#include <android-base/file.h>
+#include <android-base/stringprintf.h>
+
+#if defined(__BIONIC__)
+#include "platform/bionic/dirent_batch.h"
+#endif
 
 static void CheckProcSelf(std::set<std::string>& names) {
   // We have a good idea of what should be in /proc/self.
@@ -258,6 +267,135 @@ TEST(dirent, readdir64_smoke) {
   CheckProcSelf(name_set);
 }
 
+TEST(dirent, android_readdir_batch) {
+#if defined(__BIONIC__)
+  DIR* d = opendir("/proc/self");
+  ASSERT_TRUE(d != nullptr);
+  std::set<std::string> name_set;
+  dirent* entries;
+  ssize_t size;
+  while ((size = android_readdir_batch(d, &entries)) > 0) {
+    char* end = reinterpret_cast<char*>(entries) + size;
+    for (char* p = reinterpret_cast<char*>(entries); p < end;) {
+      dirent* e = reinterpret_cast<dirent*>(p);
+      name_set.insert(e->d_name);
+      p += e->d_reclen;
+    }
+  }
+  ASSERT_EQ(0, size);
+  ASSERT_EQ(nullptr, readdir(d));
+
+  // A batch picks up where readdir left off, without repeating or skipping anything.
+  rewinddir(d);
+  dirent* first = readdir(d);
+  ASSERT_TRUE(first != nullptr);
+  std::set<std::string> resumed_name_set = {first->d_name};
+  while ((size = android_readdir_batch(d, &entries)) > 0) {
+    char* end = reinterpret_cast<char*>(entries) + size;
+    for (char* p = reinterpret_cast<char*>(entries); p < end;) {
+      dirent* e = reinterpret_cast<dirent*>(p);
+      ASSERT_TRUE(resumed_name_set.insert(e->d_name).second) << e->d_name;
+      p += e->d_reclen;
+    }
+  }
+  ASSERT_EQ(0, size);
+  ASSERT_EQ(name_set, resumed_name_set);
+  ASSERT_EQ(closedir(d), 0);
+
+  CheckProcSelf(name_set);
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
+TEST(dirent, android_readdir_batch_large_directory) {
+#if defined(__BIONIC__)
+  // Enough entries that the buffer has to grow.
+  TemporaryDir td;
+  for (size_t i = 0; i < 2000; ++i) {
+    std::string path = android::base::StringPrintf("%s/file-with-a-longish-name-%zu", td.path, i);
+    int fd = open(path.c_str(), O_CREAT | O_WRONLY | O_CLOEXEC, 0600);
+    ASSERT_NE(-1, fd);
+    close(fd);
+  }
+
+  DIR* d = opendir(td.path);
+  ASSERT_TRUE(d != nullptr);
+  size_t count = 0;
+  dirent* entries;
+  ssize_t size;
+  while ((size = android_readdir_batch(d, &entries)) > 0) {
+    char* end = reinterpret_cast<char*>(entries) + size;
+    for (char* p = reinterpret_cast<char*>(entries); p < end;) {
+      ++count;
+      p += reinterpret_cast<dirent*>(p)->d_reclen;
+    }
+  }
+  ASSERT_EQ(0, size);
+  ASSERT_EQ(closedir(d), 0);
+  ASSERT_EQ(2002U, count);
+
+  for (size_t i = 0; i < 2000; ++i) {
+    std::string path = android::base::StringPrintf("%s/file-with-a-longish-name-%zu", td.path, i);
+    ASSERT_EQ(0, unlink(path.c_str()));
+  }
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
+TEST(dirent, android_scandirat) {
+#if defined(__BIONIC__)
+  dirent** entries;
+  int entry_count = scandir("/proc/self", &entries, nullptr, alphasort);
+  ASSERT_GE(entry_count, 0);
+
+  // The result is one allocation: only the array is freed.
+  dirent** entries_android;
+  int entry_count_android =
+      android_scandirat(AT_FDCWD, "/proc/self", &entries_android, nullptr, alphasort);
+  ASSERT_EQ(entry_count, entry_count_android);
+  std::vector<std::string> name_list_android;
+  for (int i = 0; i < entry_count_android; ++i) {
+    name_list_android.push_back(entries_android[i]->d_name);
+  }
+  free(entries_android);
+
+  std::set<std::string> name_set;
+  std::vector<std::string> name_list;
+  ScanEntries(entries, entry_count, name_set, name_list);
+  ASSERT_EQ(name_list, name_list_android);
+
+  // Without a comparator, the same names in directory order.
+  entry_count_android =
+      android_scandirat(AT_FDCWD, "/proc/self", &entries_android, nullptr, nullptr);
+  ASSERT_EQ(entry_count, entry_count_android);
+  std::set<std::string> name_set_unsorted;
+  for (int i = 0; i < entry_count_android; ++i) {
+    name_set_unsorted.insert(entries_android[i]->d_name);
+  }
+  free(entries_android);
+  ASSERT_EQ(name_set, name_set_unsorted);
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
+TEST(dirent, android_scandirat_filter_ENOENT) {
+#if defined(__BIONIC__)
+  dirent** entries;
+  ASSERT_EQ(1, android_scandirat(AT_FDCWD, "/proc", &entries, is_version_filter, nullptr));
+  ASSERT_STREQ("version", entries[0]->d_name);
+  free(entries);
+
+  errno = 0;
+  ASSERT_EQ(-1, android_scandirat(AT_FDCWD, "/does-not-exist", &entries, nullptr, nullptr));
+  ASSERT_EQ(ENOENT, errno);
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
 TEST(dirent, readdir_r) {
   DIR* d = opendir("/proc/self");
   ASSERT_TRUE(d != nullptr);
@@ -369,3 +507,43 @@ TEST(dirent, seekdir_telldir) {
 
   ASSERT_EQ(0, closedir(d));
 }
+
+TEST(dirent, readdir_large_directory) {
+  // Enough entries that readdir has to refill (and grow) its buffer several times.
+  TemporaryDir td;
+  std::set<std::string> expected;
+  for (size_t i = 0; i < 4000; ++i) {
+    std::string name = android::base::StringPrintf("file-with-a-longish-name-%zu", i);
+    std::string path = std::string(td.path) + "/" + name;
+    int fd = open(path.c_str(), O_CREAT | O_WRONLY | O_CLOEXEC, 0600);
+    ASSERT_NE(-1, fd) << strerror(errno);
+    close(fd);
+    expected.insert(name);
+  }
+  expected.insert(".");
+  expected.insert("..");
+
+  DIR* d = opendir(td.path);
+  ASSERT_TRUE(d != nullptr);
+  std::set<std::string> seen;
+  std::vector<long> offsets;
+  dirent* e;
+  while ((e = readdir(d)) != nullptr) {
+    ASSERT_TRUE(seen.insert(e->d_name).second) << "duplicate " << e->d_name;
+    offsets.push_back(telldir(d));
+  }
+  ASSERT_EQ(expected, seen);
+
+  // Seeking back into the middle still works after the buffer has grown.
+  size_t middle = offsets.size() / 2;
+  seekdir(d, offsets[middle - 1]);
+  size_t remaining = 0;
+  while ((e = readdir(d)) != nullptr) ++remaining;
+  ASSERT_EQ(offsets.size() - middle, remaining);
+
+  ASSERT_EQ(0, closedir(d));
+
+  for (const std::string& name : expected) {
+    if (name != "." && name != "..") unlink((std::string(td.path) + "/" + name).c_str());
+  }
+}
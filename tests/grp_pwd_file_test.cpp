@@ -244,3 +244,30 @@ TEST(grp_pwd_file, group_file_required_prefix) {
   GTEST_SKIP() << "bionic-only test";
 #endif  // __BIONIC__
 }
+
+TEST(grp_pwd_file, passwd_file_reloads_changed_file) {
+#if defined(__BIONIC__)
+  TemporaryFile file;
+  ASSERT_NE(-1, file.fd);
+  static const char test_string[] = "name:password:1:2:user_info:dir:shell\n";
+  ASSERT_TRUE(android::base::WriteStringToFd(test_string, file.fd));
+
+  PasswdFile passwd_file(file.path, nullptr);
+  FileUnmapper unmapper(passwd_file);
+
+  FindAndCheckPasswdEntry(&passwd_file, "name", 1, 2, "dir", "shell");
+
+  static const char new_test_string[] = "new_name:password:3:4:user_info:new_dir:new_shell\n";
+  ASSERT_TRUE(android::base::WriteStringToFile(new_test_string, file.path));
+
+  // Changes are noticed within a second or two, not immediately.
+  sleep(2);
+
+  FindAndCheckPasswdEntry(&passwd_file, "new_name", 3, 4, "new_dir", "new_shell");
+  EXPECT_FALSE(passwd_file.FindByName("name", nullptr));
+  EXPECT_FALSE(passwd_file.FindById(1, nullptr));
+
+#else   // __BIONIC__
+  GTEST_SKIP() << "bionic-only test";
+#endif  // __BIONIC__
+}
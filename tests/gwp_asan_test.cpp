@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <sys/file.h>
 #include <string>
+#include <thread>
 
 #if defined(__BIONIC__)
 
@@ -139,6 +140,22 @@ TEST(gwp_asan_integration, DISABLED_assert_gwp_asan_enabled) {
   EXPECT_DEATH({ *x = 7; }, "");
 }
 
+TEST(gwp_asan_integration, DISABLED_assert_gwp_asan_enabled_in_new_thread) {
+  volatile int* x = nullptr;
+  std::thread([&x] {
+    // A thread's first allocation only arms its sampling countdown, so with a
+    // sample rate of 1 it's every allocation after that that's sampled.
+    free(malloc(1));
+    x = new int;
+  }).join();
+  delete x;
+  EXPECT_DEATH({ *x = 7; }, "");
+}
+
+TEST(gwp_asan_integration, new_thread_sampled) {
+  RunGwpAsanTest("gwp_asan_integration.DISABLED_assert_gwp_asan_enabled_in_new_thread");
+}
+
 TEST(gwp_asan_integration, DISABLED_assert_gwp_asan_disabled) {
   std::string maps;
   EXPECT_TRUE(android::base::ReadFileToString("/proc/self/maps", &maps));
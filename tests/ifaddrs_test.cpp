@@ -29,9 +29,14 @@
 
 #include <algorithm>
 #include <map>
+#include <string>
 #include <thread>
 #include <vector>
 
+#if defined(__BIONIC__)
+#include "platform/bionic/getifaddrs_cache.h"
+#endif
+
 TEST(ifaddrs, freeifaddrs_null) {
   freeifaddrs(nullptr);
 }
@@ -306,3 +311,46 @@ TEST(ifaddrs, errno_EMFILE) {
 
   for (int fd : fds) close(fd);
 }
+
+static std::vector<std::string> ifaddrs_summary(ifaddrs* addrs) {
+  std::vector<std::string> result;
+  for (ifaddrs* addr = addrs; addr != nullptr; addr = addr->ifa_next) {
+    int family = addr->ifa_addr ? addr->ifa_addr->sa_family : AF_UNSPEC;
+    result.push_back(std::string(addr->ifa_name) + "/" + std::to_string(family) + "/" +
+                     std::to_string(addr->ifa_flags) + "/" +
+                     std::to_string(addr->ifa_netmask != nullptr));
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+TEST(ifaddrs, getifaddrs_cache) {
+#if defined(__BIONIC__)
+  ifaddrs* uncached;
+  ASSERT_EQ(0, getifaddrs(&uncached)) << strerror(errno);
+
+  if (!android_set_getifaddrs_cache_enabled(true)) {
+    freeifaddrs(uncached);
+    GTEST_SKIP() << "couldn't listen for netlink notifications: " << strerror(errno);
+  }
+
+  // Every call should get its own copy of the same list.
+  ifaddrs* cached1;
+  ASSERT_EQ(0, getifaddrs(&cached1)) << strerror(errno);
+  ifaddrs* cached2;
+  ASSERT_EQ(0, getifaddrs(&cached2)) << strerror(errno);
+  ASSERT_NE(cached1, cached2);
+  EXPECT_EQ(ifaddrs_summary(uncached), ifaddrs_summary(cached1));
+  EXPECT_EQ(ifaddrs_summary(uncached), ifaddrs_summary(cached2));
+
+  // The copies' pointers point into the copies.
+  ASSERT_NE(cached1->ifa_name, cached2->ifa_name);
+  freeifaddrs(cached1);
+  freeifaddrs(cached2);
+
+  ASSERT_TRUE(android_set_getifaddrs_cache_enabled(false));
+  freeifaddrs(uncached);
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
@@ -18,6 +18,7 @@
 
 #if defined(__BIONIC__)
 
+#include <errno.h>
 #include <inttypes.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -28,6 +29,7 @@
 
 #include <android-base/test_utils.h>
 #include <async_safe/log.h>
+#include <platform/bionic/malloc.h>
 #include <procinfo/process_map.h>
 
 #include "utils.h"
@@ -123,6 +125,49 @@ static void VerifyPtrs(TestDataType* test_data) {
   }
 }
 
+// As VerifyPtrs, but with android_malloc_iterate_incremental walking each map
+// a few pages at a time.
+static void VerifyPtrsIncremental(TestDataType* test_data) {
+  test_data->total_allocated_bytes = 0;
+
+  // The walk disables malloc itself, so the maps are collected first, into
+  // memory that doesn't need allocating.
+  struct Map {
+    uint64_t start;
+    uint64_t end;
+  };
+  static Map maps[1024];
+  size_t map_count = 0;
+  auto callback = [&](uint64_t start, uint64_t end, uint16_t, uint64_t, ino_t, const char* name,
+                      bool) {
+    if (strcmp(name, "[anon:libc_malloc]") == 0 || strncmp(name, "[anon:scudo:", 12) == 0 ||
+        strncmp(name, "[anon:GWP-ASan", 14) == 0) {
+      if (map_count < 1024) maps[map_count++] = {start, end};
+    }
+  };
+
+  std::vector<char> buffer(64 * 1024);
+  malloc_disable();
+  bool parsed = android::procinfo::ReadMapFileAsyncSafe("/proc/self/maps", buffer.data(),
+                                                        buffer.size(), callback);
+  malloc_enable();
+  ASSERT_TRUE(parsed) << "Failed to parse /proc/self/maps";
+  ASSERT_LT(map_count, 1024U);
+
+  size_t chunk_size = 4 * getpagesize();
+  for (size_t i = 0; i < map_count; ++i) {
+    ASSERT_EQ(0, android_malloc_iterate_incremental(maps[i].start, maps[i].end - maps[i].start,
+                                                    chunk_size, SavePointers, test_data, true));
+  }
+
+  for (size_t i = 0; i < test_data->allocs.size(); i++) {
+    EXPECT_EQ(1UL, test_data->allocs[i].count) << "Failed on size " << test_data->allocs[i].size;
+    if (test_data->allocs[i].count == 1) {
+      EXPECT_EQ(test_data->allocs[i].size, test_data->allocs[i].size_reported);
+    }
+  }
+}
+
 static void AllocateSizes(TestDataType* test_data, const std::vector<size_t>& sizes) {
   static constexpr size_t kInitialAllocations = 40;
   static constexpr size_t kNumAllocs = 50;
@@ -186,6 +231,35 @@ TEST(malloc_iterate, large_allocs) {
 #endif
 }
 
+// Verify that walking the heap a chunk at a time finds every allocation once,
+// including the ones that straddle a chunk boundary.
+TEST(malloc_iterate, incremental) {
+#if defined(__BIONIC__)
+  SKIP_WITH_HWASAN;
+  TestDataType test_data;
+
+  std::vector<size_t> sizes{8, 64, 512, 4096, 10240, 16384, 65536, 262144};
+  AllocateSizes(&test_data, sizes);
+
+  SCOPED_TRACE("");
+  VerifyPtrsIncremental(&test_data);
+
+  FreePtrs(&test_data);
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
+TEST(malloc_iterate, incremental_zero_chunk_size) {
+#if defined(__BIONIC__)
+  errno = 0;
+  ASSERT_EQ(-1, android_malloc_iterate_incremental(0, 4096, 0, SavePointers, nullptr, false));
+  ASSERT_EQ(EINVAL, errno);
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
 // Verify that there are no crashes attempting to get pointers from
 // non-allocated pointers.
 TEST(malloc_iterate, invalid_pointers) {
@@ -298,3 +298,39 @@ void DoMathDataTest(data_1_3_t<RT, T1, T2, T3> (&data)[N], RT f(T1, T2, T3)) {
                         data[i].expected, f(data[i].input1, data[i].input2, data[i].input3)) << "Failed on element " << i;
   }
 }
+
+// Applies 'f' to all of the input values in the array 'data' in one call,
+// and asserts that each result is within ULP ulps of the expected value.
+// For testing a (const double*, double*, size_t) -> void function like android_exp_array(3).
+template <size_t ULP, typename RT, typename T, size_t N>
+void DoMathArrayDataTest(data_1_1_t<RT, T> (&data)[N], void f(const T*, RT*, size_t)) {
+  fesetenv(FE_DFL_ENV);
+  FpUlpEq<ULP, RT> predicate;
+  T input[N];
+  RT output[N];
+  for (size_t i = 0; i < N; ++i) input[i] = data[i].input;
+  f(input, output, N);
+  for (size_t i = 0; i < N; ++i) {
+    EXPECT_PRED_FORMAT2(predicate, data[i].expected, output[i]) << "Failed on element " << i;
+  }
+}
+
+// Applies 'f' to all of the input values in the array 'data' in one call,
+// and asserts that each pair of results is within ULP ulps of the expected values.
+// For testing a (const double*, double*, double*, size_t) -> void function like android_sincos_array(3).
+template <size_t ULP, typename RT1, typename RT2, typename T1, size_t N>
+void DoMathArrayDataTest(data_2_1_t<RT1, RT2, T1> (&data)[N],
+                         void f(const T1*, RT1*, RT2*, size_t)) {
+  fesetenv(FE_DFL_ENV);
+  FpUlpEq<ULP, RT1> predicate1;
+  FpUlpEq<ULP, RT2> predicate2;
+  T1 input[N];
+  RT1 output1[N];
+  RT2 output2[N];
+  for (size_t i = 0; i < N; ++i) input[i] = data[i].input;
+  f(input, output1, output2, N);
+  for (size_t i = 0; i < N; ++i) {
+    EXPECT_PRED_FORMAT2(predicate1, data[i].expected1, output1[i]) << "Failed on element " << i;
+    EXPECT_PRED_FORMAT2(predicate2, data[i].expected2, output2[i]) << "Failed on element " << i;
+  }
+}
@@ -64,8 +64,14 @@ template<typename T> inline int test_capture_isinf(const T in) {
 #include <stdint.h>
 #include <sys/cdefs.h>
 
+#include <algorithm>
+
 #include <android-base/scopeguard.h>
 
+#if defined(__BIONIC__)
+#include <android/math_array.h>
+#endif
+
 static float float_subnormal() {
   union {
     float f;
@@ -2247,3 +2253,125 @@ TEST(MATH_TEST, trunc_intel) {
 TEST(MATH_TEST, truncf_intel) {
   DoMathDataTest<1>(g_truncf_intel_data, truncf);
 }
+
+// libm's vector function ABI entry points, run over the same data one lane at
+// a time. The other lane gets an ordinary value, so that the lanes that need
+// the scalar fallback are always mixed with ones that don't.
+#if defined(__BIONIC__) && (defined(__aarch64__) || defined(__x86_64__))
+typedef double vdouble __attribute__((__vector_size__(16)));
+typedef float vfloat __attribute__((__vector_size__(16)));
+
+#if defined(__aarch64__)
+#define VECTOR_FN(name, args) _ZGVnN##args##_##name
+#define VECTOR_PCS __attribute__((__aarch64_vector_pcs__))
+#else
+#define VECTOR_FN(name, args) _ZGVbN##args##_##name
+#define VECTOR_PCS
+#endif
+
+#define VECTOR_MATH_TEST(name, ulp)                                                  \
+  extern "C" VECTOR_PCS vdouble VECTOR_FN(name, 2v)(vdouble);                        \
+  static double vector_##name(double x) {                                            \
+    vdouble v = {1.0, x};                                                            \
+    return VECTOR_FN(name, 2v)(v)[1];                                                \
+  }                                                                                  \
+  TEST(MATH_TEST, vector_##name##_intel) {                                           \
+    DoMathDataTest<ulp>(g_##name##_intel_data, vector_##name);                       \
+  }
+
+#define VECTOR_MATH_TEST_F(name, ulp)                                                \
+  extern "C" VECTOR_PCS vfloat VECTOR_FN(name, 4v)(vfloat);                         \
+  static float vector_##name(float x) {                                              \
+    vfloat v = {1.0f, x, 1.0f, 1.0f};                                                \
+    return VECTOR_FN(name, 4v)(v)[1];                                               \
+  }                                                                                  \
+  TEST(MATH_TEST, vector_##name##_intel) {                                           \
+    DoMathDataTest<ulp>(g_##name##_intel_data, vector_##name);                       \
+  }
+
+VECTOR_MATH_TEST(cos, 4)
+VECTOR_MATH_TEST(exp, 4)
+VECTOR_MATH_TEST(log, 4)
+VECTOR_MATH_TEST(sin, 4)
+VECTOR_MATH_TEST_F(cosf, 2)
+VECTOR_MATH_TEST_F(expf, 2)
+VECTOR_MATH_TEST_F(logf, 2)
+VECTOR_MATH_TEST_F(sinf, 2)
+
+extern "C" VECTOR_PCS vdouble VECTOR_FN(pow, 2vv)(vdouble, vdouble);
+static double vector_pow(double x, double y) {
+  vdouble vx = {2.0, x};
+  vdouble vy = {0.5, y};
+  return VECTOR_FN(pow, 2vv)(vx, vy)[1];
+}
+TEST(MATH_TEST, vector_pow_intel) {
+  DoMathDataTest<1>(g_pow_intel_data, vector_pow);
+}
+
+extern "C" VECTOR_PCS vfloat VECTOR_FN(powf, 4vv)(vfloat, vfloat);
+static float vector_powf(float x, float y) {
+  vfloat vx = {2.0f, x, 2.0f, 2.0f};
+  vfloat vy = {0.5f, y, 0.5f, 0.5f};
+  return VECTOR_FN(powf, 4vv)(vx, vy)[1];
+}
+TEST(MATH_TEST, vector_powf_intel) {
+  DoMathDataTest<1>(g_powf_intel_data, vector_powf);
+}
+
+// The array functions, run over each data set in one call.
+TEST(MATH_TEST, exp_array_intel) {
+  DoMathArrayDataTest<4>(g_exp_intel_data, android_exp_array);
+}
+
+TEST(MATH_TEST, expf_array_intel) {
+  DoMathArrayDataTest<2>(g_expf_intel_data, android_expf_array);
+}
+
+TEST(MATH_TEST, log_array_intel) {
+  DoMathArrayDataTest<4>(g_log_intel_data, android_log_array);
+}
+
+TEST(MATH_TEST, logf_array_intel) {
+  DoMathArrayDataTest<2>(g_logf_intel_data, android_logf_array);
+}
+
+TEST(MATH_TEST, sincos_array_intel) {
+  DoMathArrayDataTest<4>(g_sincos_intel_data, android_sincos_array);
+}
+
+TEST(MATH_TEST, sincosf_array_intel) {
+  DoMathArrayDataTest<2>(g_sincosf_intel_data, android_sincosf_array);
+}
+
+TEST(MATH_TEST, sincosf_array_lengths) {
+  // Every length up to a few vectors, so that every length of the partial
+  // vector at the end is covered. Nothing past the end may be written.
+  float x[20];
+  for (size_t i = 0; i < 20; ++i) x[i] = 0.75f * i - 7.0f;
+  FpUlpEq<2, float> predicate;
+  for (size_t n = 0; n < 20; ++n) {
+    float s[20], c[20];
+    std::fill(s, s + 20, 42.0f);
+    std::fill(c, c + 20, 42.0f);
+    android_sincosf_array(x, s, c, n);
+    for (size_t i = 0; i < n; ++i) {
+      EXPECT_PRED_FORMAT2(predicate, sinf(x[i]), s[i]) << "n=" << n << " i=" << i;
+      EXPECT_PRED_FORMAT2(predicate, cosf(x[i]), c[i]) << "n=" << n << " i=" << i;
+    }
+    EXPECT_EQ(42.0f, s[n]) << "n=" << n;
+    EXPECT_EQ(42.0f, c[n]) << "n=" << n;
+  }
+}
+
+TEST(MATH_TEST, exp_array_in_place) {
+  double x[7] = {0.0, 1.0, -1.0, 0.5, 710.0, -HUGE_VAL, 2.0};
+  android_exp_array(x, x, 7);
+  EXPECT_EQ(1.0, x[0]);
+  EXPECT_DOUBLE_EQ(M_E, x[1]);
+  EXPECT_DOUBLE_EQ(1.0 / M_E, x[2]);
+  EXPECT_DOUBLE_EQ(sqrt(M_E), x[3]);
+  EXPECT_EQ(HUGE_VAL, x[4]);
+  EXPECT_EQ(0.0, x[5]);
+  EXPECT_DOUBLE_EQ(M_E * M_E, x[6]);
+}
+#endif
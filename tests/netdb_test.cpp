@@ -19,11 +19,33 @@
 #include <gtest/gtest.h>
 
 #include <arpa/inet.h>
+#include <errno.h>
 #include <netinet/in.h>
+#include <sched.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/cdefs.h>
+#include <sys/mount.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <android-base/file.h>
+
+#include "dns_server.h"
+#include "utils.h"
+
+#if defined(__BIONIC__)
+#include "dns/include/resolv_netid.h"
+#elif !defined(ANDROID_HOST_MUSL)
+#include <resolv.h>
+#endif
 
 // https://code.google.com/p/android/issues/detail?id=13228
 TEST(netdb, freeaddrinfo_NULL) {
@@ -188,6 +210,107 @@ TEST(netdb, gethostbyname) {
   VerifyLocalhost(hp);
 }
 
+TEST(netdb, gethostbyname_case_insensitive_repeated) {
+  // The hosts file is indexed once and then served from the index.
+  for (size_t i = 0; i < 16; ++i) {
+    VerifyLocalhost(gethostbyname((i % 2) ? "LocalHost" : "localhost"));
+  }
+}
+
+#if defined(__BIONIC__)
+static constexpr int kHostsSandboxUnavailable = 42;
+
+// Runs |fn| in a child with its own writable /system/etc, so it can change the
+// hosts file that libc reads without touching the real one. The child inherits
+// this process' hosts cache, which has to notice that the file is different.
+static void RunWithPrivateHostsFile(void (*fn)()) {
+  if (getuid() != 0) GTEST_SKIP() << "mounting over /system/etc requires root";
+  TemporaryDir dir;
+  pid_t pid = fork();
+  ASSERT_NE(-1, pid) << strerror(errno);
+  if (pid == 0) {
+    if (unshare(CLONE_NEWNS) == -1 ||
+        mount(nullptr, "/", nullptr, MS_REC | MS_PRIVATE, nullptr) == -1 ||
+        mount(dir.path, "/system/etc", nullptr, MS_BIND, nullptr) == -1) {
+      _exit(kHostsSandboxUnavailable);
+    }
+    // Look the names up here rather than in netd, which has its own hosts file.
+    setenv("ANDROID_DNS_MODE", "local", 1);
+    fn();
+    _exit(testing::Test::HasFailure());
+  }
+
+  int status;
+  ASSERT_EQ(pid, TEMP_FAILURE_RETRY(waitpid(pid, &status, 0)));
+  if (WIFEXITED(status) && WEXITSTATUS(status) == kHostsSandboxUnavailable) {
+    GTEST_SKIP() << "couldn't mount a private /system/etc";
+  }
+  ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0) << "child failed: " << status;
+}
+
+// Replaces the hosts file by rename(2), as the hosts cache expects.
+static void ReplaceHostsFile(const std::string& contents) {
+  ASSERT_TRUE(android::base::WriteStringToFile(contents, "/system/etc/hosts.new"));
+  ASSERT_EQ(0, rename("/system/etc/hosts.new", _PATH_HOSTS)) << strerror(errno);
+}
+
+static void AssertHostsEntry(const char* name, const char* address) {
+  in_addr expected;
+  ASSERT_EQ(1, inet_pton(AF_INET, address, &expected));
+
+  hostent* hp = gethostbyname(name);
+  ASSERT_TRUE(hp != nullptr) << name;
+  ASSERT_EQ(AF_INET, hp->h_addrtype);
+  ASSERT_EQ(0, memcmp(&expected, hp->h_addr, sizeof(expected))) << name;
+
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  addrinfo* ai = nullptr;
+  ASSERT_EQ(0, getaddrinfo(name, nullptr, &hints, &ai)) << name;
+  in_addr actual = reinterpret_cast<sockaddr_in*>(ai->ai_addr)->sin_addr;
+  freeaddrinfo(ai);
+  ASSERT_EQ(0, memcmp(&expected, &actual, sizeof(expected))) << name;
+
+  hp = gethostbyaddr(&expected, sizeof(expected), AF_INET);
+  ASSERT_TRUE(hp != nullptr) << address;
+  ASSERT_STREQ(name, hp->h_name);
+}
+#endif
+
+TEST(netdb, hosts_file_replaced) {
+#if defined(__BIONIC__)
+  RunWithPrivateHostsFile([]() {
+    ReplaceHostsFile("127.0.0.1 localhost\n192.0.2.1 cached.test\n");
+    AssertHostsEntry("cached.test", "192.0.2.1");
+
+    // A new file means a new index, with the changed entry and the added one.
+    ReplaceHostsFile("127.0.0.1 localhost\n192.0.2.2 cached.test\n192.0.2.3 added.test\n");
+    AssertHostsEntry("cached.test", "192.0.2.2");
+    AssertHostsEntry("added.test", "192.0.2.3");
+  });
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
+TEST(netdb, hosts_file_rewritten_in_place) {
+#if defined(__BIONIC__)
+  RunWithPrivateHostsFile([]() {
+    ReplaceHostsFile("127.0.0.1 localhost\n192.0.2.1 cached.test\n");
+    AssertHostsEntry("cached.test", "192.0.2.1");
+
+    // Same inode, but a different size and mtime.
+    ASSERT_TRUE(android::base::WriteStringToFile(
+        "127.0.0.1 localhost\n192.0.2.22 cached.test\n192.0.2.33 added.test\n", _PATH_HOSTS));
+    AssertHostsEntry("cached.test", "192.0.2.22");
+    AssertHostsEntry("added.test", "192.0.2.33");
+  });
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
 TEST(netdb, gethostbyname2) {
   hostent* hp = gethostbyname2("localhost", AF_INET);
   VerifyLocalhost(hp);
@@ -395,6 +518,55 @@ TEST(netdb, getservbyport) {
   ASSERT_STREQ("udp", s->s_proto);
 }
 
+TEST(netdb, getservbyname_getservbyport_every_service) {
+#if defined(__BIONIC__)
+  // The hashed lookups must agree with a linear scan of getservent for every entry.
+  std::vector<std::tuple<std::string, int, std::string>> services;
+  setservent(0);
+  for (servent* s = getservent(); s != nullptr; s = getservent()) {
+    services.emplace_back(s->s_name, s->s_port, s->s_proto);
+  }
+  endservent();
+  ASSERT_FALSE(services.empty());
+
+  for (const auto& [name, port, proto] : services) {
+    for (const char* p : {static_cast<const char*>(nullptr), "tcp", "udp"}) {
+      auto first = std::find_if(services.begin(), services.end(), [&](const auto& e) {
+        return std::get<0>(e) == name && (p == nullptr || std::get<2>(e) == p);
+      });
+      servent* s = getservbyname(name.c_str(), p);
+      if (first == services.end()) {
+        ASSERT_EQ(nullptr, s) << name << "/" << (p ? p : "any");
+      } else {
+        ASSERT_NE(nullptr, s) << name;
+        ASSERT_STREQ(name.c_str(), s->s_name);
+        ASSERT_EQ(std::get<1>(*first), s->s_port);
+        ASSERT_STREQ(std::get<2>(*first).c_str(), s->s_proto);
+      }
+
+      first = std::find_if(services.begin(), services.end(), [&](const auto& e) {
+        return std::get<1>(e) == port && (p == nullptr || std::get<2>(e) == p);
+      });
+      s = getservbyport(port, p);
+      if (first == services.end()) {
+        ASSERT_EQ(nullptr, s) << ntohs(port) << "/" << (p ? p : "any");
+      } else {
+        ASSERT_NE(nullptr, s) << ntohs(port);
+        ASSERT_STREQ(std::get<0>(*first).c_str(), s->s_name);
+        ASSERT_EQ(port, s->s_port);
+        ASSERT_STREQ(std::get<2>(*first).c_str(), s->s_proto);
+      }
+    }
+  }
+
+  ASSERT_EQ(nullptr, getservbyname("smtp", "sctp"));
+  ASSERT_EQ(nullptr, getservbyport(htons(25), "sctp"));
+  ASSERT_EQ(nullptr, getservbyname("no-such-service", nullptr));
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
 TEST(netdb, endnetent_getnetent_setnetent) {
   setnetent(0);
   setnetent(1);
@@ -492,3 +664,230 @@ TEST(netdb, sethostent_resets) {
   sethostent(0);
   ASSERT_EQ(first_host, std::string(gethostent()->h_name));
 }
+
+#if !defined(ANDROID_HOST_MUSL)
+// Points the resolver at a FakeDnsServer for as long as it's in scope. On
+// bionic the per-netid resolver only queries port 53, so this needs root; on
+// glibc, the calling thread's _res is pointed at an ephemeral port instead.
+class FakeDnsResolver {
+ public:
+  explicit FakeDnsResolver(FakeDnsServer::Options options) : server_(PrepareOptions(options)) {}
+
+  ~FakeDnsResolver() {
+    if (!configured_) return;
+#if defined(__BIONIC__)
+    _resolv_delete_cache_for_net(kNetId);
+    if (had_dns_mode_) {
+      setenv("ANDROID_DNS_MODE", old_dns_mode_.c_str(), 1);
+    } else {
+      unsetenv("ANDROID_DNS_MODE");
+    }
+#else
+    res_init();
+#endif
+  }
+
+  // Returns false (with errno set) if the server couldn't be started.
+  bool StartServer() { return server_.Start(); }
+
+  // Points the resolver at the running server.
+  bool Configure() {
+#if defined(__BIONIC__)
+    const char* old_mode = getenv("ANDROID_DNS_MODE");
+    had_dns_mode_ = (old_mode != nullptr);
+    if (had_dns_mode_) old_dns_mode_ = old_mode;
+    // Keep getaddrinfo from going to netd.
+    setenv("ANDROID_DNS_MODE", "local", 1);
+    const char* servers[] = {"127.0.0.1"};
+    __res_params params = {};
+    params.sample_validity = 1800;
+    params.base_timeout_msec = 1000;
+    configured_ = true;
+    return _resolv_set_nameservers_for_net(kNetId, servers, 1, "", &params) == 0;
+#else
+    res_init();
+    _res.nsaddr_list[0] = server_.addr();
+    _res.nscount = 1;
+    configured_ = true;
+    return true;
+#endif
+  }
+
+  int getaddrinfo(const char* name, const addrinfo* hints, addrinfo** result) {
+#if defined(__BIONIC__)
+    return android_getaddrinfofornet(name, nullptr, hints, kNetId, 0, result);
+#else
+    return ::getaddrinfo(name, nullptr, hints, result);
+#endif
+  }
+
+#if defined(__BIONIC__)
+  int getaddrinfo_batch(android_getaddrinfo_request* reqs, size_t count, int timeout_ms) {
+    return android_getaddrinfo_batchfornet(reqs, count, kNetId, 0, timeout_ms);
+  }
+#endif
+
+  const FakeDnsServer& server() const { return server_; }
+
+ private:
+  static FakeDnsServer::Options PrepareOptions(FakeDnsServer::Options options) {
+#if defined(__BIONIC__)
+    options.port = 53;
+#endif
+    return options;
+  }
+
+#if defined(__BIONIC__)
+  static constexpr unsigned kNetId = 4243;
+  bool had_dns_mode_ = false;
+  std::string old_dns_mode_;
+#endif
+  FakeDnsServer server_;
+  bool configured_ = false;
+};
+
+static void CheckFakeDnsLookup(FakeDnsServer::Options options, size_t* udp_queries,
+                               size_t* tcp_queries) {
+  FakeDnsResolver resolver(options);
+  if (!resolver.StartServer()) {
+    GTEST_SKIP() << "couldn't start fake DNS server on port " << resolver.server().port() << ": "
+                 << strerror(errno);
+  }
+  ASSERT_TRUE(resolver.Configure());
+
+  addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* ai = nullptr;
+  ASSERT_EQ(0, resolver.getaddrinfo("fake-dns-server.test", &hints, &ai));
+  ASSERT_TRUE(ai != nullptr);
+  ASSERT_EQ(AF_INET, ai->ai_family);
+  char buf[INET_ADDRSTRLEN];
+  ASSERT_STREQ("192.0.2.1", inet_ntop(AF_INET,
+                                      &reinterpret_cast<sockaddr_in*>(ai->ai_addr)->sin_addr,
+                                      buf, sizeof(buf)));
+  freeaddrinfo(ai);
+
+  ai = nullptr;
+  ASSERT_NE(0, resolver.getaddrinfo("nxdomain.invalid", &hints, &ai));
+  ASSERT_TRUE(ai == nullptr);
+
+  *udp_queries = resolver.server().udp_queries();
+  *tcp_queries = resolver.server().tcp_queries();
+}
+#endif
+
+TEST(netdb, getaddrinfo_fake_dns_server) {
+#if !defined(ANDROID_HOST_MUSL)
+  size_t udp_queries = 0;
+  size_t tcp_queries = 0;
+  ASSERT_NO_FATAL_FAILURE(CheckFakeDnsLookup({}, &udp_queries, &tcp_queries));
+  if (IsSkipped()) return;
+  ASSERT_GE(udp_queries, 2U);
+  ASSERT_EQ(0U, tcp_queries);
+#else
+  GTEST_SKIP() << "musl's resolver can't be pointed at a test server";
+#endif
+}
+
+TEST(netdb, getaddrinfo_fake_dns_server_tcp_fallback) {
+#if !defined(ANDROID_HOST_MUSL)
+  // Every UDP reply is truncated, so both lookups have to be retried over TCP.
+  FakeDnsServer::Options options;
+  options.truncate = true;
+  size_t udp_queries = 0;
+  size_t tcp_queries = 0;
+  ASSERT_NO_FATAL_FAILURE(CheckFakeDnsLookup(options, &udp_queries, &tcp_queries));
+  if (IsSkipped()) return;
+  ASSERT_GE(udp_queries, 2U);
+  ASSERT_GE(tcp_queries, 2U);
+#else
+  GTEST_SKIP() << "musl's resolver can't be pointed at a test server";
+#endif
+}
+
+#if defined(__BIONIC__)
+static std::vector<std::string> Addresses(const addrinfo* ai) {
+  std::vector<std::string> result;
+  for (; ai != nullptr; ai = ai->ai_next) {
+    char buf[INET6_ADDRSTRLEN];
+    const void* addr = (ai->ai_family == AF_INET)
+                           ? static_cast<const void*>(
+                                 &reinterpret_cast<sockaddr_in*>(ai->ai_addr)->sin_addr)
+                           : static_cast<const void*>(
+                                 &reinterpret_cast<sockaddr_in6*>(ai->ai_addr)->sin6_addr);
+    result.push_back(inet_ntop(ai->ai_family, addr, buf, sizeof(buf)));
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+#endif
+
+TEST(netdb, getaddrinfo_batch_fake_dns_server) {
+#if defined(__BIONIC__)
+  FakeDnsResolver resolver({});
+  if (!resolver.StartServer()) {
+    GTEST_SKIP() << "couldn't start fake DNS server on port 53: " << strerror(errno);
+  }
+  ASSERT_TRUE(resolver.Configure());
+
+  addrinfo unspec = {};
+  unspec.ai_socktype = SOCK_STREAM;
+  addrinfo inet6 = unspec;
+  inet6.ai_family = AF_INET6;
+  android_getaddrinfo_request reqs[] = {
+      {"both.test", nullptr, &unspec, nullptr, 0},
+      {"v6.test", nullptr, &inet6, nullptr, 0},
+      {"nxdomain.invalid", nullptr, &unspec, nullptr, 0},
+  };
+  ASSERT_EQ(2, resolver.getaddrinfo_batch(reqs, 3, 5000));
+
+  ASSERT_EQ(0, reqs[0].error);
+  ASSERT_EQ((std::vector<std::string>{"192.0.2.1", "2001:db8::1"}), Addresses(reqs[0].res));
+  ASSERT_EQ(0, reqs[1].error);
+  ASSERT_EQ(std::vector<std::string>{"2001:db8::1"}, Addresses(reqs[1].res));
+  ASSERT_NE(0, reqs[2].error);
+  ASSERT_NE(EAI_AGAIN, reqs[2].error);
+  ASSERT_TRUE(reqs[2].res == nullptr);
+  for (auto& req : reqs) freeaddrinfo(req.res);
+
+  // A and AAAA for both.test, AAAA for v6.test, and both for nxdomain.invalid.
+  ASSERT_GE(resolver.server().udp_queries(), 5U);
+  ASSERT_EQ(0U, resolver.server().tcp_queries());
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
+TEST(netdb, getaddrinfo_batch_fake_dns_server_partial_timeout) {
+#if defined(__BIONIC__)
+  // AAAA queries go unanswered, so a name looked up with both A and AAAA gets
+  // just its IPv4 address, and one looked up with AAAA alone times out.
+  FakeDnsServer::Options options;
+  options.ignore_aaaa = true;
+  FakeDnsResolver resolver(options);
+  if (!resolver.StartServer()) {
+    GTEST_SKIP() << "couldn't start fake DNS server on port 53: " << strerror(errno);
+  }
+  ASSERT_TRUE(resolver.Configure());
+
+  addrinfo unspec = {};
+  unspec.ai_socktype = SOCK_STREAM;
+  addrinfo inet6 = unspec;
+  inet6.ai_family = AF_INET6;
+  android_getaddrinfo_request reqs[] = {
+      {"v4-only.test", nullptr, &unspec, nullptr, 0},
+      {"v6-only.test", nullptr, &inet6, nullptr, 0},
+  };
+  ASSERT_EQ(1, resolver.getaddrinfo_batch(reqs, 2, 500));
+
+  ASSERT_EQ(0, reqs[0].error);
+  ASSERT_EQ(std::vector<std::string>{"192.0.2.1"}, Addresses(reqs[0].res));
+  ASSERT_EQ(EAI_AGAIN, reqs[1].error);
+  ASSERT_TRUE(reqs[1].res == nullptr);
+  for (auto& req : reqs) freeaddrinfo(req.res);
+  ASSERT_EQ(0U, resolver.server().tcp_queries());
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
@@ -20,6 +20,9 @@
 #include <fcntl.h>
 #include <sys/cdefs.h>
 
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 #include "SignalUtils.h"
@@ -34,6 +37,7 @@
 #  define POSIX_SPAWN_SETSID 0
 # endif
 #elif defined(__BIONIC__)
+#include <android/fdsan.h>
 #include <platform/bionic/reserved_signals.h>
 #endif
 
@@ -547,3 +551,43 @@ TEST(spawn, posix_spawn_dup2_CLOEXEC) {
 
   AssertChildExited(pid, 0);
 }
+
+TEST(spawn, posix_spawn_addclose_fdsan) {
+#if defined(__BIONIC__)
+  // The child shares the parent's memory, so closing an fdsan-owned fd in the
+  // child mustn't touch the parent's record of who owns it.
+  int fd = open("/proc/version", O_RDONLY | O_CLOEXEC);
+  ASSERT_NE(-1, fd);
+  uint64_t tag = android_fdsan_create_owner_tag(ANDROID_FDSAN_OWNER_TYPE_GENERIC_00, 1234);
+  android_fdsan_exchange_owner_tag(fd, 0, tag);
+
+  posix_spawn_file_actions_t fa;
+  ASSERT_EQ(0, posix_spawn_file_actions_init(&fa));
+  ASSERT_EQ(0, posix_spawn_file_actions_addclose(&fa, fd));
+
+  ExecTestHelper eth;
+  eth.SetArgs({"true", nullptr});
+  pid_t pid;
+  ASSERT_EQ(0, posix_spawnp(&pid, eth.GetArg0(), &fa, nullptr, eth.GetArgs(), eth.GetEnv()));
+  ASSERT_EQ(0, posix_spawn_file_actions_destroy(&fa));
+  AssertChildExited(pid, 0);
+
+  ASSERT_EQ(tag, android_fdsan_get_owner_tag(fd));
+  ASSERT_EQ(0, android_fdsan_close_with_tag(fd, tag));
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
+TEST(spawn, posix_spawnp_long_argv) {
+  // The child runs on a stack of its own, which has to be big enough for
+  // execvpe's copies of $PATH and argv.
+  std::vector<std::string> args(20000, "x");
+  std::vector<const char*> argv = {"true"};
+  for (const std::string& arg : args) argv.push_back(arg.c_str());
+  argv.push_back(nullptr);
+  pid_t pid;
+  ASSERT_EQ(0, posix_spawnp(&pid, argv[0], nullptr, nullptr, const_cast<char**>(argv.data()),
+                            nullptr));
+  AssertChildExited(pid, 0);
+}
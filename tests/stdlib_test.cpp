@@ -20,8 +20,12 @@
 #include <limits.h>
 #include <math.h>
 #include <pthread.h>
+#include <sched.h>
+#include <signal.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/cdefs.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -29,6 +33,8 @@
 
 #include <limits>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <android-base/file.h>
 #include <android-base/macros.h>
@@ -39,6 +45,10 @@
 #include "math_data_test.h"
 #include "utils.h"
 
+#if defined(__BIONIC__)
+#include "platform/bionic/exit.h"
+#endif
+
 using namespace std::string_literals;
 
 template <typename T = int (*)(char*)>
@@ -647,6 +657,104 @@ TEST(stdlib, at_quick_exit) {
   AssertChildExited(pid, 99);
 }
 
+#if defined(__BIONIC__)
+static void fast_exit_quick_exit_handler() {
+  printf("quick_exit handler ran\n");
+}
+
+static void fast_exit_atexit_handler() {
+  printf("atexit handler ran\n");
+}
+
+static void CheckFastExit(void (*enable_fast_exit)()) {
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+
+  pid_t pid = fork();
+  ASSERT_NE(-1, pid) << strerror(errno);
+
+  if (pid == 0) {
+    close(fds[0]);
+    dup2(fds[1], STDOUT_FILENO);
+    setvbuf(stdout, nullptr, _IOFBF, BUFSIZ);
+    atexit(fast_exit_atexit_handler);
+    at_quick_exit(fast_exit_quick_exit_handler);
+    enable_fast_exit();
+    // Still sitting in the stdio buffer when exit() is called.
+    printf("buffered ");
+    exit(99);
+  }
+
+  close(fds[1]);
+  std::string output;
+  ASSERT_TRUE(android::base::ReadFdToString(fds[0], &output));
+  close(fds[0]);
+  AssertChildExited(pid, 99);
+  ASSERT_EQ("buffered quick_exit handler ran\n", output);
+}
+#endif
+
+TEST(stdlib, android_set_fast_exit) {
+#if defined(__BIONIC__)
+  CheckFastExit([]() { android_set_fast_exit(true); });
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
+TEST(stdlib, DISABLED_LIBC_FAST_EXIT) {
+#if defined(__BIONIC__)
+  // libc turned fast exit on at startup and took LIBC_FAST_EXIT out of the
+  // environment, so anything this process runs won't see it.
+  ASSERT_EQ(nullptr, getenv("LIBC_FAST_EXIT"));
+  CheckFastExit([]() {});
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
+TEST(stdlib, LIBC_FAST_EXIT) {
+#if defined(__BIONIC__)
+  // LIBC_FAST_EXIT only counts in the environment a process starts with.
+  ExecTestHelper eh;
+  eh.SetEnv({"LIBC_FAST_EXIT=1", nullptr});
+  std::string exec(testing::internal::GetArgvs()[0]);
+  eh.SetArgs({exec.c_str(), "--gtest_also_run_disabled_tests",
+              "--gtest_filter=stdlib.DISABLED_LIBC_FAST_EXIT", nullptr});
+  eh.Run([&]() { execve(exec.c_str(), eh.GetArgs(), eh.GetEnv()); }, 0,
+         R"(\[  PASSED  \] 1 test)");
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
+TEST(stdlib, LIBC_FAST_EXIT_set_too_late) {
+#if defined(__BIONIC__)
+  int fds[2];
+  ASSERT_NE(-1, pipe(fds));
+
+  pid_t pid = fork();
+  ASSERT_NE(-1, pid) << strerror(errno);
+
+  if (pid == 0) {
+    close(fds[0]);
+    dup2(fds[1], STDOUT_FILENO);
+    atexit(fast_exit_atexit_handler);
+    setenv("LIBC_FAST_EXIT", "1", 1);
+    exit(99);
+  }
+
+  close(fds[1]);
+  std::string output;
+  ASSERT_TRUE(android::base::ReadFdToString(fds[0], &output));
+  close(fds[0]);
+  AssertChildExited(pid, 99);
+  ASSERT_EQ("atexit handler ran\n", output);
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
 TEST(unistd, _Exit) {
   pid_t pid = fork();
   ASSERT_NE(-1, pid) << strerror(errno);
@@ -1013,3 +1121,88 @@ TEST(stdlib, setprogname) {
   ASSERT_STREQ("muppet", getprogname());
 #endif
 }
+
+TEST(stdlib, arc4random_fork) {
+#if defined(__BIONIC__)
+  // Make sure this thread's generator is seeded before the fork...
+  arc4random();
+
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  pid_t pid = fork();
+  ASSERT_NE(-1, pid);
+  if (pid == 0) {
+    uint8_t child_bytes[32];
+    arc4random_buf(child_bytes, sizeof(child_bytes));
+    ssize_t n = write(fds[1], child_bytes, sizeof(child_bytes));
+    _exit(n == static_cast<ssize_t>(sizeof(child_bytes)) ? 99 : 1);
+  }
+  close(fds[1]);
+
+  // ...so that the child would repeat our output if it weren't reseeded.
+  uint8_t parent_bytes[32];
+  arc4random_buf(parent_bytes, sizeof(parent_bytes));
+  uint8_t child_bytes[32];
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(child_bytes)),
+            TEMP_FAILURE_RETRY(read(fds[0], child_bytes, sizeof(child_bytes))));
+  close(fds[0]);
+  AssertChildExited(pid, 99);
+  ASSERT_NE(0, memcmp(parent_bytes, child_bytes, sizeof(parent_bytes)));
+#else
+  GTEST_SKIP() << "arc4random is bionic-only";
+#endif
+}
+
+#if defined(__BIONIC__)
+static int WriteArc4randomBytes(void* arg) {
+  uint8_t bytes[32];
+  arc4random_buf(bytes, sizeof(bytes));
+  ssize_t n = write(*static_cast<int*>(arg), bytes, sizeof(bytes));
+  _exit(n == static_cast<ssize_t>(sizeof(bytes)) ? 99 : 1);
+}
+#endif
+
+TEST(stdlib, arc4random_clone) {
+#if defined(__BIONIC__)
+  // Like arc4random_fork, but clone() doesn't run the atfork handlers.
+  arc4random();
+
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  std::vector<char> stack(64 * 1024);
+  pid_t pid = clone(WriteArc4randomBytes, stack.data() + stack.size(), SIGCHLD, &fds[1]);
+  ASSERT_NE(-1, pid);
+  close(fds[1]);
+
+  uint8_t parent_bytes[32];
+  arc4random_buf(parent_bytes, sizeof(parent_bytes));
+  uint8_t child_bytes[32];
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(child_bytes)),
+            TEMP_FAILURE_RETRY(read(fds[0], child_bytes, sizeof(child_bytes))));
+  close(fds[0]);
+  AssertChildExited(pid, 99);
+  ASSERT_NE(0, memcmp(parent_bytes, child_bytes, sizeof(parent_bytes)));
+#else
+  GTEST_SKIP() << "arc4random is bionic-only";
+#endif
+}
+
+TEST(stdlib, arc4random_threads) {
+#if defined(__BIONIC__)
+  // Each thread has its own generator; they must not produce the same output.
+  static constexpr size_t kThreadCount = 4;
+  uint8_t bytes[kThreadCount][32];
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&bytes, i]() { arc4random_buf(bytes[i], sizeof(bytes[i])); });
+  }
+  for (auto& t : threads) t.join();
+  for (size_t i = 0; i < kThreadCount; ++i) {
+    for (size_t j = i + 1; j < kThreadCount; ++j) {
+      ASSERT_NE(0, memcmp(bytes[i], bytes[j], sizeof(bytes[i])));
+    }
+  }
+#else
+  GTEST_SKIP() << "arc4random is bionic-only";
+#endif
+}
@@ -55,7 +55,7 @@ void tests(CheckSize check_size, CheckOffset check_offset) {
   CHECK_OFFSET(pthread_internal_t, dlerror_buffer, 248);
   CHECK_OFFSET(pthread_internal_t, bionic_tls, 760);
   CHECK_OFFSET(pthread_internal_t, errno_value, 768);
-  CHECK_SIZE(bionic_tls, 12200);
+  CHECK_SIZE(bionic_tls, 12816);
   CHECK_OFFSET(bionic_tls, key_data, 0);
   CHECK_OFFSET(bionic_tls, locale, 2080);
   CHECK_OFFSET(bionic_tls, basename_buf, 2088);
@@ -68,9 +68,13 @@ void tests(CheckSize check_size, CheckOffset check_offset) {
   CHECK_OFFSET(bionic_tls, strsignal_buf, 11695);
   CHECK_OFFSET(bionic_tls, group, 11952);
   CHECK_OFFSET(bionic_tls, passwd, 12040);
-  CHECK_OFFSET(bionic_tls, fdtrack_disabled, 12192);
-  CHECK_OFFSET(bionic_tls, bionic_systrace_disabled, 12193);
-  CHECK_OFFSET(bionic_tls, padding, 12194);
+  CHECK_OFFSET(bionic_tls, arc4random_state, 12192);
+  CHECK_OFFSET(bionic_tls, trace_buffer, 12792);
+  CHECK_OFFSET(bionic_tls, fdtrack_disabled, 12800);
+  CHECK_OFFSET(bionic_tls, bionic_systrace_disabled, 12801);
+  CHECK_OFFSET(bionic_tls, padding, 12802);
+  CHECK_OFFSET(bionic_tls, gwp_asan_countdown, 12804);
+  CHECK_OFFSET(bionic_tls, gwp_asan_random, 12808);
 #else
   CHECK_SIZE(pthread_internal_t, 668);
   CHECK_OFFSET(pthread_internal_t, next, 0);
@@ -97,7 +101,7 @@ void tests(CheckSize check_size, CheckOffset check_offset) {
   CHECK_OFFSET(pthread_internal_t, dlerror_buffer, 148);
   CHECK_OFFSET(pthread_internal_t, bionic_tls, 660);
   CHECK_OFFSET(pthread_internal_t, errno_value, 664);
-  CHECK_SIZE(bionic_tls, 11080);
+  CHECK_SIZE(bionic_tls, 11680);
   CHECK_OFFSET(bionic_tls, key_data, 0);
   CHECK_OFFSET(bionic_tls, locale, 1040);
   CHECK_OFFSET(bionic_tls, basename_buf, 1044);
@@ -110,9 +114,13 @@ void tests(CheckSize check_size, CheckOffset check_offset) {
   CHECK_OFFSET(bionic_tls, strsignal_buf, 10635);
   CHECK_OFFSET(bionic_tls, group, 10892);
   CHECK_OFFSET(bionic_tls, passwd, 10952);
-  CHECK_OFFSET(bionic_tls, fdtrack_disabled, 11076);
-  CHECK_OFFSET(bionic_tls, bionic_systrace_disabled, 11077);
-  CHECK_OFFSET(bionic_tls, padding, 11078);
+  CHECK_OFFSET(bionic_tls, arc4random_state, 11076);
+  CHECK_OFFSET(bionic_tls, trace_buffer, 11664);
+  CHECK_OFFSET(bionic_tls, fdtrack_disabled, 11668);
+  CHECK_OFFSET(bionic_tls, bionic_systrace_disabled, 11669);
+  CHECK_OFFSET(bionic_tls, padding, 11670);
+  CHECK_OFFSET(bionic_tls, gwp_asan_countdown, 11672);
+  CHECK_OFFSET(bionic_tls, gwp_asan_random, 11676);
 #endif  // __LP64__
 #undef CHECK_SIZE
 #undef CHECK_OFFSET
@@ -19,6 +19,12 @@
 #include <sys/sysinfo.h>
 #include <unistd.h>
 
+#include <vector>
+
+#if defined(__BIONIC__)
+#include "platform/bionic/cpu_topology.h"
+#endif
+
 TEST(sys_sysinfo, smoke) {
   int nprocs = get_nprocs();
   ASSERT_GT(nprocs, 0);
@@ -49,3 +55,33 @@ TEST(sys_sysinfo, sysinfo) {
   ASSERT_GE(si.totalswap, si.freeswap);
   ASSERT_GT(si.procs, 2);  // There's at least this test and init running!
 }
+
+TEST(sys_sysinfo, android_get_cpu_clusters) {
+#if defined(__BIONIC__)
+  size_t cluster_count = android_get_cpu_clusters(nullptr, 0);
+  ASSERT_GT(cluster_count, 0U);
+
+  std::vector<android_cpu_cluster> clusters(cluster_count);
+  ASSERT_EQ(cluster_count, android_get_cpu_clusters(clusters.data(), clusters.size()));
+  int cpu_count = 0;
+  for (size_t i = 0; i < cluster_count; ++i) {
+    ASSERT_GT(clusters[i].cpu_count, 0);
+    if (get_nprocs_conf() <= CPU_SETSIZE) {
+      ASSERT_EQ(clusters[i].cpu_count, CPU_COUNT(&clusters[i].cpus));
+    } else {
+      ASSERT_LE(CPU_COUNT(&clusters[i].cpus), clusters[i].cpu_count);
+    }
+    if (i > 0) ASSERT_LE(clusters[i - 1].capacity, clusters[i].capacity);
+    cpu_count += clusters[i].cpu_count;
+  }
+  ASSERT_EQ(get_nprocs_conf(), cpu_count);
+
+  // Dropping the cached topology just means it's read again.
+  android_cpu_topology_changed();
+  ASSERT_EQ(cluster_count, android_get_cpu_clusters(nullptr, 0));
+  ASSERT_GT(get_nprocs(), 0);
+  ASSERT_EQ(sysconf(_SC_NPROCESSORS_ONLN), get_nprocs());
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
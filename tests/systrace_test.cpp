@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__BIONIC__)
+
+#include <android-base/file.h>
+#include <android-base/properties.h>
+#include <android-base/stringprintf.h>
+
+#include "utils.h"
+
+// Buffered tracing (see libc/bionic/bionic_systrace.cpp) is chosen once per process, the first
+// time it traces an event, so these tests set the properties and then run a DISABLED_ test in a
+// freshly exec()ed copy of this binary. Setting the properties needs root.
+
+static constexpr const char* kDirProperty = "libc.debug.systrace.dir";
+static constexpr const char* kTagsProperty = "debug.atrace.tags.enableflags";
+static constexpr uint64_t kAtraceTagBionic = 1ULL << 16;  // ATRACE_TAG_BIONIC from cutils/trace.h.
+
+struct TraceEvent {
+  pid_t tid;
+  char type;
+  std::string message;
+};
+
+// Parses a bionic_trace.<pid> file, returning false if it's malformed.
+static bool ReadTraceFile(const std::string& path, pid_t* pid, std::vector<TraceEvent>* events) {
+  std::string data;
+  if (!android::base::ReadFileToString(path, &data)) return false;
+
+  size_t pos = 0;
+  auto read_u32 = [&](uint32_t* value) {
+    if (data.size() - pos < sizeof(*value)) return false;
+    memcpy(value, &data[pos], sizeof(*value));
+    pos += sizeof(*value);
+    return true;
+  };
+  while (pos < data.size()) {
+    if (data.size() - pos < 4) return false;
+    std::string magic = data.substr(pos, 4);
+    pos += 4;
+    if (magic == "BTRH") {
+      uint32_t version, header_pid, clock_id;
+      if (!read_u32(&version) || !read_u32(&header_pid) || !read_u32(&clock_id)) return false;
+      if (version != 1 || clock_id != CLOCK_MONOTONIC) return false;
+      *pid = header_pid;
+    } else if (magic == "BTRC") {
+      uint32_t tid, size;
+      if (!read_u32(&tid) || !read_u32(&size)) return false;
+      if (data.size() - pos < size) return false;
+      size_t end = pos + size;
+      uint64_t last_timestamp_ns = 0;
+      while (pos < end) {
+        uint64_t timestamp_ns;
+        if (end - pos < sizeof(timestamp_ns) + 2) return false;
+        memcpy(&timestamp_ns, &data[pos], sizeof(timestamp_ns));
+        if (timestamp_ns < last_timestamp_ns) return false;
+        last_timestamp_ns = timestamp_ns;
+        char type = data[pos + sizeof(timestamp_ns)];
+        size_t length = static_cast<uint8_t>(data[pos + sizeof(timestamp_ns) + 1]);
+        pos += sizeof(timestamp_ns) + 2;
+        if (end - pos < length) return false;
+        if (type == 'E' && length != 0) return false;
+        events->push_back({static_cast<pid_t>(tid), type, data.substr(pos, length)});
+        pos += length;
+      }
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Checks that |tid| recorded a pthread_create and then a pthread_join, as
+// std::thread(...).join() does. Anything else it traced (mutex contention, say)
+// is ignored.
+static void AssertCreateAndJoin(const std::vector<TraceEvent>& events, pid_t tid) {
+  std::vector<std::string> open;
+  std::vector<std::string> seen;
+  for (const TraceEvent& event : events) {
+    if (event.tid != tid) continue;
+    std::string name;
+    if (event.type == 'B') {
+      name = event.message;
+      open.push_back(name);
+    } else {
+      ASSERT_FALSE(open.empty()) << "unmatched end event";
+      name = open.back();
+      open.pop_back();
+    }
+    if (name == "pthread_create" || name == "pthread_join") {
+      seen.push_back(std::string(1, event.type) + "|" + name);
+    }
+  }
+  std::vector<std::string> expected = {"B|pthread_create", "E|pthread_create", "B|pthread_join",
+                                       "E|pthread_join"};
+  ASSERT_EQ(expected, seen);
+}
+
+static std::string TraceFilePath(pid_t pid) {
+  return android::base::StringPrintf("%s/bionic_trace.%d",
+                                     android::base::GetProperty(kDirProperty, "").c_str(), pid);
+}
+
+// Turns buffered tracing on (or just sets the directory, with |bionic_tag|
+// false) for as long as it's in scope.
+class BufferedTracing {
+ public:
+  BufferedTracing()
+      : old_dir_(android::base::GetProperty(kDirProperty, "")),
+        old_tags_(android::base::GetProperty(kTagsProperty, "")) {}
+
+  ~BufferedTracing() {
+    android::base::SetProperty(kDirProperty, old_dir_);
+    android::base::SetProperty(kTagsProperty, old_tags_);
+
+    // Other processes that started tracing meanwhile may have left files here too.
+    DIR* d = opendir(dir_.path);
+    if (d == nullptr) return;
+    while (dirent* e = readdir(d)) {
+      if (strncmp(e->d_name, "bionic_trace.", strlen("bionic_trace.")) == 0) {
+        unlinkat(dirfd(d), e->d_name, 0);
+      }
+    }
+    closedir(d);
+  }
+
+  bool Enable(bool bionic_tag) {
+    uint64_t tags = strtoull(old_tags_.c_str(), nullptr, 0);
+    tags = bionic_tag ? (tags | kAtraceTagBionic) : (tags & ~kAtraceTagBionic);
+    std::string tags_value = android::base::StringPrintf("%#" PRIx64, tags);
+    return android::base::SetProperty(kTagsProperty, tags_value) &&
+           android::base::SetProperty(kDirProperty, dir_.path);
+  }
+
+ private:
+  TemporaryDir dir_;
+  std::string old_dir_;
+  std::string old_tags_;
+};
+
+static void RunWithBufferedTracing(bool bionic_tag, const char* test_name) {
+  if (getuid() != 0) GTEST_SKIP() << "setting the tracing properties requires root";
+  BufferedTracing tracing;
+  if (!tracing.Enable(bionic_tag)) GTEST_SKIP() << "couldn't set the tracing properties";
+  RunSubtestNoEnv(test_name);
+}
+#endif
+
+TEST(systrace, DISABLED_buffered_events) {
+#if defined(__BIONIC__)
+  // The thread's own pthread_create and pthread_join are written out when it exits.
+  pid_t thread_tid = 0;
+  std::thread([&thread_tid]() {
+    thread_tid = gettid();
+    std::thread([]() {}).join();
+  }).join();
+
+  pid_t pid = 0;
+  std::vector<TraceEvent> events;
+  ASSERT_TRUE(ReadTraceFile(TraceFilePath(getpid()), &pid, &events));
+  ASSERT_EQ(getpid(), pid);
+  AssertCreateAndJoin(events, thread_tid);
+
+  // The main thread's buffer is written out by exit().
+  pid_t child = fork();
+  ASSERT_NE(-1, child);
+  if (child == 0) {
+    std::thread([]() {}).join();
+    exit(0);
+  }
+  AssertChildExited(child, 0);
+
+  events.clear();
+  ASSERT_TRUE(ReadTraceFile(TraceFilePath(child), &pid, &events));
+  ASSERT_EQ(child, pid);
+  AssertCreateAndJoin(events, child);
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
+TEST(systrace, buffered_events) {
+#if defined(__BIONIC__)
+  RunWithBufferedTracing(true, "systrace.DISABLED_buffered_events");
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
+TEST(systrace, DISABLED_buffered_events_need_bionic_tag) {
+#if defined(__BIONIC__)
+  std::thread([]() { std::thread([]() {}).join(); }).join();
+  ASSERT_EQ(-1, access(TraceFilePath(getpid()).c_str(), F_OK));
+  ASSERT_EQ(ENOENT, errno);
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
+
+TEST(systrace, buffered_events_need_bionic_tag) {
+#if defined(__BIONIC__)
+  RunWithBufferedTracing(false, "systrace.DISABLED_buffered_events_need_bionic_tag");
+#else
+  GTEST_SKIP() << "bionic-only test";
+#endif
+}
@@ -1118,6 +1118,22 @@ TEST(UNISTD_TEST, sysconf_SC_NPROCESSORS_ONLN) {
   ASSERT_EQ(online_cpus, sysconf(_SC_NPROCESSORS_ONLN));
 }
 
+TEST(UNISTD_TEST, sysconf_SC_LEVEL1_DCACHE_LINESIZE) {
+  long line_size = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+#if defined(__BIONIC__) && (defined(__aarch64__) || defined(__i386__) || defined(__x86_64__))
+  // These come from the CPU itself (CTR_EL0 or CPUID), so they're always known.
+  ASSERT_GT(line_size, 0);
+#else
+  // Elsewhere 0 means unknown.
+  ASSERT_GE(line_size, 0);
+#endif
+  if (line_size > 0) {
+    ASSERT_EQ(0, line_size & (line_size - 1)) << line_size;
+    long size = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    if (size > 0) ASSERT_EQ(0, size % line_size) << size;
+  }
+}
+
 TEST(UNISTD_TEST, sysconf_SC_ARG_MAX) {
   // Since Linux 2.6.23, ARG_MAX isn't a constant and depends on RLIMIT_STACK.
   // See prepare_arg_pages() in the kernel for the gory details:
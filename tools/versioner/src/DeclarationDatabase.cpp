@@ -187,13 +187,6 @@ class Visitor : public RecursiveASTVisitor<Visitor> {
       }
     }
 
-    auto symbol_it = database.symbols.find(declaration_name);
-    if (symbol_it == database.symbols.end()) {
-      Symbol symbol = {.name = declaration_name };
-      bool unused;
-      std::tie(symbol_it, unused) = database.symbols.insert({declaration_name, symbol});
-    }
-
     auto expansion_range = src_manager.getExpansionRange(range);
     auto filename = src_manager.getFilename(expansion_range.getBegin());
     if (filename != src_manager.getFilename(expansion_range.getEnd())) {
@@ -212,28 +205,15 @@ class Visitor : public RecursiveASTVisitor<Visitor> {
       }
     };
 
-    // Find or insert an entry for the declaration.
-    if (auto declaration_it = symbol_it->second.declarations.find(location);
-        declaration_it != symbol_it->second.declarations.end()) {
-      if (declaration_it->second.is_extern != is_extern ||
-          declaration_it->second.is_definition != is_definition ||
-          declaration_it->second.no_guard != no_guard ||
-          declaration_it->second.fortify_inline != fortify_inline) {
-        errx(1, "varying declaration of '%s' at %s:%u:%u", declaration_name.c_str(),
-             location.filename.c_str(), location.start.line, location.start.column);
-      }
-      declaration_it->second.availability.insert(std::make_pair(type, availability));
-    } else {
-      Declaration declaration;
-      declaration.name = declaration_name;
-      declaration.location = location;
-      declaration.is_extern = is_extern;
-      declaration.is_definition = is_definition;
-      declaration.no_guard = no_guard;
-      declaration.fortify_inline = fortify_inline;
-      declaration.availability.insert(std::make_pair(type, availability));
-      symbol_it->second.declarations.insert(std::make_pair(location, declaration));
-    }
+    Declaration declaration;
+    declaration.name = declaration_name;
+    declaration.location = location;
+    declaration.is_extern = is_extern;
+    declaration.is_definition = is_definition;
+    declaration.no_guard = no_guard;
+    declaration.fortify_inline = fortify_inline;
+    declaration.availability.insert(std::make_pair(type, availability));
+    database.addDeclaration(declaration);
 
     return true;
   }
@@ -335,12 +315,138 @@ bool Symbol::hasDeclaration(const CompilationType& type) const {
   return false;
 }
 
+void HeaderDatabase::addDeclaration(const Declaration& declaration) {
+  auto symbol_it = symbols.find(declaration.name);
+  if (symbol_it == symbols.end()) {
+    Symbol symbol = {.name = declaration.name };
+    bool unused;
+    std::tie(symbol_it, unused) = symbols.insert({declaration.name, symbol});
+  }
+
+  // Find or insert an entry for the declaration.
+  const Location& location = declaration.location;
+  if (auto declaration_it = symbol_it->second.declarations.find(location);
+      declaration_it != symbol_it->second.declarations.end()) {
+    if (declaration_it->second.is_extern != declaration.is_extern ||
+        declaration_it->second.is_definition != declaration.is_definition ||
+        declaration_it->second.no_guard != declaration.no_guard ||
+        declaration_it->second.fortify_inline != declaration.fortify_inline) {
+      errx(1, "varying declaration of '%s' at %s:%u:%u", declaration.name.c_str(),
+           location.filename.c_str(), location.start.line, location.start.column);
+    }
+    declaration_it->second.availability.insert(declaration.availability.begin(),
+                                               declaration.availability.end());
+  } else {
+    symbol_it->second.declarations.insert(std::make_pair(location, declaration));
+  }
+}
+
 void HeaderDatabase::parseAST(CompilationType type, ASTContext& ctx) {
   std::unique_lock<std::mutex> lock(this->mutex);
   Visitor visitor(*this, type, ctx);
   visitor.TraverseDecl(ctx.getTranslationUnitDecl());
 }
 
+void HeaderDatabase::merge(const HeaderDatabase& other) {
+  std::unique_lock<std::mutex> lock(this->mutex);
+  for (const auto& symbol_it : other.symbols) {
+    for (const auto& declaration_it : symbol_it.second.declarations) {
+      addDeclaration(declaration_it.second);
+    }
+  }
+}
+
+// Each declaration is a line of tab-separated fields: the name, the location, the flags, and
+// then the global and per-architecture availability for the CompilationType.
+static std::string serializeAvailability(const AvailabilityValues& av) {
+  return std::to_string(av.introduced) + "," + std::to_string(av.deprecated) + "," +
+         std::to_string(av.obsoleted);
+}
+
+static bool deserializeAvailability(llvm::StringRef str, AvailabilityValues* av) {
+  llvm::SmallVector<llvm::StringRef, 3> fields;
+  str.split(fields, ",");
+  return fields.size() == 3 && !fields[0].getAsInteger(10, av->introduced) &&
+         !fields[1].getAsInteger(10, av->deprecated) && !fields[2].getAsInteger(10, av->obsoleted);
+}
+
+std::string HeaderDatabase::serialize(CompilationType type) const {
+  std::stringstream ss;
+  for (const auto& symbol_it : symbols) {
+    for (const auto& declaration_it : symbol_it.second.declarations) {
+      const Declaration& decl = declaration_it.second;
+      auto availability_it = decl.availability.find(type);
+      if (availability_it == decl.availability.end()) {
+        continue;
+      }
+      const Location& loc = decl.location;
+      ss << decl.name << "\t" << loc.filename << "\t" << loc.start.line << "\t"
+         << loc.start.column << "\t" << loc.end.line << "\t" << loc.end.column << "\t"
+         << decl.is_extern << decl.is_definition << decl.no_guard << decl.fortify_inline << "\t"
+         << serializeAvailability(availability_it->second.global_availability);
+      for (Arch arch : supported_archs) {
+        ss << "\t" << serializeAvailability(availability_it->second.arch_availability[arch]);
+      }
+      ss << "\n";
+    }
+  }
+  return ss.str();
+}
+
+bool HeaderDatabase::deserialize(CompilationType type, llvm::StringRef data) {
+  llvm::SmallVector<llvm::StringRef, 64> lines;
+  data.split(lines, "\n", -1, false);
+  for (llvm::StringRef line : lines) {
+    llvm::SmallVector<llvm::StringRef, 12> fields;
+    line.split(fields, "\t");
+    if (fields.size() != 8 + supported_archs.size() || fields[6].size() != 4) {
+      return false;
+    }
+
+    Declaration decl;
+    decl.name = fields[0].str();
+    decl.location.filename = fields[1].str();
+    if (fields[2].getAsInteger(10, decl.location.start.line) ||
+        fields[3].getAsInteger(10, decl.location.start.column) ||
+        fields[4].getAsInteger(10, decl.location.end.line) ||
+        fields[5].getAsInteger(10, decl.location.end.column)) {
+      return false;
+    }
+    decl.is_extern = fields[6][0] == '1';
+    decl.is_definition = fields[6][1] == '1';
+    decl.no_guard = fields[6][2] == '1';
+    decl.fortify_inline = fields[6][3] == '1';
+
+    DeclarationAvailability availability;
+    if (!deserializeAvailability(fields[7], &availability.global_availability)) {
+      return false;
+    }
+    size_t field = 8;
+    for (Arch arch : supported_archs) {
+      if (!deserializeAvailability(fields[field++], &availability.arch_availability[arch])) {
+        return false;
+      }
+    }
+    decl.availability.insert(std::make_pair(type, availability));
+    addDeclaration(decl);
+  }
+  return true;
+}
+
+bool HeaderDatabase::sameDeclarations(const HeaderDatabase& other) const {
+  if (symbols.size() != other.symbols.size()) {
+    return false;
+  }
+  for (const auto& [name, symbol] : symbols) {
+    auto other_it = other.symbols.find(name);
+    if (other_it == other.symbols.end() ||
+        symbol.declarations != other_it->second.declarations) {
+      return false;
+    }
+  }
+  return true;
+}
+
 std::string to_string(const AvailabilityValues& av) {
   std::stringstream ss;
 
@@ -116,6 +116,10 @@ struct Location {
   bool operator<(const Location& rhs) const {
     return std::tie(filename, start, end) < std::tie(rhs.filename, rhs.start, rhs.end);
   }
+
+  bool operator==(const Location& rhs) const {
+    return std::tie(filename, start, end) == std::tie(rhs.filename, rhs.start, rhs.end);
+  }
 };
 
 std::string to_string(const Location& loc);
@@ -135,6 +139,14 @@ struct Declaration {
     return location < rhs.location;
   }
 
+  // Unlike operator<, compares everything about the declaration.
+  bool operator==(const Declaration& rhs) const {
+    return std::tie(name, location, is_extern, is_definition, no_guard, fortify_inline,
+                    availability) == std::tie(rhs.name, rhs.location, rhs.is_extern,
+                                              rhs.is_definition, rhs.no_guard,
+                                              rhs.fortify_inline, rhs.availability);
+  }
+
   void dump(const std::string& base_path = "", FILE* out = stdout, unsigned indent = 0) const {
     std::string indent_str(indent, ' ');
     fprintf(out, "%s", indent_str.c_str());
@@ -201,7 +213,17 @@ class HeaderDatabase {
  public:
   std::map<std::string, Symbol> symbols;
 
+  void addDeclaration(const Declaration& declaration);
   void parseAST(CompilationType type, clang::ASTContext& ast);
+  void merge(const HeaderDatabase& other);
+
+  // Converts the declarations found for a CompilationType to and from the
+  // format the result cache stores them in (see Driver.cpp).
+  std::string serialize(CompilationType type) const;
+  bool deserialize(CompilationType type, llvm::StringRef data);
+
+  // Returns true if both databases hold exactly the same declarations.
+  bool sameDeclarations(const HeaderDatabase& other) const;
 
   void dump(const std::string& base_path = "", FILE* out = stdout) const {
     fprintf(out, "HeaderDatabase contains %zu symbols:\n", symbols.size());
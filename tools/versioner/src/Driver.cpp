@@ -17,10 +17,15 @@
 #include "Driver.h"
 
 #include <err.h>
+#include <inttypes.h>
+#include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <chrono>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -38,12 +43,18 @@
 #include <clang/Frontend/TextDiagnosticPrinter.h>
 #include <clang/Frontend/Utils.h>
 #include <clang/FrontendTool/Utils.h>
+#include <llvm/ADT/ArrayRef.h>
 #include <llvm/ADT/IntrusiveRefCntPtr.h>
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/ADT/StringRef.h>
 #include <llvm/Option/Option.h>
 #include <llvm/Support/Host.h>
+#include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/VirtualFileSystem.h>
+#include <llvm/Support/xxhash.h>
+
+#include <android-base/file.h>
+#include <android-base/strings.h>
 
 #include "Arch.h"
 #include "DeclarationDatabase.h"
@@ -238,9 +249,166 @@ void initializeTargetCC1FlagCache(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem
   }
 }
 
-void compileHeader(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> vfs,
+// The result cache keeps the declarations each (CompilationType, header) compilation found, along
+// with a hash of every file the compilation read. A result is reused for as long as none of those
+// files change, so after an edit only the edited header and the headers that include it are
+// recompiled. (A header that a __has_include() would now find isn't noticed.)
+static const char* result_cache_magic = "versioner result cache 1";
+
+class IncludedFileCollector : public DependencyCollector {
+ public:
+  // All of the headers are system headers, since they're passed with -isystem.
+  bool needSystemDependencies() override {
+    return true;
+  }
+};
+
+static std::mutex file_hash_mutex;
+static std::unordered_map<std::string, std::optional<uint64_t>> file_hashes;
+
+static std::optional<uint64_t> hashFile(llvm::vfs::FileSystem& vfs, const std::string& path) {
+  {
+    std::lock_guard<std::mutex> lock(file_hash_mutex);
+    if (auto it = file_hashes.find(path); it != file_hashes.end()) {
+      return it->second;
+    }
+  }
+
+  std::optional<uint64_t> hash;
+  if (auto buffer = vfs.getBufferForFile(path)) {
+    hash = llvm::xxHash64(buffer.get()->getBuffer());
+  }
+
+  std::lock_guard<std::mutex> lock(file_hash_mutex);
+  file_hashes.emplace(path, hash);
+  return hash;
+}
+
+// A rebuilt versioner (or one with a different clang) can find different declarations in the
+// same headers, so its own hash is part of every cache key.
+static uint64_t getVersionerHash() {
+  static const uint64_t hash = []() {
+    std::string path = android::base::GetExecutablePath();
+    auto buffer = llvm::MemoryBuffer::getFile(path);
+    if (!buffer) {
+      errx(1, "failed to read '%s' for the result cache key: %s", path.c_str(),
+           buffer.getError().message().c_str());
+    }
+    return llvm::xxHash64(buffer.get()->getBuffer());
+  }();
+  return hash;
+}
+
+// Cache entries are named for a hash of the versioner binary and the compiler flags, so anything
+// that changes them (a new versioner, the target, the API level, or versioner's own flags)
+// misses. The first line of the entry repeats the CompilationType and header, in case of a
+// collision.
+static std::string getResultCachePath(const std::string& cache_dir, CompilationType type,
+                                      const std::string& filename) {
+  std::string key = result_cache_magic;
+  key += '\0';
+  key += std::to_string(getVersionerHash());
+  for (const char* flag : getCC1Command(type, filename)) {
+    key += '\0';
+    key += flag;
+  }
+
+  char name[17];
+  snprintf(name, sizeof(name), "%016" PRIx64, llvm::xxHash64(key));
+  return cache_dir + "/" + name;
+}
+
+static std::string getResultCacheHeader(CompilationType type, const std::string& filename) {
+  return result_cache_magic + "\t"s + to_string(type) + "\t" + filename + "\n";
+}
+
+// The entry is the header line, one "hash<TAB>path" line per file read, a blank line, and then the
+// declarations.
+static bool readCachedResult(llvm::vfs::FileSystem& vfs, const std::string& path,
+                             HeaderDatabase* result, CompilationType type,
+                             const std::string& filename) {
+  std::string data;
+  if (!android::base::ReadFileToString(path, &data)) {
+    return false;
+  }
+
+  std::string header = getResultCacheHeader(type, filename);
+  if (!android::base::StartsWith(data, header)) {
+    return false;
+  }
+
+  size_t pos = header.size();
+  while (true) {
+    size_t end = data.find('\n', pos);
+    if (end == std::string::npos) {
+      return false;
+    } else if (end == pos) {
+      break;
+    }
+
+    llvm::StringRef line(data.data() + pos, end - pos);
+    auto [hash_str, file] = line.split('\t');
+    uint64_t hash;
+    if (hash_str.getAsInteger(16, hash) || hashFile(vfs, file.str()) != hash) {
+      return false;
+    }
+    pos = end + 1;
+  }
+
+  HeaderDatabase cached;
+  if (!cached.deserialize(type, llvm::StringRef(data).substr(pos + 1))) {
+    return false;
+  }
+  result->merge(cached);
+  return true;
+}
+
+static void writeCachedResult(llvm::vfs::FileSystem& vfs, const std::string& path,
+                              const HeaderDatabase& database, CompilationType type,
+                              const std::string& filename,
+                              llvm::ArrayRef<std::string> included_files) {
+  std::string data = getResultCacheHeader(type, filename);
+  for (const std::string& file : included_files) {
+    // Files that didn't come from the VFS (the empty stdin) can't change.
+    if (std::optional<uint64_t> hash = hashFile(vfs, file)) {
+      char hash_str[17];
+      snprintf(hash_str, sizeof(hash_str), "%016" PRIx64, *hash);
+      data += hash_str + "\t"s + file + "\n";
+    }
+  }
+  data += "\n";
+  std::string declarations = database.serialize(type);
+  data += declarations;
+
+  // A cached result that read back differently would silently change versioner's answers, so
+  // make sure that this one reads back as exactly what was compiled.
+  HeaderDatabase round_trip;
+  if (!round_trip.deserialize(type, declarations) || !round_trip.sameDeclarations(database)) {
+    errx(1, "result cache entry for %s (%s) doesn't round-trip", filename.c_str(),
+         to_string(type).c_str());
+  }
+
+  // Write a temporary file and rename it into place, so that concurrent runs never see a partial
+  // entry. Failing to write the cache isn't fatal.
+  std::string tmp_path = path + "." + std::to_string(getpid()) + ".tmp";
+  if (!android::base::WriteStringToFile(data, tmp_path) ||
+      rename(tmp_path.c_str(), path.c_str()) != 0) {
+    warn("failed to write result cache entry '%s'", path.c_str());
+    unlink(tmp_path.c_str());
+  }
+}
+
+bool compileHeader(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> vfs,
                    HeaderDatabase* header_database, CompilationType type,
-                   const std::string& filename) {
+                   const std::string& filename, const std::string& cache_dir) {
+  std::string cache_path;
+  if (!cache_dir.empty()) {
+    cache_path = getResultCachePath(cache_dir, type, filename);
+    if (readCachedResult(*vfs, cache_path, header_database, type, filename)) {
+      return true;
+    }
+  }
+
   auto diags = constructDiags();
   std::vector<const char*> cc1_flags = getCC1Command(type, filename);
   auto invocation = std::make_unique<CompilerInvocation>();
@@ -254,7 +422,14 @@ void compileHeader(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> vfs,
   Compiler.setDiagnostics(diags.get());
   Compiler.createFileManager(vfs);
 
-  VersionerASTAction versioner_action(header_database, type);
+  auto included_files = std::make_shared<IncludedFileCollector>();
+  if (!cache_dir.empty()) {
+    Compiler.addDependencyCollector(included_files);
+  }
+
+  // Collect this compilation's declarations on their own, so they can be cached.
+  HeaderDatabase database;
+  VersionerASTAction versioner_action(&database, type);
   if (!Compiler.ExecuteAction(versioner_action)) {
     errx(1, "compilation generated warnings or errors");
   }
@@ -262,4 +437,11 @@ void compileHeader(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> vfs,
   if (diags->getNumWarnings() || diags->hasErrorOccurred()) {
     errx(1, "compilation generated warnings or errors");
   }
+
+  header_database->merge(database);
+  if (!cache_dir.empty()) {
+    writeCachedResult(*vfs, cache_path, database, type, filename,
+                      included_files->getDependencies());
+  }
+  return false;
 }
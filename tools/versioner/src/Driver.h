@@ -35,6 +35,9 @@ void initializeTargetCC1FlagCache(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem
                                   const std::set<CompilationType>& types,
                                   const std::unordered_map<Arch, CompilationRequirements>& reqs);
 
-void compileHeader(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> vfs,
+// Compiles a header, adding its declarations to header_database. If cache_dir isn't empty, the
+// results are cached there, and reused while the header and everything it includes is unchanged.
+// Returns whether the cached results were used.
+bool compileHeader(llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> vfs,
                    HeaderDatabase* header_database, CompilationType type,
-                   const std::string& filename);
+                   const std::string& filename, const std::string& cache_dir);
@@ -16,6 +16,7 @@
 
 #include <dirent.h>
 #include <err.h>
+#include <errno.h>
 #include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -183,7 +184,8 @@ static std::set<CompilationType> generateCompilationTypes(const std::set<Arch> s
 }
 
 static std::unique_ptr<HeaderDatabase> compileHeaders(const std::set<CompilationType>& types,
-                                                      const HeaderLocationInformation& location) {
+                                                      const HeaderLocationInformation& location,
+                                                      const std::string& cache_dir) {
   if (types.empty()) {
     errx(1, "compileHeaders received no CompilationTypes");
   }
@@ -207,6 +209,7 @@ static std::unique_ptr<HeaderDatabase> compileHeaders(const std::set<Compilation
 
   std::vector<std::pair<CompilationType, const std::string&>> jobs;
   std::atomic<size_t> job_index(0);
+  std::atomic<size_t> cached_jobs(0);
   for (CompilationType type : types) {
     CompilationRequirements& req = requirements[type.arch];
     for (const std::string& header : req.headers) {
@@ -233,12 +236,12 @@ static std::unique_ptr<HeaderDatabase> compileHeaders(const std::set<Compilation
 
   if (thread_count == 1) {
     for (const auto& job : jobs) {
-      compileHeader(vfs, result.get(), job.first, job.second);
+      cached_jobs += compileHeader(vfs, result.get(), job.first, job.second, cache_dir);
     }
   } else {
     // Spawn threads.
     for (size_t i = 0; i < thread_count; ++i) {
-      threads.emplace_back([&jobs, &job_index, &result, vfs]() {
+      threads.emplace_back([&jobs, &job_index, &cached_jobs, &result, &cache_dir, vfs]() {
         while (true) {
           size_t idx = job_index++;
           if (idx >= jobs.size()) {
@@ -246,7 +249,7 @@ static std::unique_ptr<HeaderDatabase> compileHeaders(const std::set<Compilation
           }
 
           const auto& job = jobs[idx];
-          compileHeader(vfs, result.get(), job.first, job.second);
+          cached_jobs += compileHeader(vfs, result.get(), job.first, job.second, cache_dir);
         }
       });
     }
@@ -258,6 +261,10 @@ static std::unique_ptr<HeaderDatabase> compileHeaders(const std::set<Compilation
     threads.clear();
   }
 
+  if (!cache_dir.empty()) {
+    D("Reused cached results for %zu of %zu compilations\n", cached_jobs.load(), jobs.size());
+  }
+
   return result;
 }
 
@@ -476,6 +483,7 @@ static void usage(bool help = false) {
     fprintf(stderr, "  -f\t\tpreprocess header files even if validation fails\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "Miscellaneous:\n");
+    fprintf(stderr, "  -c PATH\tcache compilation results in PATH, to skip unchanged headers\n");
     fprintf(stderr, "  -F\t\tdo not ignore FORTIFY headers by default\n");
     fprintf(stderr, "  -d\t\tdump function availability\n");
     fprintf(stderr, "  -j THREADS\tmaximum number of threads to use\n");
@@ -497,12 +505,13 @@ int main(int argc, char** argv) {
   std::set<Arch> selected_architectures;
   std::set<int> selected_levels;
   std::string preprocessor_output_path;
+  std::string cache_dir;
   bool force = false;
   bool dump = false;
   bool ignore_fortify_headers = true;
 
   int c;
-  while ((c = getopt(argc, argv, "a:r:p:so:fdj:vhFi")) != -1) {
+  while ((c = getopt(argc, argv, "a:r:p:so:fdc:j:vhFi")) != -1) {
     switch (c) {
       case 'a': {
         char* end;
@@ -567,6 +576,19 @@ int main(int argc, char** argv) {
         dump = true;
         break;
 
+      case 'c':
+        if (!cache_dir.empty()) {
+          usage();
+        }
+        cache_dir = optarg;
+        if (cache_dir.empty()) {
+          usage();
+        }
+        if (mkdir(cache_dir.c_str(), 0755) != 0 && errno != EEXIST) {
+          err(1, "failed to create cache directory '%s'", cache_dir.c_str());
+        }
+        break;
+
       case 'j':
         if (!android::base::ParseInt<int>(optarg, &max_thread_count, 1)) {
           usage();
@@ -664,7 +686,7 @@ int main(int argc, char** argv) {
 
   auto start = std::chrono::high_resolution_clock::now();
   std::unique_ptr<HeaderDatabase> declaration_database =
-      compileHeaders(compilation_types, location);
+      compileHeaders(compilation_types, location, cache_dir);
   auto end = std::chrono::high_resolution_clock::now();
 
   if (verbose) {
@@ -0,0 +1,9 @@
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+typedef int bar_t;
+
+#if defined(__cplusplus)
+}
+#endif
@@ -0,0 +1,9 @@
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include <bar_arch.h>
+
+#if defined(__cplusplus)
+}
+#endif
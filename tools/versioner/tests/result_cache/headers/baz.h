@@ -0,0 +1,29 @@
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+// Declarations whose cached results have to keep more than the global availability.
+int baz_arch(void) __INTRODUCED_IN_ARM(9) __INTRODUCED_IN_X86(12);
+int baz_no_guard(void) __VERSIONER_NO_GUARD __INTRODUCED_IN(9);
+
+extern int baz_real(int flags, ...);
+
+static inline __attribute__((always_inline))
+int baz(int flags)
+    __attribute__((annotate("versioner_fortify_inline")))
+    __attribute__((overloadable))
+    __attribute__((enable_if(!(flags & 1), ""))) {
+  return baz_real(flags);
+}
+
+static inline __attribute__((always_inline))
+int baz(int flags, int mode)
+    __attribute__((annotate("versioner_fortify_inline")))
+    __attribute__((overloadable))
+    __attribute__((enable_if(flags & 1, ""))) {
+  return baz_real(flags, mode);
+}
+
+#if defined(__cplusplus)
+}
+#endif
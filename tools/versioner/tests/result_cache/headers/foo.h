@@ -0,0 +1,11 @@
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#include <bar.h>
+
+bar_t foo(void) __INTRODUCED_IN(9);
+
+#if defined(__cplusplus)
+}
+#endif
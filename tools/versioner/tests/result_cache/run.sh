@@ -0,0 +1,27 @@
+set -e
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+cp -r dependencies "$tmp/deps"
+run() {
+  versioner headers "$tmp/deps" -r arm -a 9 -i -j1 "$@"
+}
+run -d > "$tmp/uncached"
+run -c "$tmp/cache"
+# The second run has to reuse every one of the first run's results, not just succeed again, and
+# what it reuses has to be exactly what compiling the headers afresh finds.
+run -c "$tmp/cache" -v | grep -q 'Reused cached results for \([1-9][0-9]*\) of \1 compilations'
+run -c "$tmp/cache" -d > "$tmp/cached"
+diff "$tmp/uncached" "$tmp/cached"
+# A different versioner binary mustn't reuse any of them. The copy keeps the
+# same layout, so that it still finds its shared libraries.
+bin=$(dirname "$(command -v versioner)")
+mkdir "$tmp/bin"
+cp "$bin/versioner" "$tmp/bin/versioner"
+printf '\0' >> "$tmp/bin/versioner"
+ln -s "$bin/../lib64" "$tmp/lib64"
+"$tmp/bin/versioner" headers "$tmp/deps" -r arm -a 9 -i -j1 -c "$tmp/cache" -v |
+  grep -q 'Reused cached results for 0 of [1-9][0-9]* compilations'
+# The cached results have to be invalidated by an edit to any header that was
+# included, not just by one to the header that was compiled.
+echo "#error bar_arch.h changed" >> "$tmp/deps/arm/bar_arch/bar_arch.h"
+run -c "$tmp/cache"